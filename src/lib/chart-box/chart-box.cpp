@@ -1,6 +1,7 @@
 // GPL v3 (c) 2021, Daniel Williams 
 
 #include <cmath>
+#include <vector>
 
 #include <fmt/core.h>
 
@@ -9,45 +10,263 @@
 
 #include "chart-box.hpp"
 
-using chartbox::ChartBox;
+using chartbox::BasicChartBox;
 
-ChartBox::ChartBox()
+template<typename... slot_t>
+BasicChartBox<slot_t...>::BasicChartBox()
     : mapping_()
-    , boundary_layer_()
-    , contour_layer_()
+    , layers_()
 {
+    layers_.for_each( []( auto slot, auto& layer ){
+        layer.fill( chartbox::layer::default_cell_value );
+        layer.name( fmt::format( "{}Layer", chartbox::layer::role_name( decltype(slot)::role ) ) );
 
-    boundary_layer_.fill( chartbox::layer::default_cell_value );
-    boundary_layer_.name("BoundaryLayerGrid");
-    
-    contour_layer_.fill( chartbox::layer::default_cell_value );
-    contour_layer_.name("ContourLayerGrid");
+        // (lets `raycast` skip clear areas, without a composite)
+        if constexpr ( requires { layer.enable_pyramid( true ); } ){
+            layer.enable_pyramid( true );
+        }
+    });
+}
+
+template<typename... slot_t>
+bool BasicChartBox<slot_t...>::enable_composite( bool enable ){
+    if( ! enable ){
+        composite_.reset();
+        return true;
+    }else if( concurrent_readers_ ){
+        return false;
+    }
+
+    if( ! composite_ ){
+        const primary_layer_t& primary = layers_.template at<0>();
+        composite_ = std::make_unique<composite_layer_t>( primary.meters_across_cell() );
+        composite_->name("CompositeLayer");
+        composite_->relocate( primary.visible().min );
+        recompose();
+    }
+    return true;
 }
 
-uint8_t ChartBox::get( const LocalLocation& location ) const { 
-    const uint8_t boundary_value = boundary_layer_.get( location );
-    const uint8_t contour_value = contour_layer_.get( location );
-    return std::max( boundary_value, contour_value );
+template<typename... slot_t>
+bool BasicChartBox<slot_t...>::enable_concurrent_readers( bool enable ){
+    if( enable && composite_ ){
+        return false;
+    }
+
+    layers_.for_each( [&]( auto, auto& layer ){
+        if constexpr ( requires { layer.enable_concurrent_readers( enable ); } ){
+            layer.enable_concurrent_readers( enable );
+        }
+    });
+    concurrent_readers_ = enable;
+    return true;
+}
+
+template<typename... slot_t>
+bool BasicChartBox<slot_t...>::fill( layer::role_t role, const Polygon<LocalLocation>& source, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+    if( ! layer_stack_t::contains(role) ){
+        return false;
+    }
+
+    const bool filled = layers_.visit( role, [&]( auto& layer ){
+        return layer.fill( source, bounds, value ); });
+    recompose( bounds );
+    return filled;
 }
 
-void ChartBox::print_layers() const {
+template<typename... slot_t>
+void BasicChartBox<slot_t...>::print_layers() const {
     
     fmt::print( "============ ============ Printing Layers: ============ ============ \n");
 
     uint32_t layer_index = 0;
 
-    // Boundary Layer
-    fmt::print( "    [{:2d}] <{}> :{} ({3} x {3})\n", layer_index, boundary_layer_.type(), boundary_layer_.name(), boundary_layer_.cells_across_view() );
-    ++layer_index;
+    layers_.for_each( [&]( auto slot, const auto& layer ){
+        fmt::print( "    [{0:2d}] <{1}> :{2} ({3} x {3})  combine: {4}\n", layer_index, layer.type(), layer.name(), layer.cells_across_view(),
+                                                                          decltype(slot)::combine_t::name );
+        ++layer_index;
+    });
 
-    // Contour Layer
-    fmt::print( "    [{:2d}] <{}> :{} ({3} x {3})\n", layer_index, contour_layer_.type(), contour_layer_.name(), boundary_layer_.cells_across_view() );
-    ++layer_index;
+    if( composite_ ){
+        fmt::print( "    [--] <{0}> :{1} ({2} x {2})\n", composite_->type(), composite_->name(), composite_->cells_across_view() );
+    }
 
-    // next layer 
-    // ...
+    fmt::print( "============ ============ {} layers total ============ ============ \n", layer_index );
+}
 
+template<typename... slot_t>
+size_t BasicChartBox<slot_t...>::ingest(){
+    size_t applied = 0;
+    layers_.for_each( [&]( auto, auto& layer ){
+        if constexpr ( requires { layer.submit( std::span<const layer::sensor::SensorHit>() ); } ){
+            BoundBox<LocalLocation> touched;
+            const size_t layer_applied = layer.apply( touched );
+            if( 0 < layer_applied ){
+                applied += layer_applied;
+                recompose( touched );
+            }
+        }
+    });
+    return applied;
+}
 
-    fmt::print( "============ ============ {} layers total ============ ============ \n", layer_index );
+template<typename... slot_t>
+bool BasicChartBox<slot_t...>::raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const {
+    if( composite_ ){
+        return composite_->raycast( origin, targets, threshold, distances );
+    }else if( distances.size() < targets.size() ){
+        return false;
+    }
+
+    // (every line reads the same frames)
+    const auto reader = layers_.reader();
+    const double across = layers_.template at<0>().meters_across_cell();
+    const BoundBox<LocalLocation>& visible = reader.template at<0>().visible();
+    constexpr uint32_t cells_across = primary_layer_t::cells_across_view();
+    constexpr uint32_t block_across = composite_layer_t::summary_across;
+    constexpr uint32_t blocks_across = (cells_across + block_across - 1) / block_across;
+
+    // each block is bounded over its cells' centers -- exactly the points which its cells are read at.  Lines of
+    // the same batch share blocks: so each block is bounded at most once, and only whether it might block is kept.
+    std::vector<bool> bounded( static_cast<size_t>(blocks_across) * blocks_across );
+    std::vector<bool> blocking( bounded.size() );
+    const auto block_bound = [&]( int64_t block_column, int64_t block_row ) -> uint8_t {
+        const size_t block = static_cast<size_t>(block_row) * blocks_across + static_cast<size_t>(block_column);
+        if( ! bounded[block] ){
+            const LocalLocation first = visible.min + LocalLocation( (block_column * block_across + 0.5) * across, (block_row * block_across + 0.5) * across );
+            bounded[block] = true;
+            blocking[block] = ( threshold <= reader.max({ first, first + LocalLocation( (block_across - 1) * across, (block_across - 1) * across ) }) );
+        }
+        return blocking[block] ? threshold : layer::clear_cell_value;
+    };
+    const auto cell_value = [&]( int64_t column, int64_t row ){
+        return reader.get( visible.min + LocalLocation( (column + 0.5) * across, (row + 0.5) * across ) ); };
+
+    for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+        layer::RayClip clip;
+        if( layer::clip_ray( visible.min, across, cells_across, cells_across, origin, targets[target_index], clip ) ){
+            distances[target_index] = layer::trace_blocks( clip, threshold, block_across, block_bound, cell_value );
+        }else{
+            distances[target_index] = layer::raycast_clear;
+        }
+    }
+    return true;
+}
+
+template<typename... slot_t>
+void BasicChartBox<slot_t...>::recompose( const BoundBox<LocalLocation>& box ){
+    if( ! composite_ ){
+        return;
+    }
+
+    const BoundBox<LocalLocation>& view = composite_->visible();
+    const double meters_across_cell = composite_->meters_across_cell();
+    const double west = std::max( box.min.easting, view.min.easting ) - view.min.easting;
+    const double south = std::max( box.min.northing, view.min.northing ) - view.min.northing;
+    const double east = std::min( box.max.easting, view.max.easting ) - view.min.easting;
+    const double north = std::min( box.max.northing, view.max.northing ) - view.min.northing;
+    if( (east <= west) || (north <= south) ){
+        return;
+    }
+
+    constexpr uint32_t last_cell = composite_layer_t::dimension - 1;
+    const uint32_t first_column = std::min( static_cast<uint32_t>( west / meters_across_cell ), last_cell );
+    const uint32_t last_column = std::min( static_cast<uint32_t>( std::ceil( east / meters_across_cell ) ) - 1, last_cell );
+    const uint32_t first_row = std::min( static_cast<uint32_t>( south / meters_across_cell ), last_cell );
+    const uint32_t last_row = std::min( static_cast<uint32_t>( std::ceil( north / meters_across_cell ) ) - 1, last_cell );
+
+    // combine one row at a time, through the stack's batch query:
+    const size_t count = last_column - first_column + 1;
+    std::vector<LocalLocation> centers( count );
+    std::vector<uint8_t> values( count );
+    for( uint32_t row = first_row; row <= last_row; ++row ){
+        const double northing = view.min.northing + (row + 0.5) * meters_across_cell;
+        for( size_t index = 0; index < count; ++index ){
+            centers[index] = { view.min.easting + (first_column + index + 0.5) * meters_across_cell, northing };
+        }
+
+        layers_.get( centers, values );
+        composite_->store_row( row, first_column, values );
+    }
+    composite_->summarize( first_column, first_row, last_column, last_row );
+}
+
+template<typename... slot_t>
+void BasicChartBox<slot_t...>::recompose(){
+    if( composite_ ){
+        recompose( composite_->visible() );
+    }
+}
+
+template<typename... slot_t>
+bool BasicChartBox<slot_t...>::relocate( const LocalLocation& origin ){
+    primary_layer_t& primary = layers_.template at<0>();
+    bool relocated = primary.relocate( origin );
+
+    // keep every other movable layer centered on the primary view -- noting the views each one left + entered
+    std::vector<BoundBox<LocalLocation>> moved;
+    const LocalLocation center = primary.visible().center();
+    layers_.for_each( [&]( auto slot, auto& layer ){
+        constexpr bool is_primary = ( layer_stack_t::template slot_at<0>::role == decltype(slot)::role );
+        if constexpr ( (! is_primary) && requires { layer.relocate( center ); } ){
+            const BoundBox<LocalLocation> previous = layer.visible();
+            const double half_view = layer.meters_across_view() / 2;
+            relocated &= layer.relocate( center - LocalLocation( half_view, half_view ) );
+            if( previous.min != layer.visible().min ){
+                moved.push_back( previous );
+                moved.push_back( layer.visible() );
+            }
+        }
+    });
+    if( ! composite_ ){
+        return relocated;
+    }
+
+    const BoundBox<LocalLocation> previous = composite_->visible();
+    composite_->relocate( primary.visible().min );
+    const BoundBox<LocalLocation>& current = composite_->visible();
+
+    // recompose only the strips which entered the view:  (east / west, and then north / south)
+    if( current.min.easting < previous.min.easting ){
+        recompose({ current.min, {previous.min.easting, current.max.northing} });
+    }else if( previous.min.easting < current.min.easting ){
+        recompose({ {previous.max.easting, current.min.northing}, current.max });
+    }
+    if( current.min.northing < previous.min.northing ){
+        recompose({ current.min, {current.max.easting, previous.min.northing} });
+    }else if( previous.min.northing < current.min.northing ){
+        recompose({ {current.min.easting, previous.max.northing}, current.max });
+    }
+    for( const auto& box : moved ){
+        recompose( box );
+    }
+    return relocated;
 }
 
+template<typename... slot_t>
+bool BasicChartBox<slot_t...>::store( layer::role_t role, const LocalLocation& p, uint8_t value ){
+    double across = 0;
+    if( ! layers_.visit( role, [&]( auto& layer ){
+            across = layer.meters_across_cell();
+            return layer.store( p, value ); }) ){
+        return false;
+    }
+
+    // the layer's cell may span several composite cells:
+    recompose({ p - LocalLocation(across, across), p + LocalLocation(across, across) });
+    return true;
+}
+
+// explicit instantiation of the default chart.  (see: `ChartBox`, in `chart-box.hpp`)
+template class chartbox::BasicChartBox< chartbox::layer::LayerSlot<chartbox::layer::CONTOUR, chartbox::layer::rolling::RollingGridLayer<1024>>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::BOUNDARY, chartbox::layer::dynamic::DynamicGridLayer>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::LIDAR, chartbox::layer::sensor::SensorLayer<256>, chartbox::layer::CombineOccupied<>>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::RADAR, chartbox::layer::sensor::SensorLayer<256>, chartbox::layer::CombineMask>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::TARGET, chartbox::layer::dynamic::DynamicGridLayer, chartbox::layer::CombineMask> >;
+
+// used for tests: the default chart's stack, on small layers
+template class chartbox::BasicChartBox< chartbox::layer::LayerSlot<chartbox::layer::CONTOUR, chartbox::layer::rolling::RollingGridLayer<64>>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::BOUNDARY, chartbox::layer::dynamic::DynamicGridLayer>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::LIDAR, chartbox::layer::sensor::SensorLayer<4>, chartbox::layer::CombineOccupied<>>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::RADAR, chartbox::layer::sensor::SensorLayer<4>, chartbox::layer::CombineMask>,
+                                        chartbox::layer::LayerSlot<chartbox::layer::TARGET, chartbox::layer::dynamic::DynamicGridLayer, chartbox::layer::CombineMask> >;
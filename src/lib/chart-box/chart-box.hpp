@@ -2,42 +2,124 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
 #include "geometry/frame-mapping.hpp"
 #include "layer/layer-interface.hpp"
+#include "layer/layer-stack.hpp"
+#include "layer/raycast.hpp"
+#include "layer/composite/composite-layer.hpp"
 #include "layer/dynamic-grid/dynamic-grid-layer.hpp"
 #include "layer/rolling-grid/rolling-grid-layer.hpp"
+#include "layer/sensor/sensor-layer.hpp"
 
 namespace chartbox {
 
+using chartbox::geometry::BoundBox;
 using chartbox::geometry::FrameMapping;
 using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
 
 /// \brief A container of containers for various types of map data structures
-class ChartBox {
+///
+/// The layers form a compile-time stack (see: `layer::LayerStack`): each query folds every layer's value, in the
+/// order of the slots, by each slot's combine policy.
+///
+/// The first slot holds the primary layer: a fixed-size layer, which `relocate` moves, and whose view the (optional)
+/// composite covers.  Any other layer which can `relocate` (e.g. a `SensorLayer`) is kept centered on its view.
+/// Each layer which can keep a pyramid (e.g. the `RollingGridLayer`) does -- so that `raycast` skips its clear areas.
+///
+/// \param slot_t - a `layer::LayerSlot` for each layer
+template<typename... slot_t>
+class BasicChartBox {
 public:
-    // typedef chartbox::layer::StaticGridLayer boundary_layer_t;
-    typedef chartbox::layer::dynamic::DynamicGridLayer boundary_layer_t;
-    
-    // note: this template must be explicitly instantiated at the bottom of `rolling-grid-layer.cpp`
-    typedef chartbox::layer::rolling::RollingGridLayer<1024> contour_layer_t;
+    typedef layer::LayerStack<slot_t...> layer_stack_t;
+
+    typedef typename layer_stack_t::template layer_at<0> primary_layer_t;
+
+    // covers the primary layer's view, at its resolution
+    typedef layer::composite::CompositeLayer<primary_layer_t::cells_across_view()> composite_layer_t;
+
+    constexpr static size_t layer_count = layer_stack_t::layer_count;
 
 public:
-    ChartBox();
+    BasicChartBox();
+
+    /// \brief keep a materialized composite of every layer -- so that each query is a single read
+    ///
+    /// The composite covers the primary layer's view, at the primary layer's resolution; queries outside it are
+    /// combined on the fly.  It is kept up to date by each write through `store` or `fill`, and by `relocate`.
+    /// After writing to a layer directly (or moving any other layer), call `recompose`.
+    ///
+    /// \param enable - true to build the composite; false to release it
+    /// \return false if concurrent readers are enabled.  (the composite is written in place)
+    bool enable_composite( bool enable );
+
+    inline bool composite_enabled() const { return static_cast<bool>(composite_); }
+
+    /// \brief allow other threads to query the chart -- while this thread writes to it, and relocates it
+    ///
+    /// Enables concurrent readers on each layer which supports them.  (see:
+    /// `RollingGridLayer::enable_concurrent_readers`)  Each query (`get`, the batch `get`, or `raycast`) then pins
+    /// every such layer's current frame, for its duration.  Layers without readers (e.g. `DynamicGridLayer`) are
+    /// still read directly; they never move.
+    ///
+    /// \param enable - true to enable; false to disable.  (no query may be running)
+    /// \return false if the composite is enabled
+    bool enable_concurrent_readers( bool enable );
+
+    inline bool concurrent_readers_enabled() const { return concurrent_readers_; }
+
+    /// \brief fill a polygon into the layer of the given role -- and update the composite
+    ///
+    /// \return false if no layer has this role; or if the layer's fill fails
+    bool fill( layer::role_t role, const Polygon<LocalLocation>& source, const BoundBox<LocalLocation>& bounds, uint8_t value );
 
-    //// \brief retrieve the value of the requested point `p`. 
+    //// \brief retrieve the value of the requested point `p`.  (each layer is read through a `LayerStack::Reader`)
     ///
     /// @param {double} x The x-coordinate; in real-world units; meters
     /// @param {double} y The y-coordinate; in real-world units; meters
     /// @return {cell_value_t} The value of the node, if available; or the default value.
-    uint8_t get(const LocalLocation& p) const;
+    uint8_t get(const LocalLocation& p) const {
+        if( composite_ && composite_->visible(p) ){
+            return composite_->get(p);
+        }
+        return layers_.get(p);
+    }
+
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// Without a composite, each layer answers a chunk of points at a time.  (see: `LayerStack::get`)
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+        if( ! composite_ ){
+            return layers_.get( points, values );
+        }else if( values.size() < points.size() ){
+            return false;
+        }
+
+        for( size_t point_index = 0; point_index < points.size(); ++point_index ){
+            values[point_index] = get( points[point_index] );
+        }
+        return true;
+    }
+
+    /// \brief the stack of layers -- each query folds every layer afresh, without the composite
+    inline const layer_stack_t& layers() const { return layers_; }
 
-    inline boundary_layer_t& get_boundary_layer() {  return boundary_layer_; }
+    inline auto& get_boundary_layer() {  return layers_.template layer<layer::BOUNDARY>(); }
 
-    inline contour_layer_t& get_contour_layer() {  return contour_layer_; }
+    inline auto& get_contour_layer() {  return layers_.template layer<layer::CONTOUR>(); }
+
+    /// \brief access the layer with the given role
+    template<layer::role_t role>
+    inline auto& get_layer() {  return layers_.template layer<role>(); }
+    template<layer::role_t role>
+    inline const auto& get_layer() const {  return layers_.template layer<role>(); }
 
     inline FrameMapping& mapping() { return mapping_; }
 
@@ -45,18 +127,59 @@ public:
 
     void print_layers() const;
 
+    /// \brief write every queued sensor hit into its layer -- and update the composite
+    ///
+    /// Sensor layers take hits from any thread (see: `SensorLayer::submit`); call this from the chart's own thread.
+    ///
+    /// \return the number of hits written, across every sensor layer
+    size_t ingest();
+
+    /// \brief find where each line from the origin first meets a blocking cell -- in the combined layers
+    ///
+    /// Each line walks blocks of the primary layer's cells, across its view; it only walks the cells of a block which
+    /// might block the line.  With a composite, each block's bound is read from its summary, and each cell is a single
+    /// read.  (see: `CompositeLayer::raycast`)  Otherwise each block is bounded by every layer's maximum over it (see:
+    /// `LayerStack::Reader::max`), and each cell is combined from every layer.
+    bool raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const;
+
+    /// \brief refresh the composite over the given area, from every layer.  (no-op without a composite)
+    void recompose( const BoundBox<LocalLocation>& box );
+
+    /// \brief refresh the entire composite
+    void recompose();
+
+    /// \brief move the primary layer's view -- and the composite's -- to a new origin
+    ///
+    /// Only the cells which enter the view are recomposed.  (see: `RollingGridLayer::relocate`)  Every other
+    /// layer which can relocate is re-centered on the new view; the composite is recomposed wherever it moved.
+    bool relocate( const LocalLocation& origin );
+
+    /// \brief store a value into the layer of the given role -- and update the composite
+    ///
+    /// \return false if no layer has this role; or if `p` is outside that layer
+    bool store( layer::role_t role, const LocalLocation& p, uint8_t value );
+
     /// \brief Releases all memory associated with this quad tree.
-    ~ChartBox() = default;
+    ~BasicChartBox() = default;
 
 private:
     FrameMapping mapping_;
 
-    boundary_layer_t boundary_layer_;
-    contour_layer_t contour_layer_;
+    layer_stack_t layers_;
 
-    // manually hard-coded. Unfortunately.
-    constexpr static size_t layer_count = 2;
+    // optional; see: `enable_composite`
+    std::unique_ptr<composite_layer_t> composite_;
+
+    // see: `enable_concurrent_readers`
+    bool concurrent_readers_ = false;
 
 };
-} // namespace chart
 
+// note: this template must be explicitly instantiated at the bottom of `chart-box.cpp`
+typedef BasicChartBox< layer::LayerSlot<layer::CONTOUR, layer::rolling::RollingGridLayer<1024>>,
+                       layer::LayerSlot<layer::BOUNDARY, layer::dynamic::DynamicGridLayer>,
+                       layer::LayerSlot<layer::LIDAR, layer::sensor::SensorLayer<256>, layer::CombineOccupied<>>,
+                       layer::LayerSlot<layer::RADAR, layer::sensor::SensorLayer<256>, layer::CombineMask>,
+                       layer::LayerSlot<layer::TARGET, layer::dynamic::DynamicGridLayer, layer::CombineMask> > ChartBox;
+
+} // namespace chart
@@ -0,0 +1,543 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "io/flatbuffer.hpp"
+#include "layer/grid-ray.hpp"
+
+#include "chart-box.hpp"
+
+using chartbox::BasicChartBox;
+using chartbox::ChartBox;
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+
+using chartbox::layer::block_cell_value;
+using chartbox::layer::clear_cell_value;
+using chartbox::layer::raycast_clear;
+using chartbox::layer::unknown_cell_value;
+
+namespace chartbox::layer {
+
+// the default chart's stack, on small layers: a 320 m primary view, and 20 m sensor views.  (see: `chart-box.cpp`)
+typedef BasicChartBox< LayerSlot<CONTOUR, rolling::RollingGridLayer<64>>,
+                       LayerSlot<BOUNDARY, dynamic::DynamicGridLayer>,
+                       LayerSlot<LIDAR, sensor::SensorLayer<4>, CombineOccupied<>>,
+                       LayerSlot<RADAR, sensor::SensorLayer<4>, CombineMask>,
+                       LayerSlot<TARGET, dynamic::DynamicGridLayer, CombineMask> > test_chart_t;
+
+// count the cells of the composite which differ from a fresh fold of every layer
+static size_t count_stale_cells( const test_chart_t& chart ){
+    const BoundBox<LocalLocation>& view = chart.get_layer<CONTOUR>().visible();
+    size_t stale = 0;
+    for( double northing = view.min.northing + 0.5; northing < view.max.northing; northing += 1 ){
+        for( double easting = view.min.easting + 0.5; easting < view.max.easting; easting += 1 ){
+            stale += ( chart.layers().get({easting, northing}) != chart.get({easting, northing}) );
+        }
+    }
+    return stale;
+}
+
+// ============ ============ ChartBox Tests  ============ ============
+
+TEST_CASE( "ChartBox folds its default layers, in order, by role" ){
+    // (held on the heap: the contour layer alone is 5 km across)
+    auto chart = std::make_unique<ChartBox>();
+    CHECK( 5 == ChartBox::layer_count );
+
+    // every layer starts unknown:
+    const LocalLocation p( 5.5, 5.5 );
+    CHECK( unknown_cell_value == chart->get(p) );
+
+    REQUIRE( chart->store( CONTOUR, p, clear_cell_value ));
+    REQUIRE( chart->store( BOUNDARY, p, clear_cell_value ));
+    CHECK( clear_cell_value == chart->get(p) );
+
+    // contour + boundary: the higher value wins
+    REQUIRE( chart->store( BOUNDARY, p, 0x40 ));
+    CHECK( 0x40 == chart->get(p) );
+    REQUIRE( chart->store( CONTOUR, p, 0x60 ));
+    CHECK( 0x60 == chart->get(p) );
+
+    // lidar: holds log-odds; blocks the cells which are likely occupied, and is transparent elsewhere
+    REQUIRE( chart->store( LIDAR, p, 0x10 ));
+    CHECK( 0x60 == chart->get(p) );
+    REQUIRE( chart->store( LIDAR, p, CombineOccupied<>::occupied - 1 ));
+    CHECK( 0x60 == chart->get(p) );
+    REQUIRE( chart->store( LIDAR, p, CombineOccupied<>::occupied ));
+    CHECK( block_cell_value == chart->get(p) );
+    REQUIRE( chart->store( LIDAR, p, unknown_cell_value ));
+    CHECK( 0x60 == chart->get(p) );
+
+    // radar + target: mask blocked cells; transparent elsewhere
+    REQUIRE( chart->store( RADAR, p, 0x30 ));
+    CHECK( 0x60 == chart->get(p) );
+    REQUIRE( chart->store( RADAR, p, block_cell_value ));
+    CHECK( block_cell_value == chart->get(p) );
+    REQUIRE( chart->store( RADAR, p, clear_cell_value ));
+    CHECK( 0x60 == chart->get(p) );
+    REQUIRE( chart->store( TARGET, p, block_cell_value ));
+    CHECK( block_cell_value == chart->get(p) );
+
+    // the batch query folds the same way:
+    const std::vector<LocalLocation> points = { p, {7.5, 5.5}, {4000.5, 4000.5}, {-10, -10} };
+    std::vector<uint8_t> values( points.size() );
+    REQUIRE( chart->get( points, values ));
+    for( size_t index = 0; index < points.size(); ++index ){
+        CHECK( chart->get(points[index]) == values[index] );
+    }
+} // TEST_CASE
+
+TEST_CASE( "ChartBox lidar scans never clear charted obstacles" ){
+    auto chart = std::make_unique<test_chart_t>();
+    auto& lidar = chart->get_layer<LIDAR>();
+    const BoundBox<LocalLocation> view = lidar.visible();
+
+    // a charted wall, across the lidar's whole view:
+    const double wall_easting = view.min.easting + 12.5;
+    for( double northing = view.min.northing + 0.5; northing < view.max.northing; northing += 1 ){
+        REQUIRE( chart->store( CONTOUR, {wall_easting, northing}, block_cell_value ));
+    }
+
+    // a fan of rays, which pass through the wall, and end beyond it:
+    const LocalLocation origin = view.min + LocalLocation( 2.5, 10.5 );
+    std::vector<LocalLocation> hits;
+    for( double northing = view.min.northing + 0.5; northing < view.max.northing; northing += 1 ){
+        hits.emplace_back( view.min.easting + 16.5, northing );
+    }
+    const LocalLocation beyond = view.min + LocalLocation( 16.5, 10.5 );
+
+    REQUIRE( lidar.integrate_scan( origin, hits ));
+    // (the wall reads as a miss, in the lidar layer: well below unknown ...)
+    const LocalLocation crossed( wall_easting, origin.northing );
+    REQUIRE( unknown_cell_value - lidar.occupancy_model().miss == lidar.get(crossed) );
+    // (... but the chart still blocks it)
+    for( double northing = view.min.northing + 0.5; northing < view.max.northing; northing += 1 ){
+        CHECK( block_cell_value == chart->get({wall_easting, northing}) );
+    }
+    CHECK( unknown_cell_value == chart->get(beyond) );
+
+    // repeated hits become an obstacle:
+    REQUIRE( lidar.integrate_scan( origin, hits ));
+    REQUIRE( lidar.integrate_scan( origin, hits ));
+    REQUIRE( CombineOccupied<>::occupied <= lidar.get(beyond) );
+    CHECK( block_cell_value == chart->get(beyond) );
+    CHECK( block_cell_value == chart->get(crossed) );
+} // TEST_CASE
+
+TEST_CASE( "ChartBox raycasts match a walk of its combined cells" ){
+    auto chart = std::make_unique<test_chart_t>();
+    auto& contour = chart->get_layer<CONTOUR>();
+    auto& lidar = chart->get_layer<LIDAR>();
+    const BoundBox<LocalLocation>& view = contour.visible();
+    const BoundBox<LocalLocation> sensed = lidar.visible();
+    const double across = contour.meters_across_cell();
+
+    // charted: a wall, north-south, across the lidar's view; and scattered blocks, everywhere
+    REQUIRE( contour.fill( BoundBox<LocalLocation>( sensed.min + LocalLocation(12, 0), {sensed.min.easting + 13, sensed.max.northing} ), block_cell_value ));
+    std::mt19937 generator( 25 );
+    std::uniform_real_distribution<double> coordinate_distribution( 0, 316 );
+    for( uint32_t block = 0; block < 60; ++block ){
+        const LocalLocation corner = view.min + LocalLocation( coordinate_distribution(generator), coordinate_distribution(generator) );
+        REQUIRE( contour.fill( BoundBox<LocalLocation>( corner, corner + LocalLocation(3, 2) ), block_cell_value ));
+    }
+
+    // sensed: a scan which passes through the wall ... and an obstacle, seen three times, in front of it
+    const LocalLocation origin = sensed.min + LocalLocation( 2.5, 10.5 );
+    std::vector<LocalLocation> hits;
+    for( double northing = sensed.min.northing + 0.5; northing < sensed.max.northing; northing += 1 ){
+        hits.emplace_back( sensed.min.easting + 16.5, northing );
+    }
+    REQUIRE( lidar.integrate_scan( origin, hits ));
+    const std::vector<LocalLocation> obstacle = { sensed.min + LocalLocation( 8.5, 4.5 ) };
+    for( uint32_t scan = 0; scan < 3; ++scan ){
+        REQUIRE( lidar.integrate_scan( origin, obstacle ));
+    }
+    REQUIRE( chart->store( RADAR, sensed.min + LocalLocation( 6.5, 16.5 ), block_cell_value ));
+
+    // each layer bounds a box from above -- and so does their fold:
+    std::uniform_real_distribution<double> corner_distribution( -20, 320 );
+    for( uint32_t box = 0; box < 200; ++box ){
+        const LocalLocation corner = view.min + LocalLocation( corner_distribution(generator), corner_distribution(generator) );
+        const BoundBox<LocalLocation> bounds( corner, corner + LocalLocation( 7, 7 ) );
+        const uint8_t bound = chart->layers().reader().max( bounds );
+        uint8_t highest = clear_cell_value;
+        for( double northing = corner.northing; northing <= bounds.max.northing; northing += 0.5 ){
+            for( double easting = corner.easting; easting <= bounds.max.easting; easting += 0.5 ){
+                highest = std::max( highest, chart->layers().get({ easting, northing }) );
+            }
+        }
+        REQUIRE( static_cast<int>(highest) <= static_cast<int>(bound) );
+    }
+
+    // a scalar walk of `ChartBox::get`, cell by cell:  (both ends are in view)
+    const auto walk = [&]( const LocalLocation& to ){
+        const LocalLocation start = (origin - view.min) / across;
+        const LocalLocation end = (to - view.min) / across;
+        GridRay ray( start.easting, start.northing, end.easting, end.northing );
+        const double length = std::hypot( to.easting - origin.easting, to.northing - origin.northing );
+        while( true ){
+            const LocalLocation center = view.min + LocalLocation( (ray.column() + 0.5) * across, (ray.row() + 0.5) * across );
+            if( block_cell_value == chart->get(center) ){
+                return ray.entry() * length;
+            }else if( ray.done() ){
+                return raycast_clear;
+            }
+            ray.step();
+        }
+    };
+
+    std::vector<LocalLocation> targets = hits;
+    std::uniform_real_distribution<double> target_distribution( 0, 319.9 );
+    for( uint32_t target = 0; target < 400; ++target ){
+        targets.push_back( view.min + LocalLocation( target_distribution(generator), target_distribution(generator) ) );
+    }
+
+    std::vector<double> distances( targets.size() );
+    const auto count_blocked = [&](){
+        REQUIRE( chart->raycast( origin, targets, block_cell_value, distances ));
+        size_t blocked = 0;
+        for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+            const double expected = walk( targets[target_index] );
+            if( raycast_clear == expected ){
+                REQUIRE( raycast_clear == distances[target_index] );
+            }else{
+                REQUIRE( distances[target_index] == Approx( expected ).margin(1e-6) );
+                ++blocked;
+            }
+        }
+        return blocked;
+    };
+
+    for( const bool composite : {false, true} ){
+        REQUIRE( chart->enable_composite( composite ));
+        const size_t blocked = count_blocked();
+        CHECK( 0 < blocked );
+        CHECK( blocked < targets.size() );
+
+        // the scan's misses never clear the charted wall:  (the ray along the origin's row)
+        CHECK( distances[10] == Approx( 9.5 ) );
+        // the sensed obstacle blocks, from the lidar alone:
+        std::vector<double> distance( 1 );
+        REQUIRE( chart->raycast( origin, obstacle, block_cell_value, distance ));
+        CHECK( raycast_clear != distance[0] );
+    }
+
+    // once the chart clears the wall, the blocks which held it no longer block:  (the composite's summary falls)
+    const Polygon<LocalLocation> wall( {{sensed.min.easting + 12, sensed.min.northing}, {sensed.min.easting + 13, sensed.min.northing},
+                                        {sensed.min.easting + 13, sensed.max.northing}, {sensed.min.easting + 12, sensed.max.northing},
+                                        {sensed.min.easting + 12, sensed.min.northing}} );
+    REQUIRE( chart->fill( CONTOUR, wall, BoundBox<LocalLocation>( {sensed.min.easting + 12, sensed.min.northing}, {sensed.min.easting + 13, sensed.max.northing} ), clear_cell_value ));
+    for( const bool composite : {true, false} ){
+        REQUIRE( chart->enable_composite( composite ));
+        count_blocked();
+        CHECK( distances[10] != Approx( 9.5 ) );
+    }
+} // TEST_CASE
+
+TEST_CASE( "ChartBox dispatches stores + fills by role" ){
+    auto chart = std::make_unique<ChartBox>();
+    const LocalLocation p( 6.5, 6.5 );
+
+    // each write reaches only the layer with its role:
+    REQUIRE( chart->store( TARGET, p, 0x22 ));
+    CHECK( 0x22 == chart->get_layer<TARGET>().get(p) );
+    CHECK( unknown_cell_value == chart->get_layer<BOUNDARY>().get(p) );
+    CHECK( unknown_cell_value == chart->get_layer<CONTOUR>().get(p) );
+
+    const Polygon<LocalLocation> square( {{4,4}, {9,4}, {9,9}, {4,9}, {4,4}} );
+    const BoundBox<LocalLocation> bounds( {4,4}, {9,9} );
+    REQUIRE( chart->fill( BOUNDARY, square, bounds, 0x33 ));
+    CHECK( 0x33 == chart->get_layer<BOUNDARY>().get(p) );
+    CHECK( unknown_cell_value == chart->get_layer<BOUNDARY>().get({ 10.5, 10.5 }) );
+    CHECK( 0x22 == chart->get_layer<TARGET>().get(p) );
+    CHECK( unknown_cell_value == chart->get_layer<CONTOUR>().get(p) );
+    CHECK( unknown_cell_value == chart->get_layer<LIDAR>().get(p) );
+
+    REQUIRE( chart->fill( CONTOUR, square, bounds, 0x44 ));
+    CHECK( 0x44 == chart->get_layer<CONTOUR>().get(p) );
+    CHECK( 0x33 == chart->get_layer<BOUNDARY>().get(p) );
+
+    // no layer has this role:
+    CHECK_FALSE( chart->store( VIEW, p, 0x55 ));
+    CHECK_FALSE( chart->fill( VIEW, square, bounds, 0x55 ));
+
+    // ... or the point is outside the layer:
+    CHECK_FALSE( chart->store( BOUNDARY, {100.5, 100.5}, 0x55 ));
+    CHECK_FALSE( chart->store( CONTOUR, {-0.5, 100.5}, 0x55 ));
+} // TEST_CASE
+
+TEST_CASE( "ChartBox relocates its primary layer, and re-centers the others" ){
+    auto chart = std::make_unique<ChartBox>();
+    const auto& contour = chart->get_layer<CONTOUR>();
+    const auto& lidar = chart->get_layer<LIDAR>();
+    const auto& radar = chart->get_layer<RADAR>();
+    const auto& boundary = chart->get_layer<BOUNDARY>();
+    const BoundBox<LocalLocation> boundary_view = boundary.visible();
+
+    for( const LocalLocation& origin : { LocalLocation(1024, 2048), LocalLocation(2048, 2048), LocalLocation(0, 0) } ){
+        REQUIRE( chart->relocate( origin ));
+        CHECK( contour.visible().min.easting == Approx(origin.easting) );
+        CHECK( contour.visible().min.northing == Approx(origin.northing) );
+
+        // each sensor layer is centered on the primary view -- to within half of one of its sectors
+        const LocalLocation center = contour.visible().center();
+        for( const auto* sensor : { &lidar, &radar } ){
+            CHECK( std::fabs( sensor->visible().center().easting - center.easting ) <= 128 );
+            CHECK( std::fabs( sensor->visible().center().northing - center.northing ) <= 128 );
+        }
+
+        // layers which cannot move stay put:
+        CHECK( boundary.visible().min == boundary_view.min );
+        CHECK( boundary.visible().max == boundary_view.max );
+    }
+
+    // a move of less than half a sector leaves the primary view in place
+    const BoundBox<LocalLocation> view = contour.visible();
+    REQUIRE( chart->relocate( view.min + LocalLocation( 300, -300 ) ));
+    CHECK( contour.visible().min == view.min );
+
+    // writes follow the moved layers:
+    REQUIRE( chart->relocate({ 1024, 1024 }) );
+    const LocalLocation p = contour.visible().center();
+    REQUIRE( chart->store( LIDAR, p, 0xF0 ));
+    CHECK( 0xF0 == lidar.get(p) );
+    CHECK( block_cell_value == chart->get(p) );
+} // TEST_CASE
+
+TEST_CASE( "ChartBox sensor layers never overwrite the charted tiles" ){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-chart-cache-test";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    auto chart = std::make_unique<ChartBox>();
+    REQUIRE( chart->get_layer<CONTOUR>().enable_cache( cache_path ));
+
+    // charted + sensed cells, in the south-west sector of every layer.  (all three tiles have the same origin)
+    const LocalLocation p( 10.5, 10.5 );
+    REQUIRE( chart->store( CONTOUR, p, 0x11 ));
+    REQUIRE( chart->store( LIDAR, p, 0x22 ));
+    REQUIRE( chart->store( RADAR, p, 0x33 ));
+
+    // every layer leaves the tile at the origin ...
+    REQUIRE( chart->relocate({ 2048, 2048 }) );
+    REQUIRE_FALSE( chart->get_layer<LIDAR>().visible().contains(p) );
+    const LocalLocation q( 2100.5, 2100.5 );
+    REQUIRE( chart->store( CONTOUR, q, 0x44 ));
+
+    // ... and the contour comes back: (while the sensor layers move over the contour's tile at `q`)
+    REQUIRE( chart->relocate({ 0, 0 }) );
+    REQUIRE( chart->get_layer<LIDAR>().visible().contains(q) );
+    CHECK( 0x11 == chart->get_layer<CONTOUR>().get(p) );
+    CHECK( 0x44 == chart->get_layer<CONTOUR>().get(q) );
+    CHECK( unknown_cell_value == chart->get_layer<LIDAR>().get(q) );
+    CHECK( unknown_cell_value == chart->get_layer<RADAR>().get(q) );
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "ChartBox queries see a consistent view, while it relocates" ){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-chart-reader-test";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    // a distinct value for each cell of the plane, by its absolute location.  (always above `unknown_cell_value`)
+    const auto pattern = []( const LocalLocation& p ){
+        const int64_t column = static_cast<int64_t>( std::floor(p.easting) );
+        const int64_t row = static_cast<int64_t>( std::floor(p.northing) );
+        return static_cast<uint8_t>( 129 + ((column*7 + row*13) & 0x3F) ); };
+
+    auto chart = std::make_unique<test_chart_t>();
+    auto& contour = chart->get_layer<CONTOUR>();
+    REQUIRE( contour.enable_cache( cache_path ));
+
+    // chart the pattern across every view which the writer will move between:
+    const std::array<LocalLocation,4> stops = { LocalLocation(0, 0), LocalLocation(64, 0), LocalLocation(64, 64), LocalLocation(0, 64) };
+    for( const auto& stop : stops ){
+        REQUIRE( chart->relocate( stop ));
+        const BoundBox<LocalLocation>& view = contour.visible();
+        for( double northing = view.min.northing + 0.5; northing < view.max.northing; northing += 1 ){
+            for( double easting = view.min.easting + 0.5; easting < view.max.easting; easting += 1 ){
+                contour.store( {easting, northing}, pattern({easting, northing}) );
+            }
+        }
+        REQUIRE( contour.flush_to_cache() );
+    }
+
+    REQUIRE( chart->enable_concurrent_readers( true ));
+    REQUIRE( chart->concurrent_readers_enabled() );
+    REQUIRE( contour.concurrent_readers_enabled() );
+    REQUIRE( chart->get_layer<LIDAR>().concurrent_readers_enabled() );
+    // (the composite is written in place)
+    CHECK_FALSE( chart->enable_composite( true ));
+
+    // each cell reads as the pattern, while in view; else as unknown:
+    std::atomic<bool> done = false;
+    std::atomic<size_t> reads = 0;
+    std::atomic<size_t> mismatches = 0;
+    std::vector<std::thread> readers;
+    for( uint32_t thread = 0; thread < 3; ++thread ){
+        readers.emplace_back( [&, thread](){
+            std::mt19937 generator( thread );
+            std::uniform_real_distribution<double> location_distribution( 0, 383.99 );
+            std::vector<LocalLocation> points( 64 );
+            std::vector<uint8_t> values( points.size() );
+            std::vector<double> distances( points.size() );
+            const auto expected = [&]( const LocalLocation& p, uint8_t value ){
+                return (pattern(p) == value) || (unknown_cell_value == value); };
+            while( not done ){
+                for( auto& point : points ){
+                    point = { location_distribution(generator), location_distribution(generator) };
+                    mismatches += not expected( point, chart->get(point) );
+                }
+                chart->get( points, values );
+                for( size_t index = 0; index < points.size(); ++index ){
+                    mismatches += not expected( points[index], values[index] );
+                }
+                // (no cell blocks)
+                chart->raycast( {192.5, 192.5}, points, block_cell_value, distances );
+                for( const double distance : distances ){
+                    mismatches += ( raycast_clear != distance );
+                }
+                reads += 2 * points.size();
+            }
+        });
+    }
+
+    for( uint32_t move = 0; move < 200; ++move ){
+        REQUIRE( chart->relocate( stops[move % stops.size()] ));
+        if( 0 == (move % 8) ){
+            REQUIRE( contour.load_from_cache() );
+        }
+        // let the readers catch up
+        std::this_thread::yield();
+    }
+    done = true;
+    for( auto& reader : readers ){
+        reader.join();
+    }
+
+    CHECK( 0 < reads );
+    CHECK( 0 == mismatches );
+
+    REQUIRE( chart->enable_concurrent_readers( false ));
+    CHECK_FALSE( contour.concurrent_readers_enabled() );
+    REQUIRE( chart->enable_composite( true ));
+    CHECK_FALSE( chart->enable_concurrent_readers( true ));
+    REQUIRE( chart->enable_composite( false ));
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "ChartBox keeps its composite equal to a fold of its layers" ){
+    auto chart = std::make_unique<test_chart_t>();
+    auto& contour = chart->get_layer<CONTOUR>();
+
+    // moves of: less than a sensor's sector; less than a primary sector; one primary sector; many; more than the whole view
+    // -- and back again, so that earlier areas re-enter the view
+    const std::vector<LocalLocation> moves = { {64, 0}, {1.5, -1}, {-64, 128}, {10, 3}, {-700, 450}, {0, -128},
+                                               {700, -450}, {-3, -2}, {128, 64}, {-128, -64} };
+    constexpr uint32_t step_count = 60;
+
+    // chart every area along the way, in a distinct pattern -- held in the pool, as each sector leaves the view.  (above
+    // `unknown_cell_value`: the fixed layers are unknown outside their views, and the contour combines by max)
+    REQUIRE( contour.enable_pool( 512 ));
+    const LocalLocation home = contour.visible().min;
+    for( uint32_t step = 3; step < step_count; step += 4 ){
+        const BoundBox<LocalLocation> view = contour.visible();
+        for( double northing = view.min.northing + 0.5; northing < view.max.northing; northing += 1 ){
+            for( double easting = view.min.easting + 0.5; easting < view.max.easting; easting += 1 ){
+                const auto column = static_cast<int64_t>( std::floor(easting) );
+                const auto row = static_cast<int64_t>( std::floor(northing) );
+                contour.store( {easting, northing}, static_cast<uint8_t>( 129 + ((column*7 + row*13) & 0x3F) ) );
+            }
+        }
+        REQUIRE( chart->relocate( view.min + moves[(step / 4) % moves.size()] ));
+    }
+    REQUIRE( chart->relocate( home ));
+
+    REQUIRE( chart->enable_composite( true ));
+    REQUIRE( chart->composite_enabled() );
+    REQUIRE( 0 == count_stale_cells( *chart ));
+
+    std::mt19937 generator( 31 );
+    std::uniform_real_distribution<double> unit_distribution( 0, 1 );
+    std::uniform_int_distribution<size_t> index_distribution( 0, 4 );
+    const std::array<role_t, 5> roles = { CONTOUR, BOUNDARY, LIDAR, RADAR, TARGET };
+    const std::array<uint8_t, 4> values = { clear_cell_value, 0x40, unknown_cell_value, block_cell_value };
+
+    // a random location inside the view of the layer with the given role
+    const auto random_location = [&]( role_t role ){
+        BoundBox<LocalLocation> view;
+        chart->layers().for_each( [&]( auto slot, const auto& layer ){
+            if( decltype(slot)::role == role ){
+                view = layer.visible();
+            }
+        });
+        return view.min + LocalLocation( unit_distribution(generator) * view.width(), unit_distribution(generator) * view.height() ); };
+
+    for( uint32_t step = 0; step < step_count; ++step ){
+        const role_t role = roles[ index_distribution(generator) ];
+        const uint8_t value = values[ index_distribution(generator) % values.size() ];
+        switch( step % 4 ){
+            case 0: {
+                for( uint32_t store = 0; store < 20; ++store ){
+                    chart->store( role, random_location(role), value );
+                }
+            } break;
+            case 1: {
+                const LocalLocation a = random_location( role );
+                const LocalLocation b = random_location( role );
+                const LocalLocation c = random_location( role );
+                const BoundBox<LocalLocation> bounds( { std::min({a.easting, b.easting, c.easting}), std::min({a.northing, b.northing, c.northing}) },
+                                                      { std::max({a.easting, b.easting, c.easting}), std::max({a.northing, b.northing, c.northing}) } );
+                chart->fill( role, Polygon<LocalLocation>({ a, b, c, a }), bounds, value );
+            } break;
+            case 2: {
+                std::vector<sensor::SensorHit> hits;
+                for( uint32_t hit = 0; hit < 30; ++hit ){
+                    hits.push_back({ random_location(LIDAR), values[hit % values.size()] });
+                }
+                chart->template get_layer<LIDAR>().submit( hits );
+                for( auto& hit : hits ){
+                    hit.location = random_location( RADAR );
+                }
+                chart->template get_layer<RADAR>().submit( hits );
+                CHECK( 60 == chart->ingest() );
+            } break;
+            case 3: {
+                REQUIRE( chart->relocate( contour.visible().min + moves[(step / 4) % moves.size()] ));
+            } break;
+        }
+        INFO( "step: " << step );
+        REQUIRE( 0 == count_stale_cells( *chart ));
+    }
+
+    // after writing to a layer directly, `recompose` refreshes the composite:
+    const LocalLocation p = contour.visible().center();
+    contour.store( p, 0xB7 );
+    chart->recompose({ p, p + LocalLocation(1, 1) });
+    CHECK( 0xB7 == chart->get(p) );
+    CHECK( 0 == count_stale_cells( *chart ));
+
+    REQUIRE( chart->enable_composite( false ));
+    CHECK_FALSE( chart->composite_enabled() );
+} // TEST_CASE
+
+}   // namespace
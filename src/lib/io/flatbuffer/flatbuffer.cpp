@@ -5,6 +5,8 @@
 //       function implementations.
 
 #include <fstream>
+#include <memory>
+#include <vector>
 
 #include "geometry/local-location.hpp"
 
@@ -15,9 +17,30 @@ namespace chartbox::io::flatbuffer {
 
 std::filesystem::path cache_directory_path;
 
-bool active() { return not cache_directory_path.empty(); }
+std::unique_ptr<TileArchive> cache_archive;
+
+std::atomic<uint64_t> written_byte_count = 0;
+
+bool active() { return (not cache_directory_path.empty()) || cache_archive; }
+
+TileArchive* archive() { return cache_archive.get(); }
+
+uint64_t bytes_written() { return written_byte_count.load(); }
 
 bool enable( std::filesystem::path _path ) {
+    cache_archive.reset();
+    cache_directory_path.clear();
+
+    if( _path.empty() ){
+        return false;
+    }else if( archive_extension == _path.extension() ){
+        cache_archive = std::make_unique<TileArchive>();
+        if( not cache_archive->open(_path) ){
+            cache_archive.reset();
+        }
+        return active();
+    }
+
     cache_directory_path = _path;
 
     if( not std::filesystem::exists(cache_directory_path) ){
@@ -27,6 +50,49 @@ bool enable( std::filesystem::path _path ) {
     return active();
 }
 
+bool flush() {
+    return (not cache_archive) || cache_archive->flush();
+}
+
+MappedTile map( const chartbox::geometry::LocalLocation& origin ){
+    MappedTile tile;
+    if( not cache_directory_path.empty() ){
+        tile.open( generate_tile_cache_filename(origin) );
+    }
+    return tile;
+}
+
+bool write_tile( const chartbox::geometry::LocalLocation& origin, double meters_across_tile, const uint8_t* bytes, size_t size ){
+    if( cache_archive ){
+        if( (not TileArchive::Key::on_grid(origin, meters_across_tile))
+                || (not cache_archive->write( TileArchive::Key(origin, meters_across_tile), bytes, size )) ){
+            return false;
+        }
+    }else{
+        std::ofstream dest( generate_tile_cache_filename(origin).string(), std::ios::binary | std::ios::trunc );
+        dest.write( reinterpret_cast<const char*>(bytes), size );
+        dest.close();
+        if( not dest.good() ){
+            return false;
+        }
+    }
+
+    written_byte_count += size;
+    return true;
+}
+
+bool read_tile( const chartbox::geometry::LocalLocation& origin, double meters_across_tile, MappedTile& tile ){
+    if( cache_archive ){
+        // each thread reads into its own buffer; the tile views it until the next read on this thread.
+        thread_local std::vector<uint8_t> buffer;
+        return TileArchive::Key::on_grid( origin, meters_across_tile )
+                && cache_archive->read( TileArchive::Key(origin, meters_across_tile), buffer )
+                && tile.parse( buffer.data(), buffer.size() );
+    }
+
+    return tile.open( generate_tile_cache_filename(origin) );
+}
+
 std::filesystem::path generate_tile_cache_filename( const chartbox::geometry::LocalLocation& origin ) {
     const std::string filename = fmt::format("tile_local_{:06}E_{:06}N.fb", origin.easting, origin.northing );
     return cache_directory_path / filename;
@@ -2,10 +2,14 @@
 #pragma once
 
 // standard library includes
+#include <atomic>
 #include <cstring> // for std::memcpy
 #include <filesystem>
+#include <memory>
 
 #include "geometry/local-location.hpp"
+#include "io/flatbuffer/mapped-tile.hpp"
+#include "io/flatbuffer/tile-archive.hpp"
 #include "layer/rolling-grid/rolling-grid-sector.hpp"
 
 namespace chartbox::io::flatbuffer {
@@ -14,21 +18,43 @@ const std::string extension = ".fb";
 
 extern std::filesystem::path cache_directory_path;
 
+// running total of the bytes written by `save` (from any thread)
+extern std::atomic<uint64_t> written_byte_count;
+
+uint64_t bytes_written();
+
 bool active();
 
 // enable read/write of flatbuffer files by configuring a cache location for them
 // - module defaults-off; and fails-off 
 // - calling with an empty path explicitly disables read/write
+// - a path with the `archive_extension` selects a single-file tile archive (see TileArchive); any other path is a directory of tile files
 // - scope: global:  all code in a particular program is affecter by this.
 bool enable( std::filesystem::path _path );
 
+// the open tile archive -- or nullptr, if the cache is a directory (or is disabled)
+TileArchive* archive();
+
+// make every tile saved so far visible to other readers of the cache  (i.e. write the archive's index)
+bool flush();
+
 std::filesystem::path generate_tile_cache_filename( const chartbox::geometry::LocalLocation& origin );
 
 // general declaration
 // template<typename T>
 // bool load( const std::filesystem::path& source_path, T& to );
 
-// used for cache tile loading
+// map the cache tile at this origin, read-only -- for reading its cells in place, without a copy
+// - returns a closed tile if the file is missing, or is not a valid tile
+// - only directory caches may be mapped; see `read_tile` for archives
+MappedTile map( const chartbox::geometry::LocalLocation& origin );
+
+// read / write the encoded tile at this origin -- from / to whichever cache is enabled
+// - `read_tile` views the tile either through a mapping, or through a per-thread buffer (valid until the next read)
+bool read_tile( const chartbox::geometry::LocalLocation& origin, double meters_across_tile, MappedTile& tile );
+bool write_tile( const chartbox::geometry::LocalLocation& origin, double meters_across_tile, const uint8_t* bytes, size_t size );
+
+// used for cache tile loading  (maps the tile, and then copies its cells into the sector, once)
 template<uint32_t n>
 bool load( const chartbox::geometry::LocalLocation& at_origin, chartbox::layer::rolling::RollingGridSector<n>& to_sector );
 
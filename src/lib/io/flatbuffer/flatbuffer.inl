@@ -8,53 +8,81 @@
 
 #include "layer/rolling-grid/rolling-grid-layer.hpp"
 
+#include "run-length.hpp"
 #include "tile-cache-generated.hpp"
 
 namespace chartbox::io::flatbuffer {
 
+/// \brief pick the smallest encoding for a buffer
+///
+/// \param size - [out] encoded size, in bytes
+inline TileEncoding choose_encoding( const uint8_t* cells, size_t count, size_t& size ){
+    size_t run_count = 0;
+    const size_t pair_count = run_length_pairs( cells, count, run_count );
+    if( 1 == run_count ){
+        size = 0;
+        return TileEncoding_Uniform;
+    }else if( (2 * pair_count) < count ){
+        size = 2 * pair_count;
+        return TileEncoding_RunLength;
+    }
+    size = count;
+    return TileEncoding_Raw;
+}
+
+/// \brief write a buffer into the builder, in the given encoding.  (a uniform buffer needs no vector)
+inline flatbuffers::Offset<flatbuffers::Vector<uint8_t>> create_encoded_vector( flatbuffers::FlatBufferBuilder& builder, TileEncoding encoding, const uint8_t* cells, size_t count, size_t size ){
+    if( TileEncoding_Raw == encoding ){
+        return builder.CreateVector( cells, count );
+    }else if( TileEncoding_RunLength == encoding ){
+        uint8_t* encoded = nullptr;
+        const auto vec = builder.CreateUninitializedVector( size, &encoded );
+        run_length_encode( cells, count, encoded );
+        return vec;
+    }
+    return {};
+}
+
 template<uint32_t n>
 bool load( const chartbox::geometry::LocalLocation& at_origin, chartbox::layer::rolling::RollingGridSector<n>& to_sector ){
-    using chartbox::io::flatbuffer::TileCache;
-    using chartbox::io::flatbuffer::TileCacheBuilder;
-    using chartbox::io::flatbuffer::Location;
-
-    if( cache_directory_path.empty() ){
+    if( not active() ){
         // cache is not enabled
         to_sector.fill(chartbox::layer::unknown_cell_value);
         return false;
     }
 
-    const auto& filepath = generate_tile_cache_filename( at_origin );
-    if( not std::filesystem::is_regular_file(filepath)){
-        fmt::print(stderr, "    !! Input path is not a file!!: {}\n", filepath.string());
+    MappedTile tile;
+    if( not read_tile( at_origin, n * to_sector.meters_across_cell, tile ) ){
+        fmt::print(stderr, "    !! No tile cached at: ({}, {})\n", at_origin.easting, at_origin.northing );
         to_sector.fill(chartbox::layer::unknown_cell_value);
         return false;
     }
 
-    // read bytes from file:
-    std::ifstream source( filepath.string(), std::ios::binary );
-    std::array<uint8_t, (sizeof(TileCache) + to_sector.size())> buffer;
-    source.read( reinterpret_cast<char*>(buffer.data()), buffer.size() );
-    source.close();
-
-    // Load raw bytes into the structured flatbuffer class
-    const auto tile = chartbox::io::flatbuffer::GetTileCache( buffer.data() );
-
     // .1. Check Dimensions Match:
-    assert( tile->dimension() == to_sector.cells_across() );
+    assert( tile.dimension() == to_sector.cells_across() );
 
     // .2. Check Real-World Bounds match:
     // sector doesn't track it's own origin ...
     constexpr double tolerance = 1.0;
-    assert( tolerance > std::fabs(at_origin.easting - tile->origin()->easting()) );
-    assert( tolerance > std::fabs(at_origin.northing - tile->origin()->northing()) );
+    assert( tolerance > std::fabs(at_origin.easting - tile.origin().easting) );
+    assert( tolerance > std::fabs(at_origin.northing - tile.origin().northing) );
 
     // .3. Check Stated Precision
     // TODO: implement a precision check;  the information is not currently available to this method :(
-    // assert( tolerance > std::fabs(tile->precision() == with_precision );
-
-    // .4. Checks Passed: load actual data
-    to_sector.fill( tile->data()->data(), tile->data()->size() );
+    // assert( tolerance > std::fabs(tile.precision() == with_precision );
+
+    // .4. Checks Passed: decode straight into the sector
+    if( TileEncoding_Uniform == tile.encoding() ){
+        // (fills the pyramid, too)
+        to_sector.fill( tile.value() );
+    }else if( not tile.decode( to_sector.data(), to_sector.size() ) ){
+        fmt::print(stderr, "    !! Tile does not decode to a full sector: ({}, {})\n", at_origin.easting, at_origin.northing );
+        to_sector.fill(chartbox::layer::unknown_cell_value);
+        return false;
+    }else if( to_sector.has_pyramid() && (not tile.decode_pyramid( to_sector.pyramid_data(), to_sector.pyramid_size )) ){
+        // no (valid) pyramid was saved with this tile:
+        to_sector.rebuild_pyramid();
+    }
 
     // fmt::print( "{:8s}<<< Tile loaded: {}\n", "", filepath.string() );
 
@@ -64,33 +92,47 @@ bool load( const chartbox::geometry::LocalLocation& at_origin, chartbox::layer::
 
 template<uint32_t n>
 bool save( const chartbox::layer::rolling::RollingGridSector<n>& from_sector, const chartbox::geometry::LocalLocation& at_origin ){
-    if( cache_directory_path.empty() ){
+    if( not active() ){
         // cache is not enabled
         return false;
     }
 
-    const auto& filepath = generate_tile_cache_filename( at_origin );
-    // fmt::print( stderr, "    >>> Write Sector to: {}\n", filepath.string() );
+    // pick the smallest encoding:
+    size_t data_size = 0;
+    const TileEncoding encoding = choose_encoding( from_sector.data(), from_sector.size(), data_size );
+
+    // ... and for the pyramid, if any.  (a uniform tile has a uniform pyramid)
+    const bool save_pyramid = from_sector.has_pyramid() && (TileEncoding_Uniform != encoding);
+    size_t pyramid_size = 0;
+    TileEncoding pyramid_encoding = TileEncoding_Raw;
+    if( save_pyramid ){
+        pyramid_encoding = choose_encoding( from_sector.pyramid_data(), from_sector.pyramid_size, pyramid_size );
+        if( TileEncoding_Uniform == pyramid_encoding ){
+            // the tile's value is the first cell -- which need not match the pyramid:
+            size_t distinct = 0;
+            pyramid_encoding = TileEncoding_RunLength;
+            pyramid_size = 2 * run_length_pairs( from_sector.pyramid_data(), from_sector.pyramid_size, distinct );
+        }
+    }
 
-    flatbuffers::FlatBufferBuilder builder( sizeof(TileCache) + from_sector.size() );
+    flatbuffers::FlatBufferBuilder builder( sizeof(TileCache) + data_size + pyramid_size );
 
     // create internal objects before parent objects:
     const float precision = from_sector.meters_across_cell;
     const uint32_t dimension = from_sector.cells_across();
     chartbox::io::flatbuffer::Location origin( static_cast<float>(at_origin.easting), static_cast<float>(at_origin.northing) );
-    auto datavec = builder.CreateVector( const_cast<uint8_t*>(from_sector.data()), from_sector.size() );
+    const auto datavec = create_encoded_vector( builder, encoding, from_sector.data(), from_sector.size(), data_size );
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> pyramidvec;
+    if( save_pyramid ){
+        pyramidvec = create_encoded_vector( builder, pyramid_encoding, from_sector.pyramid_data(), from_sector.pyramid_size, pyramid_size );
+    }
 
     // build internal representation
-    auto tile_cache = chartbox::io::flatbuffer::CreateTileCache( builder, &origin, precision, dimension, datavec );
+    auto tile_cache = chartbox::io::flatbuffer::CreateTileCache( builder, &origin, precision, dimension, datavec, encoding, from_sector[0], pyramidvec, pyramid_encoding );
     builder.Finish(tile_cache);
 
-    // write bytes to file
-    std::ofstream dest( filepath.string(), std::ios::binary | std::ios::trunc );
-    dest.write( reinterpret_cast<const char*>(builder.GetBufferPointer()), builder.GetSize() );
-    dest.close();
-
-    // fmt::print(  "{:>16s}<<< Successfuly wrote {} bytes to: {} \n", "", builder.GetSize(), filepath.string() );
-    return true;
+    // write bytes to the file / archive
+    return write_tile( at_origin, n * from_sector.meters_across_cell, builder.GetBufferPointer(), builder.GetSize() );
 }
 
 
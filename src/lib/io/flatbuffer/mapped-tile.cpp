@@ -0,0 +1,161 @@
+// GPL v3 (c) 2021, Daniel Williams 
+
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped-tile.hpp"
+#include "run-length.hpp"
+#include "tile-cache-generated.hpp"
+
+namespace chartbox::io::flatbuffer {
+
+MappedTile::MappedTile( MappedTile&& other ){
+    *this = std::move( other );
+}
+
+MappedTile& MappedTile::operator=( MappedTile&& other ){
+    if( this != &other ){
+        close();
+        std::swap( mapping_, other.mapping_ );
+        std::swap( mapping_size_, other.mapping_size_ );
+        std::swap( is_open_, other.is_open_ );
+        std::swap( data_, other.data_ );
+        std::swap( data_size_, other.data_size_ );
+        encoding_ = other.encoding_;
+        value_ = other.value_;
+        std::swap( pyramid_, other.pyramid_ );
+        std::swap( pyramid_size_, other.pyramid_size_ );
+        pyramid_encoding_ = other.pyramid_encoding_;
+        dimension_ = other.dimension_;
+        precision_ = other.precision_;
+        origin_ = other.origin_;
+    }
+    return *this;
+}
+
+MappedTile::~MappedTile(){
+    close();
+}
+
+void MappedTile::close(){
+    if( nullptr != mapping_ ){
+        munmap( mapping_, mapping_size_ );
+    }
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+    is_open_ = false;
+    data_ = nullptr;
+    data_size_ = 0;
+    pyramid_ = nullptr;
+    pyramid_size_ = 0;
+}
+
+bool MappedTile::open( const std::filesystem::path& path ){
+    close();
+
+    const int descriptor = ::open( path.c_str(), O_RDONLY );
+    if( 0 > descriptor ){
+        return false;
+    }
+
+    struct stat status;
+    if( (0 != fstat(descriptor, &status)) || (0 == status.st_size) ){
+        ::close( descriptor );
+        return false;
+    }
+
+    void* const mapping = mmap( nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+    // (the mapping holds its own reference to the file)
+    ::close( descriptor );
+    if( MAP_FAILED == mapping ){
+        return false;
+    }
+    mapping_ = mapping;
+    mapping_size_ = status.st_size;
+
+    // verify in place:
+    if( not parse( static_cast<const uint8_t*>(mapping_), mapping_size_ ) ){
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedTile::parse( const uint8_t* bytes, size_t size ){
+    is_open_ = false;
+    data_ = nullptr;
+    data_size_ = 0;
+    pyramid_ = nullptr;
+    pyramid_size_ = 0;
+
+    flatbuffers::Verifier verifier( bytes, size );
+    if( not VerifyTileCacheBuffer(verifier) ){
+        return false;
+    }
+
+    const TileCache* const tile = GetTileCache( bytes );
+    if( (nullptr == tile->origin()) || flatbuffers::IsOutRange( tile->encoding(), TileEncoding_MIN, TileEncoding_MAX ) ){
+        return false;
+    }else if( (nullptr == tile->data()) && (TileEncoding_Uniform != tile->encoding()) ){
+        return false;
+    }
+
+    if( nullptr != tile->data() ){
+        data_ = tile->data()->data();
+        data_size_ = tile->data()->size();
+    }
+    encoding_ = tile->encoding();
+    value_ = tile->value();
+    if( (nullptr != tile->pyramid()) && (not flatbuffers::IsOutRange( tile->pyramid_encoding(), TileEncoding_Raw, TileEncoding_RunLength )) ){
+        pyramid_ = tile->pyramid()->data();
+        pyramid_size_ = tile->pyramid()->size();
+        pyramid_encoding_ = tile->pyramid_encoding();
+    }
+    dimension_ = tile->dimension();
+    precision_ = tile->precision();
+    origin_ = { tile->origin()->easting(), tile->origin()->northing() };
+    is_open_ = true;
+    return true;
+}
+
+namespace {
+
+bool decode_as( TileEncoding encoding, const uint8_t* data, size_t data_size, uint8_t value, uint8_t* to, size_t count ){
+    switch( encoding ){
+        case TileEncoding_Uniform:
+            std::memset( to, value, count );
+            return true;
+        case TileEncoding_RunLength:
+            return run_length_decode( data, data_size, to, count );
+        case TileEncoding_Raw:
+        default:
+            if( count != data_size ){
+                return false;
+            }
+            std::memcpy( to, data, count );
+            return true;
+    }
+}
+
+} // namespace
+
+bool MappedTile::decode( uint8_t* to, size_t count ) const {
+    if( (not is_open_) || (count != (static_cast<size_t>(dimension_) * dimension_)) ){
+        return false;
+    }
+    return decode_as( encoding_, data_, data_size_, value_, to, count );
+}
+
+bool MappedTile::decode_pyramid( uint8_t* to, size_t count ) const {
+    if( (not is_open_) || (not has_pyramid()) ){
+        return false;
+    }
+    return decode_as( pyramid_encoding_, pyramid_, pyramid_size_, value_, to, count );
+}
+
+} // namespace
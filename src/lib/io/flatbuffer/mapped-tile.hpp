@@ -0,0 +1,107 @@
+// GPL v3 (c) 2021, Daniel Williams 
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include "geometry/local-location.hpp"
+
+#include "tile-cache-generated.hpp"
+
+namespace chartbox::io::flatbuffer {
+
+/// \brief Read-only, memory-mapped view of a single tile-cache file
+///
+/// The file is mapped (not read), and the flatbuffer is verified in place.  The cells of a raw tile may then be
+/// read straight out of the mapping -- for example, by read-only consumers.  Any tile may be decoded into a
+/// sector, once.  The mapping is released when this object is destroyed.
+///
+/// (A tile held in some other buffer may also be viewed through this class -- see `parse`)
+class MappedTile {
+public:
+    MappedTile() = default;
+
+    MappedTile( const MappedTile& ) = delete;
+    MappedTile& operator=( const MappedTile& ) = delete;
+
+    MappedTile( MappedTile&& other );
+    MappedTile& operator=( MappedTile&& other );
+
+    ~MappedTile();
+
+    /// \brief map + verify the given file
+    ///
+    /// \return true if the file is a valid tile, and is now mapped
+    bool open( const std::filesystem::path& path );
+
+    /// \brief verify + view a tile held in memory elsewhere.  (nothing is mapped)
+    ///
+    /// \param bytes - the flatbuffer; must outlive this view
+    /// \param size - byte count of the flatbuffer
+    /// \return true if the bytes are a valid tile
+    bool parse( const uint8_t* bytes, size_t size );
+
+    /// \brief release the mapping, if any
+    void close();
+
+    inline bool is_open() const { return is_open_; }
+
+    /// \brief decode every cell of this tile
+    ///
+    /// \param to - destination cells
+    /// \param count - number of destination cells; must equal `dimension()^2`
+    /// \return true if the tile decoded to exactly `count` cells
+    bool decode( uint8_t* to, size_t count ) const;
+
+    /// \brief decode the pyramid stored with this tile
+    ///
+    /// \param to - destination levels
+    /// \param count - size of the destination pyramid
+    /// \return true if the tile holds a pyramid, and it decoded to exactly `count` cells
+    bool decode_pyramid( uint8_t* to, size_t count ) const;
+
+    /// \brief true if a pyramid was saved with this tile
+    inline bool has_pyramid() const { return nullptr != pyramid_; }
+
+    inline TileEncoding encoding() const { return encoding_; }
+
+    /// \brief the cells of a raw tile -- empty for any other encoding.
+    /// these point into the mapping, and are valid until it is closed.
+    inline std::span<const uint8_t> cells() const {
+        return (TileEncoding_Raw == encoding_) ? data() : std::span<const uint8_t>(); }
+
+    /// \brief the encoded payload of this tile; points into the mapping
+    inline std::span<const uint8_t> data() const { return { data_, data_size_ }; }
+
+    /// \brief value of every cell in a uniform tile
+    inline uint8_t value() const { return value_; }
+
+    inline uint32_t dimension() const { return dimension_; }
+
+    inline float precision() const { return precision_; }
+
+    inline const geometry::LocalLocation& origin() const { return origin_; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+
+    bool is_open_ = false;
+    const uint8_t* data_ = nullptr;
+    size_t data_size_ = 0;
+
+    TileEncoding encoding_ = TileEncoding_Raw;
+    uint8_t value_ = 0;
+
+    const uint8_t* pyramid_ = nullptr;
+    size_t pyramid_size_ = 0;
+    TileEncoding pyramid_encoding_ = TileEncoding_Raw;
+
+    uint32_t dimension_ = 0;
+    float precision_ = 0;
+    geometry::LocalLocation origin_;
+};
+
+} // namespace
@@ -0,0 +1,84 @@
+// GPL v3 (c) 2021, Daniel Williams 
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace chartbox::io::flatbuffer {
+
+// Byte-oriented run-length encoding, for tile payloads
+//
+// Each run is encoded as a pair of bytes:  { value, length - 1 }  -- so a run covers 1-256 cells, and a longer
+// stretch of the same value is split into several runs.  Decoding is a `memset` per run.
+
+/// \brief longest run that fits in a single pair
+constexpr size_t run_length_limit = 256;
+
+/// \brief count the runs in a buffer -- i.e. the number of pairs needed to encode it
+///
+/// \param cells - buffer to scan
+/// \param count - number of cells in the buffer
+/// \param distinct - [out] number of maximal runs of equal values, regardless of length. (1 => uniform)
+inline size_t run_length_pairs( const uint8_t* cells, size_t count, size_t& distinct ){
+    size_t pairs = 0;
+    distinct = 0;
+    for( size_t run_start = 0; run_start < count; ){
+        const uint8_t value = cells[run_start];
+        size_t run_end = run_start + 1;
+        while( (run_end < count) && (value == cells[run_end]) ){
+            ++run_end;
+        }
+        pairs += (run_end - run_start + run_length_limit - 1) / run_length_limit;
+        ++distinct;
+        run_start = run_end;
+    }
+    return pairs;
+}
+
+/// \brief encode the buffer
+///
+/// \param to - destination; sized for (at least) `2 * run_length_pairs(cells, count)` bytes
+/// \return number of bytes written
+inline size_t run_length_encode( const uint8_t* cells, size_t count, uint8_t* to ){
+    uint8_t* at = to;
+    for( size_t run_start = 0; run_start < count; ){
+        const uint8_t value = cells[run_start];
+        const size_t limit = std::min( count, run_start + run_length_limit );
+        size_t run_end = run_start + 1;
+        while( (run_end < limit) && (value == cells[run_end]) ){
+            ++run_end;
+        }
+        *at++ = value;
+        *at++ = static_cast<uint8_t>(run_end - run_start - 1);
+        run_start = run_end;
+    }
+    return at - to;
+}
+
+/// \brief decode an encoded buffer
+///
+/// \param encoded - pairs, as written by `run_length_encode`
+/// \param encoded_size - number of bytes in the encoded buffer
+/// \param to - destination cells
+/// \param count - number of destination cells
+/// \return true if the runs exactly cover the destination cells
+inline bool run_length_decode( const uint8_t* encoded, size_t encoded_size, uint8_t* to, size_t count ){
+    if( 0 != (encoded_size % 2) ){
+        return false;
+    }
+
+    size_t written = 0;
+    for( size_t pair_index = 0; pair_index < encoded_size; pair_index += 2 ){
+        const size_t length = static_cast<size_t>(encoded[pair_index + 1]) + 1;
+        if( count < (written + length) ){
+            return false;
+        }
+        std::memset( to + written, encoded[pair_index], length );
+        written += length;
+    }
+    return count == written;
+}
+
+} // namespace
@@ -0,0 +1,314 @@
+// GPL v3 (c) 2021, Daniel Williams 
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+#include "flatbuffer.hpp"
+#include "mapped-tile.hpp"
+#include "tile-archive.hpp"
+
+namespace chartbox::io::flatbuffer {
+
+/// \brief on-disk header; at offset 0
+struct TileArchive::Header {
+    constexpr static char expected_magic[8] = { 'C', 'B', 'T', 'I', 'L', 'E', 'S', '\0' };
+    constexpr static uint32_t expected_version = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t alignment;
+    uint64_t index_offset;
+    uint64_t index_count;
+};
+
+namespace {
+
+constexpr uint64_t align( uint64_t offset ){
+    return (offset + TileArchive::payload_alignment - 1) / TileArchive::payload_alignment * TileArchive::payload_alignment; }
+
+bool read_exactly( int descriptor, void* to, size_t count, uint64_t offset ){
+    uint8_t* at = static_cast<uint8_t*>(to);
+    while( 0 < count ){
+        const ssize_t got = pread( descriptor, at, count, offset );
+        if( 0 >= got ){
+            return false;
+        }
+        at += got;
+        count -= got;
+        offset += got;
+    }
+    return true;
+}
+
+bool write_exactly( int descriptor, const void* from, size_t count, uint64_t offset ){
+    const uint8_t* at = static_cast<const uint8_t*>(from);
+    while( 0 < count ){
+        const ssize_t put = pwrite( descriptor, at, count, offset );
+        if( 0 >= put ){
+            return false;
+        }
+        at += put;
+        count -= put;
+        offset += put;
+    }
+    return true;
+}
+
+} // namespace
+
+TileArchive::Key::Key( const geometry::LocalLocation& origin, double meters_across_tile )
+    : column( static_cast<int32_t>(std::lround(origin.easting / meters_across_tile)) )
+    , row( static_cast<int32_t>(std::lround(origin.northing / meters_across_tile)) )
+{
+    // (an origin off the grid would silently round onto a neighbouring tile)
+    assert( on_grid( origin, meters_across_tile ) );
+}
+
+bool TileArchive::Key::on_grid( const geometry::LocalLocation& origin, double meters_across_tile ){
+    // to within a millionth of a tile:
+    constexpr double tolerance = 1e-6;
+    const double columns = origin.easting / meters_across_tile;
+    const double rows = origin.northing / meters_across_tile;
+    return (0 < meters_across_tile)
+            && (tolerance >= std::fabs( columns - std::round(columns) ))
+            && (tolerance >= std::fabs( rows - std::round(rows) ));
+}
+
+TileArchive::~TileArchive(){
+    close();
+}
+
+bool TileArchive::open( const std::filesystem::path& path ){
+    close();
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    descriptor_ = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+    if( 0 > descriptor_ ){
+        fmt::print( stderr, "    !! Could not open tile archive: {}\n", path.string() );
+        return false;
+    }
+
+    Header header;
+    struct stat status;
+    fstat( descriptor_, &status );
+    if( 0 == status.st_size ){
+        // new archive: the header gets a page to itself
+        append_offset_ = payload_alignment;
+        index_changed_ = true;
+        return write_index();
+    }
+
+    if( (not read_exactly( descriptor_, &header, sizeof(Header), 0 ))
+            || (0 != std::memcmp( header.magic, Header::expected_magic, sizeof(header.magic) ))
+            || (Header::expected_version != header.version)
+            || (payload_alignment != header.alignment) ){
+        fmt::print( stderr, "    !! Not a tile archive: {}\n", path.string() );
+        ::close( descriptor_ );
+        descriptor_ = -1;
+        return false;
+    }
+
+    index_.resize( header.index_count );
+    if( not read_exactly( descriptor_, index_.data(), index_.size() * sizeof(Entry), header.index_offset ) ){
+        fmt::print( stderr, "    !! Tile archive index is truncated: {}\n", path.string() );
+        ::close( descriptor_ );
+        descriptor_ = -1;
+        index_.clear();
+        return false;
+    }
+
+    // append after everything -- including the current index
+    index_offset_ = header.index_offset;
+    index_capacity_ = align( index_.size() * sizeof(Entry) );
+    append_offset_ = index_offset_ + index_capacity_;
+    index_changed_ = false;
+    return true;
+}
+
+void TileArchive::close(){
+    flush();
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if( 0 <= descriptor_ ){
+        ::close( descriptor_ );
+    }
+    descriptor_ = -1;
+    index_.clear();
+    append_offset_ = 0;
+    index_offset_ = index_capacity_ = 0;
+    spare_offset_ = spare_capacity_ = 0;
+    retired_slots_.clear();
+    free_slots_.clear();
+    index_changed_ = false;
+}
+
+bool TileArchive::flush(){
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return write_index();
+}
+
+bool TileArchive::write_index(){
+    if( (0 > descriptor_) || (not index_changed_) ){
+        return true;
+    }
+
+    // never overwrite the current index: write into the spare region, if it fits; otherwise append.
+    const uint64_t index_size = index_.size() * sizeof(Entry);
+    uint64_t index_offset = spare_offset_;
+    uint64_t index_capacity = spare_capacity_;
+    if( (0 == spare_offset_) || (spare_capacity_ < index_size) ){
+        index_offset = append_offset_;
+        index_capacity = std::max<uint64_t>( payload_alignment, align(index_size) );
+    }
+    if( not write_exactly( descriptor_, index_.data(), index_size, index_offset ) ){
+        return false;
+    }
+    append_offset_ = std::max( append_offset_, index_offset + index_capacity );
+
+    // ... and only then point the header at it -- once the index, and every payload it points to, are on disk:
+    if( 0 != fdatasync( descriptor_ ) ){
+        return false;
+    }
+    Header header;
+    std::memcpy( header.magic, Header::expected_magic, sizeof(header.magic) );
+    header.version = Header::expected_version;
+    header.alignment = payload_alignment;
+    header.index_offset = index_offset;
+    header.index_count = index_.size();
+    if( (not write_exactly( descriptor_, &header, sizeof(Header), 0 )) || (0 != fdatasync( descriptor_ )) ){
+        return false;
+    }
+
+    // the old index is now free -- as is every payload slot which the new index replaced:
+    spare_offset_ = index_offset_;
+    spare_capacity_ = index_capacity_;
+    free_slots_.insert( free_slots_.end(), retired_slots_.begin(), retired_slots_.end() );
+    retired_slots_.clear();
+    index_offset_ = index_offset;
+    index_capacity_ = index_capacity;
+    index_changed_ = false;
+    return true;
+}
+
+std::vector<TileArchive::Entry>::const_iterator TileArchive::find( const Key& key ) const {
+    const auto at = std::lower_bound( index_.begin(), index_.end(), key, []( const Entry& entry, const Key& k ){
+        return Key( entry.column, entry.row ) < k; });
+    if( (index_.end() != at) && (Key( at->column, at->row ) == key) ){
+        return at;
+    }
+    return index_.end();
+}
+
+bool TileArchive::contains( const Key& key ) const {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return index_.end() != find( key );
+}
+
+bool TileArchive::read( const Key& key, std::vector<uint8_t>& payload ) const {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    const auto entry = find( key );
+    if( index_.end() == entry ){
+        return false;
+    }
+
+    payload.resize( entry->size );
+    return read_exactly( descriptor_, payload.data(), entry->size, entry->offset );
+}
+
+bool TileArchive::write( const Key& key, const uint8_t* payload, size_t size ){
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if( 0 > descriptor_ ){
+        return false;
+    }
+
+    // never over the tile's current slot -- the committed index may still point to it.  Take the first free slot
+    // which fits; otherwise append.
+    const auto slot = std::find_if( free_slots_.begin(), free_slots_.end(), [&]( const Slot& each ){
+        return size <= each.capacity; });
+    const bool append = (free_slots_.end() == slot);
+    const Slot written_slot = append ? Slot{ append_offset_, static_cast<uint32_t>(align(size)) } : *slot;
+    if( not write_exactly( descriptor_, payload, size, written_slot.offset ) ){
+        return false;
+    }
+    if( append ){
+        append_offset_ = written_slot.offset + written_slot.capacity;
+    }else{
+        free_slots_.erase( slot );
+    }
+
+    const Entry written = { key.column, key.row, written_slot.offset, static_cast<uint32_t>(size), written_slot.capacity };
+    auto entry = index_.begin() + (find( key ) - index_.cbegin());
+    if( index_.end() != entry ){
+        // (free once the next index is committed)
+        retired_slots_.push_back({ entry->offset, entry->capacity });
+        *entry = written;
+    }else{
+        const auto at = std::lower_bound( index_.begin(), index_.end(), key, []( const Entry& each, const Key& k ){
+            return Key( each.column, each.row ) < k; });
+        index_.insert( at, written );
+    }
+    index_changed_ = true;
+    return true;
+}
+
+size_t TileArchive::size() const {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return index_.size();
+}
+
+uint64_t TileArchive::file_size() const {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    struct stat status;
+    if( (0 > descriptor_) || (0 != fstat( descriptor_, &status )) ){
+        return 0;
+    }
+    return status.st_size;
+}
+
+size_t pack_directory( const std::filesystem::path& directory, const std::filesystem::path& archive_path ){
+    TileArchive archive;
+    if( not archive.open( archive_path ) ){
+        return 0;
+    }
+
+    size_t packed_count = 0;
+    for( const auto& each : std::filesystem::directory_iterator( directory ) ){
+        if( extension != each.path().extension() ){
+            continue;
+        }
+
+        MappedTile tile;
+        if( not tile.open( each.path() ) ){
+            fmt::print( stderr, "    !! Skipping invalid tile: {}\n", each.path().string() );
+            continue;
+        }
+
+        const double meters_across_tile = tile.dimension() * tile.precision();
+        if( not TileArchive::Key::on_grid( tile.origin(), meters_across_tile ) ){
+            fmt::print( stderr, "    !! Skipping tile off the tile grid: {}\n", each.path().string() );
+            continue;
+        }
+
+        // the payload is the whole file -- copied byte-for-byte
+        const TileArchive::Key key( tile.origin(), meters_across_tile );
+        std::vector<uint8_t> payload( std::filesystem::file_size( each.path() ) );
+        std::ifstream source( each.path(), std::ios::binary );
+        source.read( reinterpret_cast<char*>(payload.data()), payload.size() );
+        if( archive.write( key, payload.data(), payload.size() ) ){
+            ++packed_count;
+        }
+    }
+
+    archive.close();
+    return packed_count;
+}
+
+} // namespace
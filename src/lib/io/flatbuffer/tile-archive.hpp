@@ -0,0 +1,150 @@
+// GPL v3 (c) 2021, Daniel Williams 
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include "geometry/local-location.hpp"
+
+namespace chartbox::io::flatbuffer {
+
+const std::string archive_extension = ".tiles";
+
+/// \brief Single-file archive of cache tiles
+///
+/// File Layout:
+///   [ header ][ tile payload ][ tile payload ] ... [ index ]
+///   - header: fixed-size; at offset 0.  Points to the current index.
+///   - payloads: each is a complete `TileCache` flatbuffer, aligned to `payload_alignment`
+///   - index: one entry per tile, sorted by (row, column).  Written after the payloads, into a free region.
+///
+/// Tiles are keyed by their integer tile coordinates (i.e. `origin / meters-across-tile`).  A payload is never
+/// written over a slot which the committed index still points to: an updated tile goes into a free slot, if one
+/// fits; otherwise it is appended.  Its old slot is only freed once `flush` has committed an index without it.
+/// The index is held in memory, and is written (followed by the header) by `flush` -- an interrupted update
+/// leaves the previous index, and every payload it points to, intact.
+///
+/// Every method is thread-safe.
+class TileArchive {
+public:
+    constexpr static uint32_t payload_alignment = 4096;
+
+    /// \brief integer coordinates of a tile
+    struct Key {
+        int32_t column;
+        int32_t row;
+
+        Key( int32_t _column, int32_t _row ) : column(_column), row(_row) {}
+
+        /// \brief key of the tile at this origin.  (the origin must be on the tile grid; see: `on_grid`)
+        Key( const geometry::LocalLocation& origin, double meters_across_tile );
+
+        /// \brief true if the origin is a whole multiple of the tile width, along each axis
+        static bool on_grid( const geometry::LocalLocation& origin, double meters_across_tile );
+
+        inline bool operator<( const Key& other ) const {
+            return (row < other.row) || ((row == other.row) && (column < other.column)); }
+
+        inline bool operator==( const Key& other ) const {
+            return (row == other.row) && (column == other.column); }
+    };
+
+public:
+    TileArchive() = default;
+
+    TileArchive( const TileArchive& ) = delete;
+    TileArchive& operator=( const TileArchive& ) = delete;
+
+    /// \brief flushes + closes
+    ~TileArchive();
+
+    /// \brief open an existing archive, or create a new, empty one
+    bool open( const std::filesystem::path& path );
+
+    /// \brief write the index + header; and then release the file
+    void close();
+
+    /// \brief write the index + header, so that every tile saved so far is visible to the next reader
+    bool flush();
+
+    inline bool is_open() const { return 0 <= descriptor_; }
+
+    bool contains( const Key& key ) const;
+
+    /// \brief copy out a tile's payload (a `TileCache` flatbuffer)
+    ///
+    /// \param payload - [out] resized to fit the payload
+    /// \return true if the tile is present
+    bool read( const Key& key, std::vector<uint8_t>& payload ) const;
+
+    /// \brief store a tile's payload: into a free slot, if one fits; otherwise appended
+    ///
+    /// Readers see the new payload at once; the next reader of the file sees it only after `flush`.
+    bool write( const Key& key, const uint8_t* payload, size_t size );
+
+    /// \brief number of tiles in the archive
+    size_t size() const;
+
+    /// \brief total size of the archive file, in bytes
+    uint64_t file_size() const;
+
+private:
+    struct Header;
+
+    struct Entry {
+        int32_t column;
+        int32_t row;
+        uint64_t offset;
+        uint32_t size;
+        uint32_t capacity;
+    };
+
+    /// \brief a payload slot, which no index points to
+    struct Slot {
+        uint64_t offset;
+        uint32_t capacity;
+    };
+
+    std::vector<Entry>::const_iterator find( const Key& key ) const;
+
+    // (call with `mutex_` held)
+    bool write_index();
+
+private:
+    mutable std::mutex mutex_;
+
+    int descriptor_ = -1;
+
+    // sorted by (row, column):
+    std::vector<Entry> index_;
+
+    // next free (aligned) offset for a payload
+    uint64_t append_offset_ = 0;
+
+    // region holding the current index; and the free region which held the index before it.
+    // (successive indices alternate between these two, so that repeated flushes do not grow the file)
+    uint64_t index_offset_ = 0;
+    uint64_t index_capacity_ = 0;
+    uint64_t spare_offset_ = 0;
+    uint64_t spare_capacity_ = 0;
+
+    // payload slots which the in-memory index has replaced -- but the committed index still points to
+    std::vector<Slot> retired_slots_;
+
+    // payload slots which no index points to; reused by `write`
+    std::vector<Slot> free_slots_;
+
+    bool index_changed_ = false;
+};
+
+/// \brief pack a directory of tile files (`*.fb`) into a single archive
+///
+/// \param directory - source directory of per-tile files
+/// \param archive_path - destination archive.  Tiles already in it are replaced.
+/// \return count of tiles packed
+size_t pack_directory( const std::filesystem::path& directory, const std::filesystem::path& archive_path );
+
+} // namespace
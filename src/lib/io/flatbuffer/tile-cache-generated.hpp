@@ -14,6 +14,39 @@ struct Location;
 
 struct TileCache;
 
+enum TileEncoding {
+  TileEncoding_Raw = 0,
+  TileEncoding_Uniform = 1,
+  TileEncoding_RunLength = 2,
+  TileEncoding_MIN = TileEncoding_Raw,
+  TileEncoding_MAX = TileEncoding_RunLength
+};
+
+inline const TileEncoding (&EnumValuesTileEncoding())[3] {
+  static const TileEncoding values[] = {
+    TileEncoding_Raw,
+    TileEncoding_Uniform,
+    TileEncoding_RunLength
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesTileEncoding() {
+  static const char * const names[4] = {
+    "Raw",
+    "Uniform",
+    "RunLength",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameTileEncoding(TileEncoding e) {
+  if (flatbuffers::IsOutRange(e, TileEncoding_Raw, TileEncoding_RunLength)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesTileEncoding()[index];
+}
+
 FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) Location FLATBUFFERS_FINAL_CLASS {
  private:
   float easting_;
@@ -41,7 +74,11 @@ struct TileCache FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_ORIGIN = 4,
     VT_PRECISION = 6,
     VT_DIMENSION = 8,
-    VT_DATA = 10
+    VT_DATA = 10,
+    VT_ENCODING = 12,
+    VT_VALUE = 14,
+    VT_PYRAMID = 16,
+    VT_PYRAMID_ENCODING = 18
   };
   const Location *origin() const {
     return GetStruct<const Location *>(VT_ORIGIN);
@@ -55,6 +92,18 @@ struct TileCache FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::Vector<uint8_t> *data() const {
     return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_DATA);
   }
+  chartbox::io::flatbuffer::TileEncoding encoding() const {
+    return static_cast<chartbox::io::flatbuffer::TileEncoding>(GetField<uint8_t>(VT_ENCODING, 0));
+  }
+  uint8_t value() const {
+    return GetField<uint8_t>(VT_VALUE, 0);
+  }
+  const flatbuffers::Vector<uint8_t> *pyramid() const {
+    return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_PYRAMID);
+  }
+  chartbox::io::flatbuffer::TileEncoding pyramid_encoding() const {
+    return static_cast<chartbox::io::flatbuffer::TileEncoding>(GetField<uint8_t>(VT_PYRAMID_ENCODING, 0));
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<Location>(verifier, VT_ORIGIN) &&
@@ -62,6 +111,11 @@ struct TileCache FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyField<uint32_t>(verifier, VT_DIMENSION) &&
            VerifyOffset(verifier, VT_DATA) &&
            verifier.VerifyVector(data()) &&
+           VerifyField<uint8_t>(verifier, VT_ENCODING) &&
+           VerifyField<uint8_t>(verifier, VT_VALUE) &&
+           VerifyOffset(verifier, VT_PYRAMID) &&
+           verifier.VerifyVector(pyramid()) &&
+           VerifyField<uint8_t>(verifier, VT_PYRAMID_ENCODING) &&
            verifier.EndTable();
   }
 };
@@ -81,6 +135,18 @@ struct TileCacheBuilder {
   void add_data(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data) {
     fbb_.AddOffset(TileCache::VT_DATA, data);
   }
+  void add_encoding(chartbox::io::flatbuffer::TileEncoding encoding) {
+    fbb_.AddElement<uint8_t>(TileCache::VT_ENCODING, static_cast<uint8_t>(encoding), 0);
+  }
+  void add_value(uint8_t value) {
+    fbb_.AddElement<uint8_t>(TileCache::VT_VALUE, value, 0);
+  }
+  void add_pyramid(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> pyramid) {
+    fbb_.AddOffset(TileCache::VT_PYRAMID, pyramid);
+  }
+  void add_pyramid_encoding(chartbox::io::flatbuffer::TileEncoding pyramid_encoding) {
+    fbb_.AddElement<uint8_t>(TileCache::VT_PYRAMID_ENCODING, static_cast<uint8_t>(pyramid_encoding), 0);
+  }
   explicit TileCacheBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -98,12 +164,20 @@ inline flatbuffers::Offset<TileCache> CreateTileCache(
     const Location *origin = 0,
     float precision = 0.0f,
     uint32_t dimension = 0,
-    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data = 0) {
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data = 0,
+    chartbox::io::flatbuffer::TileEncoding encoding = chartbox::io::flatbuffer::TileEncoding_Raw,
+    uint8_t value = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> pyramid = 0,
+    chartbox::io::flatbuffer::TileEncoding pyramid_encoding = chartbox::io::flatbuffer::TileEncoding_Raw) {
   TileCacheBuilder builder_(_fbb);
+  builder_.add_pyramid(pyramid);
   builder_.add_data(data);
   builder_.add_dimension(dimension);
   builder_.add_precision(precision);
   builder_.add_origin(origin);
+  builder_.add_pyramid_encoding(pyramid_encoding);
+  builder_.add_value(value);
+  builder_.add_encoding(encoding);
   return builder_.Finish();
 }
 
@@ -112,14 +186,23 @@ inline flatbuffers::Offset<TileCache> CreateTileCacheDirect(
     const Location *origin = 0,
     float precision = 0.0f,
     uint32_t dimension = 0,
-    const std::vector<uint8_t> *data = nullptr) {
+    const std::vector<uint8_t> *data = nullptr,
+    chartbox::io::flatbuffer::TileEncoding encoding = chartbox::io::flatbuffer::TileEncoding_Raw,
+    uint8_t value = 0,
+    const std::vector<uint8_t> *pyramid = nullptr,
+    chartbox::io::flatbuffer::TileEncoding pyramid_encoding = chartbox::io::flatbuffer::TileEncoding_Raw) {
   auto data__ = data ? _fbb.CreateVector<uint8_t>(*data) : 0;
+  auto pyramid__ = pyramid ? _fbb.CreateVector<uint8_t>(*pyramid) : 0;
   return chartbox::io::flatbuffer::CreateTileCache(
       _fbb,
       origin,
       precision,
       dimension,
-      data__);
+      data__,
+      encoding,
+      value,
+      pyramid__,
+      pyramid_encoding);
 }
 
 inline const chartbox::io::flatbuffer::TileCache *GetTileCache(const void *buf) {
@@ -0,0 +1,92 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "geometry/local-location.hpp"
+
+namespace chartbox::layer {
+
+/// \brief number of points translated by each step of a batch query
+constexpr uint32_t batch_width = 4;
+
+#if defined(__AVX2__)
+// Building blocks for the batch-query kernels of each grid layer.
+//
+// Each of these operates on `batch_width` points at once:
+//   - coordinates are held as 4 doubles: one lane per point
+//   - indices are held as 4 int32: one lane per point
+//   - lane masks are held as 4 bits: bit `i` corresponds to point `i`
+
+/// \brief load 4 consecutive locations, relative to the given origin
+///
+/// \param points - pointer to (at least) 4 consecutive locations
+/// \param origin - subtract this location from each point
+/// \param easting - [out] relative eastings
+/// \param northing - [out] relative northings
+inline void load_x4( const geometry::LocalLocation* points, const geometry::LocalLocation& origin, __m256d& easting, __m256d& northing ){
+    static_assert( sizeof(geometry::LocalLocation) == 2*sizeof(double) );
+    const double* raw = reinterpret_cast<const double*>(points);
+
+    // { e0, n0, e1, n1 } + { e2, n2, e3, n3 }  ==>  { e0, e1, e2, e3 } + { n0, n1, n2, n3 }
+    const __m256d first = _mm256_loadu_pd( raw );
+    const __m256d second = _mm256_loadu_pd( raw + 4 );
+    const __m256d low = _mm256_permute2f128_pd( first, second, 0x20 );   // e0, n0, e2, n2
+    const __m256d high = _mm256_permute2f128_pd( first, second, 0x31 );  // e1, n1, e3, n3
+    easting = _mm256_sub_pd( _mm256_unpacklo_pd(low, high), _mm256_set1_pd(origin.easting) );
+    northing = _mm256_sub_pd( _mm256_unpackhi_pd(low, high), _mm256_set1_pd(origin.northing) );
+}
+
+/// \brief test if each (relative) point lies within [0, width] x [0, height]
+///
+/// \note this matches `BoundBox::contains` -- both the min- and max-borders are inclusive. NaN is outside.
+inline int within_x4( __m256d easting, __m256d northing, double width, double height ){
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d inside = _mm256_and_pd(
+                                _mm256_and_pd( _mm256_cmp_pd(easting, zero, _CMP_GE_OQ),
+                                               _mm256_cmp_pd(easting, _mm256_set1_pd(width), _CMP_LE_OQ) ),
+                                _mm256_and_pd( _mm256_cmp_pd(northing, zero, _CMP_GE_OQ),
+                                               _mm256_cmp_pd(northing, _mm256_set1_pd(height), _CMP_LE_OQ) ));
+    return _mm256_movemask_pd( inside );
+}
+
+/// \brief calculate floor( value / divisor ) for non-negative values
+///
+/// Multiplies by the reciprocal, and then corrects the quotient by one step, if necessary.  The result is
+/// exactly equal to the (scalar) division, even when the divisor is not a power of two.
+///
+/// \param value - dividend, one per lane.  Expected to be non-negative.
+/// \param divisor - common divisor for every lane
+/// \param inverse - == 1/divisor
+inline __m128i floor_divide_x4( __m256d value, double divisor, double inverse ){
+    const __m256d divisor_x4 = _mm256_set1_pd( divisor );
+    const __m256d one = _mm256_set1_pd( 1.0 );
+
+    __m256d quotient = _mm256_floor_pd( _mm256_mul_pd(value, _mm256_set1_pd(inverse)) );
+
+    // undershoot:  (q+1) * divisor <= value   ==>  q += 1
+    const __m256d under = _mm256_cmp_pd( _mm256_mul_pd(_mm256_add_pd(quotient, one), divisor_x4), value, _CMP_LE_OQ );
+    quotient = _mm256_add_pd( quotient, _mm256_and_pd(under, one) );
+
+    // overshoot:  q * divisor > value   ==>  q -= 1
+    const __m256d over = _mm256_cmp_pd( _mm256_mul_pd(quotient, divisor_x4), value, _CMP_GT_OQ );
+    quotient = _mm256_sub_pd( quotient, _mm256_and_pd(over, one) );
+
+    return _mm256_cvttpd_epi32( quotient );
+}
+
+/// \brief wrap each index back into [0, count) -- for indices in [0, 2*count)
+inline __m128i wrap_x4( __m128i index, uint32_t count ){
+    const __m128i count_x4 = _mm_set1_epi32( static_cast<int32_t>(count) );
+    const __m128i overflow = _mm_cmpgt_epi32( index, _mm_set1_epi32(static_cast<int32_t>(count) - 1) );
+    return _mm_sub_epi32( index, _mm_and_si128(overflow, count_x4) );
+}
+
+#endif // defined(__AVX2__)
+
+} // namespace
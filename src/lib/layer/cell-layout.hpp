@@ -0,0 +1,132 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "layer/grid-index.hpp"
+
+namespace chartbox::layer {
+
+// Cell-layout policies: each maps a cell's (column, row) within a square block of `across` cells onto an offset
+// into the block's storage -- and back.
+//
+// Every policy provides:
+//   - `name`                               -- for reports
+//   - `supports( across )`                 -- true if the policy can lay out a block of this size
+//   - `row_contiguous`                     -- true if each row occupies a single run of storage
+//   - `offset( column, row, across )`      -- storage offset of a cell
+//   - `index( offset, across )`            -- inverse of `offset`
+//   - `next_column( offset, across )`      -- storage offset of the next cell east, in the same row
+//   - `offset_x4( column, row, across )`   -- `offset`, for 4 lanes at once  (AVX2 only)
+
+/// \brief Row-major: each row is contiguous, and rows are stacked south-to-north.  (the default)
+struct RowMajorLayout {
+    constexpr static char name[] = "row-major";
+
+    constexpr static bool row_contiguous = true;
+
+    constexpr static bool supports( uint32_t /*across*/ ){ return true; }
+
+    constexpr static uint32_t offset( uint32_t column, uint32_t row, uint32_t across ){
+        return column + row * across; }
+
+    constexpr static GridIndex index( uint32_t offset, uint32_t across ){
+        return { offset % across, offset / across }; }
+
+    constexpr static uint32_t next_column( uint32_t offset, uint32_t /*across*/ ){
+        return offset + 1; }
+
+#if defined(__AVX2__)
+    static __m128i offset_x4( __m128i column, __m128i row, uint32_t across ){
+        return _mm_add_epi32( column, _mm_mullo_epi32(row, _mm_set1_epi32(static_cast<int32_t>(across))) ); }
+#endif
+};
+
+/// \brief Morton / Z-order: the bits of the column and row are interleaved -- column in the even bits, row in the odd
+///
+/// Every aligned 2^k x 2^k block of cells is contiguous, so a cell's neighbours are usually close by in memory; and
+/// the 2x2 children of any block are consecutive.  Requires a power-of-two block.  Uses the BMI2 `pdep` / `pext`
+/// instructions, where available.
+///
+/// Sources / Inspiration / Further Reading
+/// 1. "Morton Encoding/Decoding Through BMI2 / LUT", Jeroen Baert, 2013
+///     - https://www.forceflow.be/2013/10/07/morton-encodingdecoding-through-bit-interleaving-implementations/
+struct MortonLayout {
+    constexpr static char name[] = "morton";
+
+    constexpr static bool row_contiguous = false;
+
+    constexpr static uint32_t column_mask = 0x55555555;
+    constexpr static uint32_t row_mask = 0xAAAAAAAA;
+
+    constexpr static bool supports( uint32_t across ){
+        return std::has_single_bit( across ) && (across <= (1u << 16)); }
+
+    constexpr static uint32_t offset( uint32_t column, uint32_t row, uint32_t /*across*/ ){
+#if defined(__BMI2__)
+        if( not std::is_constant_evaluated() ){
+            return _pdep_u32( column, column_mask ) | _pdep_u32( row, row_mask );
+        }
+#endif
+        return spread( column ) | (spread( row ) << 1);
+    }
+
+    constexpr static GridIndex index( uint32_t offset, uint32_t /*across*/ ){
+#if defined(__BMI2__)
+        if( not std::is_constant_evaluated() ){
+            return { _pext_u32( offset, column_mask ), _pext_u32( offset, row_mask ) };
+        }
+#endif
+        return { compact( offset ), compact( offset >> 1 ) };
+    }
+
+    constexpr static uint32_t next_column( uint32_t offset, uint32_t /*across*/ ){
+        // increment only the column bits: the carry ripples through the (filled) row bits
+        return (((offset | row_mask) + 1) & column_mask) | (offset & row_mask); }
+
+#if defined(__AVX2__)
+    static __m128i offset_x4( __m128i column, __m128i row, uint32_t /*across*/ ){
+        return _mm_or_si128( spread_x4(column), _mm_slli_epi32(spread_x4(row), 1) ); }
+#endif
+
+private:
+    /// \brief move bit `i` of the (16-bit) input to bit `2i`
+    constexpr static uint32_t spread( uint32_t bits ){
+        bits &= 0x0000FFFF;
+        bits = (bits | (bits << 8)) & 0x00FF00FF;
+        bits = (bits | (bits << 4)) & 0x0F0F0F0F;
+        bits = (bits | (bits << 2)) & 0x33333333;
+        bits = (bits | (bits << 1)) & 0x55555555;
+        return bits;
+    }
+
+    /// \brief inverse of `spread`: move bit `2i` to bit `i`
+    constexpr static uint32_t compact( uint32_t bits ){
+        bits &= 0x55555555;
+        bits = (bits | (bits >> 1)) & 0x33333333;
+        bits = (bits | (bits >> 2)) & 0x0F0F0F0F;
+        bits = (bits | (bits >> 4)) & 0x00FF00FF;
+        bits = (bits | (bits >> 8)) & 0x0000FFFF;
+        return bits;
+    }
+
+#if defined(__AVX2__)
+    static __m128i spread_x4( __m128i bits ){
+        bits = _mm_and_si128( bits, _mm_set1_epi32(0x0000FFFF) );
+        bits = _mm_and_si128( _mm_or_si128(bits, _mm_slli_epi32(bits, 8)), _mm_set1_epi32(0x00FF00FF) );
+        bits = _mm_and_si128( _mm_or_si128(bits, _mm_slli_epi32(bits, 4)), _mm_set1_epi32(0x0F0F0F0F) );
+        bits = _mm_and_si128( _mm_or_si128(bits, _mm_slli_epi32(bits, 2)), _mm_set1_epi32(0x33333333) );
+        bits = _mm_and_si128( _mm_or_si128(bits, _mm_slli_epi32(bits, 1)), _mm_set1_epi32(0x55555555) );
+        return bits;
+    }
+#endif
+};
+
+} // namespace
@@ -0,0 +1,69 @@
+// GPL v3 (c) 2021, Daniel Williams 
+
+#include <cstdint>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "cell-layout.hpp"
+
+using chartbox::layer::GridIndex;
+using chartbox::layer::MortonLayout;
+using chartbox::layer::RowMajorLayout;
+
+// ============ ============  Cell-Layout-Tests  ============ ============
+TEST_CASE( "RowMajorLayout offsets each row contiguously" ){
+    CHECK(  0 == RowMajorLayout::offset( 0, 0, 4 ));
+    CHECK(  3 == RowMajorLayout::offset( 3, 0, 4 ));
+    CHECK(  4 == RowMajorLayout::offset( 0, 1, 4 ));
+    CHECK( 15 == RowMajorLayout::offset( 3, 3, 4 ));
+    CHECK( GridIndex(2, 1) == RowMajorLayout::index( 6, 4 ));
+    CHECK( 7 == RowMajorLayout::next_column( 6, 4 ));
+    CHECK( RowMajorLayout::supports( 5 ));
+} // TEST_CASE
+
+TEST_CASE( "MortonLayout interleaves column + row bits" ){
+    CHECK( MortonLayout::supports( 1024 ));
+    CHECK( not MortonLayout::supports( 1000 ));
+
+    // the z-curve, across a 4x4 block:
+    CHECK(  0 == MortonLayout::offset( 0, 0, 4 ));
+    CHECK(  1 == MortonLayout::offset( 1, 0, 4 ));
+    CHECK(  2 == MortonLayout::offset( 0, 1, 4 ));
+    CHECK(  3 == MortonLayout::offset( 1, 1, 4 ));
+    CHECK(  4 == MortonLayout::offset( 2, 0, 4 ));
+    CHECK(  8 == MortonLayout::offset( 0, 2, 4 ));
+    CHECK( 15 == MortonLayout::offset( 3, 3, 4 ));
+
+    // compile-time (portable) and run-time (pdep / pext) paths agree:
+    static_assert( 0x2AAAAAAA == MortonLayout::offset( 0, 0x7FFF, 1 << 15 ));
+    static_assert( GridIndex(0x1234, 0x0ABC) == MortonLayout::index( MortonLayout::offset(0x1234, 0x0ABC, 1 << 13), 1 << 13 ));
+
+    constexpr uint32_t across = 1024;
+    for( uint32_t row = 0; row < across; row += 31 ){
+        uint32_t offset = MortonLayout::offset( 0, row, across );
+        for( uint32_t column = 0; column < across; ++column ){
+            REQUIRE( offset == MortonLayout::offset( column, row, across ));
+            REQUIRE( GridIndex(column, row) == MortonLayout::index( offset, across ));
+            REQUIRE( offset < (across * across) );
+            offset = MortonLayout::next_column( offset, across );
+        }
+    }
+} // TEST_CASE
+
+#if defined(__AVX2__)
+TEST_CASE( "Cell layouts calculate 4 offsets at once" ){
+    const __m128i column = _mm_setr_epi32( 0, 5, 1023, 77 );
+    const __m128i row = _mm_setr_epi32( 0, 9, 1023, 512 );
+    alignas(16) uint32_t row_major[4];
+    alignas(16) uint32_t morton[4];
+    _mm_store_si128( reinterpret_cast<__m128i*>(row_major), RowMajorLayout::offset_x4( column, row, 1024 ));
+    _mm_store_si128( reinterpret_cast<__m128i*>(morton), MortonLayout::offset_x4( column, row, 1024 ));
+
+    const uint32_t columns[] = { 0, 5, 1023, 77 };
+    const uint32_t rows[] = { 0, 9, 1023, 512 };
+    for( int lane = 0; lane < 4; ++lane ){
+        CHECK( RowMajorLayout::offset( columns[lane], rows[lane], 1024 ) == row_major[lane] );
+        CHECK( MortonLayout::offset( columns[lane], rows[lane], 1024 ) == morton[lane] );
+    }
+} // TEST_CASE
+#endif
@@ -0,0 +1,226 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "layer/layer-interface.hpp"
+
+namespace chartbox::layer::composite {
+
+/// \brief a materialized view of several other layers: one byte per cell, in a single buffer
+///
+/// This layer does not know its sources: its owner writes each cell's combined value, and refreshes whichever cells
+/// its sources change.  (see: `ChartBox::enable_composite`)
+///
+/// Rows and columns of the buffer wrap around, from an offset: moving the view (`relocate`) only updates the offsets,
+/// and resets the cells which enter the view.  A lookup is a single read from the buffer.
+///
+/// The buffer is stored as square tiles of `tile_across` cells (one 4 KiB page each), so that a query which follows
+/// a path stays within a few pages, whichever way the path runs.
+///
+/// A coarse summary holds an upper bound on each block of `summary_across` cells (in the buffer); `raycast` skips
+/// the blocks which cannot block a line.  Every write raises the summary; `summarize` tightens it again.
+///
+/// \param dimension_ cell count across each dimension of the layer; a multiple of `tile_across`
+template<uint32_t dimension_>
+class CompositeLayer final : public LayerInterface<CompositeLayer<dimension_>> {
+public:
+
+    /// \brief number of cells along each dimension of the layer
+    constexpr static uint32_t dimension = dimension_;
+
+    /// \brief number of cells along each dimension of a tile
+    constexpr static uint32_t tile_across = 64;
+    constexpr static uint32_t tiles_across = dimension / tile_across;
+    static_assert( 0 == (dimension % tile_across), "the layer must be a whole number of tiles across" );
+
+    /// \brief number of cells along each dimension of a summary block
+    constexpr static uint32_t summary_across = 8;
+    constexpr static uint32_t blocks_across = dimension / summary_across;
+    static_assert( 0 == (tile_across % summary_across), "each tile must be a whole number of summary blocks across" );
+
+    /// \brief name of this layer's type
+    constexpr static char type_name_[] = "CompositeLayer";
+
+public:
+    /// \brief Constructs a new grid, with its south-west corner at 0,0
+    ///
+    /// \param meters_across_cell - width of each cell
+    CompositeLayer( double meters_across_cell = 1.0 );
+
+    ~CompositeLayer() = default;
+
+    /// \brief value of the cell at (column, row) of the view; both must be less than `dimension`
+    inline uint8_t cell( uint32_t column, uint32_t row ) const {
+        return cells_[ offset(column, row) ]; }
+
+    constexpr static uint32_t cells_across_view() { return dimension; }
+
+    bool contains(const geometry::LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+    bool fill( uint8_t value );
+
+    bool fill( const Path<LocalLocation>& path, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+        return super().fill( path, bounds, value); }
+
+    bool fill( const BoundBox<LocalLocation>& box, const uint8_t value ){
+        return super().fill( box, value ); }
+
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
+        return super().fill( poly, bound, value ); }
+
+    inline uint8_t get( const geometry::LocalLocation& p ) const {
+        if( visible(p) ){
+            const LocalLocation relative = p - view_bounds_.min;
+            return cells_[ offset( to_cell(relative.easting), to_cell(relative.northing) ) ];
+        }
+        return default_cell_value;
+    }
+
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const;
+
+    /// \brief bytes held by the cells, and their summary
+    inline size_t memory_usage() const {
+        return cells_.size() + summary_.size(); }
+
+    inline double meters_across_cell() const { return meters_across_cell_; }
+
+    /// \brief find where each line from the origin first meets a blocking cell.  (see: `LayerInterface::raycast`)
+    ///
+    /// Each line first walks the summary blocks; it only walks the cells of those blocks whose bound reaches the
+    /// threshold.
+    bool raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const;
+
+    double precision() const {
+        return meters_across_cell_; }
+
+    /// \brief move the view to a new origin, keeping the contents of every cell which stays in view
+    ///
+    /// The origin is rounded to the nearest whole cell from the current view.  Cells which enter the view are reset
+    /// to `default_cell_value`; their owner must refresh them.
+    ///
+    /// \param new_origin - the south-west corner of the new view
+    bool relocate( const LocalLocation& new_origin );
+
+    inline void reset(){
+        fill( default_cell_value ); }
+
+    /// \brief store a value at point `p`
+    ///
+    /// \return false if `p` is outside the view
+    bool store( const geometry::LocalLocation& p, uint8_t value );
+
+    /// \brief store a run of (distinct) values along a row
+    ///
+    /// \param row - row index of the run; relative to the view
+    /// \param first_column - column index of the first (west-most) value.  Values past the east edge are clipped
+    /// \param values - values to store, from west to east
+    /// \return true if any cells were written; else false
+    bool store_row( uint32_t row, uint32_t first_column, std::span<const uint8_t> values );
+
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value );
+
+    /// \brief an upper bound on every cell of the summary block which holds the cell at (column, row) of the view
+    inline uint8_t summary( uint32_t column, uint32_t row ) const {
+        return summary_[ block_offset( wrap( column + column_offset_ ), wrap( row + row_offset_ ) ) ]; }
+
+    /// \brief tighten the summary of every block which holds a cell of the given area, to its exact maximum
+    ///
+    /// Writes only raise the summary; call this after writing an area, so that `raycast` can skip what was cleared.
+    ///
+    /// \param first_column, first_row - south-west cell of the area; relative to the view
+    /// \param last_column, last_row - north-east cell of the area (inclusive); clipped to the view
+    /// \return false if the area is empty, or outside the view
+    bool summarize( uint32_t first_column, uint32_t first_row, uint32_t last_column, uint32_t last_row );
+
+    std::string to_cell_content_string( uint32_t indent = 0 ) const;
+    std::string to_location_content_string( uint32_t indent = 0 ) const { return super().to_location_content_string(indent); }
+    std::string to_property_string( uint32_t indent = 0 ) const;
+
+    /// \brief this layer only moves by `relocate`
+    bool track( const BoundBox<LocalLocation>& /*bounds*/ ){
+        return false; }
+    const BoundBox<LocalLocation>& tracked() const {
+        return visible(); }
+    bool tracked(const LocalLocation& p) const {
+        return visible(p); }
+
+    /// \brief move the view to the given bounds.  (see: `relocate`)
+    bool view( const BoundBox<LocalLocation>& box ){
+        return relocate( box.min ); }
+    const BoundBox<LocalLocation>& visible() const {
+        return view_bounds_; }
+    bool visible(const LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+private:
+    /// \brief offset into the buffer of the cell at (column, row) of the view
+    inline size_t offset( uint32_t column, uint32_t row ) const {
+        return buffer_offset( wrap( column + column_offset_ ), wrap( row + row_offset_ ) ); }
+
+    /// \brief offset into the buffer of the cell at (column, row) of the buffer
+    constexpr static size_t buffer_offset( uint32_t buffer_column, uint32_t buffer_row ){
+        const size_t tile = static_cast<size_t>(buffer_row / tile_across) * tiles_across + (buffer_column / tile_across);
+        return tile * (tile_across * tile_across) + (buffer_row % tile_across) * tile_across + (buffer_column % tile_across);
+    }
+
+    /// \brief offset into the summary of the block holding a buffer cell
+    constexpr static size_t block_offset( uint32_t buffer_column, uint32_t buffer_row ){
+        return static_cast<size_t>(buffer_row / summary_across) * blocks_across + (buffer_column / summary_across); }
+
+    /// \brief raise the summary over a run of cells which was just written, in a single row of one tile
+    void raise_summary( uint32_t buffer_column, uint32_t buffer_row, uint32_t count );
+
+    /// \brief cell index along one axis.  (points on the max-border are clamped inside the view)
+    inline uint32_t to_cell( double meters ) const {
+        return std::min( static_cast<uint32_t>( meters / meters_across_cell_ ), dimension - 1 ); }
+
+    /// \brief wrap an index in [0, 2*dimension) around the buffer
+    constexpr static uint32_t wrap( uint32_t index ){
+        return (index < dimension) ? index : (index - dimension); }
+
+private:
+    double meters_across_cell_;
+
+    // this tracks the bounds of the visible grid
+    geometry::BoundBox<LocalLocation> view_bounds_;
+
+    // the buffer's column (and row) of the view's south-west cell
+    uint32_t column_offset_;
+    uint32_t row_offset_;
+
+    std::vector<uint8_t> cells_;
+
+    // an upper bound on each block of the buffer.  (row-major, by buffer position)
+    std::vector<uint8_t> summary_;
+
+private:
+    LayerInterface<CompositeLayer<dimension_>>& super() {
+        return *static_cast< LayerInterface<CompositeLayer<dimension_>>* >(this);
+    }
+
+    const LayerInterface<CompositeLayer<dimension_>>& super() const {
+        return *static_cast< const LayerInterface<CompositeLayer<dimension_>>* >(this);
+    }
+};
+
+#include "composite-layer.inl"
+
+} // namespace chartbox::layer::composite
@@ -0,0 +1,215 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+template<uint32_t d>
+CompositeLayer<d>::CompositeLayer( double meters_across_cell )
+    : meters_across_cell_( meters_across_cell )
+    , view_bounds_( {0,0}, LocalLocation(meters_across_cell * dimension) )
+    , column_offset_( 0 )
+    , row_offset_( 0 )
+    , cells_( static_cast<size_t>(dimension) * dimension, default_cell_value )
+    , summary_( static_cast<size_t>(blocks_across) * blocks_across, default_cell_value )
+{}
+
+template<uint32_t d>
+bool CompositeLayer<d>::fill( uint8_t value ){
+    std::memset( cells_.data(), value, cells_.size() );
+    std::memset( summary_.data(), value, summary_.size() );
+    return true;
+}
+
+template<uint32_t d>
+bool CompositeLayer<d>::get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+    if( values.size() < points.size() ){
+        return false;
+    }
+
+    for( size_t point_index = 0; point_index < points.size(); ++point_index ){
+        values[point_index] = get( points[point_index] );
+    }
+    return true;
+}
+
+template<uint32_t d>
+void CompositeLayer<d>::raise_summary( uint32_t buffer_column, uint32_t buffer_row, uint32_t count ){
+    const uint8_t* run = cells_.data() + buffer_offset( buffer_column, buffer_row );
+    for( uint32_t index = 0; index < count; ){
+        const uint32_t block_count = std::min( count - index, summary_across - ((buffer_column + index) % summary_across) );
+        uint8_t& bound = summary_[ block_offset( buffer_column + index, buffer_row ) ];
+        bound = std::max( bound, *std::max_element( run + index, run + index + block_count ) );
+        index += block_count;
+    }
+}
+
+template<uint32_t d>
+bool CompositeLayer<d>::raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const {
+    if( distances.size() < targets.size() ){
+        return false;
+    }
+
+    // the blocks are aligned to the buffer, not the view: so the grid of blocks starts a few cells south-west of the
+    // view, and each line is shifted onto it
+    const uint32_t shift_columns = column_offset_ % summary_across;
+    const uint32_t shift_rows = row_offset_ % summary_across;
+    const auto block_bound = [&]( int64_t block_column, int64_t block_row ){
+        return summary_[ block_offset( wrap( static_cast<uint32_t>(block_column) * summary_across + (column_offset_ - shift_columns) ),
+                                       wrap( static_cast<uint32_t>(block_row) * summary_across + (row_offset_ - shift_rows) ) ) ]; };
+    const auto cell_value = [&]( int64_t column, int64_t row ){
+        return cell( static_cast<uint32_t>(column) - shift_columns, static_cast<uint32_t>(row) - shift_rows ); };
+
+    for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+        RayClip clip;
+        if( clip_ray( view_bounds_.min, meters_across_cell_, dimension, dimension, origin, targets[target_index], clip ) ){
+            clip.start_x += shift_columns;
+            clip.end_x += shift_columns;
+            clip.start_y += shift_rows;
+            clip.end_y += shift_rows;
+            distances[target_index] = trace_blocks( clip, threshold, summary_across, block_bound, cell_value );
+        }else{
+            distances[target_index] = raycast_clear;
+        }
+    }
+    return true;
+}
+
+template<uint32_t d>
+bool CompositeLayer<d>::relocate( const LocalLocation& new_origin ){
+    const int64_t shift_columns = std::llround( (new_origin.easting - view_bounds_.min.easting) / meters_across_cell_ );
+    const int64_t shift_rows = std::llround( (new_origin.northing - view_bounds_.min.northing) / meters_across_cell_ );
+    view_bounds_ = view_bounds_.move( LocalLocation( shift_columns, shift_rows ) * meters_across_cell_ );
+
+    const uint32_t entering_columns = static_cast<uint32_t>( std::min<int64_t>( std::abs(shift_columns), dimension ) );
+    const uint32_t entering_rows = static_cast<uint32_t>( std::min<int64_t>( std::abs(shift_rows), dimension ) );
+    if( (dimension == entering_columns) || (dimension == entering_rows) ){
+        column_offset_ = 0;
+        row_offset_ = 0;
+        return fill( default_cell_value );
+    }
+
+    constexpr int64_t across = dimension;
+    column_offset_ = static_cast<uint32_t>( (((column_offset_ + shift_columns) % across) + across) % across );
+    row_offset_ = static_cast<uint32_t>( (((row_offset_ + shift_rows) % across) + across) % across );
+
+    // reset the cells which enter the view:  (at the east / west edge, and then the north / south edge)
+    if( 0 < entering_columns ){
+        const uint32_t first_column = (0 < shift_columns) ? (dimension - entering_columns) : 0;
+        for( uint32_t row = 0; row < dimension; ++row ){
+            store_span( row, first_column, first_column + entering_columns - 1, default_cell_value );
+        }
+        summarize( first_column, 0, first_column + entering_columns - 1, dimension - 1 );
+    }
+    if( 0 < entering_rows ){
+        const uint32_t first_row = (0 < shift_rows) ? (dimension - entering_rows) : 0;
+        for( uint32_t row = first_row; row < (first_row + entering_rows); ++row ){
+            store_span( row, 0, dimension - 1, default_cell_value );
+        }
+        summarize( 0, first_row, dimension - 1, first_row + entering_rows - 1 );
+    }
+    return true;
+}
+
+template<uint32_t d>
+bool CompositeLayer<d>::store( const LocalLocation& p, uint8_t value ){
+    if( visible(p) ){
+        const LocalLocation relative = p - view_bounds_.min;
+        const uint32_t buffer_column = wrap( to_cell(relative.easting) + column_offset_ );
+        const uint32_t buffer_row = wrap( to_cell(relative.northing) + row_offset_ );
+        cells_[ buffer_offset( buffer_column, buffer_row ) ] = value;
+        uint8_t& bound = summary_[ block_offset( buffer_column, buffer_row ) ];
+        bound = std::max( bound, value );
+        return true;
+    }
+    return false;
+}
+
+template<uint32_t d>
+bool CompositeLayer<d>::store_row( uint32_t row, uint32_t first_column, std::span<const uint8_t> values ){
+    if( (dimension <= row) || (dimension <= first_column) || values.empty() ){
+        return false;
+    }
+
+    // copy one tile's run at a time:  (the last run may wrap around the end of the buffer's row)
+    const uint32_t last_column = static_cast<uint32_t>( std::min<size_t>( first_column + values.size(), dimension ) );
+    for( uint32_t column = first_column; column < last_column; ){
+        const uint32_t tile_column = wrap( column + column_offset_ ) % tile_across;
+        const uint32_t count = std::min( last_column - column, tile_across - tile_column );
+        std::memcpy( cells_.data() + offset(column, row), values.data() + (column - first_column), count );
+        raise_summary( wrap( column + column_offset_ ), wrap( row + row_offset_ ), count );
+        column += count;
+    }
+    return true;
+}
+
+template<uint32_t d>
+bool CompositeLayer<d>::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+    if( (dimension <= row) || (dimension <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min<uint32_t>( last_column, dimension - 1 );
+
+    // fill one tile's run at a time:  (the last run may wrap around the end of the buffer's row)
+    for( uint32_t column = first_column; column <= last_column; ){
+        const uint32_t tile_column = wrap( column + column_offset_ ) % tile_across;
+        const uint32_t count = std::min( last_column - column + 1, tile_across - tile_column );
+        std::memset( cells_.data() + offset(column, row), value, count );
+        raise_summary( wrap( column + column_offset_ ), wrap( row + row_offset_ ), count );
+        column += count;
+    }
+    return true;
+}
+
+template<uint32_t d>
+bool CompositeLayer<d>::summarize( uint32_t first_column, uint32_t first_row, uint32_t last_column, uint32_t last_row ){
+    if( (dimension <= first_column) || (dimension <= first_row) || (last_column < first_column) || (last_row < first_row) ){
+        return false;
+    }
+    last_column = std::min<uint32_t>( last_column, dimension - 1 );
+    last_row = std::min<uint32_t>( last_row, dimension - 1 );
+
+    // step from block to block: (each block lies within a single tile)
+    for( uint32_t row = first_row; row <= last_row; ){
+        const uint32_t buffer_row = wrap( row + row_offset_ );
+        const uint32_t block_row = buffer_row - (buffer_row % summary_across);
+        for( uint32_t column = first_column; column <= last_column; ){
+            const uint32_t buffer_column = wrap( column + column_offset_ );
+            const uint32_t block_column = buffer_column - (buffer_column % summary_across);
+            const uint8_t* block = cells_.data() + buffer_offset( block_column, block_row );
+            uint8_t bound = 0;
+            for( uint32_t line = 0; line < summary_across; ++line ){
+                bound = std::max( bound, *std::max_element( block + line * tile_across, block + line * tile_across + summary_across ) );
+            }
+            summary_[ block_offset( block_column, block_row ) ] = bound;
+            column += summary_across - (buffer_column % summary_across);
+        }
+        row += summary_across - (buffer_row % summary_across);
+    }
+    return true;
+}
+
+template<uint32_t d>
+std::string CompositeLayer<d>::to_cell_content_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= ======= Print Contents By Cell: ======= ======= =======\n";
+    for (uint32_t cell_row_index = dimension - 1; cell_row_index < dimension; --cell_row_index) {
+        buf << prefix << "    ";
+        for (uint32_t cell_column_index = 0; cell_column_index < dimension; ++cell_column_index ) {
+            buf << fmt::format(" {:2X}", cell(cell_column_index, cell_row_index) );
+        }
+        buf << '\n';
+    }
+    buf << prefix << "======== ======= ======= ======= ======= ======= ======= =======\n";
+    return buf.str();
+}
+
+template<uint32_t d>
+std::string CompositeLayer<d>::to_property_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= Properties: ======= =======\n";
+    buf << fmt::format( "{}    ::bounds-min:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.min.easting, view_bounds_.min.northing );
+    buf << fmt::format( "{}    ::bounds-max:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.max.easting, view_bounds_.max.northing );
+    buf << fmt::format( "{}    ::cells-across-view:      {:6d}\n", prefix, dimension );
+    buf << fmt::format( "{}    ::meters-across-cell:     {:6.1f}\n", prefix, meters_across_cell_ );
+    buf << fmt::format( "{}    ::offset:                 {:6d}, {:6d}\n", prefix, column_offset_, row_offset_ );
+    return buf.str();
+}
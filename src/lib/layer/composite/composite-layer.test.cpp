@@ -0,0 +1,191 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "composite-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+using chartbox::layer::composite::CompositeLayer;
+
+namespace chartbox::layer {
+
+// a distinct value for each cell of the plane; keyed by its south-west corner, in whole meters
+static uint8_t pattern( const LocalLocation& corner ){
+    const int64_t easting = std::llround( corner.easting );
+    const int64_t northing = std::llround( corner.northing );
+    return static_cast<uint8_t>( 1 + ((easting*7 + northing*13) & 0x3F) );
+}
+
+// ============ ============ CompositeLayer Tests  ============ ============
+
+TEST_CASE( "CompositeLayer stores single cells and rows" ){
+    CompositeLayer<64> layer;
+    CHECK( layer.memory_usage() == (64 * 64 + 8 * 8) );
+    CHECK( layer.precision() == Approx(1.0) );
+    CHECK( layer.visible().max.easting == Approx(64) );
+
+    CHECK( layer.get({ 0.5, 0.5}) == default_cell_value );
+    REQUIRE( layer.store({ 40.5, 20.5}, 0x42 ) );
+    REQUIRE_FALSE( layer.store({ -1, 20.5}, 0x42 ) );
+    CHECK( layer.get({ 40.5, 20.5}) == 0x42 );
+    CHECK( layer.cell( 40, 20 ) == 0x42 );
+
+    const std::vector<uint8_t> values = { 1, 2, 3, 4, 5, 6 };
+    REQUIRE( layer.store_row( 7, 60, values ) );
+    CHECK( layer.cell( 59, 7 ) == default_cell_value );
+    CHECK( layer.cell( 60, 7 ) == 1 );
+    CHECK( layer.cell( 63, 7 ) == 4 );
+    // ... values past the east edge are clipped:
+    CHECK( layer.cell( 0, 7 ) == default_cell_value );
+    CHECK( layer.cell( 0, 8 ) == default_cell_value );
+
+    REQUIRE_FALSE( layer.store_row( 64, 0, values ) );
+    REQUIRE_FALSE( layer.store_span( 7, 10, 9, 0x42 ) );
+} // TEST_CASE
+
+TEST_CASE( "CompositeLayer keeps cells which stay in view, as it relocates" ){
+    // (a few tiles across)
+    constexpr uint32_t dimension = 192;
+    CompositeLayer<dimension> layer;
+
+    // refresh every default cell, from the pattern:
+    const auto refresh = [&](){
+        size_t refreshed = 0;
+        for( uint32_t row = 0; row < dimension; ++row ){
+            std::vector<uint8_t> values( dimension );
+            for( uint32_t column = 0; column < dimension; ++column ){
+                const LocalLocation corner = layer.visible().min + LocalLocation( column, row );
+                values[column] = layer.cell( column, row );
+                if( default_cell_value == values[column] ){
+                    values[column] = pattern( corner );
+                    ++refreshed;
+                }
+            }
+            layer.store_row( row, 0, values );
+        }
+        return refreshed;
+    };
+    CHECK( refresh() == (dimension * dimension) );
+
+    SECTION( "each move only resets the cells which enter the view" ){
+        REQUIRE( layer.relocate({ 3, -2 }) );
+        CHECK( layer.visible().min.easting == Approx(3) );
+        CHECK( layer.visible().min.northing == Approx(-2) );
+        CHECK( refresh() == (3*dimension + 2*dimension - 3*2) );
+    }
+
+    SECTION( "a move of the whole view resets every cell" ){
+        REQUIRE( layer.relocate({ 1000, 0 }) );
+        CHECK( refresh() == (dimension * dimension) );
+    }
+
+    // ... and after any series of moves, every cell matches the plane:
+    std::mt19937 generator( 55 );
+    std::uniform_int_distribution<int> shift_distribution( -100, 100 );
+    for( uint32_t move = 0; move < 50; ++move ){
+        const LocalLocation origin = layer.visible().min + LocalLocation( shift_distribution(generator), shift_distribution(generator) );
+        REQUIRE( layer.relocate( origin ) );
+        refresh();
+
+        for( uint32_t row = 0; row < dimension; ++row ){
+            for( uint32_t column = 0; column < dimension; ++column ){
+                const LocalLocation corner = layer.visible().min + LocalLocation( column, row );
+                REQUIRE( layer.get( corner + LocalLocation(0.5, 0.5) ) == pattern( corner ) );
+            }
+        }
+    }
+
+    // spans wrap around the buffer, too:
+    REQUIRE( layer.store_span( 5, 0, dimension - 1, 0x42 ) );
+    for( uint32_t column = 0; column < dimension; ++column ){
+        REQUIRE( layer.cell( column, 5 ) == 0x42 );
+    }
+    CHECK( layer.cell( 0, 6 ) != 0x42 );
+} // TEST_CASE
+
+TEST_CASE( "CompositeLayer raycasts skip clear blocks -- and still meet every blocking cell" ){
+    constexpr uint32_t dimension = 192;
+    CompositeLayer<dimension> layer;
+    REQUIRE( layer.fill( clear_cell_value ));
+
+    // writes raise a block's summary; only `summarize` lowers it again:
+    REQUIRE( layer.store({ 40.5, 20.5}, block_cell_value ));
+    CHECK( layer.summary( 47, 23 ) == block_cell_value );
+    CHECK( layer.summary( 48, 23 ) == clear_cell_value );
+    REQUIRE( layer.store_span( 20, 38, 41, 0x11 ));
+    CHECK( layer.summary( 40, 20 ) == block_cell_value );
+    REQUIRE( layer.summarize( 40, 20, 40, 20 ));
+    CHECK( layer.summary( 40, 20 ) == 0x11 );
+    REQUIRE_FALSE( layer.summarize( dimension, 0, dimension, 0 ));
+
+    // a walk of every cell on the line, for reference:
+    const auto walk = [&]( const LocalLocation& origin, const LocalLocation& target ){
+        RayClip clip;
+        if( ! clip_ray( layer.visible().min, layer.meters_across_cell(), dimension, dimension, origin, target, clip ) ){
+            return raycast_clear;
+        }
+        return trace_ray( clip, block_cell_value, [&]( int64_t column, int64_t row ){
+            return layer.cell( static_cast<uint32_t>(column), static_cast<uint32_t>(row) ); });
+    };
+
+    std::mt19937 generator( 73 );
+    std::uniform_int_distribution<int> shift_distribution( -30, 30 );
+    std::uniform_int_distribution<uint32_t> cell_distribution( 0, dimension - 1 );
+    std::uniform_real_distribution<double> coordinate_distribution( -20, dimension + 20 );
+    size_t blocked = 0;
+    size_t clear = 0;
+    for( uint32_t move = 0; move < 20; ++move ){
+        // (the view moves by odd amounts: so the blocks do not line up with the view)
+        const LocalLocation shift( shift_distribution(generator), shift_distribution(generator) );
+        REQUIRE( layer.relocate( layer.visible().min + shift ));
+        for( uint32_t row = 0; row < dimension; ++row ){
+            for( uint32_t column = 0; column < dimension; ++column ){
+                if( default_cell_value == layer.cell( column, row ) ){
+                    layer.store_span( row, column, column, clear_cell_value );
+                }
+            }
+        }
+
+        // scattered obstacles; some of which are cleared again
+        for( uint32_t obstacle = 0; obstacle < 12; ++obstacle ){
+            const uint32_t column = cell_distribution( generator );
+            const uint32_t row = cell_distribution( generator );
+            const std::vector<uint8_t> values( 3, ((obstacle % 3) == 0) ? clear_cell_value : block_cell_value );
+            layer.store_row( row, column, values );
+        }
+        if( 0 == (move % 2) ){
+            layer.summarize( 0, 0, dimension - 1, dimension - 1 );
+        }
+
+        std::vector<LocalLocation> targets;
+        for( uint32_t target = 0; target < 200; ++target ){
+            targets.emplace_back( layer.visible().min + LocalLocation( coordinate_distribution(generator), coordinate_distribution(generator) ) );
+        }
+        const LocalLocation origin = layer.visible().min + LocalLocation( coordinate_distribution(generator), coordinate_distribution(generator) );
+        std::vector<double> distances( targets.size() );
+        REQUIRE( layer.raycast( origin, targets, block_cell_value, distances ));
+        for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+            const double expected = walk( origin, targets[target_index] );
+            if( raycast_clear == expected ){
+                REQUIRE( raycast_clear == distances[target_index] );
+                ++clear;
+            }else{
+                REQUIRE( distances[target_index] == Approx( expected ).margin(1e-6) );
+                ++blocked;
+            }
+        }
+    }
+    CHECK( 0 < blocked );
+    CHECK( 0 < clear );
+} // TEST_CASE
+
+}   // namespace
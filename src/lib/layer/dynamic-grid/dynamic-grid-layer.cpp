@@ -1,7 +1,12 @@
 // GPL v3 (c) 2021, Daniel Williams 
 
+#include <algorithm>
+#include <cstring>
+
 #include <fmt/core.h>
 
+#include "layer/batch-index.hpp"
+
 #include "dynamic-grid-layer.hpp"
 
 using chartbox::geometry::BoundBox;
@@ -16,19 +21,33 @@ DynamicGridLayer::DynamicGridLayer()
     , meters_across_cell_(1.0)
     , meters_across_sector_(meters_across_cell_*cells_across_sector_)
     , meters_across_view_(meters_across_sector_*sectors_across_view_)
-    , sectors_( sectors_across_view_ * sectors_across_view_ )    
+    , cell_shift_(1)
+    , cell_capacity_(0)
+    , power_of_two_(false)
+    , sector_shift_(0)
     , view_bounds_( {0,0}, {meters_across_view_,meters_across_view_} )
 {
-    fill(chartbox::layer::default_cell_value);
+    allocate();
 }
 
-uint32_t DynamicGridLayer::cells_across_sector( uint32_t new_cells_across ){
-    for( auto& each_sector : sectors_){
-        const size_t new_size = new_cells_across*new_cells_across;
-        each_sector.resize( new_size );
-        each_sector.assign( new_size, default_cell_value );
+void DynamicGridLayer::allocate(){
+    power_of_two_ = std::has_single_bit( cells_across_sector_ );
+    sector_shift_ = power_of_two_ ? std::countr_zero( cells_across_sector_ ) : 0;
+
+    const size_t cell_count = sectors_per_view() * cells_per_sector();
+    if( cell_capacity_ < cell_count ){
+        // `aligned_alloc` requires a whole number of aligned blocks
+        const size_t capacity = ((cell_count + cell_alignment - 1) / cell_alignment) * cell_alignment;
+        cells_.reset( static_cast<uint8_t*>(std::aligned_alloc( cell_alignment, capacity )) );
+        cell_capacity_ = capacity;
     }
+
+    fill( chartbox::layer::default_cell_value );
+}
+
+uint32_t DynamicGridLayer::cells_across_sector( uint32_t new_cells_across ){
     cells_across_sector_ = new_cells_across;
+    allocate();
     return cells_across_sector_;
 }
 
@@ -45,44 +64,110 @@ bool DynamicGridLayer::center( const LocalLocation& new_center ) {
 
 
 bool DynamicGridLayer::fill( uint8_t value){
-    for( auto& each_sector : sectors_){
-        each_sector.assign( cells_across_sector_*cells_across_sector_, value );
+    const size_t cell_count = sectors_per_view() * cells_per_sector();
+    if( 0 < cell_count ){
+        std::memset( cells_.get(), value, cell_count );
     }
     return true;
 }
 
-uint8_t DynamicGridLayer::get(const LocalLocation& layer_location ) const {
-    using chartbox::layer::default_cell_value;
+bool DynamicGridLayer::get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+    if( values.size() < points.size() ){
+        return false;
+    }
 
-    if( visible(layer_location) ){
-        const LocalLocation relative_location = layer_location - view_bounds_.min;
+    size_t point_index = 0;
 
+#if defined(__AVX2__)
+    // the scalar path truncates to whole meters before dividing:
+    const double cell_divisor = static_cast<uint32_t>(meters_across_cell_);
+    if( 0 < cell_divisor ){
         // if the point is on the max-border (east OR north) clamp it inside bounds.
-        const LocalLocation view_location( std::fmin(relative_location.easting, view_bounds_.width() - meters_across_cell_/10),
-                                           std::fmin(relative_location.northing, view_bounds_.height() - meters_across_cell_/10) );
+        const __m256d clamp_easting = _mm256_set1_pd( view_bounds_.width() - meters_across_cell_/10 );
+        const __m256d clamp_northing = _mm256_set1_pd( view_bounds_.height() - meters_across_cell_/10 );
+        const __m128i cells_across = _mm_set1_epi32( cells_across_sector_ );
+        const __m128i sectors_across = _mm_set1_epi32( sectors_across_view_ );
+        const __m128i cells_per = _mm_set1_epi32( cells_per_sector() );
+
+        alignas(16) std::array<uint32_t,batch_width> cell_offsets;
+
+        for( ; (point_index + batch_width) <= points.size(); point_index += batch_width ){
+            __m256d easting, northing;
+            load_x4( &points[point_index], view_bounds_.min, easting, northing );
+            const int visible_lanes = within_x4( easting, northing, view_bounds_.width(), view_bounds_.height() );
+            if( 0 == visible_lanes ){
+                std::fill_n( &values[point_index], batch_width, default_cell_value );
+                continue;
+            }
 
-        const GridIndex view_index = GridIndex( view_location.easting, view_location.northing).div(meters_across_cell_);
+            const __m128i column = floor_divide_x4( _mm256_min_pd(easting, clamp_easting), cell_divisor, 1.0/cell_divisor );
+            const __m128i row = floor_divide_x4( _mm256_min_pd(northing, clamp_northing), cell_divisor, 1.0/cell_divisor );
+
+            /// index of the sector to lookup in
+            const __m128i sector_column = floor_divide_x4( _mm256_cvtepi32_pd(column), cells_across_sector_, 1.0/cells_across_sector_ );
+            const __m128i sector_row = floor_divide_x4( _mm256_cvtepi32_pd(row), cells_across_sector_, 1.0/cells_across_sector_ );
+            const __m128i sector_offset = _mm_add_epi32( sector_column, _mm_mullo_epi32(sector_row, sectors_across) );
+
+            /// location of cell within sector (indexed above)
+            const __m128i cell_column = _mm_sub_epi32( column, _mm_mullo_epi32(sector_column, cells_across) );
+            const __m128i cell_row = _mm_sub_epi32( row, _mm_mullo_epi32(sector_row, cells_across) );
+            const __m128i cell_offset = _mm_add_epi32( cell_column, _mm_mullo_epi32(cell_row, cells_across) );
+            _mm_store_si128( reinterpret_cast<__m128i*>(cell_offsets.data()),
+                             _mm_add_epi32(_mm_mullo_epi32(sector_offset, cells_per), cell_offset) );
+
+            for( uint32_t lane = 0; lane < batch_width; ++lane ){
+                if( visible_lanes & (1 << lane) ){
+                    values[point_index + lane] = cells_[ cell_offsets[lane] ];
+                }else{
+                    values[point_index + lane] = default_cell_value;
+                }
+            }
+        }
+    }
+#endif
 
-        /// index of the sector to lookup in
-        const size_t sector_offset = view_index.div(cells_across_sector_).offset(sectors_across_view_);
+    // remainder (and fallback):
+    for( ; point_index < points.size(); ++point_index ){
+        values[point_index] = get( points[point_index] );
+    }
+
+    return true;
+}
 
-        /// location of cell within sector (indexed above)
-        const size_t cell_offset = view_index.mod(cells_across_sector_)
-                                            .offset(cells_across_sector_);
-        uint8_t current_cell_value = sectors_[ sector_offset ][ cell_offset ];
 
-        return current_cell_value;
+uint8_t DynamicGridLayer::max( const BoundBox<LocalLocation>& box ) const {
+    const BoundBox<LocalLocation> clipped( { std::max(box.min.easting, view_bounds_.min.easting), std::max(box.min.northing, view_bounds_.min.northing) },
+                                           { std::min(box.max.easting, view_bounds_.max.easting), std::min(box.max.northing, view_bounds_.max.northing) } );
+    if( (cells_in_view() == 0) || (clipped.max.easting < clipped.min.easting) || (clipped.max.northing < clipped.min.northing) ){
+        return default_cell_value;
     }
 
-    return default_cell_value;
+    // cells covered by the box -- clamped inside at the max-border, as in `get`
+    const LocalLocation last = LocalLocation( std::fmin( clipped.max.easting - view_bounds_.min.easting, view_bounds_.width() - meters_across_cell_/10 ),
+                                              std::fmin( clipped.max.northing - view_bounds_.min.northing, view_bounds_.height() - meters_across_cell_/10 ) );
+    const uint32_t first_column = to_cell( clipped.min.easting - view_bounds_.min.easting );
+    const uint32_t last_column = to_cell( last.easting );
+    const uint32_t first_row = to_cell( clipped.min.northing - view_bounds_.min.northing );
+    const uint32_t last_row = to_cell( last.northing );
+
+    // one sector's run of each row at a time:
+    uint8_t result = 0;
+    for( uint32_t row = first_row; row <= last_row; ++row ){
+        for( uint32_t column = first_column; column <= last_column; ){
+            const uint32_t count = std::min( last_column - column + 1, cells_across_sector_ - (column % cells_across_sector_) );
+            const uint8_t* run = cells_.get() + cell_offset( column, row );
+            result = std::max( result, *std::max_element( run, run + count ) );
+            column += count;
+        }
+    }
+    return result;
 }
 
-
-bool DynamicGridLayer::load( DynamicGridSector& sector, const LocalLocation& /*origin*/ ){
+bool DynamicGridLayer::load( DynamicGridSector sector, const LocalLocation& /*origin*/ ){
     using chartbox::layer::default_cell_value;
 
     // placeholder -- just reset sector
-    sector.assign( cells_across_sector_*cells_across_sector_, default_cell_value );
+    std::fill( sector.begin(), sector.end(), default_cell_value );
 
     return true;
 }
@@ -99,6 +184,8 @@ bool DynamicGridLayer::origin( const LocalLocation& new_origin ) {
 double DynamicGridLayer::meters_across_cell( double across ){
     if( 0 < across ){
         meters_across_cell_ = across;
+        const uint32_t whole_meters = static_cast<uint32_t>(across);
+        cell_shift_ = ((whole_meters == across) && std::has_single_bit(whole_meters)) ? (std::countr_zero(whole_meters) + 1) : 0;
         meters_across_sector_ = meters_across_cell_ * cells_across_sector_;
         meters_across_view_ = meters_across_sector_ * sectors_across_view_;
     }
@@ -116,13 +203,7 @@ std::string DynamicGridLayer::to_cell_content_string( uint32_t indent ) const {
             if( 0 == ((cell_column_index) % cells_across_sector_ ) ){
                 buf << prefix << "    ";
             }
-            const GridIndex cell_view_index(cell_column_index, cell_row_index);
-            const size_t sector_offset = cell_view_index.div(cells_across_sector_)
-                                                        .offset(sectors_across_view_);
-            const size_t cell_offset = cell_view_index.mod(cells_across_sector_)
-                                                        .offset(cells_across_sector_);
-
-            buf << fmt::format(" {:2X}", sectors_[sector_offset][cell_offset] );
+            buf << fmt::format(" {:2X}", cells_[cell_offset(cell_column_index, cell_row_index)] );
         }
         if( 0 == (cell_row_index % cells_across_sector_ ) ){
             buf << '\n' << prefix;
@@ -139,14 +220,12 @@ std::string DynamicGridLayer::to_sector_content_string( uint32_t indent) const {
     std::ostringstream buf;
     const std::string prefix = fmt::format("{:<{}}", "", indent );
     buf << prefix << "======== ======= ======= Print Contents By Sector: ======= ======= =======\n" << prefix;
-    uint32_t sector_index = 0;
-    for( auto& sector : sectors_ ){
+    for( size_t sector_index = 0; sector_index < sectors_per_view(); ++sector_index ){
         buf << fmt::format("{:2}:", sector_index );
-        for( auto& current_cell_value : sector ){
+        for( auto& current_cell_value : sector(sector_index) ){
             buf << fmt::format(" {:2X}", current_cell_value );
         }
         buf << '\n' << prefix;
-        ++sector_index;
     }
     buf << "======== ======= ======= =======  =======  ======= ======= ======= =======\n";
     return buf.str();
@@ -167,7 +246,7 @@ std::string DynamicGridLayer::to_property_string( uint32_t indent) const {
     return buf.str();
 }
 
-bool DynamicGridLayer::save( const DynamicGridSector& /*sector*/, const LocalLocation& /*origin*/ ) const { 
+bool DynamicGridLayer::save( std::span<const uint8_t> /*sector*/, const LocalLocation& /*origin*/ ) const { 
     // placeholder
     // NYI
     return false; 
@@ -179,39 +258,35 @@ uint32_t DynamicGridLayer::sectors_across_view( uint32_t new_sectors_across ){
     }
 
     sectors_across_view_ = new_sectors_across;
-    sectors_.reserve( sectors_across_view_*sectors_across_view_ );
-    sectors_.resize( sectors_across_view_*sectors_across_view_ );
-    fill( chartbox::layer::default_cell_value );
-
     cells_across_sector_ = cells_across_view_ / sectors_across_view_;
 
     if( 0 != ( cells_across_view_ % cells_across_sector_ )){
         cells_across_view_ = cells_across_sector_ * sectors_across_view_;
     }
 
+    allocate();
+
     return sectors_across_view_;
 }
 
-bool DynamicGridLayer::store(const LocalLocation& layer_location, uint8_t new_value) {
-    if( visible(layer_location) ){
-        const LocalLocation view_location = layer_location - view_bounds_.min;
-        const GridIndex view_index = GridIndex( view_location.easting, view_location.northing)
-                                            .div(meters_across_cell_);
-        
-        /// index of the sector to lookup in
-        const size_t sector_offset = view_index.div(cells_across_sector_)
-                                                .offset(sectors_across_view_);
+bool DynamicGridLayer::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+    const uint32_t cells_across_view = cells_across_sector_ * sectors_across_view_;
+    if( (cells_across_view <= row) || (cells_across_view <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min( last_column, cells_across_view - 1 );
 
-        /// location of cell within sector (indexed above)
-        const size_t cell_offset = view_index.mod(cells_across_sector_)
-                                                .offset(cells_across_sector_);
+    // split the run at each sector boundary:
+    for( uint32_t column = first_column; column <= last_column; ){
+        const uint32_t sector_column = column / cells_across_sector_;
+        const uint32_t segment_last_column = std::min( last_column, (sector_column + 1) * cells_across_sector_ - 1 );
 
-        sectors_[ sector_offset ][ cell_offset ] = new_value;
+        std::memset( cells_.get() + cell_offset(column, row), value, segment_last_column - column + 1 );
 
-        return true;
+        column = segment_last_column + 1;
     }
 
-    return false;
+    return true;
 }
 
 bool DynamicGridLayer::track( const geometry::BoundBox<geometry::LocalLocation>& _new_bounds ) {
@@ -3,9 +3,13 @@
 #pragma once
 
 #include <array>
+#include <bit>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <string>
 
 #include "layer/layer-interface.hpp"
@@ -22,13 +26,21 @@ namespace chartbox::layer::dynamic {
 ///  chart => layer => sector => cell
 ///            ^^^ you are here
 ///
+/// Every cell lives in a single, cache-line-aligned buffer, in sector-major order: each sector is one contiguous
+/// block of `cells_per_sector()` cells (row-major within the sector), and the blocks are laid out row-major across
+/// the view.  When `cells_across_sector` is a power of two, indexing uses shifts + masks instead of division.
+///
 class DynamicGridLayer final : public LayerInterface<DynamicGridLayer> {
 public:
 
     /// \brief name of this layer's type
     constexpr static char type_name_[] = "DynamicGridLayer";
 
-    typedef std::vector<uint8_t> DynamicGridSector;
+    /// \brief view of a single sector's cells, within the layer's buffer
+    typedef std::span<uint8_t> DynamicGridSector;
+
+    /// \brief alignment of the cell buffer
+    constexpr static size_t cell_alignment = 64;
 
 public:
     /// \brief Constructs a new 2d square grid
@@ -37,7 +49,7 @@ public:
     ~DynamicGridLayer() = default;
 
     inline uint32_t cells_across_sector() const { return cells_across_sector_; }
-    inline uint32_t cells_per_sector() const { return sectors_[0].size(); }
+    inline uint32_t cells_per_sector() const { return cells_across_sector_ * cells_across_sector_; }
     uint32_t cells_across_sector( uint32_t new_cells_across );
 
     inline uint32_t cells_across_view() const { return cells_across_view_; }
@@ -62,13 +74,36 @@ public:
     bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
         return super().fill( poly, bound, value ); }
 
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value, WorkerPool& pool ){
+        return super().fill( poly, bound, value, pool ); }
+
     double meters_across_cell( double across );
 
     inline double meters_across_cell() const { return meters_across_cell_; }
     inline double meters_across_sector() const { return meters_across_sector_; }
     inline double meters_across_view() const { return meters_across_view_; }
 
-    uint8_t get(const LocalLocation& p) const;
+    inline uint8_t get(const LocalLocation& p) const {
+        if( visible(p) ){
+            const LocalLocation relative = p - view_bounds_.min;
+
+            // if the point is on the max-border (east OR north) clamp it inside bounds.
+            return cells_[ cell_offset( to_cell(std::fmin(relative.easting, view_bounds_.width() - meters_across_cell_/10)),
+                                        to_cell(std::fmin(relative.northing, view_bounds_.height() - meters_across_cell_/10)) ) ];
+        }
+        return default_cell_value;
+    }
+
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const;
+
+    /// \brief the maximum value of any cell which a point in the box would read
+    ///
+    /// \param box - area to query; clipped to the view
+    /// \return the maximum value; or `default_cell_value` if the box does not overlap the view
+    uint8_t max( const BoundBox<LocalLocation>& box ) const;
 
     const geometry::LocalLocation& origin() const { return view_bounds_.min; }
 
@@ -80,20 +115,38 @@ public:
     std::string to_sector_content_string( uint32_t indenrt = 0 ) const;
     std::string to_property_string( uint32_t indent = 0 ) const;
 
-    bool save( const DynamicGridSector& sector, const LocalLocation& sector_origin ) const;
+    bool save( std::span<const uint8_t> sector, const LocalLocation& sector_origin ) const;
+
+    /// \brief the cells of the sector at the given offset. (sectors are numbered row-major, from the south-west)
+    inline DynamicGridSector sector( size_t sector_offset ) {
+        return { cells_.get() + sector_offset*cells_per_sector(), cells_per_sector() }; }
+    inline std::span<const uint8_t> sector( size_t sector_offset ) const {
+        return { cells_.get() + sector_offset*cells_per_sector(), cells_per_sector() }; }
 
     inline uint32_t sectors_across_view() const { return sectors_across_view_; }
 
     // sets the numbers of sectors across a view
     uint32_t sectors_across_view( uint32_t new_sector_count );
-    inline size_t sectors_per_view() const { return sectors_.size(); }
+    inline size_t sectors_per_view() const { return sectors_across_view_ * sectors_across_view_; }
 
     /// \brief Access the value at an (x, y) Eigen::Vector2d
     ///
     /// \param p - the x,y coordinates to search at:
     /// \param new_value - the value to stored at the specified location
     /// \return true if successful
-    bool store(const LocalLocation& p, uint8_t new_value);
+    inline bool store(const LocalLocation& p, uint8_t new_value){
+        if( visible(p) ){
+            const LocalLocation relative = p - view_bounds_.min;
+            cells_[ cell_offset( to_cell(relative.easting), to_cell(relative.northing) ) ] = new_value;
+            return true;
+        }
+        return false;
+    }
+
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value );
 
     bool track( const geometry::BoundBox<geometry::LocalLocation>& bounds );
 
@@ -106,9 +159,34 @@ public:
     inline bool visible(const LocalLocation& p) const { 
             return view_bounds_.contains(p); }
 
-    bool load( DynamicGridSector& sector, const LocalLocation& sector_origin );
+    bool load( DynamicGridSector sector, const LocalLocation& sector_origin );
 
 
+private:
+    /// \brief (re)allocate the cell buffer to fit the current sector sizes; and reset every cell
+    void allocate();
+
+    /// \brief the column (or row) containing a distance from the view's origin.  (truncated to whole meters first)
+    inline uint32_t to_cell( double meters ) const {
+        const uint32_t whole_meters = static_cast<uint32_t>(meters);
+        return (0 < cell_shift_) ? (whole_meters >> (cell_shift_ - 1)) : (whole_meters / static_cast<uint32_t>(meters_across_cell_));
+    }
+
+    /// \brief offset into the cell buffer of the cell at (column, row) of the view
+    inline size_t cell_offset( uint32_t column, uint32_t row ) const {
+        if( power_of_two_ ){
+            const uint32_t mask = cells_across_sector_ - 1;
+            const size_t sector_offset = (column >> sector_shift_) + (row >> sector_shift_) * sectors_across_view_;
+            return (sector_offset << (2*sector_shift_)) + ((row & mask) << sector_shift_) + (column & mask);
+        }
+        const size_t sector_offset = (column / cells_across_sector_) + (row / cells_across_sector_) * sectors_across_view_;
+        return sector_offset*cells_per_sector() + (row % cells_across_sector_)*cells_across_sector_ + (column % cells_across_sector_);
+    }
+
+    struct AlignedFree {
+        void operator()( uint8_t* cells ) const { std::free( cells ); }
+    };
+
 private:
 
     // group 1: these variables are interdependent
@@ -121,10 +199,18 @@ private:
     double meters_across_sector_;
     double meters_across_view_;
 
+    // power-of-two fast path: meters_across_cell_ == (1 << (cell_shift_-1));  0 => divide
+    uint32_t cell_shift_;
+
     // group 3: depends on group 1:
     //  chart => layer => sector => cell
-    //                 ^^ you are here -- this structure maps from the layer to the sectors 
-    std::vector<DynamicGridSector> sectors_;
+    //                 ^^ you are here -- this structure holds every sector, back-to-back
+    std::unique_ptr<uint8_t[], AlignedFree> cells_;
+    size_t cell_capacity_;
+
+    // power-of-two fast path: cells_across_sector_ == (1 << sector_shift_)
+    bool power_of_two_;
+    uint32_t sector_shift_;
 
     // group 4: depends on group 2
     // this tracks the outer bounds (that the whole chart is tracking)
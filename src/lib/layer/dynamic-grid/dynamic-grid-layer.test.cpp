@@ -2,7 +2,9 @@
 
 #include <cmath>
 #include <iostream>
+#include <random>
 #include <sstream>
+#include <utility>
 
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
@@ -10,11 +12,15 @@ using Catch::Approx;
 
 #include "dynamic-grid-layer.hpp"
 #include "geometry/bound-box.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/worker-pool.hpp"
 
 using chartbox::geometry::BoundBox;
 using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
 
 using chartbox::layer::dynamic::DynamicGridLayer;
+using chartbox::layer::WorkerPool;
 
 
 // ============ ============ ============ ============  Dynamic-Grid-Layer-Tests  ============ ============ ============ ============
@@ -288,3 +294,119 @@ TEST_CASE( "DynamicGridLayer Can Store and Retrieve Values at novel precision"){
     { REQUIRE( layer.visible({120.0, 20.0 }));  CHECK( 0x20 == static_cast<int>(layer.get({120.0, 20.0 }))); }
 
 } // TEST_CASE
+
+TEST_CASE( "DynamicGridLayer batch-get matches scalar get"){
+    DynamicGridLayer layer;
+    layer.meters_across_cell( 10.0 );
+    layer.track( {{0,0}, {144,144}} );
+    populate_markers_per_cell( layer );
+    REQUIRE( LocalLocation( 150.0, 150.0) == layer.visible().max );
+
+    // query both inside and outside of the visible area:
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> distribution( -20.0, 170.0 );
+    std::vector<LocalLocation> points;
+    for( size_t i = 0; i < 1001; ++i ){
+        points.emplace_back( distribution(generator), distribution(generator) );
+    }
+    // exact borders
+    points.emplace_back(   0.0,   0.0 );
+    points.emplace_back( 150.0, 150.0 );
+    points.emplace_back( 150.0,  50.0 );
+
+    std::vector<uint8_t> values( points.size() );
+    REQUIRE( layer.get( points, values ));
+
+    for( size_t i = 0; i < points.size(); ++i ){
+        CHECK( static_cast<int>(layer.get(points[i])) == static_cast<int>(values[i]) );
+    }
+} // TEST_CASE
+
+TEST_CASE( "DynamicGridLayer fills boxes across sectors"){
+    DynamicGridLayer layer;
+    layer.fill( 0 );
+    REQUIRE( 4 == layer.cells_across_sector() );
+    REQUIRE( LocalLocation( 12.0, 12.0) == layer.visible().max );
+
+    // crosses all three sectors on each axis, and is clipped at the north + east edges
+    layer.fill( BoundBox<LocalLocation>( {2.0, 3.0}, {20.0, 20.0} ), 0x55 );
+    CHECK( not layer.store_span( 12, 0, 4, 0xEE ));
+
+    for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+        for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+            const LocalLocation at( column + 0.5, row + 0.5 );
+            const bool inside = (2 <= column) && (3 <= row);
+            CHECK( (inside ? 0x55 : 0) == static_cast<int>(layer.get(at)) );
+        }
+    }
+} // TEST_CASE
+
+TEST_CASE( "DynamicGridLayer finds the maximum of a box"){
+    DynamicGridLayer layer;
+    layer.fill( 0 );
+    REQUIRE( layer.store( {5.5, 6.5}, 0x30 ));
+    REQUIRE( layer.store( {9.5, 2.5}, 0x60 ));
+
+    CHECK( 0x30 == layer.max( BoundBox<LocalLocation>( {4.0, 4.0}, {8.0, 8.0} )));
+    CHECK( 0x60 == layer.max( BoundBox<LocalLocation>( {4.0, 2.0}, {10.0, 8.0} )));
+    CHECK( 0 == layer.max( BoundBox<LocalLocation>( {0.5, 0.5}, {4.5, 4.5} )));
+    // ... clipped at the max-border:
+    CHECK( 0x60 == layer.max( BoundBox<LocalLocation>( {9.0, -5.0}, {40.0, 2.5} )));
+    CHECK( chartbox::layer::default_cell_value == layer.max( BoundBox<LocalLocation>( {20.0, 20.0}, {30.0, 30.0} )));
+} // TEST_CASE
+
+TEST_CASE( "DynamicGridLayer parallel polygon fill matches serial fill"){
+    DynamicGridLayer serial;
+    DynamicGridLayer parallel;
+    serial.fill( 0 );
+    parallel.fill( 0 );
+
+    const Polygon<LocalLocation> diamond( {{6.2,-1.0}, {13.0,5.7}, {6.1,12.6}, {-0.4,6.3}, {6.2,-1.0}} );
+    WorkerPool pool( 2 );
+
+    CHECK( serial.fill( diamond, serial.visible(), 0x77 ));
+    CHECK( parallel.fill( diamond, parallel.visible(), 0x77, pool ));
+
+    for( uint32_t row = 0; row < serial.cells_across_view(); ++row ){
+        for( uint32_t column = 0; column < serial.cells_across_view(); ++column ){
+            const LocalLocation at( column + 0.5, row + 0.5 );
+            CHECK( static_cast<int>(serial.get(at)) == static_cast<int>(parallel.get(at)) );
+        }
+    }
+    CHECK( 0x77 == serial.get({6.5, 6.5}) );
+    CHECK( 0 == serial.get({0.5, 0.5}) );
+} // TEST_CASE
+
+TEST_CASE( "DynamicGridLayer stores each sector contiguously"){
+    // power-of-two cells (shifted), then not (divided)
+    for( const double meters_across_cell : {2.0, 5.0} ){
+        DynamicGridLayer layer;
+        layer.meters_across_cell( meters_across_cell );
+        REQUIRE( layer.track( {{0,0}, {32*meters_across_cell, 32*meters_across_cell}} ));
+        REQUIRE(  8 == layer.cells_across_sector() );
+        REQUIRE(  4 == layer.sectors_across_view() );
+        layer.fill( 0 );
+
+        // a distinct-ish marker per cell
+        const auto marker = []( uint32_t column, uint32_t row ){ return static_cast<uint8_t>( (column * 7) + (row * 31) ); };
+        for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+                CHECK( layer.store( {(column + 0.5)*meters_across_cell, (row + 0.5)*meters_across_cell}, marker(column, row) ));
+            }
+        }
+
+        // sector 6 == (2, 1) :: cells [16, 24) x [8, 16), row-major within the sector
+        const auto sector = std::as_const(layer).sector( 6 );
+        REQUIRE( 64 == sector.size() );
+        CHECK( marker(16, 8) == sector[0] );
+        CHECK( marker(23, 8) == sector[7] );
+        CHECK( marker(16, 9) == sector[8] );
+        CHECK( marker(23, 15) == sector[63] );
+
+        for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+                CHECK( static_cast<int>(marker(column, row)) == static_cast<int>(layer.get( {(column + 0.5)*meters_across_cell, (row + 0.5)*meters_across_cell} )) );
+            }
+        }
+    }
+} // TEST_CASE
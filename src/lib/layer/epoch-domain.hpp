@@ -0,0 +1,163 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chartbox::layer {
+
+/// \brief epoch-based reclamation: readers never lock; writers defer each free until no reader can still hold it
+///
+/// A reader `pin`s the domain before it loads any shared pointer, and holds the returned guard until it is done
+/// with everything it loaded.  Pinning announces the current (global) epoch in one of a fixed set of reader slots;
+/// it costs a single compare-exchange, on a cache line which no other thread writes.
+///
+/// A writer first unpublishes an object (e.g. swaps an atomic pointer), and then `retire`s it.  `collect` advances
+/// the global epoch -- each time every pinned reader has caught up to it -- and frees each object retired at least
+/// two epochs ago: any reader which could have loaded it has since unpinned.
+///
+/// Sources / Inspiration / Further Reading
+/// 1. Fraser, "Practical lock-freedom" (2004), section 5.2.3
+/// 2. Hart et al, "Performance of memory reclamation for lockless synchronization" (2007)
+class EpochDomain {
+public:
+    /// \brief maximum number of simultaneously pinned readers.  (further readers wait for a free slot)
+    constexpr static size_t max_readers = 64;
+
+    /// \brief pins the domain, while it lives.  (move-only)
+    class Guard {
+    public:
+        Guard( Guard&& other ) : slot_( other.slot_ ) { other.slot_ = nullptr; }
+        Guard( const Guard& ) = delete;
+        Guard& operator=( const Guard& ) = delete;
+        Guard& operator=( Guard&& ) = delete;
+
+        ~Guard(){
+            if( slot_ ){
+                slot_->store( idle, std::memory_order_release );
+            }
+        }
+
+    private:
+        friend class EpochDomain;
+        explicit Guard( std::atomic<uint64_t>* slot ) : slot_( slot ) {}
+
+        std::atomic<uint64_t>* slot_;
+    };
+
+public:
+    EpochDomain() = default;
+    EpochDomain( const EpochDomain& ) = delete;
+    EpochDomain& operator=( const EpochDomain& ) = delete;
+
+    /// \brief frees every retired object.  (no reader may still be pinned)
+    ~EpochDomain(){
+        for( auto& each : retired_ ){
+            each.destroy();
+        }
+    }
+
+    /// \brief the current global epoch
+    inline uint64_t epoch() const { return epoch_.load(); }
+
+    /// \brief number of retired objects, which have not been freed yet
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        return retired_.size();
+    }
+
+    /// \brief enter a read-side critical section.  Load shared pointers only after this returns.
+    Guard pin() const {
+        // each thread starts at its own slot -- and returns to the slot which it last claimed
+        thread_local size_t hint = std::hash<std::thread::id>{}( std::this_thread::get_id() );
+
+        for( size_t attempt = 0; ; ++attempt ){
+            auto& slot = slots_[ (hint + attempt) % max_readers ].epoch;
+            uint64_t expected = idle;
+            if( (idle == slot.load(std::memory_order_relaxed)) && slot.compare_exchange_strong( expected, epoch_.load() ) ){
+                hint = (hint + attempt) % max_readers;
+                // (a stale epoch is safe: it only holds back the next advance)
+                return Guard( &slot );
+            }else if( (max_readers - 1) == (attempt % max_readers) ){
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /// \brief free an (already unpublished) object, once no pinned reader can hold it
+    ///
+    /// Safe to call from any writer thread.
+    template<typename object_t>
+    void retire( std::unique_ptr<object_t> object ){
+        std::shared_ptr<object_t> owner( std::move(object) );
+        std::lock_guard<std::mutex> lock( mutex_ );
+        retired_.push_back( { epoch_.load(), [owner]() mutable { owner.reset(); } } );
+    }
+
+    /// \brief advance the epoch (as far as the pinned readers allow), and free every object which is now safe
+    ///
+    /// \return the number of objects freed
+    size_t collect(){
+        std::vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            // two advances free everything retired before this call -- when no reader is pinned
+            for( uint32_t advance = 0; (advance < 2) && quiescent( epoch_.load() ); ++advance ){
+                epoch_.fetch_add( 1 );
+            }
+
+            const uint64_t current = epoch_.load();
+            const auto safe = std::stable_partition( retired_.begin(), retired_.end(), [&]( const Retired& each ){
+                return current < (each.epoch + 2); });
+            std::move( safe, retired_.end(), std::back_inserter(ready) );
+            retired_.erase( safe, retired_.end() );
+        }
+
+        // (outside the lock: a destructor may retire more objects)
+        for( auto& each : ready ){
+            each.destroy();
+        }
+        return ready.size();
+    }
+
+private:
+    constexpr static uint64_t idle = 0;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch = idle;
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> destroy;
+    };
+
+    /// \brief true if every pinned reader has announced the given epoch
+    bool quiescent( uint64_t epoch ) const {
+        return std::all_of( slots_.begin(), slots_.end(), [&]( const Slot& slot ){
+            const uint64_t announced = slot.epoch.load();
+            return (idle == announced) || (epoch == announced); });
+    }
+
+private:
+    // written by readers; scanned by `collect`
+    mutable std::array<Slot, max_readers> slots_;
+
+    // (starts after `idle`)
+    alignas(64) std::atomic<uint64_t> epoch_ = 1;
+
+    // writers only:
+    mutable std::mutex mutex_;
+    std::vector<Retired> retired_;
+};
+
+} // namespace
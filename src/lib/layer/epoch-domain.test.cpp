@@ -0,0 +1,102 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "epoch-domain.hpp"
+
+using chartbox::layer::EpochDomain;
+
+namespace {
+
+// counts its own destruction
+struct Tracked {
+    explicit Tracked( std::atomic<int>& destroyed ) : destroyed_(destroyed) {}
+    ~Tracked(){ ++destroyed_; }
+
+    std::atomic<int>& destroyed_;
+    int value = 42;
+};
+
+TEST_CASE( "EpochDomain frees retired objects only once no reader holds them" ){
+    std::atomic<int> destroyed = 0;
+    EpochDomain domain;
+
+    SECTION( "without readers, the next collect frees everything" ){
+        domain.retire( std::make_unique<Tracked>(destroyed) );
+        domain.retire( std::make_unique<Tracked>(destroyed) );
+        CHECK( 2 == domain.pending() );
+        CHECK( 0 == destroyed );
+
+        CHECK( 2 == domain.collect() );
+        CHECK( 2 == destroyed );
+        CHECK( 0 == domain.pending() );
+    }
+
+    SECTION( "a pinned reader holds back everything retired since it pinned" ){
+        std::unique_ptr<EpochDomain::Guard> reader = std::make_unique<EpochDomain::Guard>( domain.pin() );
+        domain.retire( std::make_unique<Tracked>(destroyed) );
+        for( int attempt = 0; attempt < 10; ++attempt ){
+            CHECK( 0 == domain.collect() );
+        }
+        CHECK( 0 == destroyed );
+
+        // ... until it unpins:
+        reader.reset();
+        CHECK( 1 == domain.collect() );
+        CHECK( 1 == destroyed );
+    }
+
+    SECTION( "the destructor frees whatever is left" ){
+        {
+            EpochDomain inner;
+            auto reader = inner.pin();
+            inner.retire( std::make_unique<Tracked>(destroyed) );
+        }
+        CHECK( 1 == destroyed );
+    }
+} // TEST_CASE
+
+TEST_CASE( "EpochDomain readers never see a freed object" ){
+    std::atomic<int> destroyed = 0;
+    EpochDomain domain;
+    std::atomic<Tracked*> shared( new Tracked(destroyed) );
+    std::atomic<bool> done = false;
+    std::atomic<int> bad_reads = 0;
+
+    std::vector<std::thread> readers;
+    for( int thread = 0; thread < 4; ++thread ){
+        readers.emplace_back( [&](){
+            while( not done ){
+                const auto guard = domain.pin();
+                const Tracked* object = shared.load();
+                // (a freed object would read as garbage -- or fault)
+                if( 42 != object->value ){
+                    ++bad_reads;
+                }
+            }
+        });
+    }
+
+    constexpr int swap_count = 2000;
+    for( int swap = 0; swap < swap_count; ++swap ){
+        std::unique_ptr<Tracked> last( shared.exchange( new Tracked(destroyed) ) );
+        domain.retire( std::move(last) );
+        domain.collect();
+    }
+    done = true;
+    for( auto& reader : readers ){
+        reader.join();
+    }
+
+    CHECK( 0 == bad_reads );
+    domain.collect();
+    CHECK( swap_count == destroyed );
+    delete shared.load();
+} // TEST_CASE
+
+}   // namespace
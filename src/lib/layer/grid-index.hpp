@@ -14,11 +14,11 @@ struct GridIndex {
      uint32_t column;
      uint32_t row;
 
-    GridIndex()
+    constexpr GridIndex()
         : column(0), row(0)
     {}
 
-    GridIndex( uint32_t _col, uint32_t _row )
+    constexpr GridIndex( uint32_t _col, uint32_t _row )
         : column(_col), row(_row)
     {}
 
@@ -48,7 +48,7 @@ struct GridIndex {
         return column + row*length;
     }
 
-    inline bool operator==( const GridIndex& other) const {
+    constexpr bool operator==( const GridIndex& other) const {
         return ( (column == other.column) && (row == other.row));
     }
 
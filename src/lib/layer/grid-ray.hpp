@@ -0,0 +1,158 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+namespace chartbox::layer {
+
+/// \brief walks the cells crossed by a line segment, in order: from the start cell to the end cell
+///
+/// Coordinates are in cells, relative to the grid's origin. (i.e. meters / meters_across_cell)  Each step moves to
+/// the neighbouring cell, east-west or north-south, whose boundary the segment crosses first; where it crosses both
+/// at once, the walk steps north-south first.
+///
+/// Each crossing is computed directly from the start point (rather than accumulated), so that a walk which skips
+/// ahead (see: `advance_to_row`) visits exactly the cells which the full walk would.
+///
+/// Sources / Inspiration / Further Reading
+/// 1. Amanatides & Woo, "A Fast Voxel Traversal Algorithm for Ray Tracing" (1987)
+class GridRay {
+public:
+    GridRay() = default;
+
+    /// \param start_x, start_y - start of the segment, in cells
+    /// \param end_x, end_y - end of the segment, in cells
+    GridRay( double start_x, double start_y, double end_x, double end_y )
+        : start_x_( start_x )
+        , start_y_( start_y )
+        , column_( static_cast<int64_t>( std::floor(start_x) ) )
+        , row_( static_cast<int64_t>( std::floor(start_y) ) )
+        , end_column_( static_cast<int64_t>( std::floor(end_x) ) )
+        , end_row_( static_cast<int64_t>( std::floor(end_y) ) )
+        , step_x_( (column_ < end_column_) - (end_column_ < column_) )
+        , step_y_( (row_ < end_row_) - (end_row_ < row_) )
+        , inverse_dx_( (0 == step_x_) ? 0 : (1.0 / (end_x - start_x)) )
+        , inverse_dy_( (0 == step_y_) ? 0 : (1.0 / (end_y - start_y)) )
+        , next_x_( crossing_x(column_) )
+        , next_y_( crossing_y(row_) )
+        , remaining_( static_cast<uint64_t>( std::llabs(end_column_ - column_) + std::llabs(end_row_ - row_) ) )
+    {}
+
+    inline int64_t column() const { return column_; }
+    inline int64_t row() const { return row_; }
+
+    inline int64_t end_column() const { return end_column_; }
+    inline int64_t end_row() const { return end_row_; }
+
+    /// \brief direction of each step: one of {-1, 0, 1}
+    inline int32_t step_x() const { return step_x_; }
+    inline int32_t step_y() const { return step_y_; }
+
+    /// \brief the fraction of the segment at which the walk entered this cell.  (0 at the start cell)
+    inline double entry() const { return entry_; }
+
+    /// \brief the fraction of the segment at which the walk leaves this cell.  (1 at the end cell)
+    inline double exit() const {
+        if( done() ){
+            return 1.0;
+        }
+        return std::min( 1.0, along_x() ? next_x_ : next_y_ );
+    }
+
+    /// \brief true at the end cell
+    inline bool done() const { return 0 == remaining_; }
+
+    /// \brief number of cells left to visit, after this one
+    inline uint64_t remaining() const { return remaining_; }
+
+    /// \brief move to the next cell.  (not past the end cell)
+    inline void step(){
+        // (once either axis reaches its end, only the other may move)
+        if( along_x() ){
+            entry_ = next_x_;
+            column_ += step_x_;
+            next_x_ = crossing_x( column_ );
+        }else{
+            entry_ = next_y_;
+            row_ += step_y_;
+            next_y_ = crossing_y( row_ );
+        }
+        --remaining_;
+    }
+
+    /// \brief skip ahead to the first cell of the given row -- the cell the full walk would enter it at
+    ///
+    /// \param row - a row which the walk has not reached yet
+    /// \return false if the walk never reaches this row; (the walk is unchanged)
+    bool advance_to_row( int64_t row ){
+        if( row == row_ ){
+            return true;
+        }else if( (0 == step_y_) || ((row - row_) * step_y_ < 0) || ((end_row_ - row) * step_y_ < 0) ){
+            return false;
+        }
+
+        // the full walk enters `row` when it crosses that row's near boundary:
+        const double entry = crossing_y( row - step_y_ );
+
+        // ... by which point, it has crossed every column boundary which comes strictly earlier
+        int64_t column = column_;
+        if( 0 != step_x_ ){
+            const double estimate = std::floor( start_x_ + entry / inverse_dx_ );
+            column = std::clamp( static_cast<int64_t>(estimate), std::min(column_, end_column_), std::max(column_, end_column_) );
+            while( (column != end_column_) && (crossing_x(column) < entry) ){
+                column += step_x_;
+            }
+            while( (column != column_) && (entry <= crossing_x(column - step_x_)) ){
+                column -= step_x_;
+            }
+        }
+
+        column_ = column;
+        row_ = row;
+        entry_ = entry;
+        next_x_ = crossing_x( column_ );
+        next_y_ = crossing_y( row_ );
+        remaining_ = static_cast<uint64_t>( std::llabs(end_column_ - column_) + std::llabs(end_row_ - row_) );
+        return true;
+    }
+
+private:
+    /// \brief true if the next step is east-west
+    inline bool along_x() const {
+        return (row_ == end_row_) || ((column_ != end_column_) && (next_x_ < next_y_)); }
+
+    /// \brief the fraction of the segment at which it leaves this column / row, toward the end
+    inline double crossing_x( int64_t column ) const {
+        return (static_cast<double>(column + (0 < step_x_)) - start_x_) * inverse_dx_; }
+    inline double crossing_y( int64_t row ) const {
+        return (static_cast<double>(row + (0 < step_y_)) - start_y_) * inverse_dy_; }
+
+private:
+    double start_x_ = 0;
+    double start_y_ = 0;
+
+    int64_t column_ = 0;
+    int64_t row_ = 0;
+    int64_t end_column_ = 0;
+    int64_t end_row_ = 0;
+
+    int32_t step_x_ = 0;
+    int32_t step_y_ = 0;
+
+    double inverse_dx_ = 0;
+    double inverse_dy_ = 0;
+
+    // crossings into the current cell; and out of the current column + row
+    double entry_ = 0;
+    double next_x_ = 0;
+    double next_y_ = 0;
+
+    uint64_t remaining_ = 0;
+};
+
+} // namespace
@@ -0,0 +1,142 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "grid-ray.hpp"
+
+using chartbox::layer::GridRay;
+
+namespace {
+
+typedef std::vector<std::pair<int64_t,int64_t>> cells_t;
+
+cells_t walk( GridRay ray ){
+    cells_t cells = { {ray.column(), ray.row()} };
+    while( not ray.done() ){
+        ray.step();
+        cells.emplace_back( ray.column(), ray.row() );
+    }
+    return cells;
+}
+
+// true if the segment passes within `tolerance` of the cell
+bool crosses( double x0, double y0, double x1, double y1, int64_t column, int64_t row, double tolerance ){
+    // clip the segment to the (expanded) cell -- Liang-Barsky
+    double t0 = 0, t1 = 1;
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { x0 - (column - tolerance), (column + 1 + tolerance) - x0, y0 - (row - tolerance), (row + 1 + tolerance) - y0 };
+    for( int edge = 0; edge < 4; ++edge ){
+        if( 0 == p[edge] ){
+            if( q[edge] < 0 ){
+                return false;
+            }
+        }else{
+            const double t = q[edge] / p[edge];
+            if( p[edge] < 0 ){
+                t0 = std::max( t0, t );
+            }else{
+                t1 = std::min( t1, t );
+            }
+        }
+    }
+    return t0 <= t1;
+}
+
+TEST_CASE( "GridRay walks axis-aligned and diagonal segments" ){
+    CHECK( walk( GridRay( 0.5, 0.5, 0.7, 0.2 ) ) == cells_t{ {0,0} } );
+    CHECK( walk( GridRay( 0.5, 0.5, 3.5, 0.5 ) ) == cells_t{ {0,0}, {1,0}, {2,0}, {3,0} } );
+    CHECK( walk( GridRay( 0.5, 2.5, 0.5, -0.5 ) ) == cells_t{ {0,2}, {0,1}, {0,0}, {0,-1} } );
+    CHECK( walk( GridRay( 0.2, 0.1, 2.9, 1.2 ) ) == cells_t{ {0,0}, {1,0}, {2,0}, {2,1} } );
+
+    // through a corner: north-south first
+    CHECK( walk( GridRay( 0.5, 0.5, 1.5, 1.5 ) ) == cells_t{ {0,0}, {0,1}, {1,1} } );
+
+    // where the walk enters + leaves each cell, as fractions of the segment:
+    GridRay ray( 0.5, 0.5, 4.5, 0.5 );
+    CHECK( 0 == ray.entry() );
+    CHECK( ray.exit() == Approx(0.125) );
+    ray.step();
+    CHECK( ray.entry() == Approx(0.125) );
+    CHECK( ray.exit() == Approx(0.375) );
+    while( not ray.done() ){
+        ray.step();
+    }
+    CHECK( ray.entry() == Approx(0.875) );
+    CHECK( 1 == ray.exit() );
+} // TEST_CASE
+
+TEST_CASE( "GridRay visits every cell the segment crosses, in order" ){
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> coordinate_distribution( -40, 40 );
+
+    for( int attempt = 0; attempt < 2000; ++attempt ){
+        const double x0 = coordinate_distribution(generator), y0 = coordinate_distribution(generator);
+        const double x1 = coordinate_distribution(generator), y1 = coordinate_distribution(generator);
+        const cells_t cells = walk( GridRay( x0, y0, x1, y1 ) );
+
+        REQUIRE( cells.front() == std::make_pair( static_cast<int64_t>(std::floor(x0)), static_cast<int64_t>(std::floor(y0)) ) );
+        REQUIRE( cells.back() == std::make_pair( static_cast<int64_t>(std::floor(x1)), static_cast<int64_t>(std::floor(y1)) ) );
+        for( size_t index = 0; index < cells.size(); ++index ){
+            REQUIRE( crosses( x0, y0, x1, y1, cells[index].first, cells[index].second, 1e-9 ) );
+            if( 0 < index ){
+                // each step moves to a neighbour
+                REQUIRE( 1 == std::llabs(cells[index].first - cells[index-1].first) + std::llabs(cells[index].second - cells[index-1].second) );
+            }
+        }
+    }
+} // TEST_CASE
+
+TEST_CASE( "GridRay skips ahead to a row, exactly as the full walk reaches it" ){
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> coordinate_distribution( -40, 40 );
+
+    for( int attempt = 0; attempt < 2000; ++attempt ){
+        const double x0 = coordinate_distribution(generator), y0 = coordinate_distribution(generator);
+        const double x1 = coordinate_distribution(generator), y1 = coordinate_distribution(generator);
+        const cells_t cells = walk( GridRay( x0, y0, x1, y1 ) );
+
+        for( const auto& [column, row] : cells ){
+            GridRay skipped( x0, y0, x1, y1 );
+            REQUIRE( skipped.advance_to_row( row ) );
+
+            // ... resumes from the first cell in that row:
+            size_t first = 0;
+            while( cells[first].second != row ){
+                ++first;
+            }
+            REQUIRE( walk(skipped) == cells_t( cells.begin() + first, cells.end() ) );
+            if( 0 < first ){
+                // (entering the row along the way)
+                GridRay stepped( x0, y0, x1, y1 );
+                for( size_t step = 0; step < first; ++step ){
+                    stepped.step();
+                }
+                REQUIRE( skipped.entry() == stepped.entry() );
+            }
+        }
+
+        // (rows which the walk never reaches)
+        GridRay ray( x0, y0, x1, y1 );
+        CHECK_FALSE( ray.advance_to_row( 100 ) );
+        CHECK_FALSE( ray.advance_to_row( -100 ) );
+    }
+
+    // a row, exactly on a corner:
+    GridRay corner( 0.5, 0.5, 2.5, 2.5 );
+    REQUIRE( corner.advance_to_row( 1 ) );
+    CHECK( 0 == corner.column() );
+    CHECK( walk(corner) == cells_t{ {0,1}, {1,1}, {1,2}, {2,2} } );
+} // TEST_CASE
+
+}   // namespace
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 
 #include "geometry/bound-box.hpp"
 #include "geometry/global-location.hpp"
@@ -11,6 +12,10 @@
 #include "geometry/polygon.hpp"
 #include "geometry/utm-location.hpp"
 
+#include "layer/polygon-rasterizer.hpp"
+#include "layer/raycast.hpp"
+#include "layer/worker-pool.hpp"
+
 namespace chartbox::layer {
 
 using chartbox::geometry::BoundBox;
@@ -74,6 +79,16 @@ public:
     /// \param fill_value - fill value for polygon interior
     bool fill( const Polygon<LocalLocation>& source, const BoundBox<LocalLocation>& box, uint8_t value );
 
+    /// \brief Fills the interior of the given polygon with the given value -- spread across a pool of threads
+    ///
+    /// The rows are split into bands, one for each row of sectors, so that no two threads write to the same sector.
+    /// The result is identical to the single-threaded fill.
+    ///
+    /// \param source - polygon defining the fill araea. Assumed to be in local coordinates, closed, CCW, and non-intersectings
+    /// \param fill_value - fill value for polygon interior
+    /// \param pool - threads to rasterize the bands on
+    bool fill( const Polygon<LocalLocation>& source, const BoundBox<LocalLocation>& box, uint8_t value, WorkerPool& pool );
+
     /// \brief Access the value at an (x, y) LocalLocation
     ///!
     /// \param LocalLocation - the x,y coordinates to search at:
@@ -88,10 +103,38 @@ public:
     uint8_t get(const LocalLocation& p) const { 
         return layer().get(p); }
 
+    /// \brief Retrieve the values at a batch of (x, y) LocalLocations
+    ///
+    /// Equivalent to calling `get(p)` for each point -- but the layer may translate several points at once.
+    /// Points outside the visible area read as `default_cell_value`.
+    ///
+    /// \param points - the x,y coordinates to search at
+    /// \param values - [out] the cell value for each point.  Must be at least as long as `points`
+    /// \return true for success; false if the output is too short
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+        return layer().get(points, values); }
+
+    /// \brief find where each straight line, from the origin to a target, first meets a blocking cell
+    ///
+    /// Each line walks the cells it crosses, in order, across the visible area.  (see: `GridRay`)  Cells outside
+    /// the visible area never block.  A layer may override this, to read its cells more directly.
+    ///
+    /// This generic walk reads each cell through `get`, location math and all: so it is about as fast as sampling
+    /// the line with `get`.  Only the overrides are much faster: `RollingGridLayer` (and so `SensorLayer`) and
+    /// `CompositeLayer`.
+    ///
+    /// \param origin - start of every line
+    /// \param targets - the far end of each line
+    /// \param threshold - cells with at least this value block a line
+    /// \param distances - [out] for each line: meters from the origin to where it enters its first blocking cell;
+    ///                    or `raycast_clear`.  Must be at least as long as `targets`
+    /// \return true for success; false if the output is too short
+    bool raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const;
+
     std::string name() const { 
         return name_; }
 
-    layer_t name( const std::string& _name ){ 
+    layer_t& name( const std::string& _name ){ 
         name_ = _name;
         return layer(); }
 
@@ -106,6 +149,19 @@ public:
     /// \return true for success; else false
     bool store(const LocalLocation& point, const uint8_t value){
         return layer().store(point,value); }
+
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// Cells are indexed relative to the visible area: cell (0,0) is the south-west corner of the view.
+    /// Columns past the east edge of the view are clipped.
+    ///
+    /// \param row - row index of the run
+    /// \param first_column - column index of the first (west-most) cell to write
+    /// \param last_column - column index of the last (east-most) cell to write. (inclusive)
+    /// \param value - the value to write into each cell
+    /// \return true if any cells were written; else false
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+        return layer().store_span( row, first_column, last_column, value ); }
  
     double precision() const {
         return layer().precision(); }
@@ -142,6 +198,21 @@ public:
 
 protected:
 
+    /// \brief store a value into every cell sampled along a row
+    ///
+    /// Samples are placed at `first_easting + k*meters_across_cell`, for every sample less than `end_easting`;
+    /// each sample writes the cell that contains it.
+    bool store_samples( double northing, double first_easting, double end_easting, uint8_t value );
+
+    /// \brief load the rasterizer with the rows of the given bounds
+    bool load_rasterizer( const Polygon<LocalLocation>& source, const BoundBox<LocalLocation>& bounds );
+
+    /// \brief store a value into the cells of a single polygon span, clipped to the bounds
+    inline void store_crossings( double northing, double west, double east, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+        const double incr = layer().meters_across_cell();
+        store_samples( northing, std::max( bounds.min.easting, west ) + incr/2, std::min( bounds.max.easting, east + incr/2 ), value );
+    }
+
     layer_t& layer() {
         return *static_cast<layer_t*>(this);
     }
@@ -157,6 +228,9 @@ protected:
     /// \brief descriptive for this layer's purpose
     std::string name_;
 
+    /// \brief scratch storage for polygon fills; kept to avoid reallocating on every fill
+    PolygonRasterizer rasterizer_;
+
 }; // class LayerInterface< uint8_t, layer_t >
 
 } // namespace chart
@@ -2,9 +2,11 @@
 
 // standard library includes
 #include <cctype>
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -25,9 +27,7 @@ bool LayerInterface<layer_t>::fill(const BoundBox<LocalLocation>& box, const uin
 
     // Loop through the rows of the image.
     for( double northing = northing_min; northing < northing_max; northing += incr ){
-        for( double easting = easting_min; easting < easting_max; easting += incr ){
-            layer().store( { easting, northing }, value);
-        }
+        store_samples( northing, easting_min, easting_max, value );
     }
     return true;
 }
@@ -87,55 +87,108 @@ bool LayerInterface<layer_t>::fill( const Polygon<LocalLocation>& poly, const Bo
     // adapted from:
     //  Public-domain code by Darel Rex Finley, 2007:  "Efficient Polygon Fill Algorithm With C Code Sample"
     //  Retrieved: (https://alienryderflex.com/polygon_fill/); 2019-09-07
+    // ... and then restructured around an active-edge table; see `PolygonRasterizer`
+    if( not load_rasterizer( poly, bounds ) ){
+        return (2 <= poly.size());
+    }
 
-    const size_t vertex_count = poly.size();
-    const double x_max = bounds.max[0];
-    const double x_min = bounds.min[0];
-    const double x_incr = layer().meters_across_cell();  // == y_incr.  This is a square grid.
-    const double y_max = bounds.max[1];
-    const double y_min = bounds.min[1];
-    const double y_incr = layer().meters_across_cell();  // == x_incr.  This is a square grid.
+    //  Fill the pixels between node pairs.
+    rasterizer_.rasterize( 0, rasterizer_.row_count(), [&]( double y, double west, double east ){
+        store_crossings( y, west, east, bounds, value ); });
 
-    // Loop through the rows of the image.
-    for( double y = y_min + y_incr/2; y < y_max; y += y_incr ){
-
-        // generate a list of line-segment crossings from the polygon
-        std::vector<double> crossings;
-        auto iter = poly.begin();
-        for (size_t i=0; i < (vertex_count-1); ++i) {
-            const LocalLocation segment_start = *iter;
-            ++iter;
-            const LocalLocation segment_end = *iter;
-
-            const double segment_y_min = std::min( segment_start.y(), segment_end.y() );
-            const double segment_y_max = std::max( segment_start.y(), segment_end.y() );
-
-            // if y is in range:
-            if( (segment_y_min <= y) && (y < segment_y_max) ){
-                // construct x-coordinate that crosses this line:
-                const double x_crossing = segment_start.x() + (y - segment_start.y()) * (segment_end.x()-segment_start.x())/(segment_end.y() - segment_start.y());
-                crossings.emplace_back(x_crossing);
-            }
-        }
+    return true;
+}
+
+template< typename layer_t>
+bool LayerInterface<layer_t>::fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bounds, uint8_t value, WorkerPool& pool ){
+    if( not load_rasterizer( poly, bounds ) ){
+        return (2 <= poly.size());
+    }
 
-        // early exit
-        if( 0 == crossings.size()){
-            continue;
+    // split the rows into bands -- each band holds the rows which write into a single row of sectors
+    // (this must match the row-calculation of `store_samples`)
+    const double incr = layer().meters_across_cell();
+    const double origin = layer().visible().min.northing;
+    const double cells_across_sector = layer().cells_across_sector();
+    const auto sector_row = [&]( size_t row ){
+        return std::floor( std::floor( (rasterizer_.northing(row) - origin) / incr ) / cells_across_sector ); };
+
+    std::vector<size_t> band_rows = { 0 };
+    for( size_t row = 1; row < rasterizer_.row_count(); ++row ){
+        if( sector_row(row) != sector_row(band_rows.back()) ){
+            band_rows.push_back( row );
         }
+    }
+    band_rows.push_back( rasterizer_.row_count() );
 
-        // Sort the crossings:
-        std::sort(crossings.begin(), crossings.end());
+    pool.run( band_rows.size() - 1, [&]( size_t band ){
+        PolygonRasterizer::Scratch scratch;
+        rasterizer_.rasterize( band_rows[band], band_rows[band + 1], scratch, [&]( double y, double west, double east ){
+            store_crossings( y, west, east, bounds, value ); });
+    });
 
-        //  Fill the pixels between node pairs.
-        for( size_t crossing_index = 0; crossing_index < crossings.size(); crossing_index += 2){
-            const double start_x = std::max( x_min, crossings[crossing_index]) + x_incr/2;
-            const double end_x = std::min( x_max, crossings[crossing_index+1] + x_incr/2);
-            for( double x = start_x; x < end_x; x += x_incr ){
-                layer().store( {x,y}, value);
-            }
-        }
+    return true;
+}
+
+template< typename layer_t>
+bool LayerInterface<layer_t>::load_rasterizer( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bounds ){
+    const double y_incr = layer().meters_across_cell();
+    const double y_first = bounds.min.northing + y_incr/2;
+
+    // sample the rows at the center of each cell:
+    const double row_count = std::ceil( (bounds.max.northing - y_first) / y_incr );
+    return rasterizer_.load( poly, y_first, y_incr, static_cast<size_t>(std::max(0.0, row_count)) );
+}
+
+template< typename layer_t>
+bool LayerInterface<layer_t>::store_samples( double northing, double first_easting, double end_easting, uint8_t value ){
+    if( not (first_easting < end_easting) ){
+        return false;
+    }
+
+    const double incr = layer().meters_across_cell();
+    const LocalLocation& origin = layer().visible().min;
+
+    const double row = std::floor( (northing - origin.northing) / incr );
+    const double sample_count = std::ceil( (end_easting - first_easting) / incr );
+    const double last_easting = first_easting + (sample_count - 1) * incr;
+    const double first_column = std::floor( (first_easting - origin.easting) / incr );
+    const double last_column = std::floor( (last_easting - origin.easting) / incr );
+
+    // reject runs entirely outside the view; the layer clips the east end
+    if( (row < 0) || (last_column < 0) || (std::numeric_limits<uint32_t>::max() < row) ){
+        return false;
     }
 
+    return layer().store_span( static_cast<uint32_t>(row),
+                               static_cast<uint32_t>(std::max(0.0, first_column)),
+                               static_cast<uint32_t>(std::min<double>(std::numeric_limits<uint32_t>::max(), last_column)),
+                               value );
+}
+
+template< typename layer_t>
+bool LayerInterface<layer_t>::raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const {
+    if( distances.size() < targets.size() ){
+        return false;
+    }
+
+    const double incr = layer().meters_across_cell();
+    const BoundBox<LocalLocation>& visible = layer().visible();
+    const uint32_t columns = static_cast<uint32_t>( std::lround( (visible.max.easting - visible.min.easting) / incr ) );
+    const uint32_t rows = static_cast<uint32_t>( std::lround( (visible.max.northing - visible.min.northing) / incr ) );
+
+    // sample each cell at its center
+    const auto probe = [&]( int64_t column, int64_t row ){
+        return layer().get( visible.min + LocalLocation( (column + 0.5) * incr, (row + 0.5) * incr ) ); };
+
+    for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+        RayClip clip;
+        if( clip_ray( visible.min, incr, columns, rows, origin, targets[target_index], clip ) ){
+            distances[target_index] = trace_ray( clip, threshold, probe );
+        }else{
+            distances[target_index] = raycast_clear;
+        }
+    }
     return true;
 }
 
@@ -0,0 +1,363 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "layer/layer-interface.hpp"
+
+namespace chartbox::layer {
+
+// Combine policies: each folds a layer's value into the combined value of the layers before it.
+//
+// Every policy provides:
+//   - `name`                               -- for reports
+//   - `combine( below, value )`            -- the combined value, after this layer
+//   - `bound( below, value )`              -- an upper bound on `combine`, over every `below` and `value` up to these
+
+/// \brief the higher value wins: a layer can only raise the combined value.  (the default)
+struct CombineMax {
+    constexpr static char name[] = "max";
+
+    constexpr static uint8_t combine( uint8_t below, uint8_t value ){
+        return std::max( below, value ); }
+
+    constexpr static uint8_t bound( uint8_t below, uint8_t value ){
+        return combine( below, value ); }
+};
+
+/// \brief this layer's value replaces the combined value -- except where this layer is unknown
+///
+/// e.g. a direct observation, which supersedes the charted data wherever it has seen.
+struct CombineOverride {
+    constexpr static char name[] = "override";
+
+    constexpr static uint8_t combine( uint8_t below, uint8_t value ){
+        return (unknown_cell_value == value) ? below : value; }
+
+    // (a lower value may replace a higher one: so either may be the highest)
+    constexpr static uint8_t bound( uint8_t below, uint8_t value ){
+        return std::max( below, value ); }
+};
+
+/// \brief this layer blocks the cells which it marks as blocked; every other cell is transparent
+///
+/// e.g. the footprints of other vessels.
+struct CombineMask {
+    constexpr static char name[] = "mask";
+
+    constexpr static uint8_t combine( uint8_t below, uint8_t value ){
+        return (block_cell_value == value) ? block_cell_value : below; }
+
+    constexpr static uint8_t bound( uint8_t below, uint8_t value ){
+        return combine( below, value ); }
+};
+
+/// \brief this layer blocks the cells which are likely occupied; every other cell is transparent
+///
+/// For layers which hold log-odds, rather than chart values -- e.g. `SensorLayer::integrate_scan`.  A log-odds cell
+/// which has only been passed through reads well below unknown; folded as an override, it would clear the charted
+/// obstacles beneath it.
+///
+/// \param occupied_ - the lowest value which blocks.  (default: p = 0.9, with steps of 1/32 offset by 128)
+template<uint8_t occupied_ = 198>
+struct CombineOccupied {
+    constexpr static char name[] = "occupied";
+
+    constexpr static uint8_t occupied = occupied_;
+
+    static_assert( unknown_cell_value < occupied_, "an unknown cell must not block" );
+
+    constexpr static uint8_t combine( uint8_t below, uint8_t value ){
+        return (occupied_ <= value) ? block_cell_value : below; }
+
+    constexpr static uint8_t bound( uint8_t below, uint8_t value ){
+        return combine( below, value ); }
+};
+
+/// \brief true if the layer offers a `reader()`, pinned to its current frame.  (e.g. `RollingGridLayer::Reader`)
+template<typename layer_t>
+constexpr bool has_reader = requires( const layer_t& layer ){ layer.reader(); };
+
+/// \brief reads a layer which has no `Reader` of its own -- directly.  (only safe from the layer's own thread)
+template<typename layer_t>
+class DirectReader {
+public:
+    explicit DirectReader( const layer_t& layer )
+        : layer_( layer ) {}
+
+    inline uint8_t get( const LocalLocation& p ) const {
+        return layer_.get( p ); }
+
+    inline bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+        return layer_.get( points, values ); }
+
+    /// \brief the maximum value in the box.  (only for layers which offer `max( box )`; e.g. `DynamicGridLayer`)
+    inline uint8_t max( const geometry::BoundBox<LocalLocation>& box ) const
+            requires requires( const layer_t& layer ){ layer.max( box ); } {
+        return layer_.max( box ); }
+
+    inline const geometry::BoundBox<LocalLocation>& visible() const { return layer_.visible(); }
+
+private:
+    const layer_t& layer_;
+};
+
+/// \brief start reading a layer: through its own `Reader`, if it has one
+template<typename layer_t>
+auto reader_of( const layer_t& layer ){
+    if constexpr ( has_reader<layer_t> ){
+        return layer.reader();
+    }else{
+        return DirectReader<layer_t>( layer );
+    }
+}
+
+template<typename layer_t>
+using reader_t = decltype( reader_of( std::declval<const layer_t&>() ) );
+
+/// \brief an upper bound on every value which a reader returns, for the points in a box
+///
+/// Counts `default_cell_value` wherever the box leaves the reader's view.  A reader without `max( box )` cannot
+/// bound the box: it might hold `block_cell_value` anywhere.
+template<typename reader_t>
+uint8_t bound_of( const reader_t& reader, const geometry::BoundBox<LocalLocation>& box ){
+    if constexpr ( requires { reader.max( box ); } ){
+        const uint8_t inside = reader.max( box );
+        return reader.visible().contains( box ) ? inside : std::max( inside, default_cell_value );
+    }else{
+        return block_cell_value;
+    }
+}
+
+/// \brief name of a layer's role, for reports
+constexpr const char* role_name( role_t role ){
+    switch( role ){
+        case BOUNDARY: return "Boundary";
+        case CONTOUR:  return "Contour";
+        case TARGET:   return "Target";
+        case LIDAR:    return "Lidar";
+        case RADAR:    return "Radar";
+        case VIEW:     return "View";
+    }
+    return "Unknown";
+}
+
+/// \brief one entry of a `LayerStack`: a layer, its role, and how its values combine with the layers before it
+template<role_t role_, typename layer_t_, typename combine_t_ = CombineMax>
+struct LayerSlot {
+    constexpr static role_t role = role_;
+    typedef layer_t_ layer_t;
+    typedef combine_t_ combine_t;
+};
+
+/// \brief true if no two slots share a role
+template<typename... slot_t>
+constexpr bool unique_roles(){
+    constexpr std::array<role_t, sizeof...(slot_t)> roles = { slot_t::role... };
+    for( size_t i = 0; i < roles.size(); ++i ){
+        for( size_t j = i + 1; j < roles.size(); ++j ){
+            if( roles[i] == roles[j] ){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// \brief a fixed set of layers, combined into a single value per location -- without virtual dispatch
+///
+/// The layers are held in a tuple; each query is a compile-time fold across them, in the order of the slots.  The
+/// fold starts from `clear_cell_value`, and each slot's policy combines its layer's value into the running value.
+///
+/// Each role may appear in (at most) one slot.
+///
+/// \param slot_t - a `LayerSlot` for each layer
+template<typename... slot_t>
+class LayerStack {
+public:
+    /// \brief number of layers in the stack
+    constexpr static size_t layer_count = sizeof...(slot_t);
+
+    /// \brief number of points queried from each layer at a time, by the batch `get`
+    ///
+    /// Sized so that a chunk's points (and each layer's values) stay in the L1 cache, while each layer is visited.
+    constexpr static size_t chunk_size = 256;
+
+    template<size_t index>
+    using slot_at = std::tuple_element_t<index, std::tuple<slot_t...>>;
+
+    template<size_t index>
+    using layer_at = typename slot_at<index>::layer_t;
+
+    static_assert( 0 < layer_count, "a stack needs at least one layer" );
+    static_assert( unique_roles<slot_t...>(), "each role may appear in only one slot" );
+
+public:
+    LayerStack() = default;
+
+    /// \brief true if any slot has the given role
+    constexpr static bool contains( role_t role ){
+        return ((slot_t::role == role) || ...); }
+
+    /// \brief index of the slot with the given role.  (fails to compile if there is no such slot)
+    template<role_t role>
+    constexpr static size_t index_of(){
+        static_assert( contains(role), "no layer in this stack has that role" );
+        constexpr std::array<role_t, layer_count> roles = { slot_t::role... };
+        return static_cast<size_t>( std::find( roles.begin(), roles.end(), role ) - roles.begin() );
+    }
+
+    /// \brief call `visit( slot, layer )` on each layer, in order.  `slot` is a default-constructed `LayerSlot`.
+    template<typename function_t>
+    void for_each( function_t&& visit ){
+        for_each( std::forward<function_t>(visit), std::index_sequence_for<slot_t...>{} ); }
+    template<typename function_t>
+    void for_each( function_t&& visit ) const {
+        for_each( std::forward<function_t>(visit), std::index_sequence_for<slot_t...>{} ); }
+
+    /// \brief a read-only view of every layer -- for a single query
+    ///
+    /// Each layer which offers a `Reader` (e.g. `RollingGridLayer`) is pinned to its current frame, for the life of
+    /// this reader: a frame which the writer replaces meanwhile is not freed, and its buffers are not reused.  Every
+    /// other layer is read directly.  (see: `RollingGridLayer::enable_concurrent_readers`)
+    class Reader {
+    public:
+        explicit Reader( const std::tuple<typename slot_t::layer_t...>& layers )
+            : readers_( std::apply( []( const auto&... layer ){
+                    return std::tuple<reader_t<typename slot_t::layer_t>...>( reader_of(layer)... ); }, layers ))
+        {}
+
+        /// \brief retrieve the combined value at point `p`
+        inline uint8_t get( const LocalLocation& p ) const {
+            return get( p, std::index_sequence_for<slot_t...>{} ); }
+
+        /// \brief retrieve the combined values at a batch of locations
+        ///
+        /// The points are taken a chunk at a time; each layer answers the whole chunk (through its own batch query)
+        /// before the next layer is visited.
+        ///
+        /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+        bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+            if( values.size() < points.size() ){
+                return false;
+            }
+
+            std::array<uint8_t, chunk_size> layer_values;
+            for( size_t offset = 0; offset < points.size(); offset += chunk_size ){
+                const size_t count = std::min( chunk_size, points.size() - offset );
+                const std::span<const LocalLocation> chunk_points = points.subspan( offset, count );
+                const std::span<uint8_t> chunk_values = values.subspan( offset, count );
+                std::fill( chunk_values.begin(), chunk_values.end(), clear_cell_value );
+                combine_chunk( chunk_points, chunk_values, std::span<uint8_t>( layer_values.data(), count ), std::index_sequence_for<slot_t...>{} );
+            }
+            return true;
+        }
+
+        /// \brief an upper bound on the combined value of every point in the box
+        ///
+        /// Each layer's bound (see: `bound_of`) folds by its slot's `bound` -- so a box whose bound is below a
+        /// threshold holds no point at or above it.
+        inline uint8_t max( const geometry::BoundBox<LocalLocation>& box ) const {
+            return max( box, std::index_sequence_for<slot_t...>{} ); }
+
+        /// \brief the reader of the layer in the given slot
+        template<size_t index>
+        inline const auto& at() const {
+            return std::get<index>( readers_ ); }
+
+    private:
+        template<size_t... index>
+        inline uint8_t get( const LocalLocation& p, std::index_sequence<index...> ) const {
+            uint8_t value = clear_cell_value;
+            ( (value = slot_at<index>::combine_t::combine( value, std::get<index>(readers_).get(p) )), ... );
+            return value;
+        }
+
+        template<size_t... index>
+        inline uint8_t max( const geometry::BoundBox<LocalLocation>& box, std::index_sequence<index...> ) const {
+            uint8_t value = clear_cell_value;
+            ( (value = slot_at<index>::combine_t::bound( value, bound_of( std::get<index>(readers_), box ) )), ... );
+            return value;
+        }
+
+        template<size_t... index>
+        void combine_chunk( std::span<const LocalLocation> points, std::span<uint8_t> values, std::span<uint8_t> layer_values, std::index_sequence<index...> ) const {
+            ( combine_chunk<index>( points, values, layer_values ), ... ); }
+
+        template<size_t index>
+        void combine_chunk( std::span<const LocalLocation> points, std::span<uint8_t> values, std::span<uint8_t> layer_values ) const {
+            std::get<index>(readers_).get( points, layer_values );
+            for( size_t point_index = 0; point_index < points.size(); ++point_index ){
+                values[point_index] = slot_at<index>::combine_t::combine( values[point_index], layer_values[point_index] );
+            }
+        }
+
+    private:
+        std::tuple<reader_t<typename slot_t::layer_t>...> readers_;
+    };
+
+    /// \brief start reading every layer.  (see: `Reader`)
+    inline Reader reader() const {
+        return Reader( layers_ ); }
+
+    /// \brief retrieve the combined value at point `p`
+    inline uint8_t get( const LocalLocation& p ) const {
+        return reader().get( p ); }
+
+    /// \brief retrieve the combined values at a batch of locations.  (see: `Reader::get`)
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+        return reader().get( points, values ); }
+
+    /// \brief access the layer in the given slot
+    template<size_t index>
+    inline layer_at<index>& at(){
+        return std::get<index>( layers_ ); }
+    template<size_t index>
+    inline const layer_at<index>& at() const {
+        return std::get<index>( layers_ ); }
+
+    /// \brief access the layer with the given role
+    template<role_t role>
+    inline auto& layer(){
+        return std::get<index_of<role>()>( layers_ ); }
+    template<role_t role>
+    inline const auto& layer() const {
+        return std::get<index_of<role>()>( layers_ ); }
+
+    /// \brief call `function( layer )` on the layer with the given role -- chosen at run time
+    ///
+    /// \return the result of `function`; or false, if no layer has this role
+    template<typename function_t>
+    bool visit( role_t role, function_t&& function ){
+        bool result = false;
+        for_each( [&]( auto slot, auto& layer ){
+            if( decltype(slot)::role == role ){
+                result = function( layer );
+            }
+        });
+        return result;
+    }
+
+private:
+    template<typename function_t, size_t... index>
+    void for_each( function_t&& visit, std::index_sequence<index...> ){
+        ( visit( slot_at<index>{}, std::get<index>(layers_) ), ... ); }
+    template<typename function_t, size_t... index>
+    void for_each( function_t&& visit, std::index_sequence<index...> ) const {
+        ( visit( slot_at<index>{}, std::get<index>(layers_) ), ... ); }
+
+private:
+    std::tuple<typename slot_t::layer_t...> layers_;
+};
+
+} // namespace
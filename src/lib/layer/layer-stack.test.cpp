@@ -0,0 +1,171 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "layer/composite/composite-layer.hpp"
+#include "layer/simple-grid/simple-grid-layer.hpp"
+
+#include "layer-stack.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+using chartbox::layer::block_cell_value;
+using chartbox::layer::clear_cell_value;
+using chartbox::layer::unknown_cell_value;
+
+using chartbox::layer::CombineMask;
+using chartbox::layer::CombineMax;
+using chartbox::layer::CombineOccupied;
+using chartbox::layer::CombineOverride;
+using chartbox::layer::LayerSlot;
+using chartbox::layer::LayerStack;
+using chartbox::layer::composite::CompositeLayer;
+using chartbox::layer::simple::SimpleGridLayer;
+
+namespace chartbox::layer {
+
+typedef SimpleGridLayer<uint8_t,64,1000> simple_layer_t;
+typedef CompositeLayer<64> composite_layer_t;
+
+typedef LayerStack< LayerSlot<BOUNDARY, simple_layer_t>,
+                    LayerSlot<CONTOUR, composite_layer_t>,
+                    LayerSlot<LIDAR, simple_layer_t, CombineOverride>,
+                    LayerSlot<TARGET, composite_layer_t, CombineMask> > test_stack_t;
+
+// ============ ============ LayerStack Tests  ============ ============
+
+TEST_CASE( "Combine policies" ){
+    CHECK( 0x40 == CombineMax::combine( 0x20, 0x40 ) );
+    CHECK( 0x40 == CombineMax::combine( 0x40, 0x20 ) );
+
+    CHECK( 0x20 == CombineOverride::combine( 0x40, 0x20 ) );
+    CHECK( clear_cell_value == CombineOverride::combine( block_cell_value, clear_cell_value ) );
+    CHECK( 0x40 == CombineOverride::combine( 0x40, unknown_cell_value ) );
+
+    CHECK( block_cell_value == CombineMask::combine( clear_cell_value, block_cell_value ) );
+    CHECK( 0x40 == CombineMask::combine( 0x40, clear_cell_value ) );
+    CHECK( 0x40 == CombineMask::combine( 0x40, unknown_cell_value ) );
+
+    CHECK( block_cell_value == CombineOccupied<>::combine( clear_cell_value, 198 ) );
+    CHECK( block_cell_value == CombineOccupied<>::combine( 0x40, block_cell_value ) );
+    CHECK( 0x40 == CombineOccupied<>::combine( 0x40, 197 ) );
+    CHECK( block_cell_value == CombineOccupied<>::combine( block_cell_value, 115 ) );
+    CHECK( 0x40 == CombineOccupied<>::combine( 0x40, unknown_cell_value ) );
+    CHECK( 0x40 == CombineOccupied<>::combine( 0x40, clear_cell_value ) );
+
+    // each bound holds for every lower pair of values:
+    const std::vector<uint8_t> values = { clear_cell_value, 0x40, 115, 127, unknown_cell_value, 129, 197, 198, 254, block_cell_value };
+    size_t violations = 0;
+    for( const uint8_t below : values ){
+        for( const uint8_t value : values ){
+            for( const uint8_t lower_below : values ){
+                for( const uint8_t lower_value : values ){
+                    if( (below < lower_below) || (value < lower_value) ){
+                        continue;
+                    }
+                    violations += ( CombineMax::bound( below, value ) < CombineMax::combine( lower_below, lower_value ) );
+                    violations += ( CombineOverride::bound( below, value ) < CombineOverride::combine( lower_below, lower_value ) );
+                    violations += ( CombineMask::bound( below, value ) < CombineMask::combine( lower_below, lower_value ) );
+                    violations += ( CombineOccupied<>::bound( below, value ) < CombineOccupied<>::combine( lower_below, lower_value ) );
+                }
+            }
+        }
+    }
+    CHECK( 0 == violations );
+    CHECK( block_cell_value == CombineOccupied<160>::combine( 0x40, 160 ) );
+} // TEST_CASE
+
+TEST_CASE( "LayerStack finds layers by role" ){
+    CHECK( 4 == test_stack_t::layer_count );
+    CHECK( test_stack_t::contains( CONTOUR ) );
+    CHECK_FALSE( test_stack_t::contains( RADAR ) );
+    CHECK( 0 == test_stack_t::index_of<BOUNDARY>() );
+    CHECK( 3 == test_stack_t::index_of<TARGET>() );
+
+    test_stack_t stack;
+    stack.layer<BOUNDARY>().fill( 0x11 );
+    CHECK( 0x11 == stack.layer<BOUNDARY>().get({ 3.5, 3.5 }) );
+
+    CHECK( stack.visit( LIDAR, []( auto& layer ){ return layer.fill( 0x22 ); }) );
+    CHECK( 0x22 == stack.layer<LIDAR>().get({ 3.5, 3.5 }) );
+    CHECK_FALSE( stack.visit( RADAR, []( auto& layer ){ return layer.fill( 0x22 ); }) );
+
+    std::vector<std::string> types;
+    stack.for_each( [&]( auto slot, const auto& layer ){
+        types.push_back( fmt::format( "{}:{}", role_name(decltype(slot)::role), layer.type() ) );
+    });
+    CHECK( types == std::vector<std::string>{ "Boundary:SimpleGridLayer", "Contour:CompositeLayer", "Lidar:SimpleGridLayer", "Target:CompositeLayer" } );
+} // TEST_CASE
+
+TEST_CASE( "LayerStack folds each layer, in order" ){
+    test_stack_t stack;
+    stack.layer<BOUNDARY>().fill( clear_cell_value );
+    stack.layer<CONTOUR>().fill( clear_cell_value );
+    stack.layer<LIDAR>().fill( unknown_cell_value );
+    stack.layer<TARGET>().fill( clear_cell_value );
+
+    CHECK( clear_cell_value == stack.get({ 10.5, 10.5 }) );
+
+    // max:
+    stack.layer<BOUNDARY>().store( {10.5, 10.5}, 0x30 );
+    stack.layer<CONTOUR>().store( {10.5, 10.5}, 0x60 );
+    stack.layer<CONTOUR>().store( {11.5, 10.5}, 0x20 );
+    stack.layer<BOUNDARY>().store( {11.5, 10.5}, 0x30 );
+    CHECK( 0x60 == stack.get({ 10.5, 10.5 }) );
+    CHECK( 0x30 == stack.get({ 11.5, 10.5 }) );
+
+    // override -- except where unknown:
+    stack.layer<LIDAR>().store( {10.5, 10.5}, 0x10 );
+    CHECK( 0x10 == stack.get({ 10.5, 10.5 }) );
+    CHECK( 0x30 == stack.get({ 11.5, 10.5 }) );
+
+    // mask -- only where blocked:
+    stack.layer<TARGET>().store( {10.5, 10.5}, 0x40 );
+    stack.layer<TARGET>().store( {11.5, 10.5}, block_cell_value );
+    CHECK( 0x10 == stack.get({ 10.5, 10.5 }) );
+    CHECK( block_cell_value == stack.get({ 11.5, 10.5 }) );
+} // TEST_CASE
+
+TEST_CASE( "LayerStack batch query matches single-point queries" ){
+    test_stack_t stack;
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> location_distribution( 0, 63.9 );
+    std::uniform_int_distribution<int> value_distribution( 0, 255 );
+
+    // random content in every layer; the lidar layer is mostly unknown, and the targets are mostly clear:
+    stack.layer<BOUNDARY>().fill( clear_cell_value );
+    stack.layer<CONTOUR>().fill( clear_cell_value );
+    stack.layer<LIDAR>().fill( unknown_cell_value );
+    stack.layer<TARGET>().fill( clear_cell_value );
+    stack.for_each( [&]( auto slot, auto& layer ){
+        const size_t count = (BOUNDARY == decltype(slot)::role || CONTOUR == decltype(slot)::role) ? 64*64 : 256;
+        for( size_t i = 0; i < count; ++i ){
+            const LocalLocation p( location_distribution(generator), location_distribution(generator) );
+            layer.store( p, static_cast<uint8_t>(value_distribution(generator)) );
+        }
+    });
+
+    // (not a whole number of chunks)
+    const size_t point_count = 3 * test_stack_t::chunk_size + 17;
+    std::vector<LocalLocation> points;
+    for( size_t i = 0; i < point_count; ++i ){
+        points.emplace_back( location_distribution(generator), location_distribution(generator) );
+    }
+
+    std::vector<uint8_t> values( point_count );
+    REQUIRE( stack.get( points, values ) );
+    for( size_t i = 0; i < point_count; ++i ){
+        REQUIRE( stack.get( points[i] ) == values[i] );
+    }
+
+    std::vector<uint8_t> short_values( point_count - 1 );
+    CHECK_FALSE( stack.get( points, short_values ) );
+} // TEST_CASE
+
+}   // namespace
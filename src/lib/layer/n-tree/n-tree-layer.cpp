@@ -0,0 +1,245 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include <fmt/core.h>
+
+#include "geometry/local-location.hpp"
+
+#include "n-tree-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+namespace chartbox::layer::ntree {
+
+template<uint32_t n>
+NTreeLayer<n>::NTreeLayer()
+    : view_bounds_( {0,0}, {static_cast<double>(dimension), static_cast<double>(dimension)} )
+    , precision_( 1.0 )
+{
+    reset();
+}
+
+template<uint32_t n>
+NTreeLayer<n>::NTreeLayer( const LocalLocation& center, double width )
+    : view_bounds_( center - LocalLocation(width/2), center + (width/2) )
+    , precision_( width/dimension )
+{
+    reset();
+}
+
+template<uint32_t n>
+uint32_t NTreeLayer<n>::build( const uint8_t* const buffer, uint32_t level, uint32_t column, uint32_t row ){
+    if( (levels - 1) == level ){
+        const uint8_t* const first = buffer + column + row*dimension;
+        bool is_uniform = true;
+        for( uint32_t j = 0; is_uniform && (j < n); ++j ){
+            const uint8_t* const each = first + j*dimension;
+            is_uniform = (first[0] == each[0]) && (0 == std::memcmp( each, each + 1, n - 1 ));
+        }
+        if( is_uniform ){
+            return uniform( first[0] );
+        }
+
+        const uint32_t index = leaves_.allocate();
+        for( uint32_t j = 0; j < n; ++j ){
+            std::memcpy( leaves_[index].data() + j*n, first + j*dimension, n );
+        }
+        return index;
+    }
+
+    const uint32_t child_across = cells_across_child( level );
+    Branch children;
+    for( uint32_t j = 0; j < n; ++j ){
+        for( uint32_t i = 0; i < n; ++i ){
+            children[i + j*n] = build( buffer, level + 1, column + i*child_across, row + j*child_across );
+        }
+    }
+    if( (uniform_flag & children[0]) && (0 == std::memcmp( children.data(), children.data() + 1, sizeof(uint32_t)*(n*n - 1) )) ){
+        return children[0];
+    }
+    return branches_.allocate( children );
+}
+
+template<uint32_t n>
+bool NTreeLayer<n>::fill( uint8_t value ){
+    branches_.reset();
+    leaves_.reset();
+    root_.fill( uniform(value) );
+    return true;
+}
+
+template<uint32_t n>
+bool NTreeLayer<n>::fill( const uint8_t* const buffer, size_t count ){
+    if( (dimension * dimension) != count ){
+        return false;
+    }
+    branches_.reset();
+    leaves_.reset();
+
+    const uint32_t child_across = cells_across_child( 0 );
+    for( uint32_t j = 0; j < root_across; ++j ){
+        for( uint32_t i = 0; i < root_across; ++i ){
+            root_[i + j*root_across] = build( buffer, 1, i*child_across, j*child_across );
+        }
+    }
+    return true;
+}
+
+template<uint32_t n>
+bool NTreeLayer<n>::get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+    if( values.size() < points.size() ){
+        return false;
+    }
+
+    for( size_t point_index = 0; point_index < points.size(); ++point_index ){
+        values[point_index] = get( points[point_index] );
+    }
+    return true;
+}
+
+template<uint32_t n>
+size_t NTreeLayer<n>::memory_usage() const {
+    return sizeof(root_) + branches_.size() * sizeof(Branch) + leaves_.size() * sizeof(Leaf);
+}
+
+template<uint32_t n>
+void NTreeLayer<n>::prune(){
+    for( auto& reference : root_ ){
+        prune( reference, 1 );
+    }
+}
+
+template<uint32_t n>
+void NTreeLayer<n>::prune( uint32_t& reference, uint32_t level ){
+    if( uniform_flag & reference ){
+        return;
+    }
+
+    if( (levels - 1) == level ){
+        const uint8_t* const cells = leaves_[reference].data();
+        if( 0 == std::memcmp( cells, cells + 1, n*n - 1 ) ){
+            const uint32_t merged = uniform( cells[0] );
+            leaves_.release( reference );
+            reference = merged;
+        }
+        return;
+    }
+
+    Branch& children = branches_[reference];
+    for( auto& child : children ){
+        prune( child, level + 1 );
+    }
+    if( (uniform_flag & children[0]) && (0 == std::memcmp( children.data(), children.data() + 1, sizeof(uint32_t)*(n*n - 1) )) ){
+        const uint32_t merged = children[0];
+        branches_.release( reference );
+        reference = merged;
+    }
+}
+
+template<uint32_t n>
+uint8_t* NTreeLayer<n>::split_to( uint32_t column, uint32_t row, uint8_t value ){
+    uint32_t* reference = &root_[ slot(column, row, 0) ];
+    for( uint32_t level = 1; level < levels; ++level ){
+        if( uniform_flag & *reference ){
+            const uint8_t previous = static_cast<uint8_t>( *reference );
+            if( value == previous ){
+                return nullptr;
+            }else if( level < (levels - 1) ){
+                const uint32_t index = branches_.allocate();
+                branches_[index].fill( uniform(previous) );
+                *reference = index;
+            }else{
+                const uint32_t index = leaves_.allocate();
+                leaves_[index].fill( previous );
+                *reference = index;
+            }
+        }
+
+        if( level < (levels - 1) ){
+            reference = &branches_[*reference][ slot(column, row, level) ];
+        }
+    }
+    return leaves_[*reference].data() + slot( column, row, levels - 1 );
+}
+
+template<uint32_t n>
+bool NTreeLayer<n>::store( const LocalLocation& p, uint8_t value ){
+    if( visible(p) ){
+        const LocalLocation relative = p - view_bounds_.min;
+        return store_span( to_cell(relative.northing), to_cell(relative.easting), to_cell(relative.easting), value );
+    }
+    return false;
+}
+
+template<uint32_t n>
+bool NTreeLayer<n>::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+    if( (dimension <= row) || (dimension <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min<uint32_t>( last_column, dimension - 1 );
+
+    // one descent per leaf, along the span:
+    for( uint32_t column = first_column; column <= last_column; ){
+        const uint32_t leaf_last_column = std::min( last_column, column | (n - 1) );
+        uint8_t* const cells = split_to( column, row, value );
+        if( nullptr != cells ){
+            std::memset( cells, value, leaf_last_column - column + 1 );
+        }
+        column = leaf_last_column + 1;
+    }
+    return true;
+}
+
+template<uint32_t n>
+std::string NTreeLayer<n>::to_cell_content_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= ======= Print Contents By Cell: ======= ======= =======\n";
+    for (uint32_t cell_row_index = dimension - 1; cell_row_index < dimension; --cell_row_index) {
+        buf << prefix << "    ";
+        for (uint32_t cell_column_index = 0; cell_column_index < dimension; ++cell_column_index ) {
+            buf << fmt::format(" {:2X}", cell(cell_column_index, cell_row_index) );
+        }
+        buf << '\n';
+    }
+    buf << prefix << "======== ======= ======= ======= ======= ======= ======= =======\n";
+    return buf.str();
+}
+
+template<uint32_t n>
+std::string NTreeLayer<n>::to_property_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= Properties: ======= =======\n";
+    buf << fmt::format( "{}    ::bounds-min:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.min.easting, view_bounds_.min.northing );
+    buf << fmt::format( "{}    ::bounds-max:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.max.easting, view_bounds_.max.northing );
+    buf << fmt::format( "{}    ::cells-across-view:      {:6d}\n", prefix, dimension );
+    buf << fmt::format( "{}    ::children-across-node:   {:6d}\n", prefix, n );
+    buf << fmt::format( "{}    ::meters-across-cell:     {:6.1f}\n", prefix, precision_ );
+    buf << fmt::format( "{}    ::levels:                 {:6d}\n", prefix, levels );
+    buf << fmt::format( "{}    ::branch-count:           {:6d}\n", prefix, branch_count() );
+    buf << fmt::format( "{}    ::leaf-count:             {:6d}\n", prefix, leaf_count() );
+    return buf.str();
+}
+
+template<uint32_t n>
+bool NTreeLayer<n>::view( const BoundBox<LocalLocation>& box ){
+    if( (box.width() > width()) || (box.height() > width()) ){
+        return false;
+    }
+
+    view_bounds_.min = box.min;
+    view_bounds_.max = box.min + width();
+    return true;
+}
+
+} // namespace chartbox::layer::ntree
+
+// explicit class template instantiation
+template class chartbox::layer::ntree::NTreeLayer<16u>;
+template class chartbox::layer::ntree::NTreeLayer<32u>;
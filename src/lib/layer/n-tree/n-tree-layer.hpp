@@ -0,0 +1,239 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "layer/layer-interface.hpp"
+#include "layer/node-arena.hpp"
+
+namespace chartbox::layer::ntree {
+
+/// \brief Wide tree for representing 2D data: each node splits its area `across x across` ways
+///
+/// A 16-tree (`across` = 16) covers a 1024-wide chart in 3 levels; a 32-tree, in 2.  The root takes whichever bits
+/// of the cell index the other levels leave over.  Every level below the root is a node from an arena:
+///   - branch nodes hold `across x across` child references, of 32 bits each
+///   - leaf nodes (the last level) hold `across x across` cells, of 8 bits each
+///
+/// A child reference is either the index of a node on the next level, or -- with `uniform_flag` set -- the value of
+/// an entire uniform subtree.  So a lookup indexes at most one array per level, and stops early at any uniform subtree.
+///
+/// \param across_ number of children across each node.  (The tree's branching factor is `across_ * across_`)
+template<uint32_t across_>
+class NTreeLayer final : public LayerInterface<NTreeLayer<across_>> {
+public:
+
+    /// \brief number of cells along each dimension of the entire tree
+    constexpr static uint32_t dimension = 1024;
+
+    constexpr static uint32_t across = across_;
+
+    static_assert( std::has_single_bit(across_) && (2 <= across_) && (across_ < dimension), "each node must evenly divide the tree" );
+
+    /// \brief number of bits of a cell's column (or row) which are resolved at each level
+    constexpr static uint32_t bits_per_level = std::countr_zero( across_ );
+
+    /// \brief number of levels, including the root, and the leaves
+    constexpr static uint32_t levels = (std::countr_zero(dimension) + bits_per_level - 1) / bits_per_level;
+
+    /// \brief number of children across the root
+    constexpr static uint32_t root_across = 1u << (std::countr_zero(dimension) - bits_per_level*(levels - 1));
+
+    /// \brief set on a child reference to a uniform subtree; the low byte holds the subtree's value
+    constexpr static uint32_t uniform_flag = 0x80000000;
+
+    /// \brief name of this layer's type
+    constexpr static char type_name_[] = "NTreeLayer";
+
+    typedef std::array<uint32_t, across_*across_> Branch;
+    typedef std::array<uint8_t, across_*across_> Leaf;
+
+public:
+    /// \brief Constructs a new tree, with its south-west corner at 0,0 and 1024 units wide, square
+    NTreeLayer();
+
+    /// \brief Constructs a new tree
+    ///
+    /// \param center - coordinates of the tree's center point
+    /// \param width - width of the tree.  The tree is square
+    NTreeLayer( const geometry::LocalLocation& center, double width );
+
+    ~NTreeLayer() = default;
+
+    /// \brief number of branch nodes in the tree.  (not including the root)
+    inline size_t branch_count() const {
+        return branches_.size(); }
+
+    /// \brief value of the cell at (column, row); both must be less than `dimension`
+    inline uint8_t cell( uint32_t column, uint32_t row ) const {
+        uint32_t reference = root_[ slot(column, row, 0) ];
+        for( uint32_t level = 1; level < (levels - 1); ++level ){
+            if( uniform_flag & reference ){
+                return static_cast<uint8_t>( reference );
+            }
+            reference = branches_[reference][ slot(column, row, level) ];
+        }
+        if( uniform_flag & reference ){
+            return static_cast<uint8_t>( reference );
+        }
+        return leaves_[reference][ slot(column, row, levels - 1) ];
+    }
+
+    inline uint32_t cells_across_view() const { return dimension; }
+
+    bool contains(const geometry::LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+    /// \brief release every node, and set every cell to the given value
+    bool fill( uint8_t value );
+
+    /// \brief build the tree from a dense grid of cells
+    ///
+    /// \param buffer - `dimension` x `dimension` cells; row-major, from the south-west corner
+    /// \param count - cell count of the buffer
+    /// \return false if the buffer is the wrong size
+    bool fill( const uint8_t* const buffer, size_t count );
+
+    // each bulk fill prunes the tree, once it is written
+    bool fill( const Path<LocalLocation>& path, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+        const bool result = super().fill( path, bounds, value );
+        prune();
+        return result;
+    }
+
+    bool fill( const BoundBox<LocalLocation>& box, const uint8_t value ){
+        const bool result = super().fill( box, value );
+        prune();
+        return result;
+    }
+
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
+        const bool result = super().fill( poly, bound, value );
+        prune();
+        return result;
+    }
+
+    inline uint8_t get( const geometry::LocalLocation& p ) const {
+        if( visible(p) ){
+            const LocalLocation relative = p - view_bounds_.min;
+            return cell( to_cell(relative.easting), to_cell(relative.northing) );
+        }
+        return default_cell_value;
+    }
+
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const;
+
+    /// \brief number of levels below the root; the most that any lookup descends
+    constexpr uint32_t height() const {
+        return levels - 1; }
+
+    /// \brief number of leaf nodes (dense blocks of cells) in the tree
+    inline size_t leaf_count() const {
+        return leaves_.size(); }
+
+    /// \brief bytes held by the root, and the nodes in use
+    size_t memory_usage() const;
+
+    inline double meters_across_cell() const { return precision_; }
+
+    double precision() const {
+        return precision_; }
+
+    /// \brief collapse every uniform leaf, and every branch of matching uniform children, into its parent's reference
+    void prune();
+
+    inline void reset(){
+        fill( default_cell_value ); }
+
+    /// \brief store a value at point `p`.  (Unlike the bulk fills, this does not prune the tree)
+    ///
+    /// \return false if `p` is outside the tree
+    bool store( const geometry::LocalLocation& p, uint8_t value );
+
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value );
+
+    std::string to_cell_content_string( uint32_t indent = 0 ) const;
+    std::string to_location_content_string( uint32_t indent = 0 ) const { return super().to_location_content_string(indent); }
+    std::string to_property_string( uint32_t indent = 0 ) const;
+
+    /// \brief this layer does not scroll; see: `view`
+    bool track( const BoundBox<LocalLocation>& /*bounds*/ ){
+        return false; }
+    const BoundBox<LocalLocation>& tracked() const {
+        return visible(); }
+    bool tracked(const LocalLocation& p) const {
+        return visible(p); }
+
+    /// \brief move the tree to the given bounds.  (the width of the tree is unchanged)
+    bool view( const BoundBox<LocalLocation>& box );
+    const BoundBox<LocalLocation>& visible() const {
+        return view_bounds_; }
+    bool visible(const LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+    double width() const {
+        return view_bounds_.width(); }
+
+private:
+    /// \brief reference to a uniform subtree
+    constexpr static uint32_t uniform( uint8_t value ){
+        return uniform_flag | value; }
+
+    /// \brief number of cells across each child of a node on the given level
+    constexpr static uint32_t cells_across_child( uint32_t level ){
+        return 1u << (bits_per_level * (levels - 1 - level)); }
+
+    /// \brief offset of the child (or cell) holding (column, row), within a node on the given level
+    constexpr static uint32_t slot( uint32_t column, uint32_t row, uint32_t level ){
+        const uint32_t shift = bits_per_level * (levels - 1 - level);
+        const uint32_t width = (0 == level) ? root_across : across_;
+        return ((column >> shift) & (width - 1)) + ((row >> shift) & (width - 1)) * width;
+    }
+
+    uint32_t build( const uint8_t* const buffer, uint32_t level, uint32_t column, uint32_t row );
+
+    void prune( uint32_t& reference, uint32_t level );
+
+    /// \brief descend to the leaf holding the cell at (column, row), splitting any uniform subtree on the way
+    ///
+    /// \return the cell; or nullptr, if the cell is in a uniform subtree which already holds `value`
+    uint8_t* split_to( uint32_t column, uint32_t row, uint8_t value );
+
+    /// \brief cell index along one axis.  (points on the max-border are clamped inside the tree)
+    inline uint32_t to_cell( double meters ) const {
+        return std::min( static_cast<uint32_t>( meters / precision_ ), dimension - 1 ); }
+
+private:
+    // this tracks the bounds of the visible grid
+    geometry::BoundBox<LocalLocation> view_bounds_;
+    double precision_;
+
+    std::array<uint32_t, root_across*root_across> root_;
+
+    NodeArena<Branch, 4> branches_;
+    NodeArena<Leaf, 6> leaves_;
+
+private:
+    LayerInterface<NTreeLayer<across_>>& super() {
+        return *static_cast< LayerInterface<NTreeLayer<across_>>* >(this);
+    }
+
+    const LayerInterface<NTreeLayer<across_>>& super() const {
+        return *static_cast< const LayerInterface<NTreeLayer<across_>>* >(this);
+    }
+};
+
+} // namespace chartbox::layer::ntree
@@ -0,0 +1,160 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "n-tree-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+using chartbox::layer::ntree::NTreeLayer;
+
+namespace chartbox::layer {
+
+// ============ ============ NTreeLayer Tests  ============ ============
+
+TEST_CASE( "NTreeLayer resolves a 1024-wide chart in a few levels" ){
+    CHECK( NTreeLayer<16>::levels == 3 );
+    CHECK( NTreeLayer<16>::root_across == 4 );
+    CHECK( NTreeLayer<32>::levels == 2 );
+    CHECK( NTreeLayer<32>::root_across == 32 );
+
+    NTreeLayer<16> tree;
+    CHECK( tree.branch_count() == 0 );
+    CHECK( tree.leaf_count() == 0 );
+    CHECK( tree.height() == 2 );
+    CHECK( tree.precision() == Approx(1.0) );
+
+    CHECK( tree.get({   0.5,    0.5}) == default_cell_value );
+    CHECK( tree.get({1023.5, 1023.5}) == default_cell_value );
+    CHECK( tree.get({  -0.5,    0.5}) == default_cell_value );
+} // TEST_CASE
+
+TEST_CASE( "NTreeLayer splits down to a single leaf" ){
+    NTreeLayer<16> tree;
+    tree.fill( clear_cell_value );
+
+    REQUIRE( tree.store({ 40.5, 70.5}, 0x42 ) );
+    REQUIRE_FALSE( tree.store({ -1, 70.5}, 0x42 ) );
+    CHECK( tree.get({ 40.5, 70.5}) == 0x42 );
+    CHECK( tree.get({ 39.5, 70.5}) == clear_cell_value );
+    CHECK( tree.get({ 40.5, 71.5}) == clear_cell_value );
+
+    // root => one branch => one leaf
+    CHECK( tree.branch_count() == 1 );
+    CHECK( tree.leaf_count() == 1 );
+
+    SECTION( "writing a uniform subtree's own value does not split it" ){
+        REQUIRE( tree.store({ 900.5, 900.5}, clear_cell_value ) );
+        CHECK( tree.branch_count() == 1 );
+        CHECK( tree.leaf_count() == 1 );
+    }
+
+    SECTION( "a span is written across neighboring leaves" ){
+        REQUIRE( tree.store_span( 70, 10, 50, 0x43 ) );
+        CHECK( tree.leaf_count() == 4 );
+        CHECK( tree.get({  9.5, 70.5}) == clear_cell_value );
+        CHECK( tree.get({ 10.5, 70.5}) == 0x43 );
+        CHECK( tree.get({ 50.5, 70.5}) == 0x43 );
+        CHECK( tree.get({ 51.5, 70.5}) == clear_cell_value );
+    }
+
+    SECTION( "pruning collapses the tree, once the leaf is uniform again" ){
+        tree.prune();
+        CHECK( tree.leaf_count() == 1 );
+        REQUIRE( tree.store({ 40.5, 70.5}, clear_cell_value ) );
+        tree.prune();
+        CHECK( tree.branch_count() == 0 );
+        CHECK( tree.leaf_count() == 0 );
+    }
+
+    SECTION( "refilling releases every node at once" ){
+        tree.fill( block_cell_value );
+        CHECK( tree.branch_count() == 0 );
+        CHECK( tree.leaf_count() == 0 );
+        CHECK( tree.get({ 40.5, 70.5}) == block_cell_value );
+    }
+} // TEST_CASE
+
+TEST_CASE( "NTreeLayer builds from a dense grid" ){
+    constexpr uint32_t dimension = NTreeLayer<16>::dimension;
+    std::vector<uint8_t> grid( dimension * dimension, clear_cell_value );
+    // a block, aligned to the root's children:
+    for( uint32_t row = 256; row < 512; ++row ){
+        std::fill_n( grid.data() + row*dimension + 256, 256, block_cell_value );
+    }
+    // ... and some noise, in a 64x64 block
+    std::mt19937 generator( 55 );
+    std::uniform_int_distribution<int> distribution( 0, 255 );
+    for( uint32_t row = 640; row < 704; ++row ){
+        for( uint32_t column = 832; column < 896; ++column ){
+            grid[column + row*dimension] = static_cast<uint8_t>( distribution(generator) );
+        }
+    }
+
+    NTreeLayer<16> narrow;
+    REQUIRE_FALSE( narrow.fill( grid.data(), grid.size() - 1 ) );
+    REQUIRE( narrow.fill( grid.data(), grid.size() ) );
+    CHECK( narrow.branch_count() == 1 );
+    CHECK( narrow.leaf_count() == 16 );
+
+    NTreeLayer<32> wide;
+    REQUIRE( wide.fill( grid.data(), grid.size() ) );
+    CHECK( wide.branch_count() == 0 );
+    CHECK( wide.leaf_count() == 4 );
+
+    for( uint32_t row = 0; row < dimension; ++row ){
+        for( uint32_t column = 0; column < dimension; ++column ){
+            REQUIRE( narrow.cell(column, row) == grid[column + row*dimension] );
+            REQUIRE( wide.cell(column, row) == grid[column + row*dimension] );
+        }
+    }
+
+    // an already-minimal tree does not change:
+    narrow.prune();
+    CHECK( narrow.branch_count() == 1 );
+    CHECK( narrow.leaf_count() == 16 );
+} // TEST_CASE
+
+TEST_CASE( "NTreeLayer fills shapes, as a grid does" ){
+    NTreeLayer<16> tree( {0, 0}, 256 );
+    REQUIRE( tree.precision() == Approx(0.25) );
+    REQUIRE( tree.visible().min.easting == Approx(-128) );
+    tree.fill( clear_cell_value );
+
+    const BoundBox<LocalLocation> box( {-32.1, -16.1}, {48.1, 8.1} );
+    REQUIRE( tree.fill( box, block_cell_value ) );
+    CHECK( tree.get({0, 0}) == block_cell_value );
+    CHECK( tree.get({-40, 0}) == clear_cell_value );
+
+    const Polygon<LocalLocation> diamond( {{0, 100}, {100, 0}, {0, -100}, {-100, 0}, {0, 100}} );
+    REQUIRE( tree.fill( diamond, tree.visible(), 0x42 ) );
+
+    for( double northing = -127.875; northing < 128; northing += 1.5 ){
+        for( double easting = -127.875; easting < 128; easting += 1.5 ){
+            const double distance = std::abs(easting) + std::abs(northing);
+            if( distance < 99 ){
+                REQUIRE( tree.get({easting, northing}) == 0x42 );
+            }else if( 101 < distance ){
+                REQUIRE( tree.get({easting, northing}) == clear_cell_value );
+            }
+        }
+    }
+    // only the diamond's edge needs leaves:
+    const size_t leaf_total = (NTreeLayer<16>::dimension / 16) * (NTreeLayer<16>::dimension / 16);
+    CHECK( tree.leaf_count() < (leaf_total / 4) );
+
+    // erasing the shape leaves only the background:
+    tree.fill( diamond, tree.visible(), clear_cell_value );
+    CHECK( tree.branch_count() == 0 );
+    CHECK( tree.leaf_count() == 0 );
+} // TEST_CASE
+
+}   // namespace
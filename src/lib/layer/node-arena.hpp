@@ -0,0 +1,93 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chartbox::layer {
+
+/// \brief pool of nodes, addressed by index
+///
+/// Nodes are carved out of fixed-size, cache-line-aligned chunks -- so a node never moves, and an index is only
+/// 32 bits.  Released nodes are recycled before the arena grows.  Nodes must be trivially destructible: `reset`
+/// drops every node at once, in O(1), and keeps the chunks for reuse.
+///
+/// \param node_t type of each node
+/// \param chunk_bits log2 of the node count in each chunk
+template<typename node_t, uint32_t chunk_bits>
+class NodeArena {
+public:
+    static_assert( std::is_trivially_destructible_v<node_t>, "`reset` releases nodes without destroying them" );
+
+    constexpr static size_t chunk_alignment = 64;
+    constexpr static uint32_t nodes_per_chunk = (1u << chunk_bits);
+    constexpr static size_t bytes_per_chunk = ((sizeof(node_t) * nodes_per_chunk + chunk_alignment - 1) / chunk_alignment) * chunk_alignment;
+
+public:
+    NodeArena() = default;
+
+    NodeArena( const NodeArena& ) = delete;
+    NodeArena& operator=( const NodeArena& ) = delete;
+
+    /// \brief construct a new node; and return its index
+    template<typename... args_t>
+    uint32_t allocate( args_t&&... args ){
+        uint32_t index;
+        if( free_.empty() ){
+            index = next_++;
+            if( chunks_.size() <= (index >> chunk_bits) ){
+                chunks_.emplace_back( static_cast<node_t*>( std::aligned_alloc(chunk_alignment, bytes_per_chunk) ) );
+            }
+        }else{
+            index = free_.back();
+            free_.pop_back();
+        }
+        new ( &(*this)[index] ) node_t( std::forward<args_t>(args)... );
+        return index;
+    }
+
+    /// \brief bytes held by the arena: every chunk, whether or not its nodes are in use
+    inline size_t capacity() const {
+        return chunks_.size() * bytes_per_chunk; }
+
+    /// \brief return a single node to the arena, for reuse
+    inline void release( uint32_t index ){
+        free_.push_back( index ); }
+
+    /// \brief release every node at once.
+    inline void reset(){
+        next_ = 0;
+        free_.clear();
+    }
+
+    /// \brief number of nodes in use
+    inline size_t size() const {
+        return next_ - free_.size(); }
+
+    inline node_t& operator[]( uint32_t index ){
+        return chunks_[index >> chunk_bits][index & (nodes_per_chunk - 1)]; }
+
+    inline const node_t& operator[]( uint32_t index ) const {
+        return chunks_[index >> chunk_bits][index & (nodes_per_chunk - 1)]; }
+
+private:
+    struct AlignedFree {
+        void operator()( node_t* chunk ) const { std::free( chunk ); }
+    };
+
+    std::vector<std::unique_ptr<node_t[], AlignedFree>> chunks_;
+
+    /// \brief every index below this has been handed out at least once
+    uint32_t next_ = 0;
+
+    /// \brief released indices, below `next_`
+    std::vector<uint32_t> free_;
+};
+
+} // namespace
@@ -0,0 +1,48 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "node-arena.hpp"
+
+using chartbox::layer::NodeArena;
+
+namespace chartbox::layer {
+
+// a trivially destructible stand-in for a tree node
+typedef std::array<uint32_t,8> TestNode;
+
+TEST_CASE( "NodeArena allocates, recycles, and resets" ){
+    NodeArena<TestNode,2> arena;
+    CHECK( arena.size() == 0 );
+    CHECK( arena.capacity() == 0 );
+
+    for( uint32_t i = 0; i < 9; ++i ){
+        CHECK( i == arena.allocate( TestNode{ i } ) );
+    }
+    CHECK( arena.size() == 9 );
+    // three chunks, of four nodes each:
+    CHECK( arena.capacity() == 3 * NodeArena<TestNode,2>::bytes_per_chunk );
+    CHECK( 5 == arena[5][0] );
+
+    // nodes do not move as the arena grows
+    const TestNode* first = &arena[0];
+    arena.allocate();
+    arena.allocate();
+    arena.allocate();
+    CHECK( first == &arena[0] );
+
+    arena.release( 4 );
+    CHECK( arena.size() == 11 );
+    CHECK( 4 == arena.allocate() );
+
+    arena.reset();
+    CHECK( arena.size() == 0 );
+    CHECK( arena.capacity() == 3 * NodeArena<TestNode,2>::bytes_per_chunk );
+    CHECK( 0 == arena.allocate() );
+} // TEST_CASE
+
+} // namespace
@@ -0,0 +1,251 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <fmt/core.h>
+
+#include "geometry/local-location.hpp"
+
+#include "packed-grid-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+namespace chartbox::layer::packed {
+
+namespace {
+
+/// \brief bits of the cells from `column` to the end of its word
+constexpr uint64_t from_mask( uint32_t column ){
+    return ~0ull << (2*(column % 32)); }
+
+/// \brief bits of the cells from the start of its word, through `column`
+constexpr uint64_t through_mask( uint32_t column ){
+    return ~0ull >> (62 - 2*(column % 32)); }
+
+void fill_words( uint64_t* words, size_t count, uint64_t pattern ){
+    size_t index = 0;
+#if defined(__AVX2__)
+    const __m256i wide_pattern = _mm256_set1_epi64x( static_cast<long long>(pattern) );
+    for( ; (index + 4) <= count; index += 4 ){
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>(words + index), wide_pattern );
+    }
+#endif
+    for( ; index < count; ++index ){
+        words[index] = pattern;
+    }
+}
+
+bool any_words( const uint64_t* words, size_t count, uint64_t mask ){
+    size_t index = 0;
+#if defined(__AVX2__)
+    const __m256i wide_mask = _mm256_set1_epi64x( static_cast<long long>(mask) );
+    for( ; (index + 4) <= count; index += 4 ){
+        if( 0 == _mm256_testz_si256( _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + index)), wide_mask ) ){
+            return true;
+        }
+    }
+#endif
+    for( ; index < count; ++index ){
+        if( 0 != (words[index] & mask) ){
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+template<uint32_t d>
+PackedGridLayer<d>::PackedGridLayer()
+    : view_bounds_( {0,0}, {static_cast<double>(dimension), static_cast<double>(dimension)} )
+    , precision_( 1.0 )
+    , cells_( dimension * words_per_row )
+{
+    reset();
+}
+
+template<uint32_t d>
+PackedGridLayer<d>::PackedGridLayer( const LocalLocation& center, double width )
+    : view_bounds_( center - LocalLocation(width/2), center + (width/2) )
+    , precision_( width/dimension )
+    , cells_( dimension * words_per_row )
+{
+    reset();
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::all_clear( const BoundBox<LocalLocation>& box ) const {
+    return view_bounds_.overlaps( box ) && (not any( box, ~0ull ));
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::any( uint32_t row, uint32_t first_column, uint32_t last_column, uint64_t mask ) const {
+    const uint64_t* const words = cells_.data() + row*words_per_row;
+    const uint32_t first_word = first_column / cells_per_word;
+    const uint32_t last_word = last_column / cells_per_word;
+    if( first_word == last_word ){
+        return 0 != (words[first_word] & from_mask(first_column) & through_mask(last_column) & mask);
+    }
+
+    return (0 != (words[first_word] & from_mask(first_column) & mask))
+        || (0 != (words[last_word] & through_mask(last_column) & mask))
+        || any_words( words + first_word + 1, last_word - first_word - 1, mask );
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::any( const BoundBox<LocalLocation>& box, uint64_t mask ) const {
+    if( not view_bounds_.overlaps( box ) ){
+        return false;
+    }
+
+    // view-relative cells covered by the box:
+    const uint32_t first_column = to_cell( std::max(box.min.easting, view_bounds_.min.easting) - view_bounds_.min.easting );
+    const uint32_t last_column = to_cell( std::min(box.max.easting, view_bounds_.max.easting) - view_bounds_.min.easting );
+    const uint32_t first_row = to_cell( std::max(box.min.northing, view_bounds_.min.northing) - view_bounds_.min.northing );
+    const uint32_t last_row = to_cell( std::min(box.max.northing, view_bounds_.max.northing) - view_bounds_.min.northing );
+
+    for( uint32_t row = first_row; row <= last_row; ++row ){
+        if( any( row, first_column, last_column, mask ) ){
+            return true;
+        }
+    }
+    return false;
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::any_blocked( const BoundBox<LocalLocation>& box ) const {
+    return any( box, block_mask );
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::any_blocked( uint32_t row, uint32_t first_column, uint32_t last_column ) const {
+    if( (dimension <= row) || (dimension <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    return any( row, first_column, std::min<uint32_t>( last_column, dimension - 1 ), block_mask );
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::fill( uint8_t value ){
+    fill_words( cells_.data(), cells_.size(), replicate(encode(value)) );
+    return true;
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::fill( const uint8_t* const buffer, size_t count ){
+    if( (dimension * dimension) != count ){
+        return false;
+    }
+
+    for( size_t word_index = 0; word_index < cells_.size(); ++word_index ){
+        const uint8_t* const each = buffer + word_index*cells_per_word;
+        uint64_t packed = 0;
+        for( uint32_t offset = 0; offset < cells_per_word; ++offset ){
+            packed |= encode( each[offset] ) << (2*offset);
+        }
+        cells_[word_index] = packed;
+    }
+    return true;
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+    if( values.size() < points.size() ){
+        return false;
+    }
+
+    for( size_t point_index = 0; point_index < points.size(); ++point_index ){
+        values[point_index] = get( points[point_index] );
+    }
+    return true;
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::store( const LocalLocation& p, uint8_t value ){
+    if( visible(p) ){
+        const LocalLocation relative = p - view_bounds_.min;
+        const uint32_t column = to_cell( relative.easting );
+        uint64_t& word = cells_[ to_cell(relative.northing)*words_per_row + column/cells_per_word ];
+        const uint32_t shift = 2*(column % cells_per_word);
+        word = (word & ~(0b11ull << shift)) | (encode(value) << shift);
+        return true;
+    }
+    return false;
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+    if( (dimension <= row) || (dimension <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min<uint32_t>( last_column, dimension - 1 );
+
+    uint64_t* const words = cells_.data() + row*words_per_row;
+    const uint64_t pattern = replicate( encode(value) );
+    const uint32_t first_word = first_column / cells_per_word;
+    const uint32_t last_word = last_column / cells_per_word;
+    const auto blend = [&]( uint64_t& word, uint64_t mask ){
+        word = (word & ~mask) | (pattern & mask); };
+
+    if( first_word == last_word ){
+        blend( words[first_word], from_mask(first_column) & through_mask(last_column) );
+        return true;
+    }
+    blend( words[first_word], from_mask(first_column) );
+    fill_words( words + first_word + 1, last_word - first_word - 1, pattern );
+    blend( words[last_word], through_mask(last_column) );
+    return true;
+}
+
+template<uint32_t d>
+std::string PackedGridLayer<d>::to_cell_content_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= ======= Print Contents By Cell: ======= ======= =======\n";
+    for (uint32_t cell_row_index = dimension - 1; cell_row_index < dimension; --cell_row_index) {
+        buf << prefix << "    ";
+        for (uint32_t cell_column_index = 0; cell_column_index < dimension; ++cell_column_index ) {
+            buf << fmt::format(" {:2X}", cell(cell_column_index, cell_row_index) );
+        }
+        buf << '\n';
+    }
+    buf << prefix << "======== ======= ======= ======= ======= ======= ======= =======\n";
+    return buf.str();
+}
+
+template<uint32_t d>
+std::string PackedGridLayer<d>::to_property_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= Properties: ======= =======\n";
+    buf << fmt::format( "{}    ::bounds-min:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.min.easting, view_bounds_.min.northing );
+    buf << fmt::format( "{}    ::bounds-max:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.max.easting, view_bounds_.max.northing );
+    buf << fmt::format( "{}    ::cells-across-view:      {:6d}\n", prefix, dimension );
+    buf << fmt::format( "{}    ::meters-across-cell:     {:6.1f}\n", prefix, precision_ );
+    buf << fmt::format( "{}    ::memory-usage:           {:6d}\n", prefix, memory_usage() );
+    return buf.str();
+}
+
+template<uint32_t d>
+bool PackedGridLayer<d>::view( const BoundBox<LocalLocation>& box ){
+    if( (box.width() > width()) || (box.height() > width()) ){
+        return false;
+    }
+
+    view_bounds_.min = box.min;
+    view_bounds_.max = box.min + width();
+    return true;
+}
+
+} // namespace chartbox::layer::packed
+
+// explicit class template instantiation
+template class chartbox::layer::packed::PackedGridLayer<1024u>;
+template class chartbox::layer::packed::PackedGridLayer<5120u>;
@@ -0,0 +1,213 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "layer/layer-interface.hpp"
+
+namespace chartbox::layer::packed {
+
+/// \brief a single, fixed block of cells -- packed 2 bits to a cell
+///
+/// Boundary and contour layers only ever hold three values: `clear_cell_value`, `unknown_cell_value` and
+/// `block_cell_value`.  This layer stores each cell as a 2-bit code, 32 cells to a 64-bit word, in row-major order;
+/// each row fills a whole number of words.  Stored values round to the nearest of the three.
+///
+/// Spans are written a word at a time; and region checks (`any_blocked`, `all_clear`) test 32 cells per word.
+///
+/// \param dimension_ cell count across each dimension of the layer.  Must be a multiple of 32
+template<uint32_t dimension_>
+class PackedGridLayer final : public LayerInterface<PackedGridLayer<dimension_>> {
+public:
+
+    /// \brief number of cells along each dimension of the layer
+    constexpr static uint32_t dimension = dimension_;
+
+    constexpr static uint32_t cells_per_word = 32;
+
+    static_assert( (0 < dimension_) && (0 == (dimension_ % cells_per_word)), "each row must fill whole words" );
+
+    constexpr static uint32_t words_per_row = dimension_ / cells_per_word;
+
+    /// \brief 2-bit code of each stored value.  (only blocked cells set the high bit)
+    constexpr static uint64_t clear_code = 0b00;
+    constexpr static uint64_t unknown_code = 0b01;
+    constexpr static uint64_t block_code = 0b11;
+
+    /// \brief the high bit of each cell in a word -- set only by blocked cells
+    constexpr static uint64_t block_mask = 0xAAAAAAAAAAAAAAAAull;
+
+    /// \brief name of this layer's type
+    constexpr static char type_name_[] = "PackedGridLayer";
+
+public:
+    /// \brief Constructs a new grid, with its south-west corner at 0,0; and 1 meter per cell
+    PackedGridLayer();
+
+    /// \brief Constructs a new grid
+    ///
+    /// \param center - coordinates of the grid's center point
+    /// \param width - width of the grid.  The grid is square
+    PackedGridLayer( const geometry::LocalLocation& center, double width );
+
+    ~PackedGridLayer() = default;
+
+    /// \brief true if every cell in the box is clear
+    ///
+    /// \param box - area to check; clipped to the view.  (the max-border is inclusive, as in `BoundBox::contains`)
+    /// \return false if any covered cell is unknown or blocked; or if the box does not overlap the view
+    bool all_clear( const BoundBox<LocalLocation>& box ) const;
+
+    /// \brief true if any cell in the box is blocked
+    ///
+    /// \param box - area to check; clipped to the view.  (the max-border is inclusive, as in `BoundBox::contains`)
+    /// \return false if no covered cell is blocked; or if the box does not overlap the view
+    bool any_blocked( const BoundBox<LocalLocation>& box ) const;
+
+    /// \brief true if any cell in a horizontal run of cells is blocked
+    ///
+    /// \param row - row index of the run
+    /// \param first_column - column index of the first (west-most) cell to check
+    /// \param last_column - column index of the last (east-most) cell to check. (inclusive; clipped to the grid)
+    bool any_blocked( uint32_t row, uint32_t first_column, uint32_t last_column ) const;
+
+    /// \brief value of the cell at (column, row); both must be less than `dimension`
+    inline uint8_t cell( uint32_t column, uint32_t row ) const {
+        const uint64_t word = cells_[ row*words_per_row + column/cells_per_word ];
+        return decode( (word >> (2*(column % cells_per_word))) & 0b11 ); }
+
+    inline uint32_t cells_across_view() const { return dimension; }
+
+    bool contains(const geometry::LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+    /// \brief the packed cells: `words_per_row` words per row, from the south-west corner
+    inline std::span<const uint64_t> data() const {
+        return cells_; }
+
+    /// \brief value which the 2-bit code reads back as
+    constexpr static uint8_t decode( uint64_t code ){
+        return cell_values[code]; }
+
+    /// \brief 2-bit code of the nearest of `clear_cell_value`, `unknown_cell_value` and `block_cell_value`
+    constexpr static uint64_t encode( uint8_t value ){
+        return (value < 64) ? clear_code : ((value < 192) ? unknown_code : block_code); }
+
+    bool fill( uint8_t value );
+
+    /// \brief pack a dense grid of cells into the layer
+    ///
+    /// \param buffer - `dimension` x `dimension` cells; row-major, from the south-west corner
+    /// \param count - cell count of the buffer
+    /// \return false if the buffer is the wrong size
+    bool fill( const uint8_t* const buffer, size_t count );
+
+    bool fill( const Path<LocalLocation>& path, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+        return super().fill( path, bounds, value); }
+
+    bool fill( const BoundBox<LocalLocation>& box, const uint8_t value ){
+        return super().fill( box, value ); }
+
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
+        return super().fill( poly, bound, value ); }
+
+    inline uint8_t get( const geometry::LocalLocation& p ) const {
+        if( visible(p) ){
+            const LocalLocation relative = p - view_bounds_.min;
+            return cell( to_cell(relative.easting), to_cell(relative.northing) );
+        }
+        return default_cell_value;
+    }
+
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const;
+
+    /// \brief bytes held by the cells.  (a quarter of an unpacked grid's)
+    inline size_t memory_usage() const {
+        return cells_.size() * sizeof(uint64_t); }
+
+    inline double meters_across_cell() const { return precision_; }
+
+    double precision() const {
+        return precision_; }
+
+    inline void reset(){
+        fill( default_cell_value ); }
+
+    /// \brief store a value at point `p`
+    ///
+    /// \return false if `p` is outside the grid
+    bool store( const geometry::LocalLocation& p, uint8_t value );
+
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value );
+
+    std::string to_cell_content_string( uint32_t indent = 0 ) const;
+    std::string to_location_content_string( uint32_t indent = 0 ) const { return super().to_location_content_string(indent); }
+    std::string to_property_string( uint32_t indent = 0 ) const;
+
+    /// \brief this layer does not scroll; see: `view`
+    bool track( const BoundBox<LocalLocation>& /*bounds*/ ){
+        return false; }
+    const BoundBox<LocalLocation>& tracked() const {
+        return visible(); }
+    bool tracked(const LocalLocation& p) const {
+        return visible(p); }
+
+    /// \brief move the grid to the given bounds.  (the width of the grid is unchanged)
+    bool view( const BoundBox<LocalLocation>& box );
+    const BoundBox<LocalLocation>& visible() const {
+        return view_bounds_; }
+    bool visible(const LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+    double width() const {
+        return view_bounds_.width(); }
+
+private:
+    /// \brief value read back from each code.  (code 0b10 is never written)
+    constexpr static std::array<uint8_t,4> cell_values = { clear_cell_value, unknown_cell_value, unknown_cell_value, block_cell_value };
+
+    /// \brief a word of 32 copies of the given code
+    constexpr static uint64_t replicate( uint64_t code ){
+        return code * 0x5555555555555555ull; }
+
+    /// \brief true if any cell of the run sets any bit of `mask`
+    bool any( uint32_t row, uint32_t first_column, uint32_t last_column, uint64_t mask ) const;
+
+    /// \brief true if any cell of the box sets any bit of `mask`.  (the box must already be clipped to the view)
+    bool any( const BoundBox<LocalLocation>& box, uint64_t mask ) const;
+
+    /// \brief cell index along one axis.  (points on the max-border are clamped inside the grid)
+    inline uint32_t to_cell( double meters ) const {
+        return std::min( static_cast<uint32_t>( meters / precision_ ), dimension - 1 ); }
+
+private:
+    // this tracks the bounds of the visible grid
+    geometry::BoundBox<LocalLocation> view_bounds_;
+    double precision_;
+
+    std::vector<uint64_t> cells_;
+
+private:
+    LayerInterface<PackedGridLayer<dimension_>>& super() {
+        return *static_cast< LayerInterface<PackedGridLayer<dimension_>>* >(this);
+    }
+
+    const LayerInterface<PackedGridLayer<dimension_>>& super() const {
+        return *static_cast< const LayerInterface<PackedGridLayer<dimension_>>* >(this);
+    }
+};
+
+} // namespace chartbox::layer::packed
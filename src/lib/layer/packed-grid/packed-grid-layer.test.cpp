@@ -0,0 +1,146 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "packed-grid-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+using chartbox::layer::packed::PackedGridLayer;
+
+namespace chartbox::layer {
+
+// ============ ============ PackedGridLayer Tests  ============ ============
+
+TEST_CASE( "PackedGridLayer stores 2 bits per cell" ){
+    typedef PackedGridLayer<1024> layer_t;
+    layer_t layer;
+    CHECK( layer.memory_usage() == (1024 * 1024 / 4) );
+    CHECK( layer.precision() == Approx(1.0) );
+
+    // starts unknown:
+    CHECK( layer.get({   0.5,    0.5}) == default_cell_value );
+    CHECK( layer.get({1023.5, 1023.5}) == default_cell_value );
+    CHECK( layer.get({  -0.5,    0.5}) == default_cell_value );
+
+    // values round to the nearest of: clear, unknown, and blocked
+    CHECK( layer_t::decode(layer_t::encode( clear_cell_value )) == clear_cell_value );
+    CHECK( layer_t::decode(layer_t::encode( 0x3F )) == clear_cell_value );
+    CHECK( layer_t::decode(layer_t::encode( 0x42 )) == unknown_cell_value );
+    CHECK( layer_t::decode(layer_t::encode( unknown_cell_value )) == unknown_cell_value );
+    CHECK( layer_t::decode(layer_t::encode( 0xC0 )) == block_cell_value );
+    CHECK( layer_t::decode(layer_t::encode( block_cell_value )) == block_cell_value );
+
+    REQUIRE( layer.store({ 40.5, 70.5}, block_cell_value ) );
+    REQUIRE_FALSE( layer.store({ -1, 70.5}, block_cell_value ) );
+    CHECK( layer.get({ 40.5, 70.5}) == block_cell_value );
+    CHECK( layer.get({ 39.5, 70.5}) == unknown_cell_value );
+    CHECK( layer.get({ 41.5, 70.5}) == unknown_cell_value );
+    CHECK( layer.get({ 40.5, 71.5}) == unknown_cell_value );
+} // TEST_CASE
+
+TEST_CASE( "PackedGridLayer writes and checks spans, as a byte grid does" ){
+    constexpr uint32_t dimension = 1024;
+    PackedGridLayer<dimension> layer;
+    layer.fill( clear_cell_value );
+    std::vector<uint8_t> reference( dimension * dimension, clear_cell_value );
+
+    REQUIRE_FALSE( layer.store_span( dimension, 0, 10, block_cell_value ) );
+    REQUIRE_FALSE( layer.store_span( 0, 10, 9, block_cell_value ) );
+
+    // spans within one word; across a word boundary; and across many words
+    std::mt19937 generator( 55 );
+    std::uniform_int_distribution<uint32_t> column_distribution( 0, dimension - 1 );
+    std::uniform_int_distribution<uint32_t> length_distribution( 0, 200 );
+    const uint8_t values[] = { clear_cell_value, unknown_cell_value, block_cell_value };
+    for( uint32_t span_index = 0; span_index < 2000; ++span_index ){
+        const uint32_t row = column_distribution( generator );
+        const uint32_t first = column_distribution( generator );
+        const uint32_t last = first + length_distribution( generator );
+        const uint8_t value = values[ span_index % 3 ];
+        REQUIRE( layer.store_span( row, first, last, value ) );
+        std::fill( reference.begin() + row*dimension + first, reference.begin() + row*dimension + std::min(last + 1, dimension), value );
+    }
+
+    for( uint32_t row = 0; row < dimension; ++row ){
+        for( uint32_t column = 0; column < dimension; ++column ){
+            REQUIRE( layer.cell(column, row) == reference[column + row*dimension] );
+        }
+    }
+
+    // ... and the span checks agree with a scan of the reference:
+    for( uint32_t check_index = 0; check_index < 2000; ++check_index ){
+        const uint32_t row = column_distribution( generator );
+        const uint32_t first = column_distribution( generator );
+        const uint32_t last = std::min( first + length_distribution( generator ), dimension - 1 );
+        const auto begin = reference.begin() + row*dimension;
+        const bool expected = std::any_of( begin + first, begin + last + 1, []( uint8_t each ){ return block_cell_value == each; } );
+        REQUIRE( layer.any_blocked( row, first, last ) == expected );
+    }
+
+    SECTION( "a packed copy matches the bytes it was built from" ){
+        PackedGridLayer<dimension> copy;
+        REQUIRE_FALSE( copy.fill( reference.data(), reference.size() - 1 ) );
+        REQUIRE( copy.fill( reference.data(), reference.size() ) );
+        CHECK( std::equal( copy.data().begin(), copy.data().end(), layer.data().begin() ) );
+    }
+} // TEST_CASE
+
+TEST_CASE( "PackedGridLayer checks regions for blocked and clear cells" ){
+    PackedGridLayer<1024> layer;
+    layer.fill( clear_cell_value );
+    REQUIRE( layer.fill( BoundBox<LocalLocation>({100.1, 200.1}, {163.9, 263.9}), unknown_cell_value ) );
+    REQUIRE( layer.store( {500.5, 600.5}, block_cell_value ) );
+
+    // the unknown block is neither clear, nor blocked
+    CHECK_FALSE( layer.all_clear({{90, 190}, {110, 210}}) );
+    CHECK_FALSE( layer.any_blocked({{90, 190}, {110, 210}}) );
+    CHECK( layer.all_clear({{10, 10}, {99, 950}}) );
+
+    // a single blocked cell is found, from any box that touches it:
+    CHECK( layer.any_blocked({{0, 0}, {1024, 1024}}) );
+    CHECK( layer.any_blocked({{500.9, 600.9}, {510, 610}}) );
+    CHECK( layer.any_blocked({{490, 590}, {500.1, 600.1}}) );
+    CHECK_FALSE( layer.any_blocked({{501.1, 590}, {900, 900}}) );
+    CHECK_FALSE( layer.all_clear({{490, 590}, {510, 610}}) );
+
+    // boxes are clipped to the view:
+    CHECK( layer.any_blocked({{-1000, -1000}, {2000, 2000}}) );
+    CHECK_FALSE( layer.any_blocked({{2000, 2000}, {3000, 3000}}) );
+    CHECK_FALSE( layer.all_clear({{2000, 2000}, {3000, 3000}}) );
+} // TEST_CASE
+
+TEST_CASE( "PackedGridLayer fills shapes, as a grid does" ){
+    PackedGridLayer<1024> layer( {0, 0}, 256 );
+    REQUIRE( layer.precision() == Approx(0.25) );
+    REQUIRE( layer.visible().min.easting == Approx(-128) );
+    layer.fill( clear_cell_value );
+
+    const Polygon<LocalLocation> diamond( {{0, 100}, {100, 0}, {0, -100}, {-100, 0}, {0, 100}} );
+    REQUIRE( layer.fill( diamond, layer.visible(), block_cell_value ) );
+
+    for( double northing = -127.875; northing < 128; northing += 1.5 ){
+        for( double easting = -127.875; easting < 128; easting += 1.5 ){
+            const double distance = std::abs(easting) + std::abs(northing);
+            if( distance < 99 ){
+                REQUIRE( layer.get({easting, northing}) == block_cell_value );
+            }else if( 101 < distance ){
+                REQUIRE( layer.get({easting, northing}) == clear_cell_value );
+            }
+        }
+    }
+
+    CHECK( layer.any_blocked({{-10, 95}, {10, 105}}) );
+    CHECK( layer.all_clear({{60, 60}, {120, 120}}) );
+} // TEST_CASE
+
+}   // namespace
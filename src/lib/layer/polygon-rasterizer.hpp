@@ -0,0 +1,170 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+
+namespace chartbox::layer {
+
+/// \brief Scanline rasterizer for (large) polygons
+///
+/// Finds the spans of each sample-row that lie inside a polygon, using an edge table + active edge list:
+///   - edges are sorted by the first row they touch; each row only visits the edges that cross it.
+///   - the edge table, active list and crossing list are kept between calls, so repeated fills do not reallocate.
+///
+/// Rows are sampled at `first_northing + row*row_spacing`, for `row` in [0, row_count).  Every crossing is
+/// evaluated directly from its edge's endpoints, rather than stepped from the previous row, so the output of
+/// any row does not depend on which rows were rasterized before it.
+///
+/// Sources / Inspiration / Further Reading
+/// 1. "Efficient Polygon Fill Algorithm With C Code Sample", Darel Rex Finley, 2007
+///     - https://alienryderflex.com/polygon_fill/
+/// 2. Foley, van Dam, et al.; "Computer Graphics: Principles and Practice", 3.6 "Filling Polygons"
+class PolygonRasterizer {
+public:
+    /// \brief reusable per-scan storage
+    struct Scratch {
+        std::vector<uint32_t> active;
+        std::vector<double> crossings;
+    };
+
+public:
+    PolygonRasterizer() = default;
+
+    /// \brief build the edge table for a polygon
+    ///
+    /// \param polygon - closed polygon (the last vertex repeats the first)
+    /// \param first_northing - northing of row 0
+    /// \param row_spacing - distance between rows
+    /// \param row_count - number of rows to sample
+    /// \return true if the polygon has any edges to rasterize
+    bool load( const geometry::Polygon<geometry::LocalLocation>& polygon, double first_northing, double row_spacing, size_t row_count ){
+        edges_.clear();
+        first_northing_ = first_northing;
+        row_spacing_ = row_spacing;
+        row_count_ = row_count;
+
+        if( (2 > polygon.size()) || (0 == row_count) || not (0 < row_spacing) ){
+            return false;
+        }
+
+        auto iter = polygon.begin();
+        for( size_t i = 0; i < (polygon.size() - 1); ++i ){
+            const geometry::LocalLocation& start = *iter;
+            ++iter;
+            const geometry::LocalLocation& end = *iter;
+
+            // horizontal edges never cross a row; NaN edges cannot be drawn
+            if( (start.northing == end.northing) || start.isnan() || end.isnan() ){
+                continue;
+            }
+
+            Edge edge;
+            edge.northing_min = std::min( start.northing, end.northing );
+            edge.northing_max = std::max( start.northing, end.northing );
+            edge.start = start;
+            edge.delta = end - start;
+
+            // activate one row early; the exact test in `rasterize` decides if the edge crosses each row
+            const double first_row = std::floor( (edge.northing_min - first_northing_) / row_spacing_ ) - 1;
+            const double last_row = std::ceil( (edge.northing_max - first_northing_) / row_spacing_ );
+            if( (last_row < 0) || (static_cast<double>(row_count_) <= first_row) ){
+                continue;
+            }
+            edge.first_row = static_cast<size_t>( std::max( 0.0, first_row ) );
+
+            edges_.push_back( edge );
+        }
+
+        std::sort( edges_.begin(), edges_.end(), []( const Edge& a, const Edge& b ){ return a.first_row < b.first_row; } );
+
+        return not edges_.empty();
+    }
+
+    /// \brief northing of the given row
+    inline double northing( size_t row ) const {
+        return first_northing_ + static_cast<double>(row) * row_spacing_; }
+
+    inline size_t row_count() const {
+        return row_count_; }
+
+    /// \brief emit the inside-spans of each row in [first_row, end_row)
+    ///
+    /// \param first_row - first row to rasterize
+    /// \param end_row - one-past the last row to rasterize
+    /// \param scratch - working storage for this scan. (Scans of separate row-ranges may run concurrently, each with their own scratch.)
+    /// \param emit - callable as `emit( northing, west_easting, east_easting )` for each span
+    template<typename emit_t>
+    void rasterize( size_t first_row, size_t end_row, Scratch& scratch, emit_t&& emit ) const {
+        end_row = std::min( end_row, row_count_ );
+        scratch.active.clear();
+
+        // edges which become active before the first row:
+        size_t next_edge = 0;
+        for( ; (next_edge < edges_.size()) && (edges_[next_edge].first_row <= first_row); ++next_edge ){
+            scratch.active.push_back( static_cast<uint32_t>(next_edge) );
+        }
+
+        for( size_t row = first_row; row < end_row; ++row ){
+            const double y = northing( row );
+
+            // (1) activate edges from the edge table
+            for( ; (next_edge < edges_.size()) && (edges_[next_edge].first_row <= row); ++next_edge ){
+                scratch.active.push_back( static_cast<uint32_t>(next_edge) );
+            }
+
+            // (2) retire finished edges, and collect the crossings of the rest
+            scratch.crossings.clear();
+            size_t kept = 0;
+            for( const uint32_t edge_index : scratch.active ){
+                const Edge& edge = edges_[edge_index];
+                if( edge.northing_max <= y ){
+                    continue;
+                }
+                scratch.active[kept++] = edge_index;
+
+                if( edge.northing_min <= y ){
+                    scratch.crossings.push_back( edge.start.easting + (y - edge.start.northing) * edge.delta.easting / edge.delta.northing );
+                }
+            }
+            scratch.active.resize( kept );
+
+            // (3) pair up the crossings, west-to-east
+            std::sort( scratch.crossings.begin(), scratch.crossings.end() );
+            for( size_t crossing_index = 0; (crossing_index + 1) < scratch.crossings.size(); crossing_index += 2 ){
+                emit( y, scratch.crossings[crossing_index], scratch.crossings[crossing_index + 1] );
+            }
+        }
+    }
+
+    /// \brief emit the inside-spans of each row in [first_row, end_row), with the internal scratch storage
+    template<typename emit_t>
+    void rasterize( size_t first_row, size_t end_row, emit_t&& emit ){
+        rasterize( first_row, end_row, scratch_, emit ); }
+
+private:
+    struct Edge {
+        size_t first_row;
+        double northing_min;
+        double northing_max;
+        geometry::LocalLocation start;
+        geometry::LocalLocation delta;
+    };
+
+    std::vector<Edge> edges_;
+
+    Scratch scratch_;
+
+    double first_northing_ = 0;
+    double row_spacing_ = 1;
+    size_t row_count_ = 0;
+};
+
+} // namespace
@@ -0,0 +1,118 @@
+// GPL v3 (c) 2021, Daniel Williams 
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+
+#include "polygon-rasterizer.hpp"
+
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::PolygonRasterizer;
+
+typedef std::tuple<double,double,double> span_t;
+
+// ============ ============  Polygon-Rasterizer-Tests  ============ ============
+TEST_CASE( "PolygonRasterizer rejects degenerate polygons" ){
+    PolygonRasterizer rasterizer;
+    CHECK( not rasterizer.load( Polygon<LocalLocation>(0), 0.5, 1.0, 10 ));
+
+    // only horizontal edges:
+    const Polygon<LocalLocation> flat( {{0,2}, {4,2}, {8,2}, {0,2}} );
+    CHECK( not rasterizer.load( flat, 0.5, 1.0, 10 ));
+
+    // no rows to sample:
+    const Polygon<LocalLocation> square( {{0,0}, {4,0}, {4,4}, {0,4}, {0,0}} );
+    CHECK( not rasterizer.load( square, 0.5, 1.0, 0 ));
+} // TEST_CASE
+
+TEST_CASE( "PolygonRasterizer emits spans of a square" ){
+    const Polygon<LocalLocation> square( {{1,1}, {5,1}, {5,3}, {1,3}, {1,1}} );
+    PolygonRasterizer rasterizer;
+    REQUIRE( rasterizer.load( square, 0.5, 1.0, 5 ));
+
+    std::vector<span_t> spans;
+    rasterizer.rasterize( 0, rasterizer.row_count(), [&]( double y, double west, double east ){
+        spans.emplace_back( y, west, east ); });
+
+    REQUIRE( 2 == spans.size() );
+    CHECK( span_t(1.5, 1.0, 5.0) == spans[0] );
+    CHECK( span_t(2.5, 1.0, 5.0) == spans[1] );
+} // TEST_CASE
+
+TEST_CASE( "PolygonRasterizer emits multiple spans per row" ){
+    // a 'U' shape: two spans per row in the upper half, one in the lower
+    const Polygon<LocalLocation> shape( {{0,0}, {6,0}, {6,4}, {4,4}, {4,2}, {2,2}, {2,4}, {0,4}, {0,0}} );
+    PolygonRasterizer rasterizer;
+    REQUIRE( rasterizer.load( shape, 0.5, 1.0, 4 ));
+
+    std::vector<span_t> spans;
+    rasterizer.rasterize( 0, rasterizer.row_count(), [&]( double y, double west, double east ){
+        spans.emplace_back( y, west, east ); });
+
+    REQUIRE( 6 == spans.size() );
+    CHECK( span_t(0.5, 0.0, 6.0) == spans[0] );
+    CHECK( span_t(1.5, 0.0, 6.0) == spans[1] );
+    CHECK( span_t(2.5, 0.0, 2.0) == spans[2] );
+    CHECK( span_t(2.5, 4.0, 6.0) == spans[3] );
+    CHECK( span_t(3.5, 0.0, 2.0) == spans[4] );
+    CHECK( span_t(3.5, 4.0, 6.0) == spans[5] );
+} // TEST_CASE
+
+TEST_CASE( "PolygonRasterizer matches a full edge-scan on every row" ){
+    // jagged, many-sided polygon
+    std::vector<LocalLocation> vertices;
+    constexpr size_t vertex_count = 257;
+    for( size_t i = 0; i < vertex_count; ++i ){
+        const double angle = 2 * M_PI * static_cast<double>(i) / vertex_count;
+        const double radius = 40 + 15 * std::sin( 7 * angle ) + ((i%3) ? 0 : 5);
+        vertices.emplace_back( 50 + radius*std::cos(angle), 50 + radius*std::sin(angle) );
+    }
+    vertices.emplace_back( vertices.front() );
+    const Polygon<LocalLocation> shape( vertices );
+
+    PolygonRasterizer rasterizer;
+    REQUIRE( rasterizer.load( shape, 0.25, 0.5, 200 ));
+
+    std::vector<span_t> spans;
+    rasterizer.rasterize( 0, rasterizer.row_count(), [&]( double y, double west, double east ){
+        spans.emplace_back( y, west, east ); });
+
+    // reference: visit every edge on every row
+    std::vector<span_t> expect;
+    for( size_t row = 0; row < 200; ++row ){
+        const double y = 0.25 + row * 0.5;
+        std::vector<double> crossings;
+        for( size_t i = 0; i < (vertices.size() - 1); ++i ){
+            const LocalLocation& start = vertices[i];
+            const LocalLocation& end = vertices[i+1];
+            if( (std::min(start.y(), end.y()) <= y) && (y < std::max(start.y(), end.y())) ){
+                crossings.push_back( start.x() + (y - start.y()) * (end.x() - start.x()) / (end.y() - start.y()) );
+            }
+        }
+        std::sort( crossings.begin(), crossings.end() );
+        for( size_t i = 0; (i+1) < crossings.size(); i += 2 ){
+            expect.emplace_back( y, crossings[i], crossings[i+1] );
+        }
+    }
+
+    CHECK( expect == spans );
+
+    SECTION( "Rasterizing in separate row-ranges matches a single pass" ){
+        std::vector<span_t> banded;
+        PolygonRasterizer::Scratch scratch;
+        for( size_t first_row = 0; first_row < 200; first_row += 37 ){
+            rasterizer.rasterize( first_row, first_row + 37, scratch, [&]( double y, double west, double east ){
+                banded.emplace_back( y, west, east ); });
+        }
+        CHECK( spans == banded );
+    }
+} // TEST_CASE
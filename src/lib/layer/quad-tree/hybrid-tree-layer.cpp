@@ -0,0 +1,244 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include <fmt/core.h>
+
+#include "geometry/local-location.hpp"
+
+#include "hybrid-tree-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+namespace chartbox::layer {
+
+template<uint32_t n>
+HybridTreeLayer<n>::HybridTreeLayer()
+    : view_bounds_( {0,0}, {static_cast<double>(dimension), static_cast<double>(dimension)} )
+    , precision_( 1.0 )
+{
+    reset();
+}
+
+template<uint32_t n>
+HybridTreeLayer<n>::HybridTreeLayer( const LocalLocation& center, double width )
+    : view_bounds_( center - LocalLocation(width/2), center + (width/2) )
+    , precision_( width/dimension )
+{
+    reset();
+}
+
+template<uint32_t n>
+QuadNode HybridTreeLayer<n>::build( const uint8_t* const buffer, uint32_t column, uint32_t row, uint32_t across ){
+    if( n == across ){
+        const uint8_t* const first = buffer + column + row*dimension;
+        bool uniform = true;
+        for( uint32_t j = 0; uniform && (j < n); ++j ){
+            const uint8_t* const each = first + j*dimension;
+            uniform = (first[0] == each[0]) && (0 == std::memcmp( each, each + 1, n - 1 ));
+        }
+        if( uniform ){
+            return QuadNode::uniform( first[0] );
+        }
+
+        const uint32_t index = tiles_.allocate();
+        for( uint32_t j = 0; j < n; ++j ){
+            std::memcpy( &tiles_[index].get(0, j), first + j*dimension, n );
+        }
+        return QuadNode::tile( index );
+    }
+
+    const uint32_t half = across / 2;
+    const QuadBranch children = { build( buffer, column, row, half ),
+                                  build( buffer, column + half, row, half ),
+                                  build( buffer, column, row + half, half ),
+                                  build( buffer, column + half, row + half, half ) };
+    if( std::all_of( children.begin(), children.end(), [&]( const QuadNode& child ){ return QuadNode::uniform(children[0].value) == child; } ) ){
+        return children[0];
+    }
+    return QuadNode::branch( branches_.allocate( children ) );
+}
+
+template<uint32_t n>
+bool HybridTreeLayer<n>::fill( uint8_t value ){
+    branches_.reset();
+    tiles_.reset();
+    root_ = QuadNode::uniform( value );
+    return true;
+}
+
+template<uint32_t n>
+bool HybridTreeLayer<n>::fill( const uint8_t* const buffer, size_t count ){
+    if( (dimension * dimension) != count ){
+        return false;
+    }
+    branches_.reset();
+    tiles_.reset();
+    root_ = build( buffer, 0, 0, dimension );
+    return true;
+}
+
+template<uint32_t n>
+bool HybridTreeLayer<n>::get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+    if( values.size() < points.size() ){
+        return false;
+    }
+
+    for( size_t point_index = 0; point_index < points.size(); ++point_index ){
+        values[point_index] = get( points[point_index] );
+    }
+    return true;
+}
+
+template<uint32_t n>
+uint32_t HybridTreeLayer<n>::height() const {
+    return height( root_ );
+}
+
+template<uint32_t n>
+uint32_t HybridTreeLayer<n>::height( const QuadNode& node ) const {
+    if( node.is_leaf() ){
+        return 0;
+    }
+    uint32_t deepest = 0;
+    for( const auto& child : branches_[node.index] ){
+        deepest = std::max( deepest, height(child) );
+    }
+    return deepest + 1;
+}
+
+template<uint32_t n>
+size_t HybridTreeLayer<n>::memory_usage() const {
+    return sizeof(QuadNode) + branches_.size() * sizeof(QuadBranch) + tiles_.size() * sizeof(tile_t);
+}
+
+template<uint32_t n>
+void HybridTreeLayer<n>::prune(){
+    prune( root_ );
+}
+
+template<uint32_t n>
+void HybridTreeLayer<n>::prune( QuadNode& node ){
+    if( QuadNode::Tile == node.kind ){
+        const uint8_t* const cells = tiles_[node.index].data();
+        if( 0 == std::memcmp( cells, cells + 1, n*n - 1 ) ){
+            const QuadNode merged = QuadNode::uniform( cells[0] );
+            tiles_.release( node.index );
+            node = merged;
+        }
+    }else if( QuadNode::Branch == node.kind ){
+        QuadBranch& children = branches_[node.index];
+        for( auto& child : children ){
+            prune( child );
+        }
+        if( std::all_of( children.begin(), children.end(), [&]( const QuadNode& child ){ return QuadNode::uniform(children[0].value) == child; } ) ){
+            const QuadNode merged = children[0];
+            branches_.release( node.index );
+            node = merged;
+        }
+    }
+}
+
+template<uint32_t n>
+QuadNode& HybridTreeLayer<n>::split_to( uint32_t column, uint32_t row, uint8_t value ){
+    QuadNode* node = &root_;
+    for( uint32_t across = dimension; true; ){
+        if( QuadNode::Branch == node->kind ){
+            across /= 2;
+            node = &branches_[node->index][ QuadNode::quadrant(column, row, across) ];
+        }else if( (QuadNode::Tile == node->kind) || (value == node->value) ){
+            return *node;
+        }else if( n < across ){
+            const uint32_t index = branches_.allocate();
+            branches_[index].fill( QuadNode::uniform(node->value) );
+            *node = QuadNode::branch( index );
+        }else{
+            const uint32_t index = tiles_.allocate();
+            tiles_[index].fill( node->value );
+            *node = QuadNode::tile( index );
+            return *node;
+        }
+    }
+}
+
+template<uint32_t n>
+bool HybridTreeLayer<n>::store( const LocalLocation& p, uint8_t value ){
+    if( visible(p) ){
+        const LocalLocation relative = p - view_bounds_.min;
+        return store_span( to_cell(relative.northing), to_cell(relative.easting), to_cell(relative.easting), value );
+    }
+    return false;
+}
+
+template<uint32_t n>
+bool HybridTreeLayer<n>::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+    if( (dimension <= row) || (dimension <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min<uint32_t>( last_column, dimension - 1 );
+
+    // one descent per tile, along the span:
+    for( uint32_t column = first_column; column <= last_column; ){
+        const uint32_t tile_last_column = std::min( last_column, column | (n - 1) );
+        QuadNode& node = split_to( column, row, value );
+        if( QuadNode::Tile == node.kind ){
+            std::memset( &tiles_[node.index].get(column & (n - 1), row & (n - 1)), value, tile_last_column - column + 1 );
+        }
+        column = tile_last_column + 1;
+    }
+    return true;
+}
+
+template<uint32_t n>
+std::string HybridTreeLayer<n>::to_cell_content_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= ======= Print Contents By Cell: ======= ======= =======\n";
+    for (uint32_t cell_row_index = dimension - 1; cell_row_index < dimension; --cell_row_index) {
+        buf << prefix << "    ";
+        for (uint32_t cell_column_index = 0; cell_column_index < dimension; ++cell_column_index ) {
+            buf << fmt::format(" {:2X}", cell(cell_column_index, cell_row_index) );
+        }
+        buf << '\n';
+    }
+    buf << prefix << "======== ======= ======= ======= ======= ======= ======= =======\n";
+    return buf.str();
+}
+
+template<uint32_t n>
+std::string HybridTreeLayer<n>::to_property_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= Properties: ======= =======\n";
+    buf << fmt::format( "{}    ::bounds-min:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.min.easting, view_bounds_.min.northing );
+    buf << fmt::format( "{}    ::bounds-max:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.max.easting, view_bounds_.max.northing );
+    buf << fmt::format( "{}    ::cells-across-view:      {:6d}\n", prefix, dimension );
+    buf << fmt::format( "{}    ::cells-across-tile:      {:6d}\n", prefix, n );
+    buf << fmt::format( "{}    ::meters-across-cell:     {:6.1f}\n", prefix, precision_ );
+    buf << fmt::format( "{}    ::height:                 {:6d}\n", prefix, height() );
+    buf << fmt::format( "{}    ::node-count:             {:6d}\n", prefix, node_count() );
+    buf << fmt::format( "{}    ::tile-count:             {:6d}\n", prefix, tile_count() );
+    return buf.str();
+}
+
+template<uint32_t n>
+bool HybridTreeLayer<n>::view( const BoundBox<LocalLocation>& box ){
+    if( (box.width() > width()) || (box.height() > width()) ){
+        return false;
+    }
+
+    view_bounds_.min = box.min;
+    view_bounds_.max = box.min + width();
+    return true;
+}
+
+} // namespace chartbox::layer
+
+// explicit class template instantiation
+template class chartbox::layer::HybridTreeLayer<8u>;
+template class chartbox::layer::HybridTreeLayer<32u>;
+template class chartbox::layer::HybridTreeLayer<64u>;
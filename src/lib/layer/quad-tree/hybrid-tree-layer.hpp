@@ -0,0 +1,210 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "layer/layer-interface.hpp"
+#include "layer/node-arena.hpp"
+
+#include "leaf-node.hpp"
+#include "quad-node.hpp"
+
+namespace chartbox::layer {
+
+/// \brief Quad tree whose leaves are either a uniform value, or a dense `LeafNode` tile
+///
+/// Uniform regions collapse into a single node, at any level; detailed regions are stored as grid tiles, at a fixed
+/// level.  A lookup descends only to tile granularity -- at most log2(dimension / tile_across) levels -- and then
+/// indexes the tile directly.
+///
+/// Branches and tiles are allocated from arenas, and referenced by index.  Refilling (or resetting) the tree
+/// releases every node at once, in O(1).
+///
+/// \param tile_across_ cell count across each tile
+template<uint32_t tile_across_>
+class HybridTreeLayer final : public LayerInterface<HybridTreeLayer<tile_across_>> {
+public:
+
+    /// \brief number of cells along each dimension of the entire tree
+    constexpr static uint32_t dimension = 1024;
+
+    /// \brief number of cells along each dimension of each tile
+    constexpr static uint32_t tile_across = tile_across_;
+
+    static_assert( std::has_single_bit(tile_across_) && (tile_across_ <= dimension), "tiles must evenly divide the tree" );
+
+    /// \brief name of this layer's type
+    constexpr static char type_name_[] = "HybridTreeLayer";
+
+    typedef LeafNode<tile_across_> tile_t;
+
+public:
+    /// \brief Constructs a new tree, with its south-west corner at 0,0 and 1024 units wide, square
+    HybridTreeLayer();
+
+    /// \brief Constructs a new tree
+    ///
+    /// \param center - coordinates of the tree's center point
+    /// \param width - width of the tree.  The tree is square
+    HybridTreeLayer( const geometry::LocalLocation& center, double width );
+
+    ~HybridTreeLayer() = default;
+
+    /// \brief value of the cell at (column, row); both must be less than `dimension`
+    inline uint8_t cell( uint32_t column, uint32_t row ) const {
+        const QuadNode* node = &root_;
+        for( uint32_t half = dimension/2; QuadNode::Branch == node->kind; half /= 2 ){
+            node = &branches_[node->index][ QuadNode::quadrant(column, row, half) ];
+        }
+        if( QuadNode::Tile == node->kind ){
+            return tiles_[node->index].get( column & (tile_across - 1), row & (tile_across - 1) );
+        }
+        return node->value;
+    }
+
+    inline uint32_t cells_across_view() const { return dimension; }
+
+    bool contains(const geometry::LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+    /// \brief release every node, and set every cell to the given value
+    bool fill( uint8_t value );
+
+    /// \brief build the tree from a dense grid of cells
+    ///
+    /// \param buffer - `dimension` x `dimension` cells; row-major, from the south-west corner
+    /// \param count - cell count of the buffer
+    /// \return false if the buffer is the wrong size
+    bool fill( const uint8_t* const buffer, size_t count );
+
+    // each bulk fill prunes the tree, once it is written
+    bool fill( const Path<LocalLocation>& path, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+        const bool result = super().fill( path, bounds, value );
+        prune();
+        return result;
+    }
+
+    bool fill( const BoundBox<LocalLocation>& box, const uint8_t value ){
+        const bool result = super().fill( box, value );
+        prune();
+        return result;
+    }
+
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
+        const bool result = super().fill( poly, bound, value );
+        prune();
+        return result;
+    }
+
+    inline uint8_t get( const geometry::LocalLocation& p ) const {
+        if( visible(p) ){
+            const LocalLocation relative = p - view_bounds_.min;
+            return cell( to_cell(relative.easting), to_cell(relative.northing) );
+        }
+        return default_cell_value;
+    }
+
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const;
+
+    /// \brief depth of the deepest leaf below the root
+    uint32_t height() const;
+
+    /// \brief bytes held by the nodes + tiles in use
+    size_t memory_usage() const;
+
+    inline double meters_across_cell() const { return precision_; }
+
+    /// \brief number of nodes in the tree: branches, uniform blocks, and tiles
+    inline size_t node_count() const {
+        return 1 + 4*branches_.size(); }
+
+    double precision() const {
+        return precision_; }
+
+    /// \brief collapse uniform tiles, and branches of four matching uniform children, into uniform nodes
+    void prune();
+
+    inline void reset(){
+        fill( default_cell_value ); }
+
+    /// \brief store a value at point `p`.  (Unlike the bulk fills, this does not prune the tree)
+    ///
+    /// \return false if `p` is outside the tree
+    bool store( const geometry::LocalLocation& p, uint8_t value );
+
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value );
+
+    /// \brief number of dense tiles in the tree
+    inline size_t tile_count() const {
+        return tiles_.size(); }
+
+    std::string to_cell_content_string( uint32_t indent = 0 ) const;
+    std::string to_location_content_string( uint32_t indent = 0 ) const { return super().to_location_content_string(indent); }
+    std::string to_property_string( uint32_t indent = 0 ) const;
+
+    /// \brief this layer does not scroll; see: `view`
+    bool track( const BoundBox<LocalLocation>& /*bounds*/ ){
+        return false; }
+    const BoundBox<LocalLocation>& tracked() const {
+        return visible(); }
+    bool tracked(const LocalLocation& p) const {
+        return visible(p); }
+
+    /// \brief move the tree to the given bounds.  (the width of the tree is unchanged)
+    bool view( const BoundBox<LocalLocation>& box );
+    const BoundBox<LocalLocation>& visible() const {
+        return view_bounds_; }
+    bool visible(const LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
+    double width() const {
+        return view_bounds_.width(); }
+
+private:
+    QuadNode build( const uint8_t* const buffer, uint32_t column, uint32_t row, uint32_t across );
+
+    uint32_t height( const QuadNode& node ) const;
+
+    void prune( QuadNode& node );
+
+    /// \brief descend to the leaf holding the cell at (column, row); splitting uniform nodes down to a tile, unless
+    ///        they already hold `value`
+    QuadNode& split_to( uint32_t column, uint32_t row, uint8_t value );
+
+    /// \brief cell index along one axis.  (points on the max-border are clamped inside the tree)
+    inline uint32_t to_cell( double meters ) const {
+        return std::min( static_cast<uint32_t>( meters / precision_ ), dimension - 1 ); }
+
+private:
+    // this tracks the bounds of the visible grid
+    geometry::BoundBox<LocalLocation> view_bounds_;
+    double precision_;
+
+    QuadNode root_;
+
+    NodeArena<QuadBranch, 10> branches_;
+    NodeArena<tile_t, 4> tiles_;
+
+private:
+    LayerInterface<HybridTreeLayer<tile_across_>>& super() {
+        return *static_cast< LayerInterface<HybridTreeLayer<tile_across_>>* >(this);
+    }
+
+    const LayerInterface<HybridTreeLayer<tile_across_>>& super() const {
+        return *static_cast< const LayerInterface<HybridTreeLayer<tile_across_>>* >(this);
+    }
+};
+
+} // namespace chartbox::layer
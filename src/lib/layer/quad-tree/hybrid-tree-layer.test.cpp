@@ -0,0 +1,140 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "hybrid-tree-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+using chartbox::layer::HybridTreeLayer;
+
+namespace chartbox::layer {
+
+// ============ ============ HybridTreeLayer Tests  ============ ============
+
+TEST_CASE( "HybridTreeLayer starts as a single uniform node" ){
+    HybridTreeLayer<32> tree;
+    CHECK( tree.node_count() == 1 );
+    CHECK( tree.tile_count() == 0 );
+    CHECK( tree.height() == 0 );
+    CHECK( tree.precision() == Approx(1.0) );
+
+    CHECK( tree.get({   0.5,    0.5}) == default_cell_value );
+    CHECK( tree.get({1023.5, 1023.5}) == default_cell_value );
+    CHECK( tree.get({  -0.5,    0.5}) == default_cell_value );
+} // TEST_CASE
+
+TEST_CASE( "HybridTreeLayer splits down to a single tile" ){
+    HybridTreeLayer<32> tree;
+    tree.fill( clear_cell_value );
+
+    REQUIRE( tree.store({ 40.5, 70.5}, 0x42 ) );
+    REQUIRE_FALSE( tree.store({ -1, 70.5}, 0x42 ) );
+    CHECK( tree.get({ 40.5, 70.5}) == 0x42 );
+    CHECK( tree.get({ 39.5, 70.5}) == clear_cell_value );
+    CHECK( tree.get({ 40.5, 71.5}) == clear_cell_value );
+
+    // 1024 => 32 cells across: 5 levels of branches, and a single tile
+    CHECK( tree.height() == 5 );
+    CHECK( tree.node_count() == (1 + 4*5) );
+    CHECK( tree.tile_count() == 1 );
+
+    SECTION( "writing a uniform node's own value does not split it" ){
+        REQUIRE( tree.store({ 900.5, 900.5}, clear_cell_value ) );
+        CHECK( tree.node_count() == (1 + 4*5) );
+    }
+
+    SECTION( "pruning collapses the tree, once the tile is uniform again" ){
+        tree.prune();
+        CHECK( tree.tile_count() == 1 );
+        REQUIRE( tree.store({ 40.5, 70.5}, clear_cell_value ) );
+        tree.prune();
+        CHECK( tree.node_count() == 1 );
+        CHECK( tree.tile_count() == 0 );
+    }
+
+    SECTION( "refilling releases every node at once" ){
+        tree.fill( block_cell_value );
+        CHECK( tree.node_count() == 1 );
+        CHECK( tree.tile_count() == 0 );
+        CHECK( tree.get({ 40.5, 70.5}) == block_cell_value );
+    }
+} // TEST_CASE
+
+TEST_CASE( "HybridTreeLayer builds from a dense grid" ){
+    constexpr uint32_t dimension = HybridTreeLayer<64>::dimension;
+    std::vector<uint8_t> grid( dimension * dimension, clear_cell_value );
+    // a tile-aligned block:
+    for( uint32_t row = 256; row < 512; ++row ){
+        std::fill_n( grid.data() + row*dimension + 256, 256, block_cell_value );
+    }
+    // ... and some noise, in a single tile
+    std::mt19937 generator( 55 );
+    std::uniform_int_distribution<int> distribution( 0, 255 );
+    for( uint32_t row = 640; row < 704; ++row ){
+        for( uint32_t column = 832; column < 896; ++column ){
+            grid[column + row*dimension] = static_cast<uint8_t>( distribution(generator) );
+        }
+    }
+
+    HybridTreeLayer<64> tree;
+    REQUIRE_FALSE( tree.fill( grid.data(), grid.size() - 1 ) );
+    REQUIRE( tree.fill( grid.data(), grid.size() ) );
+    CHECK( tree.tile_count() == 1 );
+    CHECK( tree.height() == 4 );
+
+    for( uint32_t row = 0; row < dimension; ++row ){
+        for( uint32_t column = 0; column < dimension; ++column ){
+            REQUIRE( tree.cell(column, row) == grid[column + row*dimension] );
+        }
+    }
+
+    // an already-minimal tree does not change:
+    const size_t node_count = tree.node_count();
+    tree.prune();
+    CHECK( tree.node_count() == node_count );
+    CHECK( tree.tile_count() == 1 );
+} // TEST_CASE
+
+TEST_CASE( "HybridTreeLayer fills shapes, as a grid does" ){
+    HybridTreeLayer<8> tree( {0, 0}, 256 );
+    REQUIRE( tree.precision() == Approx(0.25) );
+    REQUIRE( tree.visible().min.easting == Approx(-128) );
+    tree.fill( clear_cell_value );
+
+    const BoundBox<LocalLocation> box( {-32.1, -16.1}, {48.1, 8.1} );
+    REQUIRE( tree.fill( box, block_cell_value ) );
+    CHECK( tree.get({0, 0}) == block_cell_value );
+    CHECK( tree.get({-40, 0}) == clear_cell_value );
+
+    const Polygon<LocalLocation> diamond( {{0, 100}, {100, 0}, {0, -100}, {-100, 0}, {0, 100}} );
+    REQUIRE( tree.fill( diamond, tree.visible(), 0x42 ) );
+
+    for( double northing = -127.875; northing < 128; northing += 1.5 ){
+        for( double easting = -127.875; easting < 128; easting += 1.5 ){
+            const double distance = std::abs(easting) + std::abs(northing);
+            if( distance < 99 ){
+                REQUIRE( tree.get({easting, northing}) == 0x42 );
+            }else if( 101 < distance ){
+                REQUIRE( tree.get({easting, northing}) == clear_cell_value );
+            }
+        }
+    }
+    // only the diamond's edge needs tiles:
+    CHECK( tree.tile_count() < (tree.node_count() / 2) );
+
+    // erasing the shape leaves only the background:
+    tree.fill( diamond, tree.visible(), clear_cell_value );
+    CHECK( tree.node_count() == 1 );
+    CHECK( tree.tile_count() == 0 );
+} // TEST_CASE
+
+}   // namespace
@@ -2,13 +2,14 @@
 
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <string>
 
 #include <fmt/core.h>
 
-#include "chart-box/geometry/local-location.hpp"
+#include "geometry/local-location.hpp"
 
 #include "leaf-node.hpp"
 
@@ -67,16 +68,6 @@ void LeafNode<n>::fill( const uint8_t * const source, uint32_t count ){
     memcpy( data_.data(), source, count );
 }
 
-template <uint32_t n>
-uint8_t& LeafNode<n>::get( uint32_t xi, uint32_t yi ) {
-    return data_[ xi + yi*n ];
-}
-
-template <uint32_t n>
-uint8_t LeafNode<n>::get( uint32_t xi, uint32_t yi) const {
-    return data_[ xi + yi*n ];
-}
-
 template <uint32_t n>
 const LocalLocation& LeafNode<n>::origin() const {
     return origin_;
@@ -4,9 +4,10 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
-#include "chart-box/geometry/local-location.hpp"
+#include "geometry/local-location.hpp"
 
 namespace chartbox::layer {
 
@@ -28,6 +29,7 @@ public:
     bool contains( const geometry::LocalLocation& p ) const;
 
     inline uint8_t* data() { return data_.data(); }
+    inline const uint8_t* data() const { return data_.data(); }
 
     inline uint32_t dimension() const { return n; }
 
@@ -49,6 +51,12 @@ public:
 
     inline double scale() const { return scale_; }
 
+    ///! \brief direct access to the cell at column `xi`, row `yi` (from the lower-left corner)
+    inline uint8_t& get( uint32_t xi, uint32_t yi ){
+        return data_[ xi + yi*n ]; }
+    inline uint8_t get( uint32_t xi, uint32_t yi ) const {
+        return data_[ xi + yi*n ]; }
+
     bool set(const geometry::LocalLocation& p, const uint8_t new_value);
 
     ///! \brief the _total_ number of cells in this grid === (width * height)
@@ -63,9 +71,6 @@ private:
     ///! \brief sets tile to all zeros
     void reset();
 
-    uint8_t& get(const uint32_t xi, const uint32_t yi);
-    uint8_t get(const uint32_t xi, const uint32_t yi) const;
-
 private:
     /// \brief === lower-left / minimum-value point.
     /// not strictly necessary, but a useful cache
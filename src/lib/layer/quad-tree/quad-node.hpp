@@ -1,72 +1,51 @@
-// GPL v3 (c) 2021, Daniel Williams 
+// GPL v3 (c) 2021, Daniel Williams
 
 #pragma once
 
+#include <array>
 #include <cstdint>
-#include <iostream>
-#include <memory>
-#include <string>
-
-#include "leaf-node.hpp"
 
 namespace chartbox::layer {
 
-class QuadNode;
-
-class QuadNode {
-public:
-    enum Quadrant { NW, NE, SW, SE };
-
-public:
-    QuadNode();
-    QuadNode(const uint8_t value);
-    ~QuadNode();
-
-    size_t count() const;
-
-    void draw(std::ostream& sink, const std::string& prefix,
-              const std::string& as, const bool show_pointers) const;
-
-    void fill( uint8_t fill_value);
+/// \brief a single node of a `HybridTreeLayer`
+///
+/// Any given node is exactly one of:
+///   (a) a uniform block -- every cell below this node has `value`
+///   (b) a dense tile   -- `index` is a tile, in the tree's tile arena.  (only at the tree's tile level)
+///   (c) a branch       -- `index` is a block of four children, in the tree's branch arena
+///
+/// Nodes hold no pointers, and own nothing; so a whole tree is released by resetting its arenas.
+struct QuadNode {
+    /// \brief children of a branch, in Morton order
+    enum Quadrant : uint8_t { SW, SE, NW, NE };
 
-    size_t height() const;
+    enum Kind : uint8_t { Uniform, Tile, Branch };
 
-    QuadNode* get(QuadNode::Quadrant quad) const;
+    Kind kind = Uniform;
+    uint8_t value = 0;
+    uint32_t index = 0;
 
-    uint8_t get() const;
+    constexpr static QuadNode uniform( uint8_t value ){
+        return { Uniform, value, 0 }; }
 
-    bool operator==(const QuadNode& other) const;
+    constexpr static QuadNode tile( uint32_t index ){
+        return { Tile, 0, index }; }
 
-    ///! \brief coalesce leaf nodes that have the same value
-    void prune();
+    constexpr static QuadNode branch( uint32_t index ){
+        return { Branch, 0, index }; }
 
-    bool is_leaf() const;
+    /// \brief quadrant holding the cell at (column, row), below a node `2*half` cells across
+    constexpr static Quadrant quadrant( uint32_t column, uint32_t row, uint32_t half ){
+        return static_cast<Quadrant>( ((column & half) ? 1 : 0) | ((row & half) ? 2 : 0) ); }
 
-    void set(uint8_t new_value);
-
-    std::string to_string() const;
-
-    void join();
-    void split();
-
-    // typedef union {
-    //     QuadNode quad;
-    //     LeafNode<8> tile;
-    //     // LeafNode<32> tile;
-    // } child_t;
-
-    // By design, any given node will only cantain (a) children or (b) a value.
-    // => If the following uptr, `northeast` has a value, the union will contain
-    // pointers.
-    // => if 'northeast' is empty / null => the union contains leaf-node-values
-    // defined in CCW order:  NE -> NW -> SW -> SE
-    std::unique_ptr<QuadNode> northeast; // ne;
-    std::unique_ptr<QuadNode> northwest; // nw;
-    std::unique_ptr<QuadNode> southwest; // sw;
-    std::unique_ptr<QuadNode> southeast; // se;
-
-    uint8_t value_; 
+    constexpr bool is_leaf() const {
+        return Branch != kind; }
 
+    constexpr bool operator==( const QuadNode& other ) const {
+        return (kind == other.kind) && (value == other.value) && (index == other.index); }
 };
 
+/// \brief the children of a single branch
+typedef std::array<QuadNode,4> QuadBranch;
+
 } // namespace chartbox::layer
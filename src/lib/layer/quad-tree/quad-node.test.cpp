@@ -1,70 +1,44 @@
-// GPL v3 (c) 2021, Daniel Williams 
+// GPL v3 (c) 2021, Daniel Williams
 
-#include <cmath>
 #include <cstddef>
-#include <cstdio>
-#include <iostream>
-#include <sstream>
-#include <string>
-#include <vector>
+#include <cstdint>
 
-#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
-using Catch::Approx;
 
 #include "quad-node.hpp"
 
-using chartbox::geometry::LocalLocation;
- 
 using chartbox::layer::QuadNode;
 
-// ============ ============ LeafNode Tests  ============ ============
+// ============ ============ QuadNode Tests  ============ ============
 TEST_CASE( "QuadNode Default Initialization" ){
     QuadNode n;
 
     CHECK( n.is_leaf() );
-    CHECK( nullptr == n.northeast );
-    CHECK( nullptr == n.northwest );
-    CHECK( nullptr == n.southwest );
-    CHECK( nullptr == n.southeast );
- 
-    CHECK( n.get() == 0);  // check default value
+    CHECK( QuadNode::Uniform == n.kind );
+    CHECK( n.value == 0 );  // check default value
+    CHECK( sizeof(QuadNode) == 8 );
 } // TEST_CASE
 
 TEST_CASE( "QuadNode Simple Initialization" ){
-    QuadNode n(17);
-
-    CHECK( n.is_leaf() );
-    CHECK( nullptr == n.northeast );
-    CHECK( nullptr == n.northwest );
-    CHECK( nullptr == n.southwest );
-    CHECK( nullptr == n.southeast );
- 
-    CHECK( 17 == n.get() );
-}
-
-TEST_CASE( "QuadNode Equality tests value equality" ){
-    QuadNode n1(17);
-    QuadNode n2(17);
-    CHECK(n1 == n2);
-}
-
-TEST_CASE( "QuadNode will explicity splits and join" ){
-    QuadNode n;
-
-    REQUIRE( n.is_leaf() );
-    n.split();
-    REQUIRE( not n.is_leaf() );
+    CHECK( QuadNode::uniform(17).is_leaf() );
+    CHECK( 17 == QuadNode::uniform(17).value );
+    CHECK( QuadNode::tile(3).is_leaf() );
+    CHECK( not QuadNode::branch(3).is_leaf() );
+    CHECK( 3 == QuadNode::branch(3).index );
+} // TEST_CASE
 
-    CHECK( n.northeast->is_leaf() );
-    CHECK( n.northwest->is_leaf() );
-    CHECK( n.southeast->is_leaf() );
-    CHECK( n.southwest->is_leaf() );
+TEST_CASE( "QuadNode Equality tests kind + contents" ){
+    CHECK( QuadNode::uniform(17) == QuadNode::uniform(17) );
+    CHECK( not (QuadNode::uniform(17) == QuadNode::uniform(18)) );
+    CHECK( not (QuadNode::tile(1) == QuadNode::branch(1)) );
+} // TEST_CASE
 
-    n.join();
-    REQUIRE( n.is_leaf() );
-    CHECK( nullptr == n.northeast );
-    CHECK( nullptr == n.northwest );
-    CHECK( nullptr == n.southwest );
-    CHECK( nullptr == n.southeast );
-}
\ No newline at end of file
+TEST_CASE( "QuadNode orders quadrants in Morton order" ){
+    // below a node 8 cells across:
+    CHECK( QuadNode::SW == QuadNode::quadrant( 1, 2, 4 ) );
+    CHECK( QuadNode::SE == QuadNode::quadrant( 5, 2, 4 ) );
+    CHECK( QuadNode::NW == QuadNode::quadrant( 1, 6, 4 ) );
+    CHECK( QuadNode::NE == QuadNode::quadrant( 7, 7, 4 ) );
+    // ... higher bits are ignored
+    CHECK( QuadNode::NE == QuadNode::quadrant( 15, 15, 4 ) );
+} // TEST_CASE
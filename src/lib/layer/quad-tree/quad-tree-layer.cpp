@@ -1,241 +1,272 @@
-// GPL v3 (c) 2020, Daniel Williams 
+// GPL v3 (c) 2020, Daniel Williams
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
-#include <cstdio>
-#include <iostream>
-#include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
-#include "geometry/local-location.hpp"
+#include <fmt/core.h>
 
+#include "geometry/local-location.hpp"
 
 #include "quad-tree-layer.hpp"
 
+using chartbox::geometry::BoundBox;
 using chartbox::geometry::LocalLocation;
 
+using chartbox::layer::MortonLayout;
 using chartbox::layer::QuadTreeLayer;
-using chartbox::layer::QuadNode;
-using chartbox::layer::LeafNode;
-
-
-// main method for descending through a tree and returning the appropriate
-// location / node / value note: weakly optimized; intended to be a hot path.
-QuadNode* descend(const LocalLocation& /*target*/, // double& x_c, double& y_c,
-             const double /*start_width*/, QuadNode* current_node) {
-//     double current_width = start_width;a
-//     double next_width = start_width * 0.5;
-    // LocalLocation out;
-
-//     while (!current_node->is_leaf()) {
-//         current_width = next_width;
-//         next_width *= 0.5;
-
-//         if (target[0] > x_c) {
-//             if (target[1] > y_c) {
-//                 x_c += next_width;
-//                 y_c += next_width;
-//                 current_node = current_node->get_northeast();
-//             } else {
-//                 x_c += next_width;
-//                 y_c -= next_width;
-//                 current_node = current_node->get_southeast();
-//             }
-//         } else {
-//             if (target[1] > y_c) {
-//                 x_c -= next_width;
-//                 y_c += next_width;
-//                 current_node = current_node->get_northwest();
-//             } else {
-//                 x_c -= next_width;
-//                 y_c -= next_width;
-//                 current_node = current_node->get_southwest();
-//             }
-//         }
-//     }
-    return current_node;
-}
+
 
 QuadTreeLayer::QuadTreeLayer()
-    : center_( 0, 0 )
-    , width_2_( static_cast<double>(dimension) / 2.0f )
+    : view_bounds_( {0,0}, {static_cast<double>(dimension), static_cast<double>(dimension)} )
     , precision_( 1.0 )
-{}
+{
+    reset();
+}
 
 QuadTreeLayer::QuadTreeLayer(const LocalLocation& _center, double _width )
-    : center_( _center )
-    , width_2_( _width / 2.0f )
+    : view_bounds_( _center - LocalLocation(_width/2), _center + (_width/2) )
     , precision_( _width/dimension )
-{}
-
-QuadTreeLayer::~QuadTreeLayer() {
-    root->join();
+{
+    reset();
 }
 
 bool QuadTreeLayer::contains(const LocalLocation& p) const {
-    if( (p.easting  < (center_.easting - width_2_)) ||
-        (p.northing < (center_.northing - width_2_)) ||
-        ((center_.easting + width_2_)  < p.easting) ||
-        ((center_.northing + width_2_) < p.northing))
-    {
+    return view_bounds_.contains(p);
+}
+
+bool QuadTreeLayer::fill(const uint8_t fill_value) {
+    leaves_.clear();
+    leaves_.push( 0, root_level, fill_value );
+    return true;
+}
+
+bool QuadTreeLayer::fill( const uint8_t* const buffer, size_t count ){
+    if( (dimension * dimension) != count ){
         return false;
     }
 
+    // visit the cells in Morton order; each push merges any completed, uniform quad.
+    leaves_.clear();
+    for( uint32_t code = 0; code < count; ++code ){
+        const auto cell = MortonLayout::index( code, dimension );
+        leaves_.push( code, 0, buffer[ cell.column + cell.row * dimension ] );
+    }
     return true;
 }
 
-constexpr size_t QuadTreeLayer::calculate_complete_tree(const size_t height) const {
-    // see: https://en.wikipedia.org/wiki/M-ary_tree
-    //      # properties of M-ary trees
-    //
-    //    m == branching_factor == 4  ///< for a quadtree, this is trivially 4
-    //
-    //       (h+1)
-    //     m        - 1
-    // N = ---------------
-    //        m - 1
-    //
-    return (pow(4, height + 1) - 1) / 3;
+bool QuadTreeLayer::get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+    if( values.size() < points.size() ){
+        return false;
+    }
+
+    for( size_t point_index = 0; point_index < points.size(); ++point_index ){
+        values[point_index] = get( points[point_index] );
+    }
+    return true;
 }
 
-double QuadTreeLayer::load_factor() const {
-    const size_t height = root->height();
-    const size_t actual_count = root->count();
-    const size_t complete_count = calculate_complete_tree(height);
-    return static_cast<double>(actual_count) / static_cast<double>(complete_count);
+uint8_t QuadTreeLayer::get( const LocalLocation& p, uint8_t or_default_value ) const {
+    return contains(p) ? get(p) : or_default_value;
 }
 
-size_t QuadTreeLayer::memory_usage() const {
-    return size() * sizeof(QuadNode);
+uint32_t QuadTreeLayer::height() const {
+    return root_level - *std::min_element( leaves_.levels.begin(), leaves_.levels.end() );
 }
 
-void QuadTreeLayer::fill(const uint8_t fill_value) {
-    root->fill(fill_value);
+double QuadTreeLayer::load_factor() const {
+    return static_cast<double>(size()) / static_cast<double>(dimension * dimension);
 }
 
-uint32_t QuadTreeLayer::height() const {
-    return root->height() - 1;
+uint32_t QuadTreeLayer::lookup( const uint32_t i, const uint32_t j ) const {
+    return static_cast<uint32_t>( leaves_.find( MortonLayout::offset( i, j, dimension ) ) );
+}
+
+size_t QuadTreeLayer::memory_usage() const {
+    return size() * (sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint8_t));
 }
 
 void QuadTreeLayer::prune() {
-    root->prune();
+    scratch_.clear();
+    for( size_t i = 0; i < leaves_.size(); ++i ){
+        scratch_.push( leaves_.keys[i], leaves_.levels[i], leaves_.values[i] );
+    }
+    std::swap( leaves_, scratch_ );
 }
 
 void QuadTreeLayer::reset() {
-    if( root )
-        root->join();
+    fill( default_cell_value );
 }
 
-void QuadTreeLayer::split( double width ) {
-    width_2_ = width/2;
-    precision_ = width_2_/dimension;
-    // TODO: implement!
-    // auto current = root;
-    // while( ??? ){
-        // if (precision >= width) {
-        //     return;
-        // }
-
-        // if (is_leaf()) {
-        //     split();
-        // }
-
-        // const double half_width = width / 2;
-
-        // this->northeast->split(precision, half_width);
-        // this->northwest->split(precision, half_width);
-        // this->southeast->split(precision, half_width);
-        // this->southwest->split(precision, half_width);
-    // }
+size_t QuadTreeLayer::size() const {
+    return leaves_.size();
 }
 
-uint8_t QuadTreeLayer::get( const LocalLocation& /*p*/, uint8_t or_default_value ) const {
-    // TODO: implement tree-descend-and-retreive
-    // return contains(p) ? root->get(p) : or_default_value;
-    return or_default_value;
+void QuadTreeLayer::split( double width ) {
+    precision_ = width / dimension;
+    view_bounds_.max = view_bounds_.min + width;
 }
 
-bool QuadTreeLayer::store( const LocalLocation& /*p*/, const uint8_t new_value ){
-    if(contains(p)){
-        return false;
-        // TODO: implement tree-descend-and-store
-        // root->set( p, new_value);
-        // return true;
+bool QuadTreeLayer::store( const LocalLocation& p, const uint8_t new_value ){
+    if( visible(p) ){
+        const LocalLocation relative = p - view_bounds_.min;
+        return store_span( to_cell(relative.northing), to_cell(relative.easting), to_cell(relative.easting), new_value );
     }
     return false;
 }
 
-size_t QuadTreeLayer::size() const { 
-    return root->count();
-}
-
-// template<typename T>
-// void Terrain<T>::debug() const {
-//     const Layout& layout = impl.get_layout();
-//     const double precision = layout.get_precision();
-//     const size_t dimension = layout.get_dimension();
-
-//     cerr << "====== Structure: ======\n";
-//     cerr << "##  layout:     " << layout.to_json().dump() << endl;
-//     // cerr << "##  height:     " << get_height() << endl;
-//     cerr << "##  precision:  " << precision << endl;
-//     cerr << "##  dimension:  " << dimension << endl;
-
-//     cerr << "           ======== ======== ======== ======== As Grid: ======== ======== ======== ========\n";
-//     // print header (x-axis-labels: 
-//     cerr << "             ";
-//     for(double x = (layout.get_x_min() + precision/2); x < layout.get_x_max(); x += precision){
-//         fprintf(stderr, "%5.2f ", x);
-//     } cerr << endl;
-//     // print top border
-//     cerr << "           +";
-//     for(double x = (layout.get_x_min() + precision/2); x < layout.get_x_max(); x += precision){
-//         fprintf(stderr, "------");
-//     } cerr << "---+\n";
-
-//     for(double y = (layout.get_y_max() - precision/2); y > layout.get_y_min(); y -= precision ){
-//         // print left header:
-//         fprintf(stderr, "     %5.2f | ", y);
-//         for(double x = (layout.get_x_min() + precision/2); x < layout.get_x_max(); x += precision){
-//             auto value = impl.classify({x,y});
-//             if( 0 < value ){
-//                 fprintf(stderr, "   %2X,", static_cast<int>(value) );
-//             }else{
-//                 cerr << "     ,";
-//             }
-//         }
-//         // print right header:
-//         fprintf(stderr, "  | %5.2f\n", y);
-//     }
-//     // print bottom border
-//     cerr << "           +";
-//     for(double x = (layout.get_x_min() + precision/2); x < layout.get_x_max(); x += precision){
-//         fprintf(stderr, "------");
-//     } cerr << "---+\n";
-//     // print footer: (x-axis-labels: 
-//     cerr << "             ";
-//     for(double x = (layout.get_x_min() + precision/2); x < layout.get_x_max(); x += precision){
-//         fprintf(stderr, "%5.2f ", x);
-//     } cerr << endl << endl;
-// }
+bool QuadTreeLayer::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+    if( (dimension <= row) || (dimension <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min<uint32_t>( last_column, dimension - 1 );
+
+    // Morton codes increase along a row; so the span overlaps a contiguous run of leaves:
+    const size_t first_leaf = leaves_.find( MortonLayout::offset( first_column, row, dimension ) );
+    const size_t last_leaf = leaves_.find( MortonLayout::offset( last_column, row, dimension ) );
+    if( std::all_of( leaves_.values.begin() + first_leaf, leaves_.values.begin() + last_leaf + 1, [=]( uint8_t each ){ return value == each; } ) ){
+        return true;
+    }
+
+    // set aside every leaf from the first overlapped leaf onwards; then re-push them, with the span cut in.
+    // (pushing onto the untouched leaves lets a new leaf merge with its earlier siblings.)
+    scratch_.clear();
+    scratch_.keys.assign( leaves_.keys.begin() + first_leaf, leaves_.keys.end() );
+    scratch_.levels.assign( leaves_.levels.begin() + first_leaf, leaves_.levels.end() );
+    scratch_.values.assign( leaves_.values.begin() + first_leaf, leaves_.values.end() );
+    leaves_.keys.resize( first_leaf );
+    leaves_.levels.resize( first_leaf );
+    leaves_.values.resize( first_leaf );
+
+    uint32_t column = first_column;
+    uint32_t cell = MortonLayout::offset( first_column, row, dimension );
+    size_t next = 0;
+    for( ; next <= (last_leaf - first_leaf); ++next ){
+        const uint32_t end = scratch_.keys[next] + cells_in_level( scratch_.levels[next] );
+        uint32_t cursor = scratch_.keys[next];
+        for( ; (column <= last_column) && (cell < end); ++column ){
+            leaves_.push_range( cursor, cell, scratch_.values[next] );
+            leaves_.push( cell, 0, value );
+            cursor = cell + 1;
+            cell = MortonLayout::next_column( cell, dimension );
+        }
+        leaves_.push_range( cursor, end, scratch_.values[next] );
+    }
 
+    // The last leaf can only merge with leaves inside its own parent.  Once the next leaf falls outside that parent,
+    // no later leaf can merge with any rewritten leaf -- and the rest of the list is copied back as-is.
+    for( ; next < scratch_.size(); ++next ){
+        const uint32_t back_level = leaves_.levels.back();
+        const uint32_t parent_end = (leaves_.keys.back() | (cells_in_level(back_level + 1) - 1)) + 1;
+        if( (root_level <= back_level) || (parent_end <= scratch_.keys[next]) ){
+            break;
+        }
+        leaves_.push( scratch_.keys[next], scratch_.levels[next], scratch_.values[next] );
+    }
+    leaves_.keys.insert( leaves_.keys.end(), scratch_.keys.begin() + next, scratch_.keys.end() );
+    leaves_.levels.insert( leaves_.levels.end(), scratch_.levels.begin() + next, scratch_.levels.end() );
+    leaves_.values.insert( leaves_.values.end(), scratch_.values.begin() + next, scratch_.values.end() );
+    return true;
+}
 
 std::string QuadTreeLayer::summary() const {
     std::ostringstream buffer;
-    buffer.imbue(std::locale(""));
     buffer << "====== QuadTree Stats: ======\n";
-    // buffer << "##  layout:       " << impl.get_layout().to_string() << '\n';
-
     buffer << "##  width:        " << width() << '\n';
     buffer << "##  precision:    " << precision() << '\n';
     buffer << "##  dimension:    " << dimension << '\n';
-    buffer << "##  size:         " << size() <<  " nodes  ===  " << memory_usage()/1000 << " kilobytes\n";
+    buffer << "##  height:       " << height() << '\n';
+    buffer << "##  size:         " << size() <<  " leaves  ===  " << memory_usage()/1000 << " kilobytes\n";
     buffer << "##  compression:  " << load_factor() << '\n';
     buffer << '\n';
     return buffer.str();
 }
 
+std::string QuadTreeLayer::to_cell_content_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= ======= Print Contents By Cell: ======= ======= =======\n";
+    for (uint32_t cell_row_index = dimension - 1; cell_row_index < dimension; --cell_row_index) {
+        buf << prefix << "    ";
+        for (uint32_t cell_column_index = 0; cell_column_index < dimension; ++cell_column_index ) {
+            buf << fmt::format(" {:2X}", leaves_.values[lookup(cell_column_index, cell_row_index)] );
+        }
+        buf << '\n';
+    }
+    buf << prefix << "======== ======= ======= ======= ======= ======= ======= =======\n";
+    return buf.str();
+}
+
+std::string QuadTreeLayer::to_property_string( uint32_t indent ) const {
+    std::ostringstream buf;
+    const std::string prefix = fmt::format("{:<{}}", "", indent );
+    buf << prefix << "======== ======= Properties: ======= =======\n";
+    buf << fmt::format( "{}    ::bounds-min:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.min.easting, view_bounds_.min.northing );
+    buf << fmt::format( "{}    ::bounds-max:             {:8.1f}, {:8.1f}\n", prefix, view_bounds_.max.easting, view_bounds_.max.northing );
+    buf << fmt::format( "{}    ::cells-across-view:      {:6d}\n", prefix, dimension );
+    buf << fmt::format( "{}    ::meters-across-cell:     {:6.1f}\n", prefix, precision_ );
+    buf << fmt::format( "{}    ::height:                 {:6d}\n", prefix, height() );
+    buf << fmt::format( "{}    ::leaf-count:             {:6d}\n", prefix, size() );
+    return buf.str();
+}
+
+bool QuadTreeLayer::view( const BoundBox<LocalLocation>& box ){
+    if( (box.width() > width()) || (box.height() > width()) ){
+        return false;
+    }
+
+    view_bounds_.min = box.min;
+    view_bounds_.max = box.min + width();
+    return true;
+}
+
 double QuadTreeLayer::width() const {
-    return width_2_ * 2;
+    return view_bounds_.width();
+}
+
+// ====== ====== ====== ====== LeafList ====== ====== ====== ======
+
+void QuadTreeLayer::LeafList::clear(){
+    keys.clear();
+    levels.clear();
+    values.clear();
+}
+
+void QuadTreeLayer::LeafList::push( uint32_t key, uint8_t level, uint8_t value ){
+    keys.push_back( key );
+    levels.push_back( level );
+    values.push_back( value );
+
+    // the last four leaves are siblings iff they share a level, and the first of them starts its parent
+    // (the leaves are contiguous, so the other three must be its siblings)
+    while( (4 <= keys.size()) && (level < root_level) ){
+        const size_t first = keys.size() - 4;
+        if( 0 != (keys[first] & (cells_in_level(level + 1) - 1)) ){
+            return;
+        }
+        for( size_t i = first; i < keys.size(); ++i ){
+            if( (level != levels[i]) || (value != values[i]) ){
+                return;
+            }
+        }
+
+        keys.resize( first + 1 );
+        levels.resize( first + 1 );
+        values.resize( first + 1 );
+        levels[first] = ++level;
+    }
+}
+
+void QuadTreeLayer::LeafList::push_range( uint32_t first, uint32_t last, uint8_t value ){
+    while( first < last ){
+        // the largest block which is aligned at `first`, and fits before `last`
+        const uint32_t aligned_level = (0 == first) ? root_level : (std::countr_zero(first) / 2);
+        const uint32_t fit_level = (std::bit_width(last - first) - 1) / 2;
+        const uint32_t level = std::min( aligned_level, fit_level );
+        push( first, static_cast<uint8_t>(level), value );
+        first += cells_in_level( level );
+    }
 }
@@ -1,46 +1,60 @@
-// GPL v3 (c) 2021, Daniel Williams 
+// GPL v3 (c) 2021, Daniel Williams
 
 #pragma once
 
-
+#include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
-#include <iostream>
-#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
+#include "layer/cell-layout.hpp"
 #include "layer/layer-interface.hpp"
 
-#include "leaf-node.hpp"
-#include "quad-node.hpp"
-
 namespace chartbox::layer {
 
 
 ///! \brief Quad Tree for representing 2D data
 ///!     note: the quad tree as a whole is square -- in precision, and real-world-units
 ///!     note: each node / level / leaf is also square -- in real world units
-///! 
+///!
+///! This is a _linear_ quadtree: there are no interior nodes, and no pointers.  The tree is stored as its leaves only,
+///! sorted by the Morton code of each leaf's south-west cell.  Each leaf is an aligned block of 4^level cells, with
+///! a single value; together the leaves tile the entire layer.  A lookup is a binary search over the leaf keys:
+///! O(log(leaves)) <= O(2*depth).
+///!
+///! Every write keeps the leaf list canonical: whenever four sibling leaves hold the same value, they are merged
+///! into their parent.  (i.e. uniform regions are pruned as they are written)
+///!
 ///! The implementation currently requires pre-determined bounds for data as it
 ///! can not rebalance itself to that degree.
-///! 
+///!
+///! Sources / Inspiration / Further Reading
+///! 1. "An Effective Way to Represent Quadtrees", Irene Gargantini, 1982
+///!     - https://doi.org/10.1145/358728.358741
 class QuadTreeLayer final : public LayerInterface<QuadTreeLayer> {
 public:
 
     /// \brief number of cells along each dimension of the entire tree
     constexpr static uint32_t dimension = 1024;
 
+    /// \brief level of the root: a leaf at level `l` is `2^l` cells across
+    constexpr static uint32_t root_level = std::countr_zero( dimension );
+
     /// \brief name of this layer's type
     constexpr static char type_name_[] = "QuadTreeLayer";
 
 public:
     /**
-     * Constructs a new quad tree, centered at 0,0 and 1024 units wide, square
-     * 
+     * Constructs a new quad tree, with its south-west corner at 0,0 and 1024 units wide, square
+     *
      * Use this constructor if the tree will be loaded from a config file, and the initialization values do not matter.
      */
     QuadTreeLayer();
-    
+
     /**
      * Constructs a new quad tree.
      *
@@ -49,12 +63,9 @@ public:
      */
     QuadTreeLayer( const geometry::LocalLocation& center, double width );
 
-    /**
-     *  Releases all memory associated with this quad tree.
-     */
-    ~QuadTreeLayer();
+    ~QuadTreeLayer() = default;
 
-    constexpr size_t calculate_complete_tree(const size_t height) const;
+    inline uint32_t cells_across_view() const { return dimension; }
 
     /**
      * Returns true if the point at (x, y) exists in the tree.
@@ -65,62 +76,78 @@ public:
      */
     bool contains(const geometry::LocalLocation& p) const;
 
-    /**
-     * retrieve the value of the requested point `p`. 
-     *
-     * @param {double} x The x-coordinate.
-     * @param {double} y The y-coordinate.
-     * @param {uint8_t} opt_default The default value to return if the node doesn't
-     *                 exist.
-     * @return {uint8_t} The value of the node, if available; or the default value.
-     */
-    uint8_t classify(const geometry::LocalLocation& p) const;
-
-    /**
-     * Draws a simple debug representation of this tree to the given
-     * output stream. 
-     *
-     */
-    void debug_tree( bool show_pointer=false) const;
-
     ///! \brief sets all leaf nodes to the given value
     ///!       override from LayerInterface
     ///! \param fill_value - value to write
-    void fill( uint8_t fill_value);
+    bool fill( uint8_t fill_value);
 
+    /// \brief build the tree from a dense grid of cells
+    ///
+    /// \param buffer - `dimension` x `dimension` cells; row-major, from the south-west corner
+    /// \param count - cell count of the buffer
+    /// \return false if the buffer is the wrong size
     bool fill( const uint8_t* const buffer, size_t count );
 
+    bool fill( const Path<LocalLocation>& path, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+        return super().fill( path, bounds, value); }
+
+    bool fill( const BoundBox<LocalLocation>& box, const uint8_t value ){
+        return super().fill( box, value ); }
+
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
+        return super().fill( poly, bound, value ); }
+
+    /// \brief depth of the deepest leaf below the root
     uint32_t height() const;
-    
+
+    /// \brief ratio of leaves to cells.  (1.0 => no compression at all)
     double load_factor() const;
-    
+
+    /// \brief bytes held by the leaves of this tree
     size_t memory_usage() const;
 
-    uint8_t get( const geometry::LocalLocation& p) const;
+    inline uint8_t get( const geometry::LocalLocation& p ) const {
+        if( visible(p) ){
+            const LocalLocation relative = p - view_bounds_.min;
+            return leaves_.values[ leaves_.find( MortonLayout::offset( to_cell(relative.easting), to_cell(relative.northing), dimension ) ) ];
+        }
+        return default_cell_value;
+    }
+
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const;
+
+    ///! \brief Classify what value the requested point `p` has.
+    ///!
+    ///! \param location to sample near
+    ///! \param or_default_value - value to return, if `p` is outside the tree
+    ///! @return the value _actually_ contained in the tree.
+    uint8_t get(const geometry::LocalLocation& p, uint8_t or_default_value ) const;
 
+    /// \brief index of the leaf which contains the cell at column `i`, row `j`
     uint32_t lookup( const uint32_t i, const uint32_t j ) const;
 
-    // uint32_t lookup( const geometry::LocalLocation& p ) const;
+    inline double meters_across_cell() const { return precision_; }
 
+    /// \brief merge any four sibling leaves with the same value
+    ///
+    /// (every write already does this; this pass is only needed to repair a tree built by other means.)
     void prune();
 
-    ///! \brief resets _the tree_ to fully populate the bounds at the given precision
+    ///! \brief resets _the tree_ to a single leaf, of the default value
     void reset();
 
-    ///! \brief Classify what value the requested point `p` has.
-    ///!
-    ///! This method is designed for use with an interpolation algorithm.
-    ///! 
-    ///! \param location to sample near
-    ///! @return the point-value-pair _actually_ contained in the tree.
-    uint8_t get(const geometry::LocalLocation& p, uint8_t or_default_value ) const;
+    double precision() const {
+        return precision_; }
 
-    double precision() const;
-    
+    /// \brief number of leaves in the tree
     size_t size() const;
 
+    /// \brief resize the tree to the given width; every leaf keeps its cells.
     void split( double width );
-    
+
     ///! \brief store a value in the tree, at point `p`
     ///!
     ///! This is the primary method to populate a useable tree.
@@ -130,17 +157,87 @@ public:
     ///! \return success - fails if out-of-bounds.
     bool store(const geometry::LocalLocation& p, const uint8_t new_value);
 
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    /// \note a write splits and re-merges only the leaves it overlaps -- but must shift every later leaf.  Writes
+    ///       of large areas are much cheaper as spans (or as a bulk `fill`) than as single cells.
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value );
+
     std::string summary() const;
-    
+
+    /// \brief Draws a simple debug representation of this tree to stderr
+    std::string to_cell_content_string( uint32_t indent = 0 ) const;
+    std::string to_location_content_string( uint32_t indent = 0 ) const { return super().to_location_content_string(indent); }
+    std::string to_property_string( uint32_t indent = 0 ) const;
+
+    /// \brief this layer does not scroll; see: `view`
+    bool track( const BoundBox<LocalLocation>& /*bounds*/ ){
+        return false; }
+    const BoundBox<LocalLocation>& tracked() const {
+        return visible(); }
+    bool tracked(const LocalLocation& p) const {
+        return visible(p); }
+
+    /// \brief move the tree to the given bounds.  (the width of the tree is unchanged)
+    bool view(const BoundBox<LocalLocation>& box );
+    const BoundBox<LocalLocation>& visible() const {
+        return view_bounds_; }
+    bool visible(const LocalLocation& p) const {
+        return view_bounds_.contains(p); }
+
     double width() const;
 
 private:
-    ///! the data layout this tree represents
-    geometry::LocalLocation center_;
-    double width_2_;
+    /// \brief the leaves of a tree, in Morton order
+    struct LeafList {
+        /// \brief Morton code of the south-west cell of each leaf
+        std::vector<uint32_t> keys;
+        /// \brief a leaf at level `l` covers 4^l cells
+        std::vector<uint8_t> levels;
+        std::vector<uint8_t> values;
+
+        void clear();
+
+        /// \brief index of the leaf which contains the given cell: the last leaf whose key is not after `code`
+        ///
+        /// (a branchless binary search; the first key is always zero)
+        inline size_t find( uint32_t code ) const {
+            const uint32_t* base = keys.data();
+            for( size_t count = keys.size(); 1 < count; ){
+                const size_t half = count / 2;
+                base = (base[half] <= code) ? (base + half) : base;
+                count -= half;
+            }
+            return static_cast<size_t>( base - keys.data() );
+        }
+
+        /// \brief append the next leaf -- and merge it into its parent, if all four siblings now match
+        void push( uint32_t key, uint8_t level, uint8_t value );
+
+        /// \brief append the cells [first, last) as a sequence of aligned leaves
+        void push_range( uint32_t first, uint32_t last, uint8_t value );
+
+        inline size_t size() const { return keys.size(); }
+    };
+
+    /// \brief number of cells in a leaf at the given level
+    constexpr static uint32_t cells_in_level( uint32_t level ){
+        return 1u << (2*level); }
+
+    /// \brief cell index along one axis.  (points on the max-border are clamped inside the tree)
+    inline uint32_t to_cell( double meters ) const {
+        return std::min( static_cast<uint32_t>( meters / precision_ ), dimension - 1 ); }
+
+private:
+    // this tracks the bounds of the visible grid
+    geometry::BoundBox<LocalLocation> view_bounds_;
     double precision_;
 
-    std::unique_ptr<QuadNode> root;
+    LeafList leaves_;
+
+    /// \brief scratch storage for rewriting the leaves; kept to avoid reallocating on every write
+    LeafList scratch_;
 
 private:
     LayerInterface<QuadTreeLayer>& super() {
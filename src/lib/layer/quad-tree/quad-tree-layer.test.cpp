@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdio>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -14,22 +15,155 @@ using Catch::Approx;
 
 #include "quad-tree-layer.hpp"
 
-// using chartbox::geometry::BoundBox;
+using chartbox::geometry::BoundBox;
 using chartbox::geometry::LocalLocation;
 //using chartbox::geometry::UTMLocation;
  
 using chartbox::layer::QuadTreeLayer;
-using chartbox::layer::QuadNode;
-using chartbox::layer::LeafNode;
 
 
 namespace chartbox::layer {
 
 // ============ ============ QuadTreeLayer Tests  ============ ============
 
-TEST_CASE( "QuadTreeLayer placeholder " ){
-    //const LeafNode<4> leaf({0,0});
-    // CHECK( leaf.get( 00 .offset() == 5 );
+TEST_CASE( "QuadTreeLayer starts as a single leaf" ){
+    QuadTreeLayer tree;
+    CHECK( tree.size() == 1 );
+    CHECK( tree.height() == 0 );
+    CHECK( tree.precision() == Approx(1.0) );
+    CHECK( tree.width() == Approx(1024.0) );
+
+    CHECK( tree.get({   0.5,    0.5}) == default_cell_value );
+    CHECK( tree.get({1023.5, 1023.5}) == default_cell_value );
+    CHECK( tree.get({  -0.5,    0.5}) == default_cell_value );
+    CHECK( tree.get({  -0.5,    0.5}, 0x42) == 0x42 );
+} // TEST_CASE
+
+TEST_CASE( "QuadTreeLayer stores + splits single cells" ){
+    QuadTreeLayer tree;
+    tree.fill( clear_cell_value );
+
+    REQUIRE( tree.store({ 5.5, 3.5}, 0x42 ) );
+    REQUIRE_FALSE( tree.store({ -1, 3.5}, 0x42 ) );
+    CHECK( tree.get({ 5.5, 3.5}) == 0x42 );
+    CHECK( tree.get({ 4.5, 3.5}) == clear_cell_value );
+    CHECK( tree.get({ 5.5, 2.5}) == clear_cell_value );
+    // one split at each level, down to the cell: 3 siblings per level, plus the cell itself
+    CHECK( tree.height() == QuadTreeLayer::root_level );
+    CHECK( tree.size() == (3 * QuadTreeLayer::root_level + 1) );
+
+    SECTION( "writing the same value is a no-op" ){
+        REQUIRE( tree.store({ 5.5, 3.5}, 0x42 ) );
+        CHECK( tree.size() == (3 * QuadTreeLayer::root_level + 1) );
+    }
+
+    SECTION( "restoring the cell merges the tree back into a single leaf" ){
+        REQUIRE( tree.store({ 5.5, 3.5}, clear_cell_value ) );
+        CHECK( tree.size() == 1 );
+        CHECK( tree.height() == 0 );
+    }
+
+    SECTION( "completing a uniform quad merges its leaves" ){
+        tree.store({ 4.5, 2.5}, 0x42 );
+        tree.store({ 5.5, 2.5}, 0x42 );
+        CHECK( tree.size() == (3 * QuadTreeLayer::root_level + 1) );
+        tree.store({ 4.5, 3.5}, 0x42 );
+        CHECK( tree.size() == (3 * (QuadTreeLayer::root_level - 1) + 1) );
+        CHECK( tree.height() == (QuadTreeLayer::root_level - 1) );
+        CHECK( tree.get({ 4.5, 2.5}) == 0x42 );
+        CHECK( tree.get({ 3.5, 2.5}) == clear_cell_value );
+    }
+} // TEST_CASE
+
+TEST_CASE( "QuadTreeLayer builds from a dense grid" ){
+    constexpr uint32_t dimension = QuadTreeLayer::dimension;
+    std::vector<uint8_t> grid( dimension * dimension, clear_cell_value );
+    // an aligned block, in the south-west quadrant:
+    for( uint32_t row = 256; row < 512; ++row ){
+        std::fill_n( grid.data() + row*dimension + 256, 256, block_cell_value );
+    }
+    // ... and a single cell, in the north-east quadrant
+    grid[ 700 + 900*dimension ] = 0x42;
+
+    QuadTreeLayer tree;
+    REQUIRE_FALSE( tree.fill( grid.data(), grid.size() - 1 ) );
+    REQUIRE( tree.fill( grid.data(), grid.size() ) );
+
+    // south-west quadrant: 4 leaves.  north-east quadrant: 3 per level, below the root's children + the cell
+    CHECK( tree.size() == (2 + 4 + (3*(QuadTreeLayer::root_level - 1) + 1)) );
+    CHECK( tree.load_factor() < 0.0001 );
+
+    for( uint32_t row = 0; row < dimension; row += 3 ){
+        for( uint32_t column = 0; column < dimension; column += 3 ){
+            REQUIRE( tree.get({column + 0.5, row + 0.5}) == grid[column + row*dimension] );
+        }
+    }
+    CHECK( tree.get({700.5, 900.5}) == 0x42 );
+
+    const size_t leaf_count = tree.size();
+    tree.prune();
+    CHECK( tree.size() == leaf_count );
+} // TEST_CASE
+
+TEST_CASE( "QuadTreeLayer stays canonical under random writes" ){
+    constexpr uint32_t dimension = QuadTreeLayer::dimension;
+    std::vector<uint8_t> grid( dimension * dimension, clear_cell_value );
+    QuadTreeLayer tree;
+    tree.fill( clear_cell_value );
+
+    // few values, clustered in one corner => many merges
+    std::mt19937 generator( 55 );
+    std::uniform_int_distribution<uint32_t> position( 0, 63 );
+    std::uniform_int_distribution<uint32_t> length( 0, 15 );
+    std::uniform_int_distribution<uint32_t> value( 0, 1 );
+    for( size_t i = 0; i < 4000; ++i ){
+        const uint32_t row = position(generator);
+        const uint32_t first = position(generator);
+        const uint32_t last = first + length(generator);
+        const uint8_t each = static_cast<uint8_t>( value(generator) );
+        REQUIRE( tree.store_span( row, first, last, each ) );
+        std::fill( grid.data() + row*dimension + first, grid.data() + row*dimension + last + 1, each );
+    }
+
+    for( uint32_t row = 0; row < 96; ++row ){
+        for( uint32_t column = 0; column < 96; ++column ){
+            REQUIRE( tree.get({column + 0.5, row + 0.5}) == grid[column + row*dimension] );
+        }
+    }
+
+    // a canonical tree has nothing left to prune:
+    const size_t leaf_count = tree.size();
+    tree.prune();
+    CHECK( tree.size() == leaf_count );
+} // TEST_CASE
+
+TEST_CASE( "QuadTreeLayer fills shapes, as a grid does" ){
+    QuadTreeLayer tree( {0, 0}, 256 );
+    REQUIRE( tree.precision() == Approx(0.25) );
+    REQUIRE( tree.visible().min.easting == Approx(-128) );
+    tree.fill( clear_cell_value );
+
+    const BoundBox<LocalLocation> box( {-32.1, -16.1}, {48.1, 8.1} );
+    REQUIRE( tree.fill( box, block_cell_value ) );
+
+    const Polygon<LocalLocation> diamond( {{0, 100}, {100, 0}, {0, -100}, {-100, 0}, {0, 100}} );
+    REQUIRE( tree.fill( diamond, tree.visible(), 0x42 ) );
+
+    for( double northing = -127.875; northing < 128; northing += 1.5 ){
+        for( double easting = -127.875; easting < 128; easting += 1.5 ){
+            const double distance = std::abs(easting) + std::abs(northing);
+            if( distance < 99 ){
+                REQUIRE( tree.get({easting, northing}) == 0x42 );
+            }else if( 101 < distance ){
+                REQUIRE( tree.get({easting, northing}) == clear_cell_value );
+            }
+        }
+    }
+
+    // erasing the shapes leaves only the background:
+    tree.fill( diamond, tree.visible(), clear_cell_value );
+    tree.fill( box, clear_cell_value );
+    CHECK( tree.size() == 1 );
 } // TEST_CASE
 
 }   // namespace
@@ -0,0 +1,140 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "geometry/local-location.hpp"
+#include "layer/grid-ray.hpp"
+
+namespace chartbox::layer {
+
+/// \brief the distance reported by `raycast`, for a line which meets no blocking cell
+constexpr double raycast_clear = std::numeric_limits<double>::infinity();
+
+/// \brief the part of a line which lies on a grid -- in cells from the grid's south-west corner
+struct RayClip {
+    double start_x;
+    double start_y;
+    double end_x;
+    double end_y;
+
+    /// \brief meters from the line's origin, to the start of the clipped part
+    double start_distance;
+
+    /// \brief meters along the clipped part
+    double length;
+
+    /// \brief meters from the line's origin, to a fraction of the clipped part
+    inline double distance( double fraction ) const {
+        return start_distance + fraction * length; }
+};
+
+/// \brief clip the line from `origin` to `target` to a grid of cells
+///
+/// \param grid_origin - south-west corner of the grid
+/// \param meters_across_cell - width of each cell
+/// \param columns, rows - cell count across each dimension of the grid
+/// \param clip - [out] the part of the line on the grid
+/// \return false if the line misses the grid
+inline bool clip_ray( const geometry::LocalLocation& grid_origin, double meters_across_cell, uint32_t columns, uint32_t rows,
+                      const geometry::LocalLocation& origin, const geometry::LocalLocation& target, RayClip& clip ){
+    const double x0 = (origin.easting - grid_origin.easting) / meters_across_cell;
+    const double y0 = (origin.northing - grid_origin.northing) / meters_across_cell;
+    const double dx = (target.easting - origin.easting) / meters_across_cell;
+    const double dy = (target.northing - origin.northing) / meters_across_cell;
+
+    // Liang-Barsky: narrow [t0, t1] by each edge of the grid
+    double t0 = 0;
+    double t1 = 1;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { x0, columns - x0, y0, rows - y0 };
+    for( int edge = 0; edge < 4; ++edge ){
+        if( 0 == p[edge] ){
+            if( q[edge] < 0 ){
+                return false;
+            }
+        }else if( p[edge] < 0 ){
+            t0 = std::max( t0, q[edge] / p[edge] );
+        }else{
+            t1 = std::min( t1, q[edge] / p[edge] );
+        }
+    }
+    if( t1 < t0 ){
+        return false;
+    }
+
+    // (each end stays inside the grid: an end on the north or east edge is in the last row or column)
+    const double max_x = std::nextafter( static_cast<double>(columns), 0.0 );
+    const double max_y = std::nextafter( static_cast<double>(rows), 0.0 );
+    clip.start_x = std::clamp( x0 + t0 * dx, 0.0, max_x );
+    clip.start_y = std::clamp( y0 + t0 * dy, 0.0, max_y );
+    clip.end_x = std::clamp( x0 + t1 * dx, 0.0, max_x );
+    clip.end_y = std::clamp( y0 + t1 * dy, 0.0, max_y );
+
+    const double length = std::hypot( dx, dy ) * meters_across_cell;
+    clip.start_distance = t0 * length;
+    clip.length = (t1 - t0) * length;
+    return true;
+}
+
+/// \brief walk the cells of a clipped line, in order, until one of them blocks
+///
+/// \param threshold - cells with at least this value block the line
+/// \param probe - `probe(column, row)` returns the value of a cell on the grid
+/// \return meters from the line's origin to where it enters the first blocking cell; or `raycast_clear`
+template<typename probe_t>
+double trace_ray( const RayClip& clip, uint8_t threshold, probe_t&& probe ){
+    GridRay ray( clip.start_x, clip.start_y, clip.end_x, clip.end_y );
+    while( true ){
+        if( threshold <= probe( ray.column(), ray.row() ) ){
+            return clip.distance( ray.entry() );
+        }else if( ray.done() ){
+            return raycast_clear;
+        }
+        ray.step();
+    }
+}
+
+/// \brief walk a clipped line over square blocks of cells; walk cell by cell only the blocks which might block
+///
+/// Block (i, j) covers the columns [i*block_across, (i+1)*block_across) of the clip's grid, and likewise its rows.
+///
+/// \param block_across - cells across each block
+/// \param block_probe - `block_probe(block_column, block_row)` returns an upper bound on every cell of that block
+/// \param probe - `probe(column, row)` returns the value of a cell on the grid
+/// \return as `trace_ray`
+template<typename block_probe_t, typename probe_t>
+double trace_blocks( const RayClip& clip, uint8_t threshold, uint32_t block_across, block_probe_t&& block_probe, probe_t&& probe ){
+    const double across = block_across;
+    GridRay block( clip.start_x / across, clip.start_y / across, clip.end_x / across, clip.end_y / across );
+    while( true ){
+        if( threshold <= block_probe( block.column(), block.row() ) ){
+            // the part of the line inside this block -- kept inside, against rounding
+            const double entry = block.entry();
+            const double exit = block.exit();
+            const double west = block.column() * across;
+            const double south = block.row() * across;
+            const double east = std::nextafter( west + across, west );
+            const double north = std::nextafter( south + across, south );
+            const RayClip part = { std::clamp( clip.start_x + entry * (clip.end_x - clip.start_x), west, east ),
+                                   std::clamp( clip.start_y + entry * (clip.end_y - clip.start_y), south, north ),
+                                   std::clamp( clip.start_x + exit * (clip.end_x - clip.start_x), west, east ),
+                                   std::clamp( clip.start_y + exit * (clip.end_y - clip.start_y), south, north ),
+                                   clip.distance( entry ), clip.distance( exit ) - clip.distance( entry ) };
+            const double distance = trace_ray( part, threshold, probe );
+            if( raycast_clear != distance ){
+                return distance;
+            }
+        }
+        if( block.done() ){
+            return raycast_clear;
+        }
+        block.step();
+    }
+}
+
+} // namespace
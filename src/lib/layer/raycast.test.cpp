@@ -0,0 +1,69 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "raycast.hpp"
+
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::RayClip;
+using chartbox::layer::clip_ray;
+using chartbox::layer::raycast_clear;
+using chartbox::layer::trace_ray;
+
+namespace {
+
+TEST_CASE( "clip_ray keeps the part of a line on the grid" ){
+    RayClip clip;
+
+    SECTION( "a line inside the grid is unchanged" ){
+        REQUIRE( clip_ray( {0, 0}, 1.0, 8, 8, {1.5, 2.5}, {6.5, 2.5}, clip ) );
+        CHECK( clip.start_x == Approx(1.5) );
+        CHECK( clip.end_x == Approx(6.5) );
+        CHECK( clip.start_distance == Approx(0) );
+        CHECK( clip.length == Approx(5) );
+    }
+
+    SECTION( "a line from outside the grid starts at its edge -- at the same distance from the origin" ){
+        REQUIRE( clip_ray( {10, 10}, 2.0, 8, 8, {0, 12}, {40, 12}, clip ) );
+        CHECK( clip.start_x == Approx(0) );
+        CHECK( clip.start_y == Approx(1) );
+        CHECK( clip.end_x < 8 );
+        CHECK( clip.end_x == Approx(8) );
+        CHECK( clip.start_distance == Approx(10) );
+        CHECK( clip.length == Approx(16) );
+        CHECK( clip.distance(0.5) == Approx(18) );
+    }
+
+    SECTION( "a line which misses the grid" ){
+        CHECK_FALSE( clip_ray( {0, 0}, 1.0, 8, 8, {-5, 9}, {9, 9}, clip ) );
+        CHECK_FALSE( clip_ray( {0, 0}, 1.0, 8, 8, {-5, -1}, {-1, 4}, clip ) );
+    }
+} // TEST_CASE
+
+TEST_CASE( "trace_ray stops at the first blocking cell" ){
+    // a 4x4 grid, with one wall cell:
+    std::array<uint8_t, 16> cells = {};
+    cells[ 2 + 1*4 ] = 0xFF;
+    const auto probe = [&]( int64_t column, int64_t row ){ return cells[ column + row*4 ]; };
+
+    RayClip clip;
+    REQUIRE( clip_ray( {0, 0}, 1.0, 4, 4, {0.5, 1.5}, {3.5, 1.5}, clip ) );
+    CHECK( trace_ray( clip, 0x80, probe ) == Approx(1.5) );
+    CHECK( trace_ray( clip, 0x00, probe ) == Approx(0) );
+
+    // ... or no cell at all:
+    REQUIRE( clip_ray( {0, 0}, 1.0, 4, 4, {0.5, 0.5}, {3.5, 0.5}, clip ) );
+    CHECK( raycast_clear == trace_ray( clip, 0x80, probe ) );
+
+    // ... including the start cell
+    REQUIRE( clip_ray( {0, 0}, 1.0, 4, 4, {2.5, 1.5}, {0.5, 1.5}, clip ) );
+    CHECK( trace_ray( clip, 0x80, probe ) == Approx(0) );
+} // TEST_CASE
+
+}   // namespace
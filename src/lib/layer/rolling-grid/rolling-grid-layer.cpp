@@ -1,10 +1,17 @@
 // GPL v3 (c) 2021, Daniel Williams 
 
+#include <cstring>
+
 #include "geometry/bound-box.hpp"
 #include "geometry/local-location.hpp"
 #include "geometry/polygon.hpp"
+#include "layer/batch-index.hpp"
+#include "layer/grid-ray.hpp"
+#include "layer/raycast.hpp"
 
 #include "rolling-grid-layer.hpp"
+#include "sector-loader.hpp"
+#include "sector-pool.hpp"
 
 #include "io/flatbuffer.hpp"
 
@@ -21,7 +28,17 @@ RollingGridLayer<cells_across_sector_>::RollingGridLayer()
     , track_bounds_( {0,0}, {meters_across_view_,meters_across_view_} )
     , view_bounds_( {0,0}, {meters_across_view_,meters_across_view_} )
 {
-    fill( chartbox::layer::default_cell_value );
+    for( auto& each_sector : sectors_ ){
+        each_sector = std::make_unique<sector_t>( chartbox::layer::default_cell_value );
+    }
+    publish();
+}
+
+template<uint32_t cells_across_sector_>
+RollingGridLayer<cells_across_sector_>::~RollingGridLayer(){
+    // (the loader may still retire buffers, as it finishes its saves)
+    loader_.reset();
+    delete frame_.load();
 }
 
 template<uint32_t cells_across_sector_>
@@ -30,6 +47,7 @@ bool RollingGridLayer<cells_across_sector_>::center() {
     view_bounds_.min = { center.easting - meters_across_view_/2, center.northing - meters_across_view_/2 };
     view_bounds_.max = { center.easting + meters_across_view_/2, center.northing + meters_across_view_/2 };
     view_bounds_ = view_bounds_.snap( meters_across_sector_, meters_across_view_ );
+    publish();
     return true;
 }
 
@@ -38,6 +56,9 @@ bool RollingGridLayer<cells_across_sector_>::enable_cache( std::filesystem::path
     if( new_path.empty() ){
         fmt::print(stderr, "<<!! No path given !! : {}\n", new_path.string() );
         return false;
+    }else if( chartbox::io::flatbuffer::archive_extension == new_path.extension() ){
+        // single-file tile archive (created if missing)
+        return chartbox::io::flatbuffer::enable( new_path );
     }else if( not std::filesystem::is_directory(new_path) ){
         fmt::print(stderr, "    !! Could contour input path is not a directory!!: {}\n", new_path.string());
         return false;
@@ -46,50 +67,276 @@ bool RollingGridLayer<cells_across_sector_>::enable_cache( std::filesystem::path
     return chartbox::io::flatbuffer::enable( new_path );
 }
 
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::enable_concurrent_readers( bool enable ){
+    if( enable && (not epochs_) ){
+        epochs_ = std::make_unique<EpochDomain>();
+        if( loader_ ){
+            loader_->retire_with( [this]( std::unique_ptr<sector_t> sector ){ epochs_->retire( std::move(sector) ); } );
+        }
+    }else if( (not enable) && epochs_ ){
+        if( loader_ ){
+            loader_->retire_with( {} );
+            // (wait for any buffer which is still being retired)
+            loader_->flush();
+        }
+        // frees every retired frame + buffer
+        epochs_.reset();
+    }
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::enable_persistence( bool enable ){
+    if( not enable ){
+        // (finishes any outstanding saves)
+        enable_prefetch( false );
+    }
+    persistent_ = enable;
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::enable_prefetch( bool enable ){
+    if( enable && (not persistent_) ){
+        // (nothing to load)
+        return false;
+    }else if( enable && (not loader_) ){
+        loader_ = std::make_unique<SectorLoader<cells_across_sector_>>();
+        if( epochs_ ){
+            loader_->retire_with( [this]( std::unique_ptr<sector_t> sector ){ epochs_->retire( std::move(sector) ); } );
+        }
+    }else if( (not enable) && loader_ ){
+        // (the destructor finishes any outstanding saves)
+        loader_.reset();
+    }
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::enable_pool( size_t capacity ){
+    if( 0 < capacity ){
+        if( not pool_ ){
+            pool_ = std::make_unique<SectorPool<cells_across_sector_>>( capacity );
+        }
+        pool_->capacity( capacity );
+    }else if( not pool_ ){
+        return true;
+    }
+
+    // write back any sectors beyond the (new) capacity
+    std::vector<std::unique_ptr<sector_t>> spares;
+    while( (0 == capacity) ? (0 < pool_->size()) : pool_->full() ){
+        LocalLocation origin;
+        auto sector = pool_->evict( origin );
+        write_back( std::move(sector), origin, spares );
+    }
+    if( 0 == capacity ){
+        pool_.reset();
+    }
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::enable_pyramid( bool enable ){
+    if( enable && (0 == level_count()) ){
+        return false;
+    }
+
+    pyramid_enabled_ = enable;
+    for( auto& each_sector : sectors_ ){
+        each_sector->enable_pyramid( enable );
+    }
+    if( pool_ ){
+        pool_->for_each( [&]( sector_t& sector, const LocalLocation& ){ sector.enable_pyramid( enable ); });
+    }
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+uint8_t RollingGridLayer<cells_across_sector_>::get( const LocalLocation& p, uint32_t level ) const {
+    if( (0 == level) || (not pyramid_enabled_) ){
+        return get( p );
+    }else if( not visible(p) ){
+        return chartbox::layer::default_cell_value;
+    }
+
+    level = std::min( level, level_count() );
+    const CellAddress address = locate( p - view_bounds_.min, anchor_ );
+    const uint32_t column = (address.cell % cells_across_sector_) >> level;
+    const uint32_t row = (address.cell / cells_across_sector_) >> level;
+    return sectors_[ address.sector ]->level_data( level )[ column + row * sector_t::cells_across_level(level) ];
+}
+
+template<uint32_t cells_across_sector_>
+uint8_t RollingGridLayer<cells_across_sector_>::max( const BoundBox<LocalLocation>& box, uint32_t level ) const {
+    return max( *frame_.load(), box, pyramid_enabled_ ? std::min( level, level_count() ) : 0 );
+}
+
+template<uint32_t cells_across_sector_>
+uint8_t RollingGridLayer<cells_across_sector_>::max( const Frame& frame, const BoundBox<LocalLocation>& box, uint32_t level ){
+    const BoundBox<LocalLocation>& view = frame.view_bounds;
+    const BoundBox<LocalLocation> clipped( { std::max(box.min.easting, view.min.easting), std::max(box.min.northing, view.min.northing) },
+                                           { std::min(box.max.easting, view.max.easting), std::min(box.max.northing, view.max.northing) } );
+    if( (clipped.max.easting < clipped.min.easting) || (clipped.max.northing < clipped.min.northing) ){
+        return chartbox::layer::default_cell_value;
+    }
+
+    // view-relative cells covered by the box:  (the max-border is inclusive, as in `BoundBox::contains`)
+    const auto cell_of = [&]( double meters ){
+        return std::min( cells_across_view_ - 1, static_cast<uint32_t>(meters * cells_across_meter_) ); };
+    const uint32_t first_column = cell_of( clipped.min.easting - view.min.easting );
+    const uint32_t last_column = cell_of( clipped.max.easting - view.min.easting );
+    const uint32_t first_row = cell_of( clipped.min.northing - view.min.northing );
+    const uint32_t last_row = cell_of( clipped.max.northing - view.min.northing );
+
+    uint8_t result = 0;
+    for( uint32_t sector_row = first_row / cells_across_sector_; sector_row <= last_row / cells_across_sector_; ++sector_row ){
+        for( uint32_t sector_column = first_column / cells_across_sector_; sector_column <= last_column / cells_across_sector_; ++sector_column ){
+            const sector_t& sector = *frame.sectors[ wrap(sector_column + frame.anchor.column) + wrap(sector_row + frame.anchor.row) * sectors_across_view_ ];
+            const uint32_t sector_level = sector.has_pyramid() ? level : 0;
+            const uint32_t level_across = sector_t::cells_across_level( sector_level );
+            const uint8_t* cells = sector.level_data( sector_level );
+
+            // range of this sector's cells covered by the box, at this level:
+            const uint32_t column_begin = (std::max( first_column, sector_column * cells_across_sector_ ) % cells_across_sector_) >> sector_level;
+            const uint32_t column_end = (std::min( last_column, (sector_column + 1) * cells_across_sector_ - 1 ) % cells_across_sector_) >> sector_level;
+            const uint32_t row_begin = (std::max( first_row, sector_row * cells_across_sector_ ) % cells_across_sector_) >> sector_level;
+            const uint32_t row_end = (std::min( last_row, (sector_row + 1) * cells_across_sector_ - 1 ) % cells_across_sector_) >> sector_level;
+            for( uint32_t row = row_begin; row <= row_end; ++row ){
+                const uint8_t* row_cells = cells + row * level_across;
+                result = std::max( result, *std::max_element( row_cells + column_begin, row_cells + column_end + 1 ) );
+            }
+        }
+    }
+    return result;
+}
+
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const {
+    if( distances.size() < targets.size() ){
+        return false;
+    }
+
+    const auto cell = [this]( int64_t column, int64_t row ){
+        const CellAddress address = locate( static_cast<uint32_t>(column), static_cast<uint32_t>(row), anchor_ );
+        return (*sectors_[ address.sector ])[ address.cell ]; };
+
+    // without a pyramid: walk every cell
+    if( (0 == raycast_level) || (not pyramid_enabled_) ){
+        for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+            RayClip clip;
+            if( clip_ray( view_bounds_.min, meters_across_cell_, cells_across_view_, cells_across_view_, origin, targets[target_index], clip ) ){
+                distances[target_index] = trace_ray( clip, threshold, cell );
+            }else{
+                distances[target_index] = raycast_clear;
+            }
+        }
+        return true;
+    }
+
+    // with a pyramid: walk the level-cells; descend into those which might block
+    constexpr uint32_t level = raycast_level;
+    constexpr uint32_t level_shift = cell_shift_ - level;
+    constexpr uint32_t level_across = sector_t::cells_across_level( level );
+    const auto level_cell = [this]( int64_t column, int64_t row ){
+        const uint32_t sector = wrap( static_cast<uint32_t>(column >> level_shift) + anchor_.column )
+                              + wrap( static_cast<uint32_t>(row >> level_shift) + anchor_.row ) * sectors_across_view_;
+        return sectors_[sector]->level_data( level )[ (column & (level_across - 1)) + (row & (level_across - 1)) * level_across ]; };
+
+    for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+        RayClip clip;
+        if( clip_ray( view_bounds_.min, meters_across_cell_, cells_across_view_, cells_across_view_, origin, targets[target_index], clip ) ){
+            distances[target_index] = trace_blocks( clip, threshold, 1u << level, level_cell, cell );
+        }else{
+            distances[target_index] = raycast_clear;
+        }
+    }
+    return true;
+}
+
 template<uint32_t cells_across_sector_>
 bool RollingGridLayer<cells_across_sector_>::fill( uint8_t value){
     for( auto& each_sector : sectors_){
-        each_sector.fill(value);
+        each_sector->fill(value);
+        each_sector->dirty(true);
     }
     return true;
 }
 
 template<uint32_t cells_across_sector_>
-bool RollingGridLayer<cells_across_sector_>::flush_to_cache() const {
+bool RollingGridLayer<cells_across_sector_>::flush_to_cache() {
+    if( not persistent_ ){
+        return true;
+    }else if( loader_ ){
+        // write-behind saves are older than the current contents:
+        loader_->flush();
+    }
 
     for( uint32_t at_row = 0; at_row < sectors_across_view_; ++at_row ){
         for( uint32_t at_column = 0; at_column < sectors_across_view_; ++at_column ){
+            // view-relative index => ring index
             const GridIndex at_index( at_column, at_row );
+            sector_t& sector = *sectors_[ GridIndex( wrap(at_column + anchor_.column), wrap(at_row + anchor_.row) ).offset(sectors_across_view_) ];
 
-            auto& sector = sectors_[at_index.offset(sectors_across_view_)];
-            
             const LocalLocation relative_location = LocalLocation(at_index.column, at_index.row) * meters_across_sector_;
             const LocalLocation absolute_location = view_bounds_.min + relative_location;
 
             // fmt::print( stderr, "{:>16s}@[ {}, {}]:   >> store: ( {}, {} )\n", "", at_index.column, at_index.row, absolute_location.easting, absolute_location.northing );
-            chartbox::io::flatbuffer::save( sector, absolute_location );
+            save_sector( sector, absolute_location );
         }
     }
 
-    return true;
+    if( pool_ ){
+        pool_->for_each( []( sector_t& sector, const LocalLocation& origin ){
+            save_sector( sector, origin ); });
+    }
+
+    return chartbox::io::flatbuffer::flush();
 }
 
 
 template<uint32_t cells_across_sector_>
 bool RollingGridLayer<cells_across_sector_>::load_from_cache() {
-    if( chartbox::io::flatbuffer::active() ){
+    if( not persistent_ ){
+        return true;
+    }else if( chartbox::io::flatbuffer::active() ){
+        if( loader_ ){
+            loader_->discard_prefetched();
+            loader_->flush();
+        }
+
         for( uint32_t at_row = 0; at_row < sectors_across_view_; ++at_row ){
             for( uint32_t at_column = 0; at_column < sectors_across_view_; ++at_column ){
 
-                const GridIndex index(at_column, at_row);
+                // view-relative index => ring index
+                const GridIndex index( wrap(at_column + anchor_.column), wrap(at_row + anchor_.row) );
                 const LocalLocation sector_offset = { at_column*meters_across_sector_, at_row*meters_across_sector_ };
                 const LocalLocation sector_origin = view_bounds_.min + sector_offset ;
 
                 auto& sector = sectors_[index.offset(sectors_across_view_)];
-
-                chartbox::io::flatbuffer::load( sector_origin, sector);
+                if( pool_ ){
+                    if( auto pooled = pool_->take( sector_origin ) ){
+                        discard( std::move(sector) );
+                        sector = std::move( pooled );
+                        sector->enable_pyramid( pyramid_enabled_ );
+                        continue;
+                    }
+                }
+
+                if( epochs_ ){
+                    // (readers may still hold this buffer: load into a fresh one)
+                    auto fresh = std::make_unique<sector_t>();
+                    load_sector( sector_origin, *fresh );
+                    fresh->enable_pyramid( pyramid_enabled_ );
+                    discard( std::move(sector) );
+                    sector = std::move( fresh );
+                }else{
+                    load_sector( sector_origin, *sector );
+                }
             }
         }
+        publish();
 
         // fmt::print( "    <<< Successfully Loaded Cache @ {},{}\n", view_bounds_.min.easting, view_bounds_.min.northing );
     }else{
@@ -100,35 +347,70 @@ bool RollingGridLayer<cells_across_sector_>::load_from_cache() {
 }
 
 template<uint32_t cells_across_sector_>
-uint8_t RollingGridLayer<cells_across_sector_>::get(const LocalLocation& layer_location ) const {
-
-    if( visible(layer_location) ){
-        
-        const LocalLocation view_location = layer_location - view_bounds_.min;
-
-        const GridIndex view_index = GridIndex( static_cast<uint32_t>(view_location.easting), 
-                                                static_cast<uint32_t>(view_location.northing) )
-                                            .div(meters_across_cell_);
+bool RollingGridLayer<cells_across_sector_>::get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+    // (this thread's frame is always current)
+    return get( *frame_.load(std::memory_order_relaxed), points, values );
+}
 
-        /// index of the sector to lookup in
-        const size_t sector_offset = view_index.div(cells_across_sector_)
-                                                .add(anchor_)
-                                                .wrap(sectors_across_view_)
-                                                .offset(sectors_across_view_);
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::get( const Frame& frame, std::span<const LocalLocation> points, std::span<uint8_t> values ){
+    if( values.size() < points.size() ){
+        return false;
+    }
 
-        /// location of cell within sector (indexed above)
-        const size_t cell_offset = view_index.mod(cells_across_sector_)
-                                            .offset(cells_across_sector_);
+    size_t point_index = 0;
+
+#if defined(__AVX2__)
+    if constexpr ( power_of_two_sector_ ){
+        const __m128i cell_mask = _mm_set1_epi32( cell_mask_ );
+        const __m128i anchor_column = _mm_set1_epi32( frame.anchor.column );
+        const __m128i anchor_row = _mm_set1_epi32( frame.anchor.row );
+        const __m128i sectors_across = _mm_set1_epi32( sectors_across_view_ );
+
+        alignas(16) std::array<uint32_t,batch_width> sector_offsets;
+        alignas(16) std::array<uint32_t,batch_width> cell_offsets;
+
+        for( ; (point_index + batch_width) <= points.size(); point_index += batch_width ){
+            __m256d easting, northing;
+            load_x4( &points[point_index], frame.view_bounds.min, easting, northing );
+            const int visible_lanes = within_x4( easting, northing, meters_across_view_, meters_across_view_ );
+            if( 0 == visible_lanes ){
+                std::fill_n( &values[point_index], batch_width, default_cell_value );
+                continue;
+            }
 
-        // current_index.get_sector()  // refactor idea ==> retreives raw-index to sector-within-layer
-        // current_index.get_cell()    // refactor idea: retreives raw-index to cell-within-sector
-        // const auto& current_sector = sectors[ sector_index ];
-        uint8_t current_cell_value = sectors_[ sector_offset ][ cell_offset ];
+            // view-relative index of each cell
+            const __m128i column = floor_divide_x4( easting, meters_across_cell_, cells_across_meter_ );
+            const __m128i row = floor_divide_x4( northing, meters_across_cell_, cells_across_meter_ );
+
+            /// index of the sector to lookup in
+            const __m128i sector_column = wrap_x4( _mm_add_epi32(_mm_srli_epi32(column, cell_shift_), anchor_column), sectors_across_view_ );
+            const __m128i sector_row = wrap_x4( _mm_add_epi32(_mm_srli_epi32(row, cell_shift_), anchor_row), sectors_across_view_ );
+            _mm_store_si128( reinterpret_cast<__m128i*>(sector_offsets.data()),
+                             _mm_add_epi32(sector_column, _mm_mullo_epi32(sector_row, sectors_across)) );
+
+            /// location of cell within sector (indexed above)
+            _mm_store_si128( reinterpret_cast<__m128i*>(cell_offsets.data()),
+                             _mm_add_epi32( _mm_and_si128(column, cell_mask),
+                                            _mm_slli_epi32(_mm_and_si128(row, cell_mask), cell_shift_)) );
+
+            for( uint32_t lane = 0; lane < batch_width; ++lane ){
+                if( visible_lanes & (1 << lane) ){
+                    values[point_index + lane] = (*frame.sectors[ sector_offsets[lane] ])[ cell_offsets[lane] ];
+                }else{
+                    values[point_index + lane] = default_cell_value;
+                }
+            }
+        }
+    }
+#endif
 
-        return current_cell_value;
+    // remainder (and fallback):
+    for( ; point_index < points.size(); ++point_index ){
+        values[point_index] = get( frame, points[point_index] );
     }
 
-    return default_cell_value;
+    return true;
 }
 
 template<uint32_t cells_across_sector_>
@@ -146,7 +428,7 @@ std::string RollingGridLayer<cells_across_sector_>::to_cell_content_string( uint
             }
 
             const size_t sector_index = (cell_column_index/cells_across_sector_) + (cell_row_index/cells_across_sector_)*sectors_across_view_;
-            const auto& current_sector = sectors_[ sector_index ];
+            const auto& current_sector = *sectors_[ sector_index ];
 
             const GridIndex cell_lookup_index( cell_column_index%cells_across_sector_, cell_row_index%cells_across_sector_ );
             const uint8_t current_cell_value = current_sector.get( cell_lookup_index );
@@ -190,7 +472,7 @@ bool RollingGridLayer<cells_across_sector_>::track( const LocalLocation& new_ori
 
     view_bounds_.min = track_bounds_.min;
     view_bounds_.max = track_bounds_.max;
-    
+    publish();
     return true;
 }
 
@@ -227,156 +509,236 @@ bool RollingGridLayer<cells_across_sector_>::track( const BoundBox<UTMLocation>&
 }
 
 template<uint32_t cells_across_sector_>
-bool RollingGridLayer<cells_across_sector_>::scroll_east() {
- const auto& last_bounds = view_bounds_;
-    const LocalLocation delta( meters_across_sector_, 0.0 );
-    const auto next_bounds = last_bounds.move( delta );
-    const uint32_t at_column = static_cast<uint32_t>(anchor_.column + 1 + sectors_across_view_)%sectors_across_view_;
-    const GridIndex next_anchor{ at_column, anchor_.row };
+size_t RollingGridLayer<cells_across_sector_>::plan_moves( int64_t shift_columns, int64_t shift_rows, std::array<SectorMove,sectors_in_view_>& moves ) const {
+    const auto next_min = view_bounds_.min + LocalLocation( shift_columns, shift_rows ) * meters_across_sector_;
+    const GridIndex next_anchor( ring_offset( anchor_.column, shift_columns ), ring_offset( anchor_.row, shift_rows ) );
 
+    size_t move_count = 0;
     for( uint32_t at_row = 0; at_row < sectors_across_view_; ++at_row ){
-        const GridIndex at_index( anchor_.column, at_row );
-        auto& sector = sectors_[at_index.offset(sectors_across_view_)];
+        for( uint32_t at_column = 0; at_column < sectors_across_view_; ++at_column ){
+            // view-relative index of this sector: before + after the move
+            const GridIndex last_index( ring_offset( at_column, -static_cast<int64_t>(anchor_.column) ),
+                                        ring_offset( at_row, -static_cast<int64_t>(anchor_.row) ) );
+            const GridIndex next_index( ring_offset( at_column, -static_cast<int64_t>(next_anchor.column) ),
+                                        ring_offset( at_row, -static_cast<int64_t>(next_anchor.row) ) );
+
+            // sectors which stay in view keep their contents, and just change their position in the ring
+            const int64_t kept_column = static_cast<int64_t>(last_index.column) - shift_columns;
+            const int64_t kept_row = static_cast<int64_t>(last_index.row) - shift_rows;
+            if( (0 <= kept_column) && (kept_column < sectors_across_view_) && (0 <= kept_row) && (kept_row < sectors_across_view_) ){
+                continue;
+            }
+
+            moves[move_count++] = { GridIndex(at_column, at_row).offset(sectors_across_view_),
+                                    view_bounds_.min + LocalLocation( last_index.column, last_index.row ) * meters_across_sector_,
+                                    next_min + LocalLocation( next_index.column, next_index.row ) * meters_across_sector_ };
+        }
+    }
+    return move_count;
+}
+
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::relocate( const LocalLocation& new_origin ){
+    // whole-sector shift of the view:
+    const int64_t shift_columns = std::llround( (new_origin.easting - view_bounds_.min.easting) / meters_across_sector_ );
+    const int64_t shift_rows = std::llround( (new_origin.northing - view_bounds_.min.northing) / meters_across_sector_ );
+    if( (0 == shift_columns) && (0 == shift_rows) ){
+        return true;
+    }
+
+    // (1) find the sectors which leave the view -- each is re-used for a sector which enters
+    std::array<SectorMove, sectors_in_view_> moves;
+    const size_t move_count = plan_moves( shift_columns, shift_rows, moves );
+
+    // (2) take any entering sectors which are in the pool -- before the leaving sectors push them out of it
+    std::array<std::unique_ptr<sector_t>, sectors_in_view_> pooled;
+    if( pool_ ){
+        for( size_t move_index = 0; move_index < move_count; ++move_index ){
+            pooled[move_index] = pool_->take( moves[move_index].to );
+        }
+    }
 
-        // (A) Store values to old location
-        const LocalLocation from_location = (LocalLocation( at_index.column, at_index.row) * meters_across_sector_) + last_bounds.min;
-        // fmt::print( stderr, "    @[ {}, {}]:   >> store: ( {}, {} )\n", at_index.column, at_index.row, from_location.easting, from_location.northing );
-        chartbox::io::flatbuffer::save( const_cast<const sector_t&>(sector), from_location );
+    // (3) retire each leaving sector -- into the pool, or to its old location in the cache
+    std::vector<std::unique_ptr<sector_t>> spares;
+    for( size_t move_index = 0; move_index < move_count; ++move_index ){
+        retire( std::move(sectors_[moves[move_index].slot]), moves[move_index].from, spares );
+    }
+
+    // (4) load the rest of the entering sectors from the cache
+    if( loader_ ){
+        // (queue every miss before waiting on any of them)
+        for( size_t move_index = 0; move_index < move_count; ++move_index ){
+            if( not pooled[move_index] ){
+                loader_->prefetch( moves[move_index].to );
+            }
+        }
+    }
+    for( size_t move_index = 0; move_index < move_count; ++move_index ){
+        auto& sector = sectors_[moves[move_index].slot];
+        if( pooled[move_index] ){
+            sector = std::move( pooled[move_index] );
+        }else{
+            sector = acquire( moves[move_index].to, spares );
+        }
+        // (fresh buffers start without a pyramid)
+        if( pyramid_enabled_ != sector->has_pyramid() ){
+            sector->enable_pyramid( pyramid_enabled_ );
+        }
+    }
+    if( loader_ ){
+        loader_->discard_prefetched();
+    }
 
-        // (B) Load values at new location 
-        const LocalLocation to_location( (next_bounds.max.easting - meters_across_sector_), from_location.northing );
-        // fmt::print( stderr, "                << load:  ( {}, {} )\n", to_location.easting, to_location.northing );
-        chartbox::io::flatbuffer::load( to_location, sector);
+    anchor_ = GridIndex( ring_offset( anchor_.column, shift_columns ), ring_offset( anchor_.row, shift_rows ) );
+    view_bounds_ = view_bounds_.move( LocalLocation( shift_columns, shift_rows ) * meters_across_sector_ );
+    heading_columns_ = (0 < shift_columns) - (shift_columns < 0);
+    heading_rows_ = (0 < shift_rows) - (shift_rows < 0);
+    publish();
+
+    if( loader_ ){
+        // (5) predict the next move: one more sector in the same direction
+        const size_t predicted_count = plan_moves( heading_columns_, heading_rows_, moves );
+        for( size_t move_index = 0; move_index < predicted_count; ++move_index ){
+            // (pooled sectors are newer than the cache)
+            if( (not pool_) || (not pool_->contains( moves[move_index].to )) ){
+                loader_->prefetch( moves[move_index].to );
+            }
+        }
     }
 
-    anchor_ = next_anchor;
-    view_bounds_ = next_bounds;
     return true;
 }
 
 template<uint32_t cells_across_sector_>
-bool RollingGridLayer<cells_across_sector_>::scroll_north() {
-    const auto& last_bounds = view_bounds_;
-    const LocalLocation delta( 0.0, meters_across_sector_);
-    const auto next_bounds = last_bounds.move( delta );
-    const uint32_t at_row = static_cast<uint32_t>(anchor_.row + 1 + sectors_across_view_)%sectors_across_view_;
-    const GridIndex next_anchor{ anchor_.column, at_row };
-
-    for( uint32_t at_column = 0; at_column < sectors_across_view_; ++at_column ){
-        const GridIndex at_index( at_column, anchor_.row );
-        auto& sector = sectors_[at_index.offset(sectors_across_view_)];
+void RollingGridLayer<cells_across_sector_>::retire( std::unique_ptr<sector_t> sector, const LocalLocation& origin, std::vector<std::unique_ptr<sector_t>>& spares ){
+    if( pool_ ){
+        LocalLocation evicted_origin;
+        auto evicted = pool_->put( std::move(sector), origin, evicted_origin );
+        if( evicted ){
+            write_back( std::move(evicted), evicted_origin, spares );
+        }
+        return;
+    }
 
-        // (A) Store values to old location
-        const LocalLocation from_location = (LocalLocation(at_index.column, at_index.row) * meters_across_sector_) + last_bounds.min;
-        // fmt::print( stderr, "    @[ {}, {}]:   >> store: ( {}, {} )\n", at_index.column, at_index.row, from_location.easting, from_location.northing );
-        chartbox::io::flatbuffer::save( const_cast<const sector_t&>(sector), from_location );
+    write_back( std::move(sector), origin, spares );
+}
 
-        // (B) Load values at new location 
-        const LocalLocation to_location( from_location.easting, next_bounds.max.northing-meters_across_sector_ );
-        // fmt::print( stderr, "                << load:  ( {}, {} )\n", to_location.easting, to_location.northing );
-        chartbox::io::flatbuffer::load( to_location, sector);
+template<uint32_t cells_across_sector_>
+void RollingGridLayer<cells_across_sector_>::write_back( std::unique_ptr<sector_t> sector, const LocalLocation& origin, std::vector<std::unique_ptr<sector_t>>& spares ){
+    if( loader_ ){
+        // (the loader recycles the buffer)
+        loader_->save( std::move(sector), origin );
+        return;
     }
 
-    anchor_ = next_anchor;
-    view_bounds_ = next_bounds;
-    return true;
+    if( persistent_ ){
+        save_sector( *sector, origin );
+    }
+    if( epochs_ ){
+        // (a reader may still hold this buffer)
+        discard( std::move(sector) );
+    }else{
+        spares.push_back( std::move(sector) );
+    }
 }
 
 template<uint32_t cells_across_sector_>
-bool RollingGridLayer<cells_across_sector_>::scroll_south() {
-    const auto& last_bounds = view_bounds_;
-    const LocalLocation delta( 0.0, -meters_across_sector_);
-    const auto next_bounds = last_bounds.move( delta );
-    
-    const uint32_t at_row = (anchor_.row + sectors_across_view_ - 1 ) % sectors_across_view_;
-    const GridIndex next_anchor{ anchor_.column, at_row };
-
-    for( uint32_t at_column = 0; at_column < sectors_across_view_; ++at_column ){
-        const GridIndex at_index( at_column, at_row );
-        auto& sector = sectors_[at_index.offset(sectors_across_view_)];
-
-        // (A) Store values to old location
-        const LocalLocation from_location = (LocalLocation(at_index.column, at_index.row) * meters_across_sector_) + last_bounds.min;
-        // fmt::print( stderr, "    @[ {}, {}]:   >> store: ( {}, {} )\n", at_index.column, at_index.row, from_location.easting, from_location.northing );
-        chartbox::io::flatbuffer::save( const_cast<const sector_t&>(sector), from_location );
-
-        // (B) Load values at new location 
-        const LocalLocation to_location( from_location.easting, next_bounds.min.northing );
-        // fmt::print( stderr, "                << load:  ( {}, {} )\n", to_location.easting, to_location.northing );
-        chartbox::io::flatbuffer::load( to_location, sector);
-    }
-
-    anchor_ = next_anchor;
-    view_bounds_ = next_bounds;
-    return true;
+void RollingGridLayer<cells_across_sector_>::discard( std::unique_ptr<sector_t> sector ){
+    if( epochs_ ){
+        epochs_->retire( std::move(sector) );
+    }
 }
 
 template<uint32_t cells_across_sector_>
-bool RollingGridLayer<cells_across_sector_>::scroll_west() {
-    const auto& last_bounds = view_bounds_;
-    const LocalLocation delta( -meters_across_sector_, 0.0 );
-    const auto next_bounds = last_bounds.move( delta );
+void RollingGridLayer<cells_across_sector_>::publish(){
+    auto frame = std::make_unique<Frame>( Frame{ view_bounds_, anchor_, {} } );
+    for( uint32_t index = 0; index < sectors_in_view_; ++index ){
+        frame->sectors[index] = sectors_[index].get();
+    }
 
-    const uint32_t at_column = (anchor_.column + sectors_across_view_ - 1 )% sectors_across_view_;
-    const GridIndex next_anchor{ at_column, anchor_.row };
+    // readers which pinned before this swap may still hold the last frame:
+    std::unique_ptr<const Frame> last( frame_.exchange( frame.release() ) );
+    if( epochs_ ){
+        if( last ){
+            epochs_->retire( std::move(last) );
+        }
+        epochs_->collect();
+    }
+}
 
-    for( uint32_t at_row = 0; at_row < sectors_across_view_; ++at_row ){
-        const GridIndex at_index( at_column, at_row );
-        auto& sector = sectors_[at_index.offset(sectors_across_view_)];
+template<uint32_t cells_across_sector_>
+std::unique_ptr<typename RollingGridLayer<cells_across_sector_>::sector_t> RollingGridLayer<cells_across_sector_>::acquire( const LocalLocation& origin, std::vector<std::unique_ptr<sector_t>>& spares ){
+    if( loader_ ){
+        return loader_->load( origin );
+    }
 
-        // (A) Store values to old location
-        const LocalLocation from_location = (LocalLocation( at_index.column, at_index.row) * meters_across_sector_) + last_bounds.min;
-        // fmt::print( stderr, "    @[ {}, {}]:   >> store: ( {}, {} )\n", at_index.column, at_index.row, from_location.easting, from_location.northing );
-        chartbox::io::flatbuffer::save( const_cast<const sector_t&>(sector), from_location );
+    std::unique_ptr<sector_t> sector;
+    if( spares.empty() ){
+        sector = std::make_unique<sector_t>();
+    }else{
+        sector = std::move( spares.back() );
+        spares.pop_back();
+    }
 
-        // (B) Load values at new location 
-        const LocalLocation to_location( next_bounds.min.easting, from_location.northing );
-        // fmt::print( stderr, "                << load:  ( {}, {} )\n", to_location.easting, to_location.northing );
-        chartbox::io::flatbuffer::load( to_location, sector);
+    if( persistent_ ){
+        load_sector( origin, *sector );
+    }else{
+        sector->fill( chartbox::layer::unknown_cell_value );
+        sector->dirty( false );
     }
+    return sector;
+}
 
-    anchor_ = next_anchor;
-    view_bounds_ = next_bounds;
-    return true;
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::scroll_east() {
+    return relocate( view_bounds_.min + LocalLocation( meters_across_sector_, 0.0 ) );
+}
+
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::scroll_north() {
+    return relocate( view_bounds_.min + LocalLocation( 0.0, meters_across_sector_ ) );
 }
 
 template<uint32_t cells_across_sector_>
-bool RollingGridLayer<cells_across_sector_>::store(const LocalLocation& layer_location, uint8_t new_value) {
-    if( visible(layer_location) ){
-        const LocalLocation view_location = layer_location - view_bounds_.min;
+bool RollingGridLayer<cells_across_sector_>::scroll_south() {
+    return relocate( view_bounds_.min + LocalLocation( 0.0, -meters_across_sector_ ) );
+}
 
-        const GridIndex view_index = GridIndex( static_cast<uint32_t>(view_location.easting), 
-                                                static_cast<uint32_t>(view_location.northing) )
-                                            .div(meters_across_cell_);
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::scroll_west() {
+    return relocate( view_bounds_.min + LocalLocation( -meters_across_sector_, 0.0 ) );
+}
 
-        /// index of the sector to lookup in
-        const size_t sector_offset = view_index.div(cells_across_sector_)
-                                                .add(anchor_)
-                                                .wrap(sectors_across_view_)
-                                                .offset(sectors_across_view_);
+template<uint32_t cells_across_sector_>
+bool RollingGridLayer<cells_across_sector_>::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+    if( (cells_across_view_ <= row) || (cells_across_view_ <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min( last_column, cells_across_view_ - 1 );
 
-        /// location of cell within sector (indexed above)
-        const size_t cell_offset = view_index.mod(cells_across_sector_)
-                                            .offset(cells_across_sector_);
+    const uint32_t sector_row = wrap( (row / cells_across_sector_) + anchor_.row );
+    const uint32_t cell_row = row % cells_across_sector_;
 
-        sectors_[ sector_offset ][ cell_offset ] = new_value;
+    // split the run at each sector boundary:
+    for( uint32_t column = first_column; column <= last_column; ){
+        const uint32_t view_sector_column = column / cells_across_sector_;
+        const uint32_t segment_last_column = std::min( last_column, (view_sector_column + 1) * cells_across_sector_ - 1 );
 
-        // fmt::print( stderr, ">> store   @location:     {:12.4f}, {:12.4f} <<== {:X} \n", layer_location.easting, layer_location.northing, new_value );
-        // fmt::print( stderr, "      in-view:            {:12.4f}, {:12.4f} \n", view_location.easting, view_location.northing );
-        // fmt::print( stderr, "      cell-in-layer-index:     {:2d}, {:2d} \n", view_cell_column , view_cell_row );
-        // fmt::print( stderr, "      sector-in-layer-index:   {:2d} \n", sector_index );
-        // fmt::print( stderr, "      cell-in-sector-index:    {:2d} \n", cell_index );
+        sector_t& sector = *sectors_[ wrap(view_sector_column + anchor_.column) + sector_row * sectors_across_view_ ];
+        sector.store_span( cell_row, column % cells_across_sector_, segment_last_column % cells_across_sector_, value );
+        sector.dirty( true );
 
-        return true;
+        column = segment_last_column + 1;
     }
 
-    return false;
+    return true;
 }
 
 template<uint32_t cells_across_sector_>
 bool RollingGridLayer<cells_across_sector_>::view(const LocalLocation& p) {
     view_bounds_.min = p;
     view_bounds_.max = p + meters_across_view_;
+    publish();
     return true;
 }
 
@@ -2,15 +2,22 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cmath>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "geometry/polygon.hpp"
 #include "geometry/bound-box.hpp"
+#include "layer/epoch-domain.hpp"
 #include "layer/layer-interface.hpp"
 #include "layer/grid-index.hpp"
 
@@ -18,6 +25,9 @@
 
 namespace chartbox::layer::rolling {
 
+template<uint32_t cells_across_sector> class SectorLoader;
+template<uint32_t cells_across_sector> class SectorPool;
+
 /// \brief represents an entire layer of scrolling data
 /// 
 /// This layer offers two important features:
@@ -27,6 +37,9 @@ namespace chartbox::layer::rolling {
 ///  chart => layer => sector => cell
 ///            ^^^ you are here
 ///
+/// The layer has a single writer: every method belongs to one thread.  Other threads may only read through a
+/// `Reader`, while concurrent readers are enabled.  (see: `enable_concurrent_readers`)
+///
 /// Sources / Inspiration / Further Reading
 /// 1. Grid-Map (aka Rolling-Grid)
 ///     - http://wiki.ros.org/grid_map
@@ -56,11 +69,17 @@ private:
     constexpr static uint32_t sectors_in_view_ = sectors_across_view_ * sectors_across_view_;
     constexpr static double meters_across_view_ = meters_across_cell_ * cells_across_view_;
 
+    // cell addressing: (precomputed, so that the hot paths only multiply, shift and mask)
+    constexpr static double cells_across_meter_ = 1.0 / meters_across_cell_;
+    constexpr static bool power_of_two_sector_ = std::has_single_bit( cells_across_sector_ );
+    constexpr static uint32_t cell_shift_ = std::countr_zero( cells_across_sector_ );
+    constexpr static uint32_t cell_mask_ = cells_across_sector_ - 1;
+
 public:
     /// \brief Constructs a new 2d square grid
     RollingGridLayer();
 
-    ~RollingGridLayer(){};
+    ~RollingGridLayer();
 
     constexpr static uint32_t cells_across_sector() { return cells_across_sector_; }
     constexpr static uint32_t sectors_across_view() { return sectors_across_view_; }
@@ -74,8 +93,98 @@ public:
     bool track( const BoundBox<LocalLocation>& bounds );
     bool track( const BoundBox<UTMLocation>& bounds );
 
+    /// \brief read + write sectors through a tile cache
+    ///
+    /// \param cache_path - either a directory of tile files, or a single tile archive (with the `.tiles` extension)
     bool enable_cache( std::filesystem::path cache_path );
 
+    /// \brief read + write this layer's sectors through the tile cache.  (the default)
+    ///
+    /// The cache is shared by every layer in the process, and names each tile only by its origin.  A layer which
+    /// holds transient data (e.g. sensor observations) should opt out: its sectors are never saved, and each sector
+    /// which enters its view starts unknown.  Disabling persistence also stops any background loader.
+    bool enable_persistence( bool enable );
+
+    inline bool persistence_enabled() const { return persistent_; }
+
+    /// \brief move tile I/O onto a background thread
+    ///
+    /// While enabled, each move of the view predicts the next move (from the direction of the last one), and
+    /// starts loading the sectors which that move would bring into view.  Sectors which leave the view are
+    /// written behind, in the background.  A correctly-predicted scroll only swaps sector buffers.
+    ///
+    /// \param enable - true to start the background loader; false to finish its saves, and stop it
+    /// \return false if this layer is not persistent.  (see: `enable_persistence`)
+    bool enable_prefetch( bool enable );
+
+    /// \brief hold recently-evicted sectors in memory, rather than writing them straight to the cache
+    ///
+    /// Sectors which leave the view are parked in an LRU pool, keyed by their origin; moves of the view (and
+    /// `load_from_cache`) take sectors from the pool before reading the cache.  Dirty sectors are only written
+    /// when they fall out of the pool -- or by `flush_to_cache`.
+    ///
+    /// \param capacity - maximum number of pooled sectors.  0 => write back every pooled sector, and disable the pool.
+    bool enable_pool( size_t capacity );
+
+    /// \brief the pool of evicted sectors (for its hit / miss counters) -- or nullptr, if disabled
+    inline const SectorPool<cells_across_sector_>* pool() const { return pool_.get(); }
+
+    /// \brief allow other threads to read the layer through a `Reader` -- while this thread writes to it
+    ///
+    /// Each move of the view publishes an immutable frame (the view bounds, the anchor, and the sector buffers) with
+    /// a single atomic pointer swap; readers never lock, and always see a consistent frame.  Buffers which leave the
+    /// view -- and the frames which held them -- are freed only once no reader can still hold them. (see:
+    /// `EpochDomain`)  While enabled, those buffers are not recycled: each sector which enters the view gets a
+    /// fresh buffer.
+    ///
+    /// Cell writes are not synchronized: a reader sees either the old or the new value of a cell which is written
+    /// while it reads.
+    ///
+    /// \param enable - true to enable; false to disable.  (no reader may be alive)
+    bool enable_concurrent_readers( bool enable );
+
+    inline bool concurrent_readers_enabled() const { return static_cast<bool>(epochs_); }
+
+    /// \brief maintain a max-pooled pyramid in every sector.  (see: `RollingGridSector`)
+    ///
+    /// Each level `k` halves the resolution of level `k-1`; each of its cells holds the maximum of the cells it
+    /// covers.  Levels are updated incrementally by each write, and are saved alongside each tile in the cache.
+    bool enable_pyramid( bool enable );
+
+    inline bool pyramid_enabled() const { return pyramid_enabled_; }
+
+    /// \brief number of levels above the cells.  (the top level holds one cell per sector)
+    constexpr static uint32_t level_count() { return sector_t::level_count; }
+
+    /// \brief meters across a single cell of the given level
+    constexpr static double meters_across_level( uint32_t level ) { return meters_across_cell_ * (1u << level); }
+
+    /// \brief retrieve the value of the level-cell containing this location
+    ///
+    /// \param p - location to query
+    /// \param level - in [0, level_count()]; 0 => the cells themselves.  Without a pyramid, only level 0 is available.
+    /// \return the maximum of every cell covered by that level-cell; or `default_cell_value` if outside the view
+    uint8_t get( const LocalLocation& p, uint32_t level ) const;
+
+    /// \brief the maximum value of any cell in the box -- read from the given level
+    ///
+    /// Higher levels touch (up to 4^level times) fewer cells, but are conservative: each level-cell which
+    /// overlaps the box counts in full, so cells up to `meters_across_level(level)` outside the box may count.
+    ///
+    /// \param box - area to query; clipped to the view
+    /// \param level - in [0, level_count()]; 0 => exact.  Without a pyramid, only level 0 is available.
+    /// \return the maximum value; or `default_cell_value` if the box does not overlap the view
+    uint8_t max( const BoundBox<LocalLocation>& box, uint32_t level ) const;
+
+    /// \brief the pyramid level at which `raycast` skips clear areas
+    constexpr static uint32_t raycast_level = std::min<uint32_t>( 3, sector_t::level_count );
+
+    /// \brief find where each line from the origin first meets a blocking cell.  (see: `LayerInterface::raycast`)
+    ///
+    /// Reads each cell directly from its sector.  With a pyramid, each line first walks the cells of level
+    /// `raycast_level`; it only walks the cells beneath those level-cells which hold a blocking value.
+    bool raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const;
+
     bool fill( uint8_t value );
 
     bool fill( const BoundBox<LocalLocation>& box, const uint8_t value ){
@@ -84,17 +193,83 @@ public:
     bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
         return super().fill( poly, bound, value ); }
 
-    // \brief flush layer contents to the internal cache
-    bool flush_to_cache() const;
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value, WorkerPool& pool ){
+        return super().fill( poly, bound, value, pool ); }
+
+    // \brief flush layer contents to the internal cache -- only the sectors changed since their last load or save
+    bool flush_to_cache();
 
     // \brief load sector-tiles from the internal cache (if avaiable)
     bool load_from_cache();
 
-    uint8_t get(const LocalLocation& p) const;
+private:
+    /// \brief an immutable snapshot of the view -- republished by each change of the view
+    struct Frame {
+        BoundBox<LocalLocation> view_bounds;
+        GridIndex anchor;
+        std::array<const sector_t*, sectors_in_view_> sectors;
+    };
+
+public:
+    /// \brief a read-only view of the layer, for any thread -- pinned to the frame which was current when it began
+    ///
+    /// A reader holds back the reclamation of every buffer it can see: keep each one short-lived (e.g. a single
+    /// planning query), and take a new one for the next.  Without concurrent readers, use it from the writing thread.
+    class Reader {
+    public:
+        inline uint8_t get( const LocalLocation& p ) const {
+            return RollingGridLayer::get( *frame_, p ); }
+
+        /// \brief retrieve the values at a batch of locations.  (see: `RollingGridLayer::get`)
+        inline bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+            return RollingGridLayer::get( *frame_, points, values ); }
+
+        /// \brief the maximum value of any cell in the box.  (see: `RollingGridLayer::max`)
+        ///
+        /// Reads level `raycast_level` of each sector which has a pyramid; so the result is an upper bound, which
+        /// may count cells up to `meters_across_level(raycast_level)` outside the box.  (toggle the pyramid only
+        /// while no reader is running)
+        inline uint8_t max( const BoundBox<LocalLocation>& box ) const {
+            return RollingGridLayer::max( *frame_, box, raycast_level ); }
+
+        /// \brief the visible bounds of this reader's frame
+        inline const BoundBox<LocalLocation>& visible() const { return frame_->view_bounds; }
+
+    private:
+        friend class RollingGridLayer;
+        Reader( std::optional<EpochDomain::Guard> guard, const Frame* frame )
+            : guard_( std::move(guard) ), frame_( frame ) {}
+
+        // (pinned before the frame is loaded)
+        std::optional<EpochDomain::Guard> guard_;
+        const Frame* frame_;
+    };
+
+    /// \brief start reading the current frame.  Safe from any thread, while concurrent readers are enabled.
+    Reader reader() const {
+        std::optional<EpochDomain::Guard> guard;
+        if( epochs_ ){
+            guard.emplace( epochs_->pin() );
+        }
+        return Reader( std::move(guard), frame_.load() );
+    }
+
+    inline uint8_t get(const LocalLocation& p) const {
+        if( visible(p) ){
+            const CellAddress address = locate( p - view_bounds_.min, anchor_ );
+            return (*sectors_[ address.sector ])[ address.cell ];
+        }
+        return chartbox::layer::default_cell_value;
+    }
 
     inline uint8_t get( double easting, double northing ) const {
             return get({easting, northing});  }
 
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const;
+
 
     inline double meters_across_cell() const { return meters_across_cell_; }
     inline double meters_across_sector() const { return meters_across_sector_; }
@@ -105,19 +280,78 @@ public:
     std::string to_location_content_string( uint32_t indent = 0 ) const { return super().to_location_content_string(indent); }
     std::string to_property_string( uint32_t indent = 0) const;
 
+    /// \brief move the view to a new origin, keeping the contents of every sector which stays in view
+    ///
+    /// The origin is rounded to the nearest whole sector from the current view.  Overlapping sectors only change
+    /// their place in the ring (via the anchor); only the sectors which leave the view are saved to the cache,
+    /// and then re-used for the sectors which enter it -- all in one pass.
+    ///
+    /// \param new_origin - the south-west corner of the new view
+    /// \return true if successful
+    bool relocate( const LocalLocation& new_origin );
+
+    /// \brief shift the view by a single sector.  (see: `relocate`)
     bool scroll_east();
     bool scroll_north();
     bool scroll_south();
     bool scroll_west();
 
-    const std::vector<sector_t>& sectors() const { return sectors_; }
+    /// \brief access a sector by its (storage) index in the ring
+    inline const sector_t& sector( uint32_t index ) const { return *sectors_[index]; }
+
+    /// \brief index of the sector currently at the south-west corner of the view
+    inline const GridIndex& anchor() const { return anchor_; }
 
     /// \brief Access the value at an (x, y)
     ///
     /// \param p - the x,y coordinates to search at:
     /// \param new_value - the value to stored at the specified location
     /// \return true if successful
-    bool store(const LocalLocation& p, uint8_t new_value);
+    inline bool store(const LocalLocation& p, uint8_t new_value){
+        if( visible(p) ){
+            const CellAddress address = locate( p - view_bounds_.min, anchor_ );
+            sector_t& sector = *sectors_[ address.sector ];
+            sector.store( address.cell, new_value );
+            sector.dirty( true );
+            return true;
+        }
+        return false;
+    }
+
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value );
+
+    /// \brief rewrite a horizontal run of cells, in place
+    ///
+    /// \param row, first_column, last_column - cell indices, relative to the view.  (as `store_span`)
+    /// \param update - called once per sector the run crosses: `update(first_column, cells)`, with that sector's part
+    ///                  of the run, and the view column of its first cell
+    template<typename update_t>
+    bool update_span( uint32_t row, uint32_t first_column, uint32_t last_column, update_t&& update ){
+        if( (cells_across_view_ <= row) || (cells_across_view_ <= first_column) || (last_column < first_column) ){
+            return false;
+        }
+        last_column = std::min( last_column, cells_across_view_ - 1 );
+
+        const uint32_t sector_row = wrap( (row / cells_across_sector_) + anchor_.row );
+        const uint32_t cell_row = row % cells_across_sector_;
+
+        // split the run at each sector boundary:
+        for( uint32_t column = first_column; column <= last_column; ){
+            const uint32_t view_sector_column = column / cells_across_sector_;
+            const uint32_t segment_last_column = std::min( last_column, (view_sector_column + 1) * cells_across_sector_ - 1 );
+
+            sector_t& sector = *sectors_[ wrap(view_sector_column + anchor_.column) + sector_row * sectors_across_view_ ];
+            sector.update_span( cell_row, column % cells_across_sector_, segment_last_column % cells_across_sector_,
+                                [&]( std::span<uint8_t> cells ){ update( column, cells ); } );
+            sector.dirty( true );
+
+            column = segment_last_column + 1;
+        }
+        return true;
+    }
 
     /// \brief track from the given location  (... + the native width)
     bool track( const LocalLocation& bounds );
@@ -141,8 +375,31 @@ private:
 
     //  chart => layer => sector => cell
     //                 ^^ you are here -- this structure maps from the layer to the sectors 
-    std::vector<sector_t> sectors_;
-    // NOTE: currently this is only adjusted|allocated in the constructor
+    std::vector<std::unique_ptr<sector_t>> sectors_;
+    // NOTE: the ring is sized in the constructor; sector buffers are only swapped in + out by `relocate`
+
+    // the frame which readers see.  (owned; see: `publish`)
+    std::atomic<const Frame*> frame_ = nullptr;
+
+    // reclaims frames and sectors, once no reader holds them  (optional; declared before `loader_`, which
+    // retires buffers into it until it is destroyed)
+    std::unique_ptr<EpochDomain> epochs_;
+
+    // background tile I/O (optional)
+    std::unique_ptr<SectorLoader<cells_across_sector_>> loader_;
+
+    // recently evicted sectors (optional)
+    std::unique_ptr<SectorPool<cells_across_sector_>> pool_;
+
+    // each sector in view maintains a pyramid
+    bool pyramid_enabled_ = false;
+
+    // sectors are loaded from + saved to the tile cache
+    bool persistent_ = true;
+
+    // direction of the last move of the view, in sectors: one of {-1, 0, 1}
+    int32_t heading_columns_ = 0;
+    int32_t heading_rows_ = 0;
 
     // this tracks the outer bounds (that the whole chart is tracking)
     geometry::BoundBox<LocalLocation> track_bounds_;
@@ -152,6 +409,95 @@ private:
 
 private:
 
+    /// \brief storage offsets of a single cell
+    struct CellAddress {
+        uint32_t sector;
+        uint32_t cell;
+    };
+
+    /// \brief translate a view-relative location into the storage offsets of its cell
+    ///
+    /// \param view_location - location relative to the view origin. Must be inside the view.
+    /// \param anchor - ring index of the sector at the view origin
+    inline static CellAddress locate( const LocalLocation& view_location, const GridIndex& anchor ) {
+        // view-relative index of the cell:
+        return locate( static_cast<uint32_t>( view_location.easting * cells_across_meter_ ),
+                       static_cast<uint32_t>( view_location.northing * cells_across_meter_ ), anchor );
+    }
+
+    /// \brief translate a view-relative cell index into its storage offsets
+    ///
+    /// \param column, row - index of the cell, from the view origin. Must be inside the view.
+    /// \param anchor - ring index of the sector at the view origin
+    inline static CellAddress locate( uint32_t column, uint32_t row, const GridIndex& anchor ) {
+        if constexpr ( power_of_two_sector_ ){
+            return { wrap((column >> cell_shift_) + anchor.column) + wrap((row >> cell_shift_) + anchor.row) * sectors_across_view_,
+                     (column & cell_mask_) + ((row & cell_mask_) << cell_shift_) };
+        }else{
+            return { wrap((column / cells_across_sector_) + anchor.column) + wrap((row / cells_across_sector_) + anchor.row) * sectors_across_view_,
+                     (column % cells_across_sector_) + (row % cells_across_sector_) * cells_across_sector_ };
+        }
+    }
+
+    /// \brief retrieve the value at point `p`, from a frame
+    inline static uint8_t get( const Frame& frame, const LocalLocation& p ){
+        if( frame.view_bounds.contains(p) ){
+            const CellAddress address = locate( p - frame.view_bounds.min, frame.anchor );
+            return (*frame.sectors[ address.sector ])[ address.cell ];
+        }
+        return chartbox::layer::default_cell_value;
+    }
+
+    /// \brief retrieve the values at a batch of locations, from a frame
+    static bool get( const Frame& frame, std::span<const LocalLocation> points, std::span<uint8_t> values );
+
+    /// \brief the maximum value of any cell in the box, from a frame.  (see: `max`)
+    ///
+    /// \param level - in [0, level_count()]; sectors without a pyramid are read at level 0
+    static uint8_t max( const Frame& frame, const BoundBox<LocalLocation>& box, uint32_t level );
+
+    /// \brief publish the current view (bounds, anchor + sectors) to readers; retire the last frame
+    void publish();
+
+    /// \brief free a buffer which has been in view -- once no reader can hold it
+    void discard( std::unique_ptr<sector_t> sector );
+
+    /// \brief a sector which leaves the view, and is re-used for a sector which enters it
+    struct SectorMove {
+        uint32_t slot;
+        LocalLocation from;
+        LocalLocation to;
+    };
+
+    /// \brief find the sectors which a move of the view would replace
+    ///
+    /// \param shift_columns, shift_rows - the move, in sectors
+    /// \param moves - [out] the replaced sectors
+    /// \return number of sectors replaced
+    size_t plan_moves( int64_t shift_columns, int64_t shift_rows, std::array<SectorMove,sectors_in_view_>& moves ) const;
+
+    /// \brief a sector leaves the view: into the pool (if enabled); whatever falls out of the pool is written back
+    ///
+    /// \param spares - [out] buffers which are free for re-use.  (without a loader)
+    void retire( std::unique_ptr<sector_t> sector, const LocalLocation& origin, std::vector<std::unique_ptr<sector_t>>& spares );
+
+    /// \brief write a sector back to the cache -- in the background, if enabled
+    void write_back( std::unique_ptr<sector_t> sector, const LocalLocation& origin, std::vector<std::unique_ptr<sector_t>>& spares );
+
+    /// \brief load a sector which enters the view, from the cache -- in the background, if enabled
+    ///
+    /// \param spares - buffers which are free for re-use.  (without a loader)
+    std::unique_ptr<sector_t> acquire( const LocalLocation& origin, std::vector<std::unique_ptr<sector_t>>& spares );
+
+    /// \brief offset a sector index around the ring, by any (signed) number of sectors
+    constexpr static uint32_t ring_offset( uint32_t index, int64_t offset ){
+        const int64_t across = sectors_across_view_;
+        return static_cast<uint32_t>( ((static_cast<int64_t>(index) + offset) % across + across) % across ); }
+
+    /// \brief wrap a sector index around the ring -- for indices in [0, 2*sectors_across_view_)
+    constexpr static uint32_t wrap( uint32_t index ){
+        return ( index < sectors_across_view_ ) ? index : (index - sectors_across_view_); }
+
     LayerInterface<RollingGridLayer<cells_across_sector_>>& super() {
         return *static_cast< LayerInterface<RollingGridLayer<cells_across_sector_>>* >(this);
     }
@@ -2,10 +2,16 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
 
+#include "layer/cell-layout.hpp"
 #include "layer/grid-index.hpp"
 
 namespace chartbox::layer::rolling {
@@ -15,11 +21,27 @@ namespace chartbox::layer::rolling {
 ///  chart => layer => sector => cell
 ///                    ^^ you are here
 ///
-template<uint32_t cells_across_sector>
+/// Optionally, a sector also maintains a max-pooled pyramid of its cells: level `k` holds `(cells_across >> k)^2`
+/// cells, each of which is the maximum of the 2x2 cells beneath it in level `k-1`.  (level 0 is the cells
+/// themselves)  The pyramid is kept up to date by every write through this class.
+///
+/// \param cells_across_sector cell count across a single dimension of each sector
+/// \param layout_t order of the cells in storage -- for the cells and for each level of the pyramid.  (see: `cell-layout.hpp`)
+template<uint32_t cells_across_sector, typename layout_t = RowMajorLayout>
 class RollingGridSector {
 public:
+    static_assert( layout_t::supports(cells_across_sector), "this layout cannot arrange a sector of this size" );
+
+    typedef layout_t layout_type;
+
     constexpr static double meters_across_cell = 1.0;
 
+    /// \brief number of levels above the cells: down to a single cell.  (only power-of-two sectors have a pyramid)
+    constexpr static uint32_t level_count = std::has_single_bit( cells_across_sector ) ? std::countr_zero( cells_across_sector ) : 0;
+
+    /// \brief total cells in levels [1, level_count]
+    constexpr static uint32_t pyramid_size = ((cells_across_sector * cells_across_sector) - 1) / 3;
+
 public:
 
     RollingGridSector() = default;
@@ -37,22 +59,106 @@ public:
 
     inline constexpr static uint32_t cells_across() { return cells_across_sector; }
 
+    /// \brief true if this sector has changed since it was last loaded from (or saved to) the cache
+    inline bool dirty() const { return dirty_; }
+    inline void dirty( bool is_dirty ) { dirty_ = is_dirty; }
+
+    inline uint8_t* data() {
+        return data_.data(); }
+
     inline const uint8_t* data() const {
         return data_.data(); }
 
     inline void fill( uint8_t value ) { 
-            data_.fill(value); }
+            data_.fill(value);
+            std::fill( pyramid_.begin(), pyramid_.end(), value ); }
 
     inline bool fill( const uint8_t * const source, size_t count ){
         if( count == data_.size() ){
             std::memcpy( data_.data(), source, count );
+            rebuild_pyramid();
             return true;
         }
         return false;
     }
 
+    // ====== ====== Pyramid ====== ======
+
+    inline bool has_pyramid() const { return not pyramid_.empty(); }
+
+    /// \brief start (and build) or stop (and release) the pyramid
+    void enable_pyramid( bool enable ){
+        if( enable && (not has_pyramid()) && (0 < level_count) ){
+            pyramid_.resize( pyramid_size );
+            rebuild_pyramid();
+        }else if( not enable ){
+            pyramid_.clear();
+            pyramid_.shrink_to_fit();
+        }
+    }
+
+    constexpr static uint32_t cells_across_level( uint32_t level ){
+        return cells_across_sector >> level; }
+
+    /// \brief the cells of the given level, in `layout_t` order.  (level 0 => the sector's cells; otherwise requires a pyramid)
+    inline const uint8_t* level_data( uint32_t level ) const {
+        return (0 == level) ? data_.data() : (pyramid_.data() + level_offset(level)); }
+
+    inline uint8_t* pyramid_data() { return pyramid_.data(); }
+    inline const uint8_t* pyramid_data() const { return pyramid_.data(); }
+
+    /// \brief recalculate every level from the cells
+    void rebuild_pyramid(){
+        if( has_pyramid() ){
+            for( uint32_t level = 1; level <= level_count; ++level ){
+                const uint32_t across = cells_across_level( level );
+                for( uint32_t row = 0; row < across; ++row ){
+                    for( uint32_t column = 0; column < across; ++column ){
+                        downsample( level, column, row );
+                    }
+                }
+            }
+        }
+    }
+
+    /// \brief refresh the pyramid above a single changed cell
+    inline void update_pyramid( uint32_t column, uint32_t row ){
+        if( has_pyramid() ){
+            for( uint32_t level = 1; level <= level_count; ++level ){
+                column >>= 1;
+                row >>= 1;
+                if( not downsample( level, column, row ) ){
+                    // nothing above can change, either
+                    break;
+                }
+            }
+        }
+    }
+
+    /// \brief refresh the pyramid above a changed run of cells, in one row
+    inline void update_pyramid( uint32_t row, uint32_t first_column, uint32_t last_column ){
+        if( has_pyramid() ){
+            for( uint32_t level = 1; level <= level_count; ++level ){
+                row >>= 1;
+                first_column >>= 1;
+                last_column >>= 1;
+                bool changed = false;
+                for( uint32_t column = first_column; column <= last_column; ++column ){
+                    changed |= downsample( level, column, row );
+                }
+                if( not changed ){
+                    break;
+                }
+            }
+        }
+    }
+
+    /// \brief storage offset of the given cell
+    constexpr static uint32_t offset( GridIndex index ){
+        return layout_t::offset( index.column, index.row, cells_across_sector ); }
+
     inline uint8_t get( GridIndex index ) const { 
-            return data_[index.offset(cells_across_sector)]; }
+            return data_[offset(index)]; }
 
     inline uint8_t operator[](uint32_t index) const { 
             return data_[index]; }
@@ -86,16 +192,74 @@ public:
     }
 
     inline uint8_t set( GridIndex index, uint8_t value ) {
-            return data_[index.offset(cells_across_sector)] = value; }
+            data_[offset(index)] = value;
+            update_pyramid( index.column, index.row );
+            return value; }
+
+    /// \brief write a single cell, by its storage offset
+    inline void store( uint32_t cell_offset, uint8_t value ){
+        data_[cell_offset] = value;
+        const GridIndex index = layout_t::index( cell_offset, cells_across_sector );
+        update_pyramid( index.column, index.row );
+    }
+
+    /// \brief write a run of cells within one row
+    inline void store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+        if constexpr ( layout_t::row_contiguous ){
+            std::memset( data_.data() + offset({first_column, row}), value, last_column - first_column + 1 );
+        }else{
+            uint32_t cell_offset = offset({first_column, row});
+            for( uint32_t column = first_column; column <= last_column; ++column ){
+                data_[cell_offset] = value;
+                cell_offset = layout_t::next_column( cell_offset, cells_across_sector );
+            }
+        }
+        update_pyramid( row, first_column, last_column );
+    }
+
+    /// \brief rewrite a run of cells within one row, in place: `update` is passed the run, as a span
+    template<typename update_t>
+    inline void update_span( uint32_t row, uint32_t first_column, uint32_t last_column, update_t&& update ){
+        static_assert( layout_t::row_contiguous, "a run of cells is only contiguous in a row-contiguous layout" );
+        update( std::span<uint8_t>( data_.data() + offset({first_column, row}), last_column - first_column + 1 ) );
+        update_pyramid( row, first_column, last_column );
+    }
 
     constexpr inline uint32_t size() const { 
             return data_.size(); }
 
+private:
+    /// \brief offset of the given level (>= 1) within the pyramid
+    constexpr static uint32_t level_offset( uint32_t level ){
+        // == sum of (n >> k)^2, for k in [1, level)
+        return ((cells_across_sector * cells_across_sector) - (cells_across_level(level - 1) * cells_across_level(level - 1))) / 3;
+    }
+
+    /// \brief recalculate one cell of a level, from the 2x2 cells beneath it
+    ///
+    /// \return true if its value changed
+    inline bool downsample( uint32_t level, uint32_t column, uint32_t row ){
+        const uint32_t below_across = cells_across_level( level - 1 );
+        const uint8_t* below = level_data( level - 1 );
+        const uint8_t value = std::max( std::max( below[layout_t::offset(2*column, 2*row, below_across)], below[layout_t::offset(2*column + 1, 2*row, below_across)] ),
+                                        std::max( below[layout_t::offset(2*column, 2*row + 1, below_across)], below[layout_t::offset(2*column + 1, 2*row + 1, below_across)] ));
+        uint8_t& cell = pyramid_[ level_offset(level) + layout_t::offset(column, row, cells_across_level(level)) ];
+        const bool changed = (cell != value);
+        cell = value;
+        return changed;
+    }
+
 private:
     
     //  chart => layer => sector => cell
     //                              ^^^ you are here
     std::array<uint8_t, cells_across_sector * cells_across_sector> data_;
+
+    // max-pooled levels [1, level_count], concatenated; empty when disabled
+    std::vector<uint8_t> pyramid_;
+
+    // maintained by the owning layer: set by each write; cleared by each load + save
+    bool dirty_ = false;
 };
 
 
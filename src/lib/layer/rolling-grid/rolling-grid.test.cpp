@@ -1,8 +1,14 @@
 // GPL v3 (c) 2021, Daniel Williams 
 
+#include <atomic>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
@@ -10,16 +16,20 @@ using Catch::Approx;
 
 #include "geometry/bound-box.hpp"
 #include "geometry/polygon.hpp"
+#include "io/flatbuffer.hpp"
 #include "layer/grid-index.hpp"
+#include "layer/worker-pool.hpp"
 
 #include "rolling-grid-layer.hpp"
 #include "rolling-grid-sector.hpp"
+#include "sector-pool.hpp"
 
 using chartbox::geometry::BoundBox;
 using chartbox::geometry::LocalLocation;
 using chartbox::geometry::Polygon;
 using chartbox::geometry::UTMLocation;
 using chartbox::layer::GridIndex;
+using chartbox::layer::WorkerPool;
 using chartbox::layer::rolling::RollingGridSector;
 using chartbox::layer::rolling::RollingGridLayer;
 
@@ -124,6 +134,40 @@ void populate_markers_per_sector( T& layer ) {
     }
 }
 
+TEST_CASE( "RollingGridSector with a Morton layout matches row-major"){
+    using chartbox::layer::MortonLayout;
+    RollingGridSector<16> row_major( 0 );
+    RollingGridSector<16, MortonLayout> morton( 0 );
+    row_major.enable_pyramid( true );
+    morton.enable_pyramid( true );
+
+    for( uint32_t row = 0; row < 16; ++row ){
+        for( uint32_t column = 0; column < 16; ++column ){
+            const uint8_t value = static_cast<uint8_t>( (column * 37 + row * 11) % 97 );
+            row_major.set( {column, row}, value );
+            morton.set( {column, row}, value );
+        }
+    }
+    row_major.store_span( 5, 3, 12, 0xC0 );
+    morton.store_span( 5, 3, 12, 0xC0 );
+    row_major.store( row_major.offset({9, 14}), 0xE0 );
+    morton.store( morton.offset({9, 14}), 0xE0 );
+
+    // every cell, and every level of the pyramid, holds the same values -- in a different order
+    CHECK( 0xE0 == morton.get({9, 14}) );
+    CHECK( 0xC0 == morton.get({12, 5}) );
+    for( uint32_t level = 0; level <= row_major.level_count; ++level ){
+        const uint32_t across = row_major.cells_across_level( level );
+        for( uint32_t row = 0; row < across; ++row ){
+            for( uint32_t column = 0; column < across; ++column ){
+                CHECK( static_cast<int>(row_major.level_data(level)[ chartbox::layer::RowMajorLayout::offset(column, row, across) ])
+                        == static_cast<int>(morton.level_data(level)[ MortonLayout::offset(column, row, across) ]) );
+            }
+        }
+    }
+    CHECK( 0xE0 == morton.level_data( morton.level_count )[0] );
+} // TEST_CASE
+
 TEST_CASE( "Verify RollingGridLayer Default Initialization"){
     RollingGridLayer<4> layer;
 
@@ -523,3 +567,908 @@ TEST_CASE( "Verify Layer Can Scroll"){
         }
     }
 }
+
+TEST_CASE( "Verify RollingGridLayer batch-get matches scalar get"){
+    RollingGridLayer<4> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+    populate_markers_per_cell( layer );
+
+    // move the anchor away from zero, so the batch-path wraps sectors:
+    layer.scroll_north();
+    layer.scroll_east();
+    REQUIRE( LocalLocation( 16.0, 16.0) == layer.visible().min );
+
+    // query both inside and outside of the visible area:
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> distribution( 10.0, 40.0 );
+    std::vector<LocalLocation> points;
+    for( size_t i = 0; i < 1001; ++i ){
+        points.emplace_back( distribution(generator), distribution(generator) );
+    }
+    // exact borders
+    points.emplace_back( 16.0, 16.0 );
+    points.emplace_back( 36.0, 36.0 );
+    points.emplace_back( 36.0, 16.0 );
+
+    std::vector<uint8_t> values( points.size() );
+    REQUIRE( layer.get( points, values ));
+
+    for( size_t i = 0; i < points.size(); ++i ){
+        CHECK( static_cast<int>(layer.get(points[i])) == static_cast<int>(values[i]) );
+    }
+
+    // output must be large enough:
+    std::vector<uint8_t> short_values( points.size() - 1 );
+    CHECK( not layer.get( points, short_values ));
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer stores spans across sectors"){
+    RollingGridLayer<4> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+    layer.scroll_east();
+    layer.scroll_north();
+    layer.fill( 0 );
+    REQUIRE( LocalLocation( 16.0, 16.0) == layer.visible().min );
+
+    CHECK( layer.store_span( 5, 2, 13, 0x77 ));
+    // clipped at the east edge:
+    CHECK( layer.store_span( 3, 18, 40, 0x11 ));
+    // entirely outside:
+    CHECK( not layer.store_span( 20, 0, 4, 0xEE ));
+    CHECK( not layer.store_span( 0, 20, 24, 0xEE ));
+
+    for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+        for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+            const LocalLocation at = layer.visible().min + LocalLocation( column + 0.5, row + 0.5 );
+            uint8_t expect = 0;
+            if( (5 == row) && (2 <= column) && (column <= 13) ){
+                expect = 0x77;
+            }else if( (3 == row) && (18 <= column) ){
+                expect = 0x11;
+            }
+            CHECK( static_cast<int>(expect) == static_cast<int>(layer.get(at)) );
+        }
+    }
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer fills boxes and polygons"){
+    RollingGridLayer<4> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+    REQUIRE( LocalLocation( 12.0, 12.0) == layer.visible().min );
+
+    SECTION( "Fill Box" ){
+        layer.fill( 0 );
+        layer.fill( BoundBox<LocalLocation>( {14.0, 15.0}, {20.0, 18.0} ), 0x33 );
+
+        for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+                const LocalLocation at = layer.visible().min + LocalLocation( column + 0.5, row + 0.5 );
+                const bool inside = (2 <= column) && (column <= 7) && (3 <= row) && (row <= 5);
+                CHECK( (inside ? 0x33 : 0) == static_cast<int>(layer.get(at)) );
+            }
+        }
+    }
+
+    SECTION( "Fill Polygon" ){
+        layer.fill( 0 );
+        const Polygon<LocalLocation> triangle( {{12,12}, {22,12}, {12,22}, {12,12}} );
+        layer.fill( triangle, layer.visible(), 0x44 );
+
+        for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+                const LocalLocation at = layer.visible().min + LocalLocation( column + 0.5, row + 0.5 );
+                const bool inside = (row <= 9) && (column <= (9 - row));
+                CHECK( (inside ? 0x44 : 0) == static_cast<int>(layer.get(at)) );
+            }
+        }
+    }
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer parallel polygon fill matches serial fill"){
+    RollingGridLayer<4> serial;
+    RollingGridLayer<4> parallel;
+    for( auto* layer : {&serial, &parallel} ){
+        layer->track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+        layer->scroll_north();
+        layer->fill( 0 );
+    }
+
+    // a concave 'comb', crossing every row of sectors:
+    const Polygon<LocalLocation> comb( {{12.3,16.1}, {31.7,16.1}, {31.7,35.9}, {27.2,35.9}, {27.2,21.4}, {22.6,34.8},
+                                        {19.1,21.9}, {16.4,35.2}, {12.3,35.2}, {12.3,16.1}} );
+    WorkerPool pool( 3 );
+    REQUIRE( 3 == pool.size() );
+
+    CHECK( serial.fill( comb, serial.visible(), 0x66 ));
+    CHECK( parallel.fill( comb, parallel.visible(), 0x66, pool ));
+
+    size_t filled = 0;
+    for( uint32_t row = 0; row < serial.cells_across_view(); ++row ){
+        for( uint32_t column = 0; column < serial.cells_across_view(); ++column ){
+            const LocalLocation at = serial.visible().min + LocalLocation( column + 0.5, row + 0.5 );
+            CHECK( static_cast<int>(serial.get(at)) == static_cast<int>(parallel.get(at)) );
+            filled += (0x66 == serial.get(at));
+        }
+    }
+    CHECK( 200 < filled );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer relocates across multiple sectors"){
+    RollingGridLayer<4> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+    REQUIRE( LocalLocation( 12.0, 12.0) == layer.visible().min );
+    populate_markers_per_sector( layer );
+
+    SECTION( "Relocate Diagonally" ){
+        // two sectors east, one sector south; (also rounds to the nearest sector)
+        CHECK( layer.relocate( {20.7, 8.4} ));
+        REQUIRE( LocalLocation( 20.0, 8.0) == layer.visible().min );
+        REQUIRE( LocalLocation( 40.0, 28.0) == layer.visible().max );
+
+        for( uint32_t row = 0; row < layer.sectors_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.sectors_across_view(); ++column ){
+                const LocalLocation at = layer.visible().min + LocalLocation( column*4 + 1.5, row*4 + 2.5 );
+                if( (column < 3) && (0 < row) ){
+                    // kept: marked with its sector-index from the original view
+                    CHECK( (((column + 2) << 4) + (row - 1)) == static_cast<int>(layer.get(at)) );
+                }else{
+                    // loaded: (no cache is enabled)
+                    CHECK( 0x80 == static_cast<int>(layer.get(at)) );
+                }
+            }
+        }
+    }
+
+    SECTION( "Relocate Matches Repeated Scrolls" ){
+        RollingGridLayer<4> scrolled;
+        scrolled.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+        populate_markers_per_sector( scrolled );
+
+        CHECK( layer.relocate( {4.0, 24.0} ));
+        scrolled.scroll_west();
+        scrolled.scroll_west();
+        scrolled.scroll_north();
+        scrolled.scroll_north();
+        scrolled.scroll_north();
+        REQUIRE( layer.visible().min == scrolled.visible().min );
+
+        for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+                const LocalLocation at = layer.visible().min + LocalLocation( column + 0.5, row + 0.5 );
+                CHECK( static_cast<int>(scrolled.get(at)) == static_cast<int>(layer.get(at)) );
+            }
+        }
+    }
+
+    SECTION( "Relocate Through The Cache" ){
+        const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-relocate-test";
+        std::filesystem::create_directories( cache_path );
+        REQUIRE( layer.enable_cache( cache_path ));
+
+        // move the view entirely away -- every sector is saved -- and then back again.
+        CHECK( layer.relocate( {32.0, 36.0} ));
+        CHECK( LocalLocation( 32.0, 36.0) == layer.visible().min );
+        CHECK( layer.relocate( {12.0, 12.0} ));
+        CHECK( LocalLocation( 12.0, 12.0) == layer.visible().min );
+
+        for( uint32_t row = 0; row < layer.sectors_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.sectors_across_view(); ++column ){
+                const LocalLocation at = layer.visible().min + LocalLocation( column*4 + 0.5, row*4 + 3.5 );
+                CHECK( ((column << 4) + row) == static_cast<int>(layer.get(at)) );
+            }
+        }
+
+        chartbox::io::flatbuffer::cache_directory_path.clear();
+        std::filesystem::remove_all( cache_path );
+    }
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer prefetching matches synchronous tile I/O"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-prefetch-test";
+
+    // snapshot of the view after each move: (scroll east, east, north, west, west, west, relocate, east)
+    const auto travel = [&]( bool prefetch ){
+        std::filesystem::remove_all( cache_path );
+        std::filesystem::create_directories( cache_path );
+
+        RollingGridLayer<4> layer;
+        layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+        REQUIRE( layer.enable_cache( cache_path ));
+        REQUIRE( layer.enable_prefetch( prefetch ));
+        populate_markers_per_cell( layer );
+
+        std::vector<std::vector<uint8_t>> snapshots;
+        const auto snapshot = [&](){
+            std::vector<uint8_t> values;
+            for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+                for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+                    values.push_back( layer.get( layer.visible().min + LocalLocation( column + 0.5, row + 0.5 ) ));
+                }
+            }
+            snapshots.push_back( values );
+            // mark the view, so that the next moves must write it back:
+            layer.store( layer.visible().min + LocalLocation( 1.5, 1.5 ), static_cast<uint8_t>(snapshots.size()) );
+        };
+
+        layer.scroll_east();  snapshot();
+        layer.scroll_east();  snapshot();
+        layer.scroll_north(); snapshot();
+        layer.scroll_west();  snapshot();
+        layer.scroll_west();  snapshot();
+        layer.scroll_west();  snapshot();
+        layer.relocate( layer.visible().min + LocalLocation( 8.0, -4.0 ) ); snapshot();
+        layer.scroll_east();  snapshot();
+
+        layer.enable_prefetch( false );
+        chartbox::io::flatbuffer::cache_directory_path.clear();
+        return snapshots;
+    };
+
+    const auto expect = travel( false );
+    const auto actual = travel( true );
+    std::filesystem::remove_all( cache_path );
+
+    REQUIRE( expect.size() == actual.size() );
+    for( size_t move = 0; move < expect.size(); ++move ){
+        CHECK( expect[move] == actual[move] );
+    }
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer only writes modified sectors"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-dirty-test";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    RollingGridLayer<4> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+    REQUIRE( layer.enable_cache( cache_path ));
+    const auto written = [](){ return chartbox::io::flatbuffer::bytes_written(); };
+
+    // a new layer has nothing to write:
+    uint64_t last_written = written();
+    CHECK( layer.flush_to_cache() );
+    CHECK( last_written == written() );
+
+    // markers touch every sector.  (and keep every tile raw -- so that each one is the same size)
+    populate_markers_per_cell( layer );
+    CHECK( layer.flush_to_cache() );
+    const uint64_t tile_size = (written() - last_written) / 25;
+    CHECK( (written() - last_written) == (25 * tile_size) );
+    CHECK( 16 < tile_size );
+
+    // ... and then they're clean again:
+    last_written = written();
+    CHECK( layer.flush_to_cache() );
+    CHECK( last_written == written() );
+
+    // one cell => one sector
+    CHECK( layer.store( {13.5, 13.5}, 0x22 ));
+    CHECK( layer.flush_to_cache() );
+    CHECK( (last_written + tile_size) == written() );
+
+    // a span (across two sectors), and then a scroll which evicts one of them
+    last_written = written();
+    CHECK( layer.store_span( 17, 2, 5, 0x33 ));
+    CHECK( layer.scroll_east() );
+    CHECK( (last_written + tile_size) == written() );
+    CHECK( layer.flush_to_cache() );
+    CHECK( (last_written + 2*tile_size) == written() );
+
+    // scrolling over clean sectors writes nothing
+    last_written = written();
+    CHECK( layer.scroll_west() );
+    CHECK( layer.scroll_north() );
+    CHECK( layer.scroll_south() );
+    CHECK( last_written == written() );
+    CHECK( 0x22 == layer.get( {13.5, 13.5} ));
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify a transient RollingGridLayer never touches the tile cache"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-transient-test";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+    const auto written = [](){ return chartbox::io::flatbuffer::bytes_written(); };
+
+    // a persistent layer charts its view:
+    RollingGridLayer<4> charted;
+    REQUIRE( charted.enable_cache( cache_path ));
+    CHECK( charted.persistence_enabled() );
+    populate_markers_per_cell( charted );
+    REQUIRE( charted.flush_to_cache() );
+
+    // ... and then a transient layer (of the same origins) moves away, and back
+    RollingGridLayer<4> transient;
+    REQUIRE( transient.enable_persistence( false ));
+    CHECK_FALSE( transient.persistence_enabled() );
+    CHECK_FALSE( transient.enable_prefetch( true ));
+    transient.fill( 0x22 );
+    const uint64_t last_written = written();
+    CHECK( transient.relocate( {40, 40} ));
+    CHECK( transient.relocate( {0, 0} ));
+    CHECK( transient.flush_to_cache() );
+    CHECK( last_written == written() );
+
+    // its sectors enter the view unknown:
+    CHECK( chartbox::layer::unknown_cell_value == transient.get({ 2.5, 2.5 }) );
+    CHECK( transient.store( {2.5, 2.5}, 0x33 ));
+    CHECK( transient.load_from_cache() );
+    CHECK( 0x33 == transient.get({ 2.5, 2.5 }) );
+
+    // ... and the charted tiles are intact:
+    RollingGridLayer<4> reloaded;
+    REQUIRE( reloaded.load_from_cache() );
+    for( double northing = 0.5; northing < 20; northing += 1 ){
+        for( double easting = 0.5; easting < 20; easting += 1 ){
+            REQUIRE( charted.get({easting, northing}) == reloaded.get({easting, northing}) );
+        }
+    }
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer tiles can be read in place"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-mapped-test";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    RollingGridLayer<4> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+    REQUIRE( layer.enable_cache( cache_path ));
+    populate_markers_per_cell( layer );
+    CHECK( layer.flush_to_cache() );
+
+    // the south-west sector of the view:
+    const auto tile = chartbox::io::flatbuffer::map( layer.visible().min );
+    REQUIRE( tile.is_open() );
+    CHECK( 4 == tile.dimension() );
+    CHECK( layer.visible().min == tile.origin() );
+    REQUIRE( 16 == tile.cells().size() );
+    for( uint32_t row = 0; row < 4; ++row ){
+        for( uint32_t column = 0; column < 4; ++column ){
+            const LocalLocation at = layer.visible().min + LocalLocation( column + 0.5, row + 0.5 );
+            CHECK( static_cast<int>(layer.get(at)) == static_cast<int>(tile.cells()[column + row*4]) );
+        }
+    }
+
+    // missing tiles do not map:
+    CHECK( not chartbox::io::flatbuffer::map( {1000, 1000} ).is_open() );
+
+    // ... and neither do corrupt ones:
+    const auto corrupt_path = chartbox::io::flatbuffer::generate_tile_cache_filename( {2000, 2000} );
+    { std::ofstream corrupt( corrupt_path, std::ios::binary ); corrupt << "not a tile"; }
+    CHECK( not chartbox::io::flatbuffer::map( {2000, 2000} ).is_open() );
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer round-trips through a tile archive"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-archive-test";
+    const std::filesystem::path archive_path = std::filesystem::temp_directory_path() / "chartbox-archive-test.tiles";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+    std::filesystem::remove( archive_path );
+
+    // expected value of each sector, by its origin:
+    const auto marker = []( const LocalLocation& origin ){
+        return static_cast<uint8_t>( (static_cast<int>(origin.easting) / 4) * 16 + static_cast<int>(origin.northing) / 4 ); };
+    const auto check_view = [&]( RollingGridLayer<4>& layer ){
+        for( uint32_t row = 0; row < layer.sectors_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.sectors_across_view(); ++column ){
+                const LocalLocation origin = layer.visible().min + LocalLocation( column*4, row*4 );
+                CHECK( static_cast<int>(marker(origin)) == static_cast<int>(layer.get( origin + LocalLocation(1.5, 2.5) )) );
+            }
+        }
+    };
+
+    RollingGridLayer<4> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+    const auto mark_view = [&](){
+        for( uint32_t row = 0; row < layer.sectors_across_view(); ++row ){
+            for( uint32_t column = 0; column < layer.sectors_across_view(); ++column ){
+                const LocalLocation origin = layer.visible().min + LocalLocation( column*4, row*4 );
+                layer.fill( BoundBox<LocalLocation>( origin, origin + LocalLocation(4,4) ), marker(origin) );
+            }
+        }
+    };
+
+    SECTION( "Through a new archive" ){
+        REQUIRE( layer.enable_cache( archive_path ));
+        REQUIRE( nullptr != chartbox::io::flatbuffer::archive() );
+        mark_view();
+
+        // away, and back again:
+        CHECK( layer.relocate( {32.0, 32.0} ));
+        mark_view();
+        CHECK( layer.relocate( {12.0, 12.0} ));
+        check_view( layer );
+        CHECK( layer.flush_to_cache() );
+        CHECK( 50 == chartbox::io::flatbuffer::archive()->size() );
+
+        // size of the archive, in whole slots:  (the last payload need not fill its slot)
+        const auto slot_count = [](){
+            constexpr uint64_t alignment = chartbox::io::flatbuffer::TileArchive::payload_alignment;
+            return (chartbox::io::flatbuffer::archive()->file_size() + alignment - 1) / alignment; };
+
+        // an update never overwrites the committed payload -- the first is appended:
+        CHECK( layer.store( {13.5, 13.5}, 0x77 ));
+        CHECK( layer.flush_to_cache() );
+        const uint64_t file_slots = slot_count();
+        // ... and later updates take the slots which each flush frees:  (as does the index)
+        CHECK( layer.store( {14.5, 13.5}, 0x78 ));
+        CHECK( layer.flush_to_cache() );
+        CHECK( file_slots == slot_count() );
+        CHECK( layer.store( {15.5, 13.5}, 0x79 ));
+        CHECK( layer.flush_to_cache() );
+        CHECK( file_slots == slot_count() );
+
+        // reopen:
+        chartbox::io::flatbuffer::enable( {} );
+        RollingGridLayer<4> reopened;
+        reopened.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+        REQUIRE( reopened.enable_cache( archive_path ));
+        CHECK( 50 == chartbox::io::flatbuffer::archive()->size() );
+        CHECK( reopened.relocate( {32.0, 32.0} ));
+        check_view( reopened );
+        CHECK( reopened.relocate( {12.0, 12.0} ));
+        CHECK( 0x77 == reopened.get( {13.5, 13.5} ));
+        CHECK( 0x78 == reopened.get( {14.5, 13.5} ));
+        CHECK( 0x79 == reopened.get( {15.5, 13.5} ));
+    }
+
+    SECTION( "Packed from a tile directory" ){
+        REQUIRE( layer.enable_cache( cache_path ));
+        mark_view();
+        CHECK( layer.relocate( {32.0, 32.0} ));
+        mark_view();
+        CHECK( layer.flush_to_cache() );
+        chartbox::io::flatbuffer::enable( {} );
+
+        CHECK( 50 == chartbox::io::flatbuffer::pack_directory( cache_path, archive_path ));
+
+        RollingGridLayer<4> packed;
+        packed.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+        REQUIRE( packed.enable_cache( archive_path ));
+        CHECK( packed.relocate( {32.0, 32.0} ));
+        check_view( packed );
+        CHECK( packed.relocate( {12.0, 12.0} ));
+        check_view( packed );
+
+        // a file that is not an archive does not open:
+        chartbox::io::flatbuffer::enable( {} );
+        const std::filesystem::path bogus_path = cache_path / "bogus.tiles";
+        { std::ofstream bogus( bogus_path, std::ios::binary ); bogus << "not an archive -- not at all, no"; }
+        CHECK( not chartbox::io::flatbuffer::enable( bogus_path ));
+    }
+
+    chartbox::io::flatbuffer::enable( {} );
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::remove( archive_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify a tile archive keeps each committed tile intact, until the next flush"){
+    using chartbox::io::flatbuffer::MappedTile;
+    using chartbox::io::flatbuffer::TileArchive;
+    const std::filesystem::path archive_path = std::filesystem::temp_directory_path() / "chartbox-archive-commit-test.tiles";
+    std::filesystem::remove( archive_path );
+
+    const std::vector<uint8_t> original( 3000, 0x11 );
+    const std::vector<uint8_t> shorter( 1000, 0x22 );
+    const TileArchive::Key key( 3, -2 );
+    std::vector<uint8_t> payload;
+
+    TileArchive writer;
+    REQUIRE( writer.open( archive_path ));
+    REQUIRE( writer.write( key, original.data(), original.size() ));
+    REQUIRE( writer.flush() );
+
+    // an update which fits the old slot -- but is not yet flushed:  (e.g. interrupted)
+    REQUIRE( writer.write( key, shorter.data(), shorter.size() ));
+    REQUIRE( writer.read( key, payload ));
+    CHECK( shorter == payload );
+    {
+        // ... the next reader of the file still sees the whole of the committed tile:
+        TileArchive reader;
+        REQUIRE( reader.open( archive_path ));
+        REQUIRE( reader.read( key, payload ));
+        CHECK( original == payload );
+    }
+
+    REQUIRE( writer.flush() );
+    {
+        TileArchive reader;
+        REQUIRE( reader.open( archive_path ));
+        REQUIRE( reader.read( key, payload ));
+        CHECK( shorter == payload );
+    }
+    writer.close();
+
+    // tiles are keyed by whole tile widths:
+    CHECK( TileArchive::Key::on_grid( {-1024, 2048}, 1024 ));
+    CHECK_FALSE( TileArchive::Key::on_grid( {1000, 2048}, 1024 ));
+    CHECK_FALSE( TileArchive::Key::on_grid( {1024, 2560}, 1024 ));
+
+    // ... a tile off the grid is rejected, rather than rounded onto its neighbour:
+    REQUIRE( chartbox::io::flatbuffer::enable( archive_path ));
+    CHECK( chartbox::io::flatbuffer::write_tile( {1024, 0}, 1024, original.data(), original.size() ));
+    CHECK_FALSE( chartbox::io::flatbuffer::write_tile( {1000, 0}, 1024, shorter.data(), shorter.size() ));
+    MappedTile tile;
+    CHECK_FALSE( chartbox::io::flatbuffer::read_tile( {1000, 0}, 1024, tile ));
+    REQUIRE( chartbox::io::flatbuffer::archive()->read( TileArchive::Key( {1024, 0}, 1024 ), payload ));
+    CHECK( original == payload );
+
+    chartbox::io::flatbuffer::enable( {} );
+    std::filesystem::remove( archive_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer saves each tile with its smallest encoding"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-encoding-test";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    RollingGridLayer<64> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {320,320} ));
+    REQUIRE( layer.enable_cache( cache_path ));
+    const auto sector_origin = [&]( uint32_t column, uint32_t row ){
+        return layer.visible().min + LocalLocation( column*64, row*64 ); };
+
+    // (0,0): uniform;  (1,0): a few runs;  (2,0): every cell differs
+    layer.fill( 0x11 );
+    layer.fill( BoundBox<LocalLocation>( sector_origin(1,0), sector_origin(1,0) + LocalLocation(64,32) ), 0x22 );
+    for( uint32_t cell_index = 0; cell_index < 4096; ++cell_index ){
+        layer.store( sector_origin(2,0) + LocalLocation( (cell_index % 64) + 0.5, (cell_index / 64) + 0.5 ), static_cast<uint8_t>(cell_index) );
+    }
+    REQUIRE( layer.flush_to_cache() );
+
+    const auto uniform = chartbox::io::flatbuffer::map( sector_origin(0,0) );
+    REQUIRE( uniform.is_open() );
+    CHECK( chartbox::io::flatbuffer::TileEncoding_Uniform == uniform.encoding() );
+    CHECK( 0x11 == uniform.value() );
+    CHECK( uniform.data().empty() );
+    CHECK( uniform.cells().empty() );
+
+    const auto runs = chartbox::io::flatbuffer::map( sector_origin(1,0) );
+    REQUIRE( runs.is_open() );
+    CHECK( chartbox::io::flatbuffer::TileEncoding_RunLength == runs.encoding() );
+    CHECK( (2 * 16) == runs.data().size() );   // 2 runs, each of 2048 cells ==> 8 pairs
+
+    const auto raw = chartbox::io::flatbuffer::map( sector_origin(2,0) );
+    REQUIRE( raw.is_open() );
+    CHECK( chartbox::io::flatbuffer::TileEncoding_Raw == raw.encoding() );
+    CHECK( 4096 == raw.cells().size() );
+
+    // every encoding decodes back to the same cells:
+    std::vector<uint8_t> decoded( 4096 );
+    CHECK( runs.decode( decoded.data(), decoded.size() ));
+    CHECK( 0x22 == decoded[0] );
+    CHECK( 0x22 == decoded[2047] );
+    CHECK( 0x11 == decoded[2048] );
+    CHECK( not runs.decode( decoded.data(), decoded.size() - 1 ));
+
+    // ... and loads back into a new layer:
+    RollingGridLayer<64> reloaded;
+    reloaded.track( BoundBox<LocalLocation>( {0,0}, {320,320} ));
+    CHECK( reloaded.load_from_cache() );
+    for( uint32_t row = 0; row < layer.cells_across_view(); ++row ){
+        for( uint32_t column = 0; column < layer.cells_across_view(); ++column ){
+            const LocalLocation at = layer.visible().min + LocalLocation( column + 0.5, row + 0.5 );
+            CHECK( static_cast<int>(layer.get(at)) == static_cast<int>(reloaded.get(at)) );
+        }
+    }
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer pools evicted sectors"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-pool-test";
+    const auto written = [](){ return chartbox::io::flatbuffer::bytes_written(); };
+
+    for( const bool prefetch : {false, true} ){
+        std::filesystem::remove_all( cache_path );
+        std::filesystem::create_directories( cache_path );
+
+        RollingGridLayer<4> layer;
+        layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+        REQUIRE( layer.enable_cache( cache_path ));
+        REQUIRE( layer.enable_prefetch( prefetch ));
+        REQUIRE( layer.enable_pool( 5 ));
+        REQUIRE( nullptr != layer.pool() );
+        populate_markers_per_cell( layer );
+        const LocalLocation home = layer.visible().min;
+        const auto marker_at = [&]( const LocalLocation& at ){
+            return static_cast<uint8_t>( (static_cast<uint8_t>(at.easting - home.easting) << 4) + static_cast<uint8_t>(at.northing - home.northing) ); };
+
+        // tack back and forth across a sector boundary: the same column is evicted + restored, and never written
+        const uint64_t written_before = written();
+        for( int tack = 0; tack < 4; ++tack ){
+            CHECK( layer.scroll_east() );
+            CHECK( layer.scroll_west() );
+        }
+        CHECK( written_before == written() );
+        // (every scroll but the first finds its column of 5 sectors in the pool)
+        CHECK( (7 * 5) == layer.pool()->hits() );
+        CHECK( 5 == layer.pool()->misses() );
+        CHECK( 5 == layer.pool()->size() );
+        CHECK( 0 == layer.pool()->evictions() );
+        for( double northing = 0.5; northing < 20; northing += 1 ){
+            for( double easting = 0.5; easting < 20; easting += 1 ){
+                CHECK( static_cast<int>(marker_at( home + LocalLocation(easting, northing) )) == static_cast<int>(layer.get( home + LocalLocation(easting, northing) )) );
+            }
+        }
+
+        // a longer move overflows the pool: the oldest dirty sectors are written as they fall out
+        CHECK( layer.scroll_north() );
+        CHECK( layer.scroll_north() );
+        CHECK( 5 == layer.pool()->size() );
+        CHECK( 10 == layer.pool()->evictions() );
+        CHECK( layer.enable_prefetch( false ));
+        CHECK( written_before < written() );
+
+        // ... and read back from the cache, once the pool is flushed + emptied
+        CHECK( layer.enable_pool( 0 ));
+        CHECK( nullptr == layer.pool() );
+        CHECK( layer.scroll_south() );
+        CHECK( layer.scroll_south() );
+        for( double northing = 0.5; northing < 20; northing += 1 ){
+            for( double easting = 0.5; easting < 20; easting += 1 ){
+                CHECK( static_cast<int>(marker_at( home + LocalLocation(easting, northing) )) == static_cast<int>(layer.get( home + LocalLocation(easting, northing) )) );
+            }
+        }
+
+        chartbox::io::flatbuffer::cache_directory_path.clear();
+    }
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer pyramid tracks the max of each block"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-pyramid-test";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    RollingGridLayer<64> layer;
+    layer.track( BoundBox<LocalLocation>( {0,0}, {320,320} ));
+    REQUIRE( layer.enable_cache( cache_path ));
+    REQUIRE( 6 == layer.level_count() );
+    REQUIRE( layer.enable_pyramid( true ));
+    const LocalLocation home = layer.visible().min;
+
+    // sparse, scattered values -- sector (0,0) is left uniform:
+    layer.fill( 0 );
+    for( uint32_t cell_index = 0; cell_index < (320*320); cell_index += 97 ){
+        const uint32_t column = cell_index % 320;
+        const uint32_t row = cell_index / 320;
+        if( (64 <= column) || (64 <= row) ){
+            layer.store( home + LocalLocation( column + 0.5, row + 0.5 ), static_cast<uint8_t>( (cell_index * 31) % 251 ) );
+        }
+    }
+
+    // brute-force max over the level-cell containing (column, row)
+    const auto block_max = [&]( const RollingGridLayer<64>& from, uint32_t column, uint32_t row, uint32_t level ){
+        const uint32_t first_column = (column >> level) << level;
+        const uint32_t first_row = (row >> level) << level;
+        uint8_t value = 0;
+        for( uint32_t each_row = first_row; each_row < (first_row + (1u << level)); ++each_row ){
+            for( uint32_t each_column = first_column; each_column < (first_column + (1u << level)); ++each_column ){
+                value = std::max( value, from.get( home + LocalLocation( each_column + 0.5, each_row + 0.5 )));
+            }
+        }
+        return value;
+    };
+    const auto check_levels = [&]( const RollingGridLayer<64>& from ){
+        for( uint32_t level = 0; level <= from.level_count(); ++level ){
+            for( uint32_t row = 3; row < 320; row += 29 ){
+                for( uint32_t column = 5; column < 320; column += 23 ){
+                    CHECK( static_cast<int>(block_max(from, column, row, level)) == static_cast<int>(from.get( home + LocalLocation( column + 0.5, row + 0.5 ), level )) );
+                }
+            }
+        }
+    };
+    check_levels( layer );
+
+    // box queries: exact at level 0; conservative above it
+    const BoundBox<LocalLocation> box( home + LocalLocation(70.5, 70.5), home + LocalLocation(150.5, 90.5) );
+    uint8_t exact = 0;
+    for( uint32_t row = 70; row <= 90; ++row ){
+        for( uint32_t column = 70; column <= 150; ++column ){
+            exact = std::max( exact, layer.get( home + LocalLocation( column + 0.5, row + 0.5 )));
+        }
+    }
+    CHECK( static_cast<int>(exact) == static_cast<int>(layer.max( box, 0 )) );
+    for( uint32_t level = 1; level <= layer.level_count(); ++level ){
+        CHECK( exact <= layer.max( box, level ));
+        CHECK( layer.max( box, level - 1 ) <= layer.max( box, level ));
+    }
+
+    // lowering the peak of a sector lowers its top level, too
+    const LocalLocation peak = home + LocalLocation( 200.5, 200.5 );
+    layer.store( peak, 0xFE );
+    CHECK( 0xFE == layer.get( peak, layer.level_count() ));
+    layer.store( peak, 0 );
+    CHECK( static_cast<int>(block_max(layer, 200, 200, 6)) == static_cast<int>(layer.get( peak, layer.level_count() )) );
+    CHECK( 0xFE > layer.get( peak, layer.level_count() ));
+    check_levels( layer );
+
+    // pyramids are saved alongside their (non-uniform) tiles ...
+    REQUIRE( layer.flush_to_cache() );
+    CHECK( not chartbox::io::flatbuffer::map( home ).has_pyramid() );
+    CHECK( chartbox::io::flatbuffer::map( home + LocalLocation(64, 64) ).has_pyramid() );
+
+    // ... and restored with them
+    RollingGridLayer<64> reloaded;
+    reloaded.track( BoundBox<LocalLocation>( {0,0}, {320,320} ));
+    REQUIRE( reloaded.enable_pyramid( true ));
+    CHECK( reloaded.load_from_cache() );
+    check_levels( reloaded );
+
+    // tiles saved without a pyramid are rebuilt as they load
+    RollingGridLayer<64> plain;
+    plain.track( BoundBox<LocalLocation>( {0,0}, {320,320} ));
+    CHECK( plain.load_from_cache() );
+    plain.store( peak, 0xFE );
+    CHECK( plain.flush_to_cache() );
+    CHECK( not chartbox::io::flatbuffer::map( home + LocalLocation(192, 192) ).has_pyramid() );
+    CHECK( reloaded.load_from_cache() );
+    CHECK( 0xFE == reloaded.get( peak, reloaded.level_count() ));
+    check_levels( reloaded );
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer raycasts match a walk of every cell"){
+    RollingGridLayer<64> layer;
+    const LocalLocation home = layer.visible().min;
+    layer.fill( chartbox::layer::clear_cell_value );
+
+    // a wall, north-south; and scattered blocks, of various values
+    layer.fill( BoundBox<LocalLocation>( home + LocalLocation(100, 0), home + LocalLocation(101, 60) ), chartbox::layer::block_cell_value );
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> coordinate_distribution( 0, 310 );
+    for( uint32_t block = 0; block < 60; ++block ){
+        const LocalLocation corner = home + LocalLocation( coordinate_distribution(generator), coordinate_distribution(generator) );
+        layer.fill( BoundBox<LocalLocation>( corner, corner + LocalLocation(4, 3) ), static_cast<uint8_t>( 0x40 + block * 3 ) );
+    }
+
+    // from inside the view, and from outside it:
+    const std::vector<LocalLocation> origins = { home + LocalLocation(20.5, 50.5), home + LocalLocation(160.25, 170.75), home + LocalLocation(-40, 200) };
+    std::uniform_real_distribution<double> target_distribution( -60, 380 );
+    std::vector<LocalLocation> targets;
+    for( uint32_t target = 0; target < 500; ++target ){
+        targets.push_back( home + LocalLocation( target_distribution(generator), target_distribution(generator) ) );
+    }
+
+    const auto& generic = static_cast<const chartbox::layer::LayerInterface<RollingGridLayer<64>>&>( layer );
+    std::vector<double> expected( targets.size() );
+    std::vector<double> direct( targets.size() );
+    std::vector<double> skipping( targets.size() );
+    for( const auto& origin : origins ){
+        for( const uint8_t threshold : { uint8_t(0x80), uint8_t(0xFF) } ){
+            REQUIRE( generic.raycast( origin, targets, threshold, expected ) );
+            REQUIRE( layer.enable_pyramid( false ) );
+            REQUIRE( layer.raycast( origin, targets, threshold, direct ) );
+            REQUIRE( layer.enable_pyramid( true ) );
+            REQUIRE( layer.raycast( origin, targets, threshold, skipping ) );
+
+            size_t blocked = 0;
+            for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+                REQUIRE( expected[target_index] == direct[target_index] );
+                if( chartbox::layer::raycast_clear == expected[target_index] ){
+                    REQUIRE( chartbox::layer::raycast_clear == skipping[target_index] );
+                }else{
+                    REQUIRE( skipping[target_index] == Approx( expected[target_index] ).margin(1e-6) );
+                    ++blocked;
+                }
+            }
+            CHECK( 0 < blocked );
+            CHECK( blocked < targets.size() );
+        }
+    }
+
+    // straight at the wall:
+    std::vector<double> distances( 2 );
+    const std::vector<LocalLocation> at_wall = { home + LocalLocation(150.5, 50.5), home + LocalLocation(150.5, 80.5) };
+    REQUIRE( layer.raycast( home + LocalLocation(20.5, 50.5), at_wall, chartbox::layer::block_cell_value, distances ) );
+    CHECK( distances[0] == Approx(79.5) );
+    CHECK( chartbox::layer::raycast_clear == distances[1] );
+
+    // (the output must fit every target)
+    CHECK_FALSE( layer.raycast( home, at_wall, chartbox::layer::block_cell_value, std::span<double>( distances.data(), 1 ) ) );
+} // TEST_CASE
+
+TEST_CASE( "Verify RollingGridLayer readers see a consistent view, while it scrolls"){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-reader-test";
+
+    // a distinct value for each cell of the plane, by its absolute location.  (never `unknown_cell_value`)
+    const auto pattern = []( const LocalLocation& p ){
+        const int64_t column = static_cast<int64_t>( std::floor(p.easting) );
+        const int64_t row = static_cast<int64_t>( std::floor(p.northing) );
+        return static_cast<uint8_t>( 1 + ((column*7 + row*13) & 0x3F) ); };
+
+    for( const bool prefetch : {false, true} ){
+        for( const size_t pool_capacity : {0, 3} ){
+            std::filesystem::remove_all( cache_path );
+            std::filesystem::create_directories( cache_path );
+
+            RollingGridLayer<4> layer;
+            layer.track( BoundBox<LocalLocation>( {0,0}, {48,48} ));
+            REQUIRE( layer.enable_cache( cache_path ));
+            const LocalLocation home = layer.visible().min;
+
+            // write the pattern across every view which the writer will move between:
+            const std::array<LocalLocation,4> stops = { home, home + LocalLocation(4, 0), home + LocalLocation(4, 4), home + LocalLocation(0, 4) };
+            for( const auto& stop : stops ){
+                REQUIRE( layer.relocate( stop ));
+                for( double northing = stop.northing + 0.5; northing < stop.northing + 20; northing += 1 ){
+                    for( double easting = stop.easting + 0.5; easting < stop.easting + 20; easting += 1 ){
+                        layer.store( {easting, northing}, pattern({easting, northing}) );
+                    }
+                }
+                REQUIRE( layer.flush_to_cache() );
+            }
+
+            REQUIRE( layer.enable_concurrent_readers( true ));
+            REQUIRE( layer.concurrent_readers_enabled() );
+            REQUIRE( layer.enable_prefetch( prefetch ));
+            REQUIRE( layer.enable_pool( pool_capacity ));
+
+            std::atomic<bool> done = false;
+            std::atomic<size_t> reads = 0;
+            std::atomic<size_t> mismatches = 0;
+            std::vector<std::thread> readers;
+            for( uint32_t thread = 0; thread < 3; ++thread ){
+                readers.emplace_back( [&, thread](){
+                    std::mt19937 generator( thread );
+                    std::uniform_real_distribution<double> offset_distribution( 0, 19.99 );
+                    std::vector<LocalLocation> points( 16 );
+                    std::vector<uint8_t> values( points.size() );
+                    while( not done ){
+                        const auto reader = layer.reader();
+                        const LocalLocation origin = reader.visible().min;
+                        for( auto& point : points ){
+                            point = origin + LocalLocation( offset_distribution(generator), offset_distribution(generator) );
+                            mismatches += ( pattern(point) != reader.get(point) );
+                        }
+                        reader.get( points, values );
+                        for( size_t index = 0; index < points.size(); ++index ){
+                            mismatches += ( pattern(points[index]) != values[index] );
+                        }
+                        reads += 2 * points.size();
+                    }
+                });
+            }
+
+            for( uint32_t move = 0; move < 200; ++move ){
+                REQUIRE( layer.relocate( stops[move % stops.size()] ));
+                // let the readers catch up
+                std::this_thread::yield();
+            }
+            done = true;
+            for( auto& reader : readers ){
+                reader.join();
+            }
+
+            CHECK( 0 < reads );
+            CHECK( 0 == mismatches );
+
+            // the writer's own view is unchanged:
+            for( double northing = 0.5; northing < 20; northing += 1 ){
+                for( double easting = 0.5; easting < 20; easting += 1 ){
+                    const LocalLocation p = layer.visible().min + LocalLocation( easting, northing );
+                    REQUIRE( pattern(p) == layer.get(p) );
+                }
+            }
+
+            REQUIRE( layer.enable_pool( 0 ));
+            REQUIRE( layer.enable_prefetch( false ));
+            REQUIRE( layer.enable_concurrent_readers( false ));
+            CHECK_FALSE( layer.concurrent_readers_enabled() );
+            chartbox::io::flatbuffer::cache_directory_path.clear();
+        }
+    }
+    std::filesystem::remove_all( cache_path );
+} // TEST_CASE
@@ -0,0 +1,237 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "geometry/local-location.hpp"
+#include "io/flatbuffer.hpp"
+
+#include "rolling-grid-sector.hpp"
+
+namespace chartbox::layer::rolling {
+
+/// \brief write a sector to the cache -- but only if it has changed since it was last loaded or saved
+///
+/// \return true if the sector was written
+template<uint32_t cells_across_sector>
+bool save_sector( RollingGridSector<cells_across_sector>& sector, const geometry::LocalLocation& origin ){
+    if( sector.dirty() && chartbox::io::flatbuffer::save( const_cast<const RollingGridSector<cells_across_sector>&>(sector), origin ) ){
+        sector.dirty( false );
+        return true;
+    }
+    return false;
+}
+
+/// \brief read a sector from the cache.  (A missing tile reads as unknown cells)
+template<uint32_t cells_across_sector>
+bool load_sector( const geometry::LocalLocation& origin, RollingGridSector<cells_across_sector>& sector ){
+    const bool loaded = chartbox::io::flatbuffer::load( origin, sector );
+    sector.dirty( false );
+    return loaded;
+}
+
+/// \brief Background tile I/O for a RollingGridLayer: prefetched loads, and write-behind saves
+///
+/// Every load + save runs on a single background thread, in the order it was requested -- so each load
+/// always sees the results of every earlier save.  Sector buffers are passed in and out by pointer, and are
+/// recycled once they have been written.  (Clean sectors are recycled without being written.)  While concurrent
+/// readers may still hold saved buffers, they are handed to `retire_with`'s function, instead.
+///
+/// \param cells_across_sector cell count across a single dimension of each sector
+template<uint32_t cells_across_sector>
+class SectorLoader {
+public:
+    typedef RollingGridSector<cells_across_sector> sector_t;
+    typedef std::unique_ptr<sector_t> sector_ptr;
+
+public:
+    SectorLoader()
+        : worker_( [this](){ work(); } )
+    {}
+
+    SectorLoader( const SectorLoader& ) = delete;
+    SectorLoader& operator=( const SectorLoader& ) = delete;
+
+    /// \brief finishes every queued save, and then stops
+    ~SectorLoader(){
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        worker_.join();
+    }
+
+    /// \brief start loading the tile at the given origin, ahead of time
+    void prefetch( const geometry::LocalLocation& origin ){
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            if( jobs_.end() != find_load( origin ) ){
+                return;
+            }
+            jobs_.push_back( { Job::load, origin, allocate() } );
+        }
+        wake_.notify_all();
+    }
+
+    /// \brief take the tile at the given origin -- prefetched, if available; otherwise it is loaded now
+    sector_ptr load( const geometry::LocalLocation& origin ){
+        std::unique_lock<std::mutex> lock( mutex_ );
+        auto job = find_load( origin );
+        if( jobs_.end() == job ){
+            job = jobs_.insert( jobs_.end(), { Job::load, origin, allocate() } );
+            wake_.notify_all();
+        }
+        job->wanted = true;
+
+        done_.wait( lock, [&](){ return Job::finished == job->state; } );
+        sector_ptr sector = std::move( job->sector );
+        jobs_.erase( job );
+        return sector;
+    }
+
+    /// \brief hand each buffer which has left the view to `retire` -- rather than recycling it
+    ///
+    /// Called (without any lock held) from the saving thread, once the buffer has been written.  Buffers which were
+    /// never in view (e.g. discarded prefetches) are still recycled.
+    ///
+    /// \param retire - takes ownership of each buffer; or empty, to recycle every buffer again
+    void retire_with( std::function<void(sector_ptr)> retire ){
+        std::lock_guard<std::mutex> lock( mutex_ );
+        retire_ = std::move( retire );
+    }
+
+    /// \brief queue a sector to be written back to the cache.  (its buffer is recycled afterwards)
+    void save( sector_ptr sector, const geometry::LocalLocation& origin ){
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            if( not sector->dirty() ){
+                if( retire_ ){
+                    const auto retire = retire_;
+                    lock.unlock();
+                    retire( std::move(sector) );
+                }else{
+                    spares_.push_back( std::move(sector) );
+                }
+                return;
+            }
+            jobs_.push_back( { Job::save, origin, std::move(sector) } );
+        }
+        wake_.notify_all();
+    }
+
+    /// \brief drop every prefetched tile which has not been taken
+    void discard_prefetched(){
+        std::lock_guard<std::mutex> lock( mutex_ );
+        for( auto job = jobs_.begin(); job != jobs_.end(); ){
+            if( (Job::load == job->kind) && (not job->wanted) && (Job::running != job->state) ){
+                spares_.push_back( std::move(job->sector) );
+                job = jobs_.erase( job );
+            }else{
+                job->discarded |= (Job::load == job->kind) && (not job->wanted);
+                ++job;
+            }
+        }
+    }
+
+    /// \brief wait until every queued save has been written
+    void flush(){
+        std::unique_lock<std::mutex> lock( mutex_ );
+        done_.wait( lock, [this](){
+            return std::none_of( jobs_.begin(), jobs_.end(), []( const Job& job ){ return Job::save == job.kind; } ); });
+    }
+
+private:
+    struct Job {
+        enum Kind { load, save };
+        enum State { pending, running, finished };
+
+        Kind kind;
+        geometry::LocalLocation origin;
+        sector_ptr sector;
+        State state = pending;
+        bool wanted = false;
+        bool discarded = false;
+    };
+
+    // (call with `mutex_` held)
+    sector_ptr allocate(){
+        if( spares_.empty() ){
+            return std::make_unique<sector_t>();
+        }
+        sector_ptr sector = std::move( spares_.back() );
+        spares_.pop_back();
+        return sector;
+    }
+
+    // (call with `mutex_` held)
+    typename std::list<Job>::iterator find_load( const geometry::LocalLocation& origin ){
+        return std::find_if( jobs_.begin(), jobs_.end(), [&]( const Job& job ){
+            return (Job::load == job.kind) && (not job.discarded) && (origin == job.origin); });
+    }
+
+    void work(){
+        std::unique_lock<std::mutex> lock( mutex_ );
+        while( true ){
+            auto job = std::find_if( jobs_.begin(), jobs_.end(), []( const Job& each ){ return Job::pending == each.state; } );
+            if( jobs_.end() == job ){
+                if( stopping_ ){
+                    return;
+                }
+                wake_.wait( lock );
+                continue;
+            }else if( stopping_ && (Job::load == job->kind) ){
+                // nobody will take this tile:
+                jobs_.erase( job );
+                continue;
+            }
+
+            job->state = Job::running;
+            lock.unlock();
+            if( Job::save == job->kind ){
+                save_sector( *job->sector, job->origin );
+            }else{
+                load_sector( job->origin, *job->sector );
+            }
+            lock.lock();
+            job->state = Job::finished;
+
+            if( (Job::save == job->kind) && retire_ ){
+                // (the job stays queued until the buffer is retired -- so that `flush` waits for it, too)
+                const auto retire = retire_;
+                lock.unlock();
+                retire( std::move(job->sector) );
+                lock.lock();
+                jobs_.erase( job );
+            }else if( (Job::save == job->kind) || job->discarded ){
+                spares_.push_back( std::move(job->sector) );
+                jobs_.erase( job );
+            }
+            done_.notify_all();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    // guarded by `mutex_`:
+    std::list<Job> jobs_;
+    std::vector<sector_ptr> spares_;
+    std::function<void(sector_ptr)> retire_;
+    bool stopping_ = false;
+
+    std::thread worker_;
+};
+
+} // namespace
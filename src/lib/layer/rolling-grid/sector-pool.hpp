@@ -0,0 +1,129 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+#include "geometry/local-location.hpp"
+
+#include "rolling-grid-sector.hpp"
+
+namespace chartbox::layer::rolling {
+
+/// \brief Bounded pool of sectors which recently left the view of a RollingGridLayer -- in least-recently-used order
+///
+/// A sector which leaves the view is parked here, keyed by its origin, instead of being written to the cache.
+/// If the view returns before the sector falls out of the pool, it is swapped straight back in.  Sectors only
+/// fall out (and are written back, if dirty) when the pool is full.
+///
+/// \param cells_across_sector cell count across a single dimension of each sector
+template<uint32_t cells_across_sector>
+class SectorPool {
+public:
+    typedef RollingGridSector<cells_across_sector> sector_t;
+    typedef std::unique_ptr<sector_t> sector_ptr;
+
+public:
+    /// \param capacity - maximum number of sectors held by this pool
+    explicit SectorPool( size_t capacity )
+        : capacity_(capacity)
+    {}
+
+    SectorPool( const SectorPool& ) = delete;
+    SectorPool& operator=( const SectorPool& ) = delete;
+
+    inline size_t capacity() const { return capacity_; }
+
+    /// \brief change the capacity.  (excess sectors remain until the next `evict`)
+    inline void capacity( size_t new_capacity ) { capacity_ = new_capacity; }
+
+    inline size_t size() const { return entries_.size(); }
+
+    /// \brief true if the pool holds more sectors than its capacity
+    inline bool full() const { return capacity_ < entries_.size(); }
+
+    /// \brief count of `take` calls which found their sector
+    inline uint64_t hits() const { return hits_; }
+
+    /// \brief count of `take` calls which did not find their sector
+    inline uint64_t misses() const { return misses_; }
+
+    /// \brief count of sectors which fell out of the pool
+    inline uint64_t evictions() const { return evictions_; }
+
+    bool contains( const geometry::LocalLocation& origin ) const {
+        return entries_.end() != std::find_if( entries_.begin(), entries_.end(), [&]( const Entry& entry ){ return origin == entry.origin; });
+    }
+
+    /// \brief remove the sector at the given origin from the pool
+    ///
+    /// \return the sector -- or nullptr, if it is not in the pool
+    sector_ptr take( const geometry::LocalLocation& origin ){
+        const auto entry = std::find_if( entries_.begin(), entries_.end(), [&]( const Entry& each ){ return origin == each.origin; });
+        if( entries_.end() == entry ){
+            ++misses_;
+            return nullptr;
+        }
+        ++hits_;
+        sector_ptr sector = std::move( entry->sector );
+        entries_.erase( entry );
+        return sector;
+    }
+
+    /// \brief add a sector to the pool, as its most-recently-used entry
+    ///
+    /// \param sector - the sector to hold
+    /// \param origin - the origin of the sector
+    /// \param evicted_origin - [out] the origin of the evicted sector, if any
+    /// \return the least-recently-used sector, if the pool overflowed; otherwise nullptr
+    sector_ptr put( sector_ptr sector, const geometry::LocalLocation& origin, geometry::LocalLocation& evicted_origin ){
+        entries_.push_front( { origin, std::move(sector) } );
+        if( full() ){
+            return evict( evicted_origin );
+        }
+        return nullptr;
+    }
+
+    /// \brief remove the least-recently-used sector
+    ///
+    /// \param origin - [out] the origin of the evicted sector
+    /// \return the sector -- or nullptr, if the pool is empty
+    sector_ptr evict( geometry::LocalLocation& origin ){
+        if( entries_.empty() ){
+            return nullptr;
+        }
+        ++evictions_;
+        origin = entries_.back().origin;
+        sector_ptr sector = std::move( entries_.back().sector );
+        entries_.pop_back();
+        return sector;
+    }
+
+    /// \brief visit every sector in the pool, as `visit( sector_t&, const LocalLocation& origin )`
+    template<typename visit_t>
+    void for_each( visit_t&& visit ){
+        for( auto& entry : entries_ ){
+            visit( *entry.sector, entry.origin );
+        }
+    }
+
+private:
+    struct Entry {
+        geometry::LocalLocation origin;
+        sector_ptr sector;
+    };
+
+    size_t capacity_;
+
+    // most-recently-used first:
+    std::list<Entry> entries_;
+
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+};
+
+} // namespace
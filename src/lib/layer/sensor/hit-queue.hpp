@@ -0,0 +1,82 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "geometry/local-location.hpp"
+
+namespace chartbox::layer::sensor {
+
+/// \brief a single sensor return: the location it was seen at, and the value to store there
+struct SensorHit {
+    geometry::LocalLocation location;
+    uint8_t value;
+};
+
+/// \brief lock-free queue of hit batches: any number of producers; a single consumer
+///
+/// Producers push whole batches onto an intrusive stack, with a single compare-exchange each.  The consumer takes
+/// every queued batch at once (a single exchange), and visits them in the order they were pushed.  With only
+/// pushes and take-alls, a node is never popped while another thread may hold it -- so there is no ABA hazard.
+class HitQueue {
+public:
+    HitQueue() = default;
+    HitQueue( const HitQueue& ) = delete;
+    HitQueue& operator=( const HitQueue& ) = delete;
+
+    /// \brief drops any batches which were never taken
+    ~HitQueue(){
+        drain( []( const std::vector<SensorHit>& ){} );
+    }
+
+    /// \brief true if no batch is queued.  (a hint -- producers may push at any time)
+    inline bool empty() const {
+        return nullptr == head_.load( std::memory_order_relaxed ); }
+
+    /// \brief queue a batch of hits.  Safe from any thread.
+    void push( std::vector<SensorHit>&& hits ){
+        Batch* batch = new Batch{ head_.load(std::memory_order_relaxed), std::move(hits) };
+        while( not head_.compare_exchange_weak( batch->next, batch, std::memory_order_release, std::memory_order_relaxed ) ){}
+    }
+
+    /// \brief take every queued batch, and call `visit( hits )` on each -- oldest first.  (consumer only)
+    ///
+    /// \return the number of batches visited
+    template<typename function_t>
+    size_t drain( function_t&& visit ){
+        Batch* newest = head_.exchange( nullptr, std::memory_order_acquire );
+
+        // the stack holds the newest batch first:
+        Batch* oldest = nullptr;
+        while( newest ){
+            Batch* next = newest->next;
+            newest->next = oldest;
+            oldest = newest;
+            newest = next;
+        }
+
+        size_t count = 0;
+        while( oldest ){
+            Batch* next = oldest->next;
+            visit( oldest->hits );
+            delete oldest;
+            oldest = next;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct Batch {
+        Batch* next;
+        std::vector<SensorHit> hits;
+    };
+
+    std::atomic<Batch*> head_ = nullptr;
+};
+
+} // namespace
@@ -0,0 +1,238 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "sensor-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+namespace chartbox::layer::sensor {
+
+template<uint32_t cells_across_sector_>
+SensorLayer<cells_across_sector_>::SensorLayer(){
+    // (the cache is shared with -- and must never be overwritten by -- the charted layers)
+    grid_.enable_persistence( false );
+}
+
+template<uint32_t cells_across_sector_>
+void SensorLayer<cells_across_sector_>::submit( std::span<const SensorHit> hits ){
+    if( hits.empty() ){
+        return;
+    }
+
+    // split the batch by sector -- each part goes onto its sector's queue.  (sized first, to fill without regrowth)
+    std::vector<uint8_t> queue_indices( hits.size() );
+    std::array<size_t, queue_count> counts = {};
+    for( size_t hit_index = 0; hit_index < hits.size(); ++hit_index ){
+        queue_indices[hit_index] = static_cast<uint8_t>( queue_of(hits[hit_index].location) );
+        ++counts[ queue_indices[hit_index] ];
+    }
+
+    std::array<std::vector<SensorHit>, queue_count> parts;
+    for( uint32_t queue_index = 0; queue_index < queue_count; ++queue_index ){
+        parts[queue_index].reserve( counts[queue_index] );
+    }
+    for( size_t hit_index = 0; hit_index < hits.size(); ++hit_index ){
+        parts[ queue_indices[hit_index] ].push_back( hits[hit_index] );
+    }
+    for( uint32_t queue_index = 0; queue_index < queue_count; ++queue_index ){
+        if( not parts[queue_index].empty() ){
+            queues_[queue_index].push( std::move(parts[queue_index]) );
+        }
+    }
+
+    submitted_.fetch_add( hits.size(), std::memory_order_relaxed );
+}
+
+template<uint32_t cells_across_sector_>
+size_t SensorLayer<cells_across_sector_>::apply( BoundBox<LocalLocation>& touched ){
+    size_t applied = 0;
+    size_t dropped = 0;
+    LocalLocation min( std::numeric_limits<double>::max(), std::numeric_limits<double>::max() );
+    LocalLocation max( std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest() );
+
+    // sector by sector:
+    for( auto& queue : queues_ ){
+        if( queue.empty() ){
+            continue;
+        }
+
+        queue.drain( [&]( const std::vector<SensorHit>& hits ){
+            for( const auto& hit : hits ){
+                if( grid_.store( hit.location, hit.value ) ){
+                    min = { std::min(min.easting, hit.location.easting), std::min(min.northing, hit.location.northing) };
+                    max = { std::max(max.easting, hit.location.easting), std::max(max.northing, hit.location.northing) };
+                    ++applied;
+                }else{
+                    ++dropped;
+                }
+            }
+        });
+    }
+
+    if( 0 < applied ){
+        // (out to the far edge of the north-east cell)
+        touched = BoundBox<LocalLocation>( min, max + LocalLocation( meters_across_cell(), meters_across_cell() ) );
+    }
+    applied_.fetch_add( applied, std::memory_order_relaxed );
+    dropped_.fetch_add( dropped, std::memory_order_relaxed );
+    return applied;
+}
+
+namespace {
+    // the update for each marked cell, as bits: any hit outranks every miss
+    constexpr uint8_t mark_miss = 1;
+    constexpr uint8_t mark_hit = 2;
+
+    /// \brief apply the marked update to each cell of a run; unmarked cells are unchanged
+    void update_cells( const uint8_t* marks, std::span<uint8_t> cells, const OccupancyModel& model ){
+        size_t index = 0;
+#if defined(__AVX2__)
+        // 32 cells at a time: (saturating adds, then clamped -- the same as the scalar loop)
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i hit_bit = _mm256_set1_epi8( static_cast<char>(mark_hit) );
+        const __m256i hit = _mm256_set1_epi8( static_cast<char>(model.hit) );
+        const __m256i miss = _mm256_set1_epi8( static_cast<char>(model.miss) );
+        const __m256i min = _mm256_set1_epi8( static_cast<char>(model.min) );
+        const __m256i max = _mm256_set1_epi8( static_cast<char>(model.max) );
+        for( ; (index + 32) <= cells.size(); index += 32 ){
+            const __m256i mark = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(marks + index) );
+            const __m256i value = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(cells.data() + index) );
+            const __m256i is_hit = _mm256_cmpeq_epi8( _mm256_and_si256(mark, hit_bit), hit_bit );
+            const __m256i is_unmarked = _mm256_cmpeq_epi8( mark, zero );
+            const __m256i up = _mm256_and_si256( is_hit, hit );
+            const __m256i down = _mm256_andnot_si256( _mm256_or_si256(is_hit, is_unmarked), miss );
+            const __m256i updated = _mm256_min_epu8( _mm256_max_epu8( _mm256_subs_epu8( _mm256_adds_epu8(value, up), down ), min ), max );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>(cells.data() + index), _mm256_blendv_epi8( updated, value, is_unmarked ) );
+        }
+#endif
+        for( ; index < cells.size(); ++index ){
+            if( 0 != marks[index] ){
+                const int32_t update = (0 != (marks[index] & mark_hit)) ? model.hit : -static_cast<int32_t>(model.miss);
+                cells[index] = static_cast<uint8_t>( std::clamp<int32_t>( cells[index] + update, model.min, model.max ) );
+            }
+        }
+    }
+} // namespace
+
+template<uint32_t cells_across_sector_>
+bool SensorLayer<cells_across_sector_>::integrate_scan( const LocalLocation& origin, std::span<const LocalLocation> hits ){
+    if( not prepare_scan( origin, hits ) ){
+        return false;
+    }
+    for( uint32_t band = 0; band < walk_band_count; ++band ){
+        walk_band( band );
+    }
+    for( uint32_t sector_row = 0; sector_row < queues_across; ++sector_row ){
+        update_band( sector_row );
+    }
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+bool SensorLayer<cells_across_sector_>::integrate_scan( const LocalLocation& origin, std::span<const LocalLocation> hits, WorkerPool& pool ){
+    if( not prepare_scan( origin, hits ) ){
+        return false;
+    }
+    pool.run( walk_band_count, [this]( size_t band ){ walk_band( static_cast<uint32_t>(band) ); } );
+    pool.run( queues_across, [this]( size_t sector_row ){ update_band( static_cast<uint32_t>(sector_row) ); } );
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+bool SensorLayer<cells_across_sector_>::prepare_scan( const LocalLocation& origin, std::span<const LocalLocation> hits ){
+    if( not grid_.visible( origin ) ){
+        return false;
+    }
+    if( marks_.empty() ){
+        marks_.resize( static_cast<size_t>(cells_across_view()) * cells_across_view(), 0 );
+    }
+
+    // (one flat pass over the hits -- the walks then only read these)
+    const LocalLocation& view_origin = grid_.visible().min;
+    const double start_x = (origin.easting - view_origin.easting) / meters_across_cell_;
+    const double start_y = (origin.northing - view_origin.northing) / meters_across_cell_;
+    rays_.resize( hits.size() );
+    for( size_t ray_index = 0; ray_index < hits.size(); ++ray_index ){
+        rays_[ray_index] = GridRay( start_x, start_y,
+                                    (hits[ray_index].easting - view_origin.easting) / meters_across_cell_,
+                                    (hits[ray_index].northing - view_origin.northing) / meters_across_cell_ );
+    }
+    return true;
+}
+
+template<uint32_t cells_across_sector_>
+void SensorLayer<cells_across_sector_>::walk_band( uint32_t band ){
+    constexpr int64_t cells_across = cells_across_view();
+    const int64_t first_row = band * rows_per_walk_band;
+    const int64_t last_row = std::min<int64_t>( first_row + rows_per_walk_band, cells_across ) - 1;
+    uint8_t* const marks = marks_.data();
+
+    // walk the part of each ray which crosses this band -- marking each cell it visits
+    for( GridRay ray : rays_ ){
+        if( (std::max(ray.row(), ray.end_row()) < first_row) || (last_row < std::min(ray.row(), ray.end_row())) ){
+            continue;
+        }else if( ray.row() < first_row ){
+            ray.advance_to_row( first_row );
+        }else if( last_row < ray.row() ){
+            ray.advance_to_row( last_row );
+        }
+
+        // (the view is convex: once a ray leaves it, that ray is finished)
+        while( (0 <= ray.column()) && (ray.column() < cells_across) ){
+            const size_t index = static_cast<size_t>( ray.column() + ray.row() * cells_across );
+            if( ray.done() ){
+                marks[index] = mark_hit;
+                break;
+            }
+            marks[index] |= mark_miss;
+
+            ray.step();
+            if( (ray.row() < first_row) || (last_row < ray.row()) ){
+                break;
+            }
+        }
+    }
+}
+
+template<uint32_t cells_across_sector_>
+void SensorLayer<cells_across_sector_>::update_band( uint32_t sector_row ){
+    constexpr int64_t cells_across = cells_across_view();
+    const int64_t first_row = sector_row * cells_across_sector_;
+    const int64_t last_row = first_row + cells_across_sector_ - 1;
+    uint8_t* const marks = marks_.data();
+
+    // update each marked cell, once -- row by row, across the marked columns; then clear the marks for the next scan
+    for( int64_t row = first_row; row <= last_row; ++row ){
+        uint8_t* const row_marks = marks + row * cells_across;
+        const uint8_t* const first = std::find_if( row_marks, row_marks + cells_across, []( uint8_t mark ){ return 0 != mark; } );
+        if( (row_marks + cells_across) == first ){
+            continue;
+        }
+        const uint8_t* last = row_marks + cells_across - 1;
+        while( 0 == *last ){
+            --last;
+        }
+
+        grid_.update_span( static_cast<uint32_t>(row), static_cast<uint32_t>(first - row_marks), static_cast<uint32_t>(last - row_marks),
+                           [&]( uint32_t column, std::span<uint8_t> cells ){ update_cells( row_marks + column, cells, model_ ); } );
+        std::memset( row_marks, 0, cells_across );
+    }
+}
+
+// used for tests
+template class SensorLayer<4>;
+
+// used in production
+template class SensorLayer<256>;
+
+}  // namespace
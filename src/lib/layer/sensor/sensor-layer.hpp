@@ -0,0 +1,227 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/grid-ray.hpp"
+#include "layer/layer-interface.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+#include "layer/worker-pool.hpp"
+
+#include "hit-queue.hpp"
+
+namespace chartbox::layer::sensor {
+
+/// \brief the log-odds update for each cell that a scan crosses
+///
+/// Cells hold log-odds in steps of 1/32, offset by `unknown_cell_value`: 128 => even odds.  Each cell a scan crosses
+/// is updated at most once per scan -- up by `hit` if any ray ends in it; else down by `miss`.
+struct OccupancyModel {
+    /// \brief added to a cell which a ray ends in.  (default: p = 0.7)
+    uint8_t hit = 27;
+
+    /// \brief subtracted from each cell which a ray passes through.  (default: p = 0.4)
+    uint8_t miss = 13;
+
+    /// \brief cells are clamped to [min, max] -- so that they can still change their minds.  (default: p = 0.12, 0.97)
+    uint8_t min = 64;
+    uint8_t max = 240;
+};
+
+/// \brief occupancy from a high-rate sensor (e.g. lidar, radar) -- fed by any number of producer threads
+///
+/// Producers `submit` batches of hits; each batch is split by sector, and pushed onto one lock-free queue per
+/// sector of the ring.  Producers never touch the cells -- nor any other layer.  The layer's own thread calls
+/// `apply`, which drains the queues one sector at a time, so that each sector's hits are written together.
+///
+/// Alternately, a scanning sensor may `integrate_scan` directly: each ray carves free space from the sensor to its
+/// hit, as log-odds updates.  (see: `OccupancyModel`)
+///
+/// The cells live in a `RollingGridLayer`'s sector ring: the layer scrolls with the vessel, via `relocate`.  Hits
+/// are queued by absolute location; hits which are outside the view when they are applied are dropped.  Sensor data
+/// is transient: the ring never reads nor writes the tile cache, and each sector which enters the view starts unknown.
+///
+/// \param cells_across_sector_ cell count across a single dimension of each sector
+template<uint32_t cells_across_sector_>
+class SensorLayer final : public LayerInterface< SensorLayer<cells_across_sector_> > {
+public:
+    /// \brief name of this layer's type
+    constexpr static char type_name_[] = "SensorLayer";
+
+    typedef rolling::RollingGridLayer<cells_across_sector_> grid_t;
+
+    /// \brief one queue for each sector of the ring
+    constexpr static uint32_t queues_across = grid_t::sectors_across_view();
+    constexpr static uint32_t queue_count = queues_across * queues_across;
+    static_assert( queue_count <= 256, "queue indices are sorted as bytes" );
+
+    /// \brief rays are walked in bands of rows: finer than a sector, to spread the scan's dense center across threads
+    constexpr static uint32_t rows_per_walk_band = std::max<uint32_t>( 1, cells_across_sector_ / 4 );
+    constexpr static uint32_t walk_band_count = (grid_t::cells_across_view() + rows_per_walk_band - 1) / rows_per_walk_band;
+
+public:
+    SensorLayer();
+
+    ~SensorLayer() = default;
+
+    // ====== ====== Producers (any thread) ====== ======
+
+    /// \brief queue a batch of hits, to be written by the next `apply`.  Safe from any thread; never blocks.
+    void submit( std::span<const SensorHit> hits );
+
+    /// \brief count of hits queued by `submit`, since construction
+    inline uint64_t submitted() const { return submitted_.load( std::memory_order_relaxed ); }
+
+    // ====== ====== Consumer (the layer's thread) ====== ======
+
+    /// \brief write every queued hit into its cell -- one sector at a time
+    ///
+    /// \param touched - [out] bounds of every cell written.  (unchanged, if none were applied)
+    /// \return the number of hits applied
+    size_t apply( BoundBox<LocalLocation>& touched );
+    size_t apply(){
+        BoundBox<LocalLocation> touched;
+        return apply( touched );
+    }
+
+    /// \brief count of hits written by `apply`, since construction
+    inline uint64_t applied() const { return applied_.load( std::memory_order_relaxed ); }
+
+    /// \brief count of hits which were outside the view, when applied
+    inline uint64_t dropped() const { return dropped_.load( std::memory_order_relaxed ); }
+
+    /// \brief update the cells along each ray of a scan: from the origin, to each hit
+    ///
+    /// Each ray is walked cell by cell, out to its hit or to the edge of the view; each cell it visits is marked.
+    /// Then each marked cell is updated, once.  With a pool, both steps split the view into bands of rows: each
+    /// walk band walks its own part of every ray; each update band is one row of sectors -- so that no two threads
+    /// write the same cell, nor the same sector.
+    ///
+    /// \param origin - location of the sensor.  Must be visible.
+    /// \param hits - the end of each ray
+    /// \return false if the origin is outside the view; (nothing is updated)
+    bool integrate_scan( const LocalLocation& origin, std::span<const LocalLocation> hits );
+    bool integrate_scan( const LocalLocation& origin, std::span<const LocalLocation> hits, WorkerPool& pool );
+
+    inline const OccupancyModel& occupancy_model() const { return model_; }
+    inline void occupancy_model( const OccupancyModel& model ){ model_ = model; }
+
+    /// \brief the sector ring which holds the cells
+    inline const grid_t& grid() const { return grid_; }
+
+    /// \brief see: `RollingGridLayer::enable_concurrent_readers`
+    bool enable_concurrent_readers( bool enable ){
+        return grid_.enable_concurrent_readers( enable ); }
+
+    inline bool concurrent_readers_enabled() const { return grid_.concurrent_readers_enabled(); }
+
+    typedef typename grid_t::Reader Reader;
+
+    /// \brief start reading the ring's current frame.  (see: `RollingGridLayer::reader`)
+    inline Reader reader() const { return grid_.reader(); }
+
+    // ====== ====== Layer Interface ====== ======
+
+    constexpr static uint32_t cells_across_view() { return grid_t::cells_across_view(); }
+
+    bool fill( uint8_t value ){
+        return grid_.fill( value ); }
+
+    bool fill( const BoundBox<LocalLocation>& box, uint8_t value ){
+        return grid_.fill( box, value ); }
+
+    bool fill( const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bound, uint8_t value ){
+        return grid_.fill( poly, bound, value ); }
+
+    inline uint8_t get( const LocalLocation& p ) const {
+        return grid_.get( p ); }
+
+    /// \brief retrieve the values at a batch of locations.  (see: `RollingGridLayer::get`)
+    inline bool get( std::span<const LocalLocation> points, std::span<uint8_t> values ) const {
+        return grid_.get( points, values ); }
+
+    /// \brief see: `RollingGridLayer::raycast`
+    inline bool raycast( const LocalLocation& origin, std::span<const LocalLocation> targets, uint8_t threshold, std::span<double> distances ) const {
+        return grid_.raycast( origin, targets, threshold, distances ); }
+
+    inline double meters_across_cell() const { return grid_.meters_across_cell(); }
+    inline double meters_across_view() const { return grid_.meters_across_view(); }
+    inline double precision() const { return grid_.meters_across_cell(); }
+
+    /// \brief move the view to a new origin.  (see: `RollingGridLayer::relocate`)
+    bool relocate( const LocalLocation& new_origin ){
+        return grid_.relocate( new_origin ); }
+
+    inline bool store( const LocalLocation& p, uint8_t value ){
+        return grid_.store( p, value ); }
+
+    inline bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, uint8_t value ){
+        return grid_.store_span( row, first_column, last_column, value ); }
+
+    std::string to_cell_content_string( uint32_t indent ) const { return grid_.to_cell_content_string( indent ); }
+    std::string to_property_string( uint32_t indent = 0 ) const { return grid_.to_property_string( indent ); }
+
+    bool track( const BoundBox<LocalLocation>& bounds ){
+        return grid_.track( bounds ); }
+    inline const BoundBox<LocalLocation>& tracked() const { return grid_.tracked(); }
+    inline bool tracked( const LocalLocation& p ) const { return grid_.tracked( p ); }
+
+    bool view( const LocalLocation& p ){
+        return grid_.view( p ); }
+    inline const BoundBox<LocalLocation>& visible() const { return grid_.visible(); }
+    inline bool visible( const LocalLocation& p ) const { return grid_.visible( p ); }
+
+private:
+    /// \brief the queue for a location: its absolute sector, wrapped around the ring
+    ///
+    /// While the view is aligned to the sector grid, each queue holds the hits of exactly one sector in view.
+    inline static uint32_t queue_of( const LocalLocation& p ){
+        const auto wrap = []( double meters ){
+            const int64_t sector = static_cast<int64_t>( std::floor( meters / (cells_across_sector_ * meters_across_cell_) ) );
+            return static_cast<uint32_t>( ((sector % queues_across) + queues_across) % queues_across ); };
+        return wrap( p.easting ) + wrap( p.northing ) * queues_across;
+    }
+
+    /// \brief set up the rays of a scan, in view-relative cells
+    bool prepare_scan( const LocalLocation& origin, std::span<const LocalLocation> hits );
+
+    /// \brief mark the cells of the prepared scan, within one band of rows
+    void walk_band( uint32_t band );
+
+    /// \brief update the marked cells of one row of sectors
+    void update_band( uint32_t sector_row );
+
+private:
+    // (matches the grid)
+    constexpr static double meters_across_cell_ = 1.0;
+
+    grid_t grid_;
+
+    std::array<HitQueue, queue_count> queues_;
+
+    OccupancyModel model_;
+
+    // scratch space, for `integrate_scan`: the current scan's rays; and each cell's update, by view index.  (0 => none)
+    std::vector<GridRay> rays_;
+    std::vector<uint8_t> marks_;
+
+    // (written by producers)
+    alignas(64) std::atomic<uint64_t> submitted_ = 0;
+
+    // (written by the consumer)
+    alignas(64) std::atomic<uint64_t> applied_ = 0;
+    std::atomic<uint64_t> dropped_ = 0;
+};
+
+} // namespace
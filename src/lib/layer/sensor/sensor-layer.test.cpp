@@ -0,0 +1,248 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+using Catch::Approx;
+
+#include "hit-queue.hpp"
+#include "sensor-layer.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+
+using chartbox::layer::GridRay;
+using chartbox::layer::WorkerPool;
+
+using chartbox::layer::sensor::HitQueue;
+using chartbox::layer::sensor::OccupancyModel;
+using chartbox::layer::sensor::SensorHit;
+using chartbox::layer::sensor::SensorLayer;
+
+namespace chartbox::layer {
+
+// a distinct value for each cell of the plane, by its absolute location.  (never `unknown_cell_value`)
+static uint8_t pattern( const LocalLocation& p ){
+    const int64_t column = static_cast<int64_t>( std::floor(p.easting) );
+    const int64_t row = static_cast<int64_t>( std::floor(p.northing) );
+    return static_cast<uint8_t>( 1 + ((column*7 + row*13) & 0x3F) );
+}
+
+// ============ ============ Sensor Layer Tests  ============ ============
+
+TEST_CASE( "HitQueue visits batches in the order they were pushed" ){
+    HitQueue queue;
+    CHECK( queue.empty() );
+    for( uint8_t batch = 0; batch < 5; ++batch ){
+        queue.push({ {{0.5, 0.5}, batch}, {{1.5, 0.5}, batch} });
+    }
+    CHECK_FALSE( queue.empty() );
+
+    std::vector<uint8_t> order;
+    CHECK( 5 == queue.drain( [&]( const std::vector<SensorHit>& hits ){
+        REQUIRE( 2 == hits.size() );
+        order.push_back( hits[0].value );
+    }));
+    CHECK( order == std::vector<uint8_t>{ 0, 1, 2, 3, 4 } );
+    CHECK( queue.empty() );
+    CHECK( 0 == queue.drain( []( const std::vector<SensorHit>& ){} ) );
+} // TEST_CASE
+
+TEST_CASE( "SensorLayer writes hits only when they are applied" ){
+    SensorLayer<4> layer;
+    layer.fill( unknown_cell_value );
+    CHECK( layer.visible().max.easting == Approx(20) );
+
+    const std::vector<SensorHit> hits = { {{0.5, 0.5}, 0x11}, {{13.5, 7.5}, 0x22}, {{19.5, 19.5}, 0x33},
+                                          {{-3.5, 4.5}, 0x44},  {{25.5, 1.5}, 0x55} };
+    layer.submit( hits );
+    CHECK( 5 == layer.submitted() );
+    CHECK( unknown_cell_value == layer.get({ 13.5, 7.5 }) );
+
+    BoundBox<LocalLocation> touched;
+    CHECK( 3 == layer.apply( touched ) );
+    CHECK( 3 == layer.applied() );
+    CHECK( 2 == layer.dropped() );
+    CHECK( 0x11 == layer.get({ 0.5, 0.5 }) );
+    CHECK( 0x22 == layer.get({ 13.5, 7.5 }) );
+    CHECK( 0x33 == layer.get({ 19.5, 19.5 }) );
+    CHECK( touched.min.easting == Approx(0.5) );
+    CHECK( touched.min.northing == Approx(0.5) );
+    CHECK( touched.max.easting == Approx(20.5) );
+    CHECK( touched.max.northing == Approx(20.5) );
+
+    // nothing left to apply:
+    CHECK( 0 == layer.apply() );
+
+    // hits are queued by absolute location -- so they land correctly, even after the view moves
+    layer.submit( std::vector<SensorHit>{ {{25.5, 1.5}, 0x55} } );
+    REQUIRE( layer.relocate({ 8, 0 }) );
+    CHECK( 1 == layer.apply() );
+    CHECK( 0x55 == layer.get({ 25.5, 1.5 }) );
+    CHECK( 0x22 == layer.get({ 13.5, 7.5 }) );
+} // TEST_CASE
+
+TEST_CASE( "SensorLayer takes hits from many producers at once" ){
+    SensorLayer<4> layer;
+    layer.fill( unknown_cell_value );
+
+    // each producer owns a band of rows; every cell is hit by exactly one producer
+    constexpr uint32_t producer_count = 4;
+    constexpr uint32_t rows_per_producer = 5;
+    constexpr uint32_t rounds = 200;
+    std::atomic<uint32_t> finished = 0;
+    std::vector<std::thread> producers;
+    for( uint32_t producer = 0; producer < producer_count; ++producer ){
+        producers.emplace_back( [&, producer](){
+            for( uint32_t round = 0; round < rounds; ++round ){
+                std::vector<SensorHit> hits;
+                for( uint32_t row = producer * rows_per_producer; row < (producer + 1) * rows_per_producer; ++row ){
+                    for( uint32_t column = 0; column < 20; ++column ){
+                        const LocalLocation p( column + 0.5, row + 0.5 );
+                        hits.push_back({ p, pattern(p) });
+                    }
+                }
+                layer.submit( hits );
+            }
+            ++finished;
+        });
+    }
+
+    // ... while the consumer applies, concurrently
+    while( producer_count > finished ){
+        layer.apply();
+    }
+    for( auto& producer : producers ){
+        producer.join();
+    }
+    layer.apply();
+
+    CHECK( (producer_count * rounds * rows_per_producer * 20) == layer.submitted() );
+    CHECK( layer.submitted() == layer.applied() );
+    CHECK( 0 == layer.dropped() );
+    for( uint32_t row = 0; row < 20; ++row ){
+        for( uint32_t column = 0; column < 20; ++column ){
+            const LocalLocation p( column + 0.5, row + 0.5 );
+            REQUIRE( pattern(p) == layer.get(p) );
+        }
+    }
+} // TEST_CASE
+
+TEST_CASE( "SensorLayer carves free space along each ray of a scan" ){
+    SensorLayer<4> layer;
+    layer.fill( unknown_cell_value );
+    const OccupancyModel model;
+    const uint8_t free_value = static_cast<uint8_t>( unknown_cell_value - model.miss );
+    const uint8_t hit_value = static_cast<uint8_t>( unknown_cell_value + model.hit );
+
+    SECTION( "cells along a ray are freed; its last cell is hit" ){
+        REQUIRE( layer.integrate_scan( {0.5, 2.5}, std::vector<LocalLocation>{ {10.5, 2.5} } ) );
+        for( uint32_t column = 0; column < 10; ++column ){
+            CHECK( free_value == layer.get({ column + 0.5, 2.5 }) );
+        }
+        CHECK( hit_value == layer.get({ 10.5, 2.5 }) );
+        CHECK( unknown_cell_value == layer.get({ 11.5, 2.5 }) );
+        CHECK( unknown_cell_value == layer.get({ 5.5, 3.5 }) );
+        CHECK( unknown_cell_value == layer.get({ 5.5, 1.5 }) );
+
+        // ... and clamped, scan after scan
+        for( int scan = 0; scan < 20; ++scan ){
+            REQUIRE( layer.integrate_scan( {0.5, 2.5}, std::vector<LocalLocation>{ {10.5, 2.5} } ) );
+        }
+        CHECK( model.min == layer.get({ 5.5, 2.5 }) );
+        CHECK( model.max == layer.get({ 10.5, 2.5 }) );
+    }
+
+    SECTION( "each cell is updated once per scan -- and a hit wins" ){
+        REQUIRE( layer.integrate_scan( {0.5, 0.5}, std::vector<LocalLocation>{ {5.5, 0.5}, {8.5, 0.5}, {8.5, 0.5} } ) );
+        CHECK( free_value == layer.get({ 0.5, 0.5 }) );
+        CHECK( free_value == layer.get({ 4.5, 0.5 }) );
+        CHECK( hit_value == layer.get({ 5.5, 0.5 }) );
+        CHECK( free_value == layer.get({ 6.5, 0.5 }) );
+        CHECK( hit_value == layer.get({ 8.5, 0.5 }) );
+    }
+
+    SECTION( "rays end at the edge of the view" ){
+        REQUIRE( layer.integrate_scan( {10.5, 10.5}, std::vector<LocalLocation>{ {10.5, 40.5}, {-30.5, 10.5} } ) );
+        for( uint32_t cell = 10; cell < 20; ++cell ){
+            CHECK( free_value == layer.get({ 10.5, cell + 0.5 }) );
+        }
+        for( uint32_t cell = 0; cell <= 10; ++cell ){
+            CHECK( free_value == layer.get({ cell + 0.5, 10.5 }) );
+        }
+        CHECK( unknown_cell_value == layer.get({ 10.5, 9.5 }) );
+        CHECK( unknown_cell_value == layer.get({ 11.5, 10.5 }) );
+    }
+
+    SECTION( "scans from outside the view are rejected" ){
+        CHECK_FALSE( layer.integrate_scan( {-0.5, 2.5}, std::vector<LocalLocation>{ {10.5, 2.5} } ) );
+        CHECK( unknown_cell_value == layer.get({ 5.5, 2.5 }) );
+    }
+} // TEST_CASE
+
+// integrate random scans, single-threaded and pooled -- and compare both against whole rays, walked one by one
+template<uint32_t cells_across_sector>
+static void check_scans( uint32_t scan_count, uint32_t ray_count ){
+    constexpr uint32_t cells_across = SensorLayer<cells_across_sector>::cells_across_view();
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> coordinate_distribution( -0.5 * cells_across, 1.5 * cells_across );
+    std::uniform_real_distribution<double> origin_distribution( 0, cells_across - 0.01 );
+
+    auto single = std::make_unique<SensorLayer<cells_across_sector>>();
+    auto pooled = std::make_unique<SensorLayer<cells_across_sector>>();
+    single->fill( unknown_cell_value );
+    pooled->fill( unknown_cell_value );
+    WorkerPool pool( 3 );
+    const OccupancyModel model;
+    std::vector<int32_t> expected( cells_across * cells_across, unknown_cell_value );
+
+    for( uint32_t scan = 0; scan < scan_count; ++scan ){
+        const LocalLocation origin( origin_distribution(generator), origin_distribution(generator) );
+        std::vector<LocalLocation> hits;
+        for( uint32_t ray = 0; ray < ray_count; ++ray ){
+            hits.emplace_back( coordinate_distribution(generator), coordinate_distribution(generator) );
+        }
+        REQUIRE( single->integrate_scan( origin, hits ) );
+        REQUIRE( pooled->integrate_scan( origin, hits, pool ) );
+
+        // reference: walk each whole ray, until it leaves the view
+        std::map<uint32_t, bool> marks;
+        for( const auto& hit : hits ){
+            GridRay ray( origin.easting, origin.northing, hit.easting, hit.northing );
+            while( (0 <= ray.column()) && (ray.column() < cells_across) && (0 <= ray.row()) && (ray.row() < cells_across) ){
+                marks[ static_cast<uint32_t>(ray.column() + ray.row() * cells_across) ] |= ray.done();
+                if( ray.done() ){
+                    break;
+                }
+                ray.step();
+            }
+        }
+        for( const auto& [index, hit] : marks ){
+            expected[index] = std::clamp<int32_t>( expected[index] + (hit ? model.hit : -model.miss), model.min, model.max );
+        }
+    }
+
+    for( uint32_t row = 0; row < cells_across; ++row ){
+        for( uint32_t column = 0; column < cells_across; ++column ){
+            const LocalLocation p( column + 0.5, row + 0.5 );
+            REQUIRE( expected[column + row * cells_across] == single->get(p) );
+            REQUIRE( expected[column + row * cells_across] == pooled->get(p) );
+        }
+    }
+}
+
+TEST_CASE( "SensorLayer integrates a scan identically, across threads" ){
+    check_scans<4>( 20, 50 );
+
+    // (long runs of cells, for the vectorized update)
+    check_scans<256>( 3, 400 );
+} // TEST_CASE
+
+}   // namespace
@@ -5,16 +5,29 @@
 #include <cmath>
 #include <memory>
 #include <cstdlib>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "layer/batch-index.hpp"
+#include "layer/cell-layout.hpp"
 #include "layer/layer-interface.hpp"
 
 namespace chartbox::layer::simple {
 
-template<typename cell_t=uint8_t, uint32_t dimension_=1024, uint32_t precision_mm_=1000>
-class SimpleGridLayer final : public LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_>> {
+/// \brief a single, fixed block of cells
+///
+/// \param cell_t type of each cell
+/// \param dimension_ cell count across each dimension of the layer
+/// \param precision_mm_ width of each cell, in millimeters
+/// \param layout_t order of the cells in storage.  (see: `cell-layout.hpp`)
+template<typename cell_t=uint8_t, uint32_t dimension_=1024, uint32_t precision_mm_=1000, typename layout_t=RowMajorLayout>
+class SimpleGridLayer final : public LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_,layout_t>> {
 public:
+    static_assert( layout_t::supports(dimension_), "this layout cannot arrange a grid of this size" );
+
+    typedef layout_t layout_type;
+
     /// \brief name of this layer's type
     constexpr static char type_name_[] = "SimpleGridLayer";
 
@@ -37,12 +50,14 @@ public:
     /// \brief number of cells along each dimension of this grid
     constexpr static size_t dimension() { return cells_across_layer_; }
 
+    /// \brief raw cells, in `layout_t` order
     inline cell_t* data() {
         return grid_.data(); }
 
     // override from LayerInterface
     bool fill( cell_t value );
 
+    /// \brief copy raw cells into the grid.  (`buffer` must already be in `layout_t` order)
     bool fill( const cell_t* const buffer, size_t count );
     
     bool fill( const Path<LocalLocation>& path, const BoundBox<LocalLocation>& bounds, cell_t value ){
@@ -62,6 +77,13 @@ public:
 
     cell_t get(const LocalLocation& p) const;
 
+    /// \brief retrieve the values at a batch of locations
+    ///
+    /// see: `LayerInterface::get( std::span<const LocalLocation>, std::span<uint8_t> )`
+    /// \note unlike the single-point `get`, points outside the grid read as `default_cell_value`
+    bool get( std::span<const LocalLocation> points, std::span<cell_t> values ) const;
+
+    /// \brief storage offset of the cell at column `i`, row `j`
     size_t lookup( const uint32_t i, const uint32_t j ) const;
 
     inline uint32_t cells_across_view() const { return cells_across_layer_; }
@@ -89,6 +111,12 @@ public:
     /// \return reference to the cell value
     bool store(const LocalLocation& p, const cell_t new_value);
 
+    /// \brief store a value across a horizontal run of cells
+    ///
+    /// see: `LayerInterface::store_span( uint32_t, uint32_t, uint32_t, uint8_t )`
+    /// \note this layer is a single block; row and columns index the grid directly.
+    bool store_span( uint32_t row, uint32_t first_column, uint32_t last_column, cell_t value );
+
     /// \brief track from the given location  (... + the native width)
     bool track( const BoundBox<LocalLocation>& bounds ){
         return false; }
@@ -117,12 +145,12 @@ protected:
 
 private:
 
-    LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_>>& super() {
-        return *static_cast< LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_>>* >(this);
+    LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_,layout_t>>& super() {
+        return *static_cast< LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_,layout_t>>* >(this);
     }
 
-    const LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_>>& super() const {
-        return *static_cast< const LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_>>* >(this);
+    const LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_,layout_t>>& super() const {
+        return *static_cast< const LayerInterface<SimpleGridLayer<cell_t,dimension_,precision_mm_,layout_t>>* >(this);
     }
 };
 
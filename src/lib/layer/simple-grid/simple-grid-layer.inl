@@ -3,13 +3,13 @@ using chartbox::layer::simple::SimpleGridLayer;
 
 
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-SimpleGridLayer<cell_t,dimension_,precision_mm>::SimpleGridLayer()
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::SimpleGridLayer()
     : view_bounds_( {0,0}, {meters_across_view(),meters_across_view()})
 {}
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-bool SimpleGridLayer<cell_t,dimension_,precision_mm>::contains(const LocalLocation& p ) const {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::contains(const LocalLocation& p ) const {
     if( 0 > p.easting || 0 > p.northing ){
         return false;
     }else if( cells_across_layer_ < p.easting || cells_across_layer_ < p.northing ){
@@ -18,14 +18,14 @@ bool SimpleGridLayer<cell_t,dimension_,precision_mm>::contains(const LocalLocati
     return true;
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-bool SimpleGridLayer<cell_t,dimension_,precision_mm>::fill( const cell_t  value) {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::fill( const cell_t  value) {
     grid_.fill( value);
     return true;
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-bool SimpleGridLayer<cell_t,dimension_,precision_mm>::fill( const cell_t * const source, size_t count ){
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::fill( const cell_t * const source, size_t count ){
     if ( count > grid_.size()) {
         return false;
     }
@@ -33,8 +33,8 @@ bool SimpleGridLayer<cell_t,dimension_,precision_mm>::fill( const cell_t * const
     return true;
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-bool SimpleGridLayer<cell_t,dimension_,precision_mm>::fill(const std::vector<cell_t >& source) {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::fill(const std::vector<cell_t >& source) {
     if (source.size() != grid_.size()) {
         return false;
     }
@@ -42,20 +42,75 @@ bool SimpleGridLayer<cell_t,dimension_,precision_mm>::fill(const std::vector<cel
     return true;
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-cell_t SimpleGridLayer<cell_t,dimension_,precision_mm>::get(const LocalLocation& p ) const {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+cell_t SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::get(const LocalLocation& p ) const {
     const size_t offset = lookup(static_cast<uint32_t>(p.easting/meters_across_cell_),
                                  static_cast<uint32_t>(p.northing/meters_across_cell_));
     return grid_[ offset ];
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-size_t SimpleGridLayer<cell_t,dimension_,precision_mm>::lookup( const uint32_t i, const uint32_t j ) const {
-    return i + (j * cells_across_layer_);
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::get( std::span<const LocalLocation> points, std::span<cell_t> values ) const {
+    if( values.size() < points.size() ){
+        return false;
+    }
+
+    size_t point_index = 0;
+
+#if defined(__AVX2__)
+    using chartbox::layer::batch_width;
+    const LocalLocation origin(0,0);
+    const __m256d divisor = _mm256_set1_pd( meters_across_cell_ );
+    const __m128i limit = _mm_set1_epi32( static_cast<int32_t>(cells_across_layer_) );
+
+    alignas(16) std::array<uint32_t,batch_width> offsets;
+
+    for( ; (point_index + batch_width) <= points.size(); point_index += batch_width ){
+        __m256d easting, northing;
+        chartbox::layer::load_x4( &points[point_index], origin, easting, northing );
+        const int positive_lanes = chartbox::layer::within_x4( easting, northing, meters_across_layer_, meters_across_layer_ );
+
+        // identical to the scalar path: divide, then truncate
+        const __m128i column = _mm256_cvttpd_epi32( _mm256_div_pd(easting, divisor) );
+        const __m128i row = _mm256_cvttpd_epi32( _mm256_div_pd(northing, divisor) );
+        const __m128i inside = _mm_and_si128( _mm_cmplt_epi32(column, limit), _mm_cmplt_epi32(row, limit) );
+        const int valid_lanes = positive_lanes & _mm_movemask_ps( _mm_castsi128_ps(inside) );
+
+        _mm_store_si128( reinterpret_cast<__m128i*>(offsets.data()),
+                         layout_t::offset_x4(column, row, cells_across_layer_) );
+
+        for( uint32_t lane = 0; lane < batch_width; ++lane ){
+            if( valid_lanes & (1 << lane) ){
+                values[point_index + lane] = grid_[ offsets[lane] ];
+            }else{
+                values[point_index + lane] = static_cast<cell_t>(chartbox::layer::default_cell_value);
+            }
+        }
+    }
+#endif
+
+    // remainder (and fallback):
+    for( ; point_index < points.size(); ++point_index ){
+        const LocalLocation& p = points[point_index];
+        const double column = p.easting/meters_across_cell_;
+        const double row = p.northing/meters_across_cell_;
+        if( (0 <= column) && (column < cells_across_layer_) && (0 <= row) && (row < cells_across_layer_) ){
+            values[point_index] = grid_[ lookup(static_cast<uint32_t>(column), static_cast<uint32_t>(row)) ];
+        }else{
+            values[point_index] = static_cast<cell_t>(chartbox::layer::default_cell_value);
+        }
+    }
+
+    return true;
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-std::string SimpleGridLayer<cell_t,dimension_,precision_mm>::to_cell_content_string( uint32_t indent ) const {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+size_t SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::lookup( const uint32_t i, const uint32_t j ) const {
+    return layout_t::offset( i, j, cells_across_layer_ );
+}
+
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+std::string SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::to_cell_content_string( uint32_t indent ) const {
     const uint32_t break_interval = 8;
     std::ostringstream buf;
 
@@ -86,8 +141,8 @@ std::string SimpleGridLayer<cell_t,dimension_,precision_mm>::to_cell_content_str
     return buf.str();
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-std::string SimpleGridLayer<cell_t,dimension_,precision_mm>::to_property_string( uint32_t indent ) const {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+std::string SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::to_property_string( uint32_t indent ) const {
     std::ostringstream buf;
 
     const std::string prefix = fmt::format("{:<{}}", "", indent );
@@ -102,8 +157,8 @@ std::string SimpleGridLayer<cell_t,dimension_,precision_mm>::to_property_string(
     return buf.str();
 }
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-bool SimpleGridLayer<cell_t,dimension_,precision_mm>::store( const LocalLocation& p, const cell_t  value) {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::store( const LocalLocation& p, const cell_t  value) {
     const auto offset = lookup( static_cast<uint32_t>(p.easting/meters_across_cell_),
                                 static_cast<uint32_t>(p.northing/meters_across_cell_) );
     grid_[offset] = value;
@@ -111,8 +166,27 @@ bool SimpleGridLayer<cell_t,dimension_,precision_mm>::store( const LocalLocation
 }
 
 
-template<typename cell_t, uint32_t dimension_, uint32_t precision_mm>
-bool SimpleGridLayer<cell_t,dimension_,precision_mm>::view(const BoundBox<LocalLocation>& nb ) {
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::store_span( uint32_t row, uint32_t first_column, uint32_t last_column, const cell_t value ){
+    if( (cells_across_layer_ <= row) || (cells_across_layer_ <= first_column) || (last_column < first_column) ){
+        return false;
+    }
+    last_column = std::min<uint32_t>( last_column, cells_across_layer_ - 1 );
+
+    if constexpr ( layout_t::row_contiguous ){
+        std::fill_n( grid_.data() + lookup(first_column, row), last_column - first_column + 1, value );
+    }else{
+        uint32_t offset = lookup( first_column, row );
+        for( uint32_t column = first_column; column <= last_column; ++column ){
+            grid_[offset] = value;
+            offset = layout_t::next_column( offset, cells_across_layer_ );
+        }
+    }
+    return true;
+}
+
+template<typename cell_t, uint32_t dimension_, uint32_t precision_mm, typename layout_t>
+bool SimpleGridLayer<cell_t,dimension_,precision_mm,layout_t>::view(const BoundBox<LocalLocation>& nb ) {
     if( nb.width() > meters_across_view() || nb.height() > meters_across_view() ){
        return false;
     }
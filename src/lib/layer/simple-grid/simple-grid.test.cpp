@@ -3,6 +3,7 @@
 // #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <cstring>
 #include <string>
@@ -140,3 +141,99 @@ TEST_CASE( "SimpleGridLayer Populates From Array" ){
     CHECK( 7070 == layer.get({ 4.5, 4.5}));
 
 } // TEST_CASE
+
+TEST_CASE( "SimpleGridLayer batch-get matches scalar get" ){
+    SimpleGridLayer<uint8_t, 16, 500> layer;
+    for( size_t i = 0; i < 16*16; ++i ){
+        layer.data()[i] = static_cast<uint8_t>(i);
+    }
+    REQUIRE( 8.0 == Approx(layer.meters_across_view()) );
+
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> distribution( 0.0, 7.99 );
+    std::vector<LocalLocation> points;
+    for( size_t i = 0; i < 1001; ++i ){
+        points.emplace_back( distribution(generator), distribution(generator) );
+    }
+
+    std::vector<uint8_t> values( points.size() );
+    REQUIRE( layer.get( points, values ));
+    for( size_t i = 0; i < points.size(); ++i ){
+        CHECK( static_cast<int>(layer.get(points[i])) == static_cast<int>(values[i]) );
+    }
+
+    // outside the grid reads as the default value:
+    const std::vector<LocalLocation> outside = { {-1.0, 1.0}, {1.0, -1.0}, {8.0, 1.0}, {1.0, 9.0}, {100.0, 100.0} };
+    REQUIRE( layer.get( outside, values ));
+    for( size_t i = 0; i < outside.size(); ++i ){
+        CHECK( chartbox::layer::default_cell_value == values[i] );
+    }
+} // TEST_CASE
+
+TEST_CASE( "SimpleGridLayer fills boxes with spans" ){
+    SimpleGridLayer<uint8_t, 8, 1000> layer;
+    layer.fill( 0 );
+
+    layer.fill( BoundBox<LocalLocation>( {1.0, 2.0}, {5.0, 4.0} ), 0x66 );
+    CHECK( layer.store_span( 7, 6, 20, 0x11 ));
+    CHECK( not layer.store_span( 8, 0, 4, 0xEE ));
+
+    for( uint32_t row = 0; row < 8; ++row ){
+        for( uint32_t column = 0; column < 8; ++column ){
+            const LocalLocation at( column + 0.5, row + 0.5 );
+            uint8_t expect = 0;
+            if( (1 <= column) && (column <= 4) && (2 <= row) && (row <= 3) ){
+                expect = 0x66;
+            }else if( (7 == row) && (6 <= column) ){
+                expect = 0x11;
+            }
+            CHECK( static_cast<int>(expect) == static_cast<int>(layer.get(at)) );
+        }
+    }
+} // TEST_CASE
+
+TEST_CASE( "SimpleGridLayer with a Morton layout matches row-major" ){
+    using chartbox::layer::MortonLayout;
+    SimpleGridLayer<uint8_t, 16, 500> row_major;
+    SimpleGridLayer<uint8_t, 16, 500, MortonLayout> morton;
+
+    row_major.fill( 0 );
+    morton.fill( 0 );
+    for( uint32_t row = 0; row < 16; ++row ){
+        for( uint32_t column = 0; column < 16; ++column ){
+            const LocalLocation at( (column + 0.5)/2, (row + 0.5)/2 );
+            const uint8_t value = static_cast<uint8_t>( (column << 4) | row );
+            row_major.store( at, value );
+            morton.store( at, value );
+        }
+    }
+    // cells (2, 3) and (3, 3) are neighbours in both layouts; (0, 1) is not, in Morton order
+    CHECK( 0x23 == morton.data()[ 14 ] );
+    CHECK( 0x33 == morton.data()[ 15 ] );
+    CHECK( 0x01 == morton.data()[ 2 ] );
+
+    // spans + boxes
+    row_major.fill( BoundBox<LocalLocation>( {1.0, 2.0}, {5.0, 4.0} ), 0x66 );
+    row_major.store_span( 15, 3, 20, 0x11 );
+    morton.fill( BoundBox<LocalLocation>( {1.0, 2.0}, {5.0, 4.0} ), 0x66 );
+    morton.store_span( 15, 3, 20, 0x11 );
+
+    std::mt19937 generator( 55 );
+    std::uniform_real_distribution<double> distribution( -1.0, 9.0 );
+    std::vector<LocalLocation> points;
+    for( size_t i = 0; i < 1001; ++i ){
+        points.emplace_back( distribution(generator), distribution(generator) );
+    }
+    std::vector<uint8_t> row_major_values( points.size() );
+    std::vector<uint8_t> morton_values( points.size() );
+    REQUIRE( row_major.get( points, row_major_values ));
+    REQUIRE( morton.get( points, morton_values ));
+    CHECK( row_major_values == morton_values );
+
+    for( uint32_t row = 0; row < 16; ++row ){
+        for( uint32_t column = 0; column < 16; ++column ){
+            const LocalLocation at( (column + 0.5)/2, (row + 0.5)/2 );
+            CHECK( static_cast<int>(row_major.get(at)) == static_cast<int>(morton.get(at)) );
+        }
+    }
+} // TEST_CASE
@@ -0,0 +1,145 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chartbox::layer {
+
+/// \brief fixed-size pool of threads, for running data-parallel loops over a layer
+///
+/// The calling thread always takes part in `run`; a pool of size 1 starts no threads, and runs every task inline.
+class WorkerPool {
+public:
+    typedef std::function<void(size_t)> task_t;
+
+public:
+    /// \brief start a new pool
+    ///
+    /// \param thread_count - total threads that run tasks, including the calling thread. 0 => all hardware threads.
+    explicit WorkerPool( size_t thread_count = 0 ){
+        if( 0 == thread_count ){
+            thread_count = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+        }
+        workers_.reserve( thread_count - 1 );
+        for( size_t i = 1; i < thread_count; ++i ){
+            workers_.emplace_back( [this](){ work(); } );
+        }
+    }
+
+    WorkerPool( const WorkerPool& ) = delete;
+    WorkerPool& operator=( const WorkerPool& ) = delete;
+
+    ~WorkerPool(){
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for( auto& worker : workers_ ){
+            worker.join();
+        }
+    }
+
+    /// \brief number of threads that run tasks (including the caller)
+    inline size_t size() const {
+        return workers_.size() + 1; }
+
+    /// \brief run `task(i)` for each i in [0, task_count), and wait for all of them to finish
+    ///
+    /// Tasks are claimed in order, but may complete in any order -- and on any thread.
+    void run( size_t task_count, const task_t& task ){
+        if( 0 == task_count ){
+            return;
+        }else if( workers_.empty() ){
+            for( size_t i = 0; i < task_count; ++i ){
+                task( i );
+            }
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            // a worker may still be leaving the previous run:
+            done_.wait( lock, [this](){ return 0 == active_; } );
+            task_ = &task;
+            task_count_ = task_count;
+            next_task_.store( 0 );
+            finished_ = 0;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        const size_t finished = drain( task, task_count );
+
+        std::unique_lock<std::mutex> lock( mutex_ );
+        finished_ += finished;
+        done_.wait( lock, [this](){ return (finished_ == task_count_) && (0 == active_); } );
+        task_ = nullptr;
+    }
+
+private:
+    size_t drain( const task_t& task, size_t task_count ){
+        size_t finished = 0;
+        for( size_t i = next_task_.fetch_add(1); i < task_count; i = next_task_.fetch_add(1) ){
+            task( i );
+            ++finished;
+        }
+        return finished;
+    }
+
+    void work(){
+        uint64_t last_generation = 0;
+        while( true ){
+            const task_t* task;
+            size_t task_count;
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                wake_.wait( lock, [&](){ return stopping_ || ((last_generation != generation_) && (nullptr != task_)); } );
+                if( stopping_ ){
+                    return;
+                }
+                last_generation = generation_;
+                task = task_;
+                task_count = task_count_;
+                ++active_;
+            }
+
+            const size_t finished = drain( *task, task_count );
+
+            {
+                std::lock_guard<std::mutex> lock( mutex_ );
+                finished_ += finished;
+                --active_;
+            }
+            done_.notify_all();
+        }
+    }
+
+private:
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    // guarded by `mutex_`:
+    const task_t* task_ = nullptr;
+    size_t task_count_ = 0;
+    size_t finished_ = 0;
+    size_t active_ = 0;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+
+    std::atomic<size_t> next_task_ = 0;
+};
+
+} // namespace
@@ -0,0 +1,29 @@
+// GPL v3 (c) 2021, Daniel Williams 
+
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "worker-pool.hpp"
+
+using chartbox::layer::WorkerPool;
+
+TEST_CASE( "WorkerPool runs every task exactly once" ){
+    for( size_t thread_count : {1, 2, 4} ){
+        WorkerPool pool( thread_count );
+        REQUIRE( thread_count == pool.size() );
+
+        // repeated runs reuse the same threads:
+        for( size_t attempt = 0; attempt < 20; ++attempt ){
+            std::vector<std::atomic<int>> counts( 37 );
+            pool.run( counts.size(), [&]( size_t task ){ ++counts[task]; } );
+            for( const auto& count : counts ){
+                CHECK( 1 == count.load() );
+            }
+        }
+
+        // empty runs are fine, too
+        pool.run( 0, []( size_t ){ FAIL( "no tasks to run" ); } );
+    }
+} // TEST_CASE
@@ -0,0 +1,33 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <filesystem>
+
+#include <fmt/core.h>
+
+#include "io/flatbuffer/tile-archive.hpp"
+
+using chartbox::io::flatbuffer::archive_extension;
+using chartbox::io::flatbuffer::pack_directory;
+
+// convert a directory of per-tile cache files into a single tile archive
+//   usage:  pack-tiles <cache-directory> <archive.tiles>
+int main( int argc, char* argv[] ){
+    if( 3 != argc ){
+        fmt::print( stderr, "usage: {} <cache-directory> <archive{}>\n", argv[0], archive_extension );
+        return 1;
+    }
+
+    const std::filesystem::path directory = argv[1];
+    const std::filesystem::path archive_path = argv[2];
+    if( not std::filesystem::is_directory(directory) ){
+        fmt::print( stderr, "!! cache path is not a directory !!: {}\n", directory.string() );
+        return 1;
+    }else if( archive_extension != archive_path.extension() ){
+        fmt::print( stderr, "!! archive path must end with '{}' !!: {}\n", archive_extension, archive_path.string() );
+        return 1;
+    }
+
+    const size_t packed_count = pack_directory( directory, archive_path );
+    fmt::print( ">> packed {} tiles into: {}\n", packed_count, archive_path.string() );
+    return (0 < packed_count) ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "layer/dynamic-grid/dynamic-grid-layer.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+#include "layer/simple-grid/simple-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::dynamic::DynamicGridLayer;
+using chartbox::layer::rolling::RollingGridLayer;
+using chartbox::layer::simple::SimpleGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t query_count = 1<<20;
+constexpr size_t repeat_count = 5;
+
+// compare one-at-a-time lookups against a single batch lookup, over the same random points
+template<typename layer_t>
+int compare_batch_query( const char* layer_name, layer_t& layer, const BoundBox<LocalLocation>& bounds ){
+    const std::vector<LocalLocation> points = random_locations( bounds, query_count );
+    // mark a sampling of cells, so that the lookups are not all identical
+    for( size_t i = 0; i < points.size(); i += 16 ){
+        layer.store( points[i], static_cast<uint8_t>(i) );
+    }
+
+    std::vector<uint8_t> scalar_values( points.size() );
+    std::vector<uint8_t> batch_values( points.size() );
+
+    const double scalar_ns = nanoseconds_per_operation( points.size(), repeat_count, [&](){
+        for( size_t i = 0; i < points.size(); ++i ){
+            scalar_values[i] = layer.get( points[i] );
+        }
+    });
+
+    const double batch_ns = nanoseconds_per_operation( points.size(), repeat_count, [&](){
+        layer.get( points, batch_values );
+    });
+
+    report( "batch-query", layer_name, "scalar", scalar_ns );
+    report( "batch-query", layer_name, "batch", batch_ns );
+    fmt::print( "        >> speedup: {:.2f}x\n", scalar_ns / batch_ns );
+
+    if( scalar_values != batch_values ){
+        fmt::print( "        !! batch results differ from scalar results !!\n" );
+        return 1;
+    }
+    return 0;
+}
+
+int profile_batch_query(){
+    int failures = 0;
+
+    {
+        auto layer = std::make_unique<RollingGridLayer<1024>>();
+        layer->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+        layer->fill( chartbox::layer::clear_cell_value );
+        failures += compare_batch_query( "RollingGridLayer<1024>", *layer, layer->visible() );
+    }{
+        DynamicGridLayer layer;
+        layer.cells_across_sector( 1024 );
+        layer.meters_across_cell( 1.0 );
+        layer.origin( {0,0} );
+        layer.fill( chartbox::layer::clear_cell_value );
+        failures += compare_batch_query( "DynamicGridLayer", layer, layer.visible() );
+    }{
+        auto layer = std::make_unique<SimpleGridLayer<uint8_t,1024,1000>>();
+        layer->fill( chartbox::layer::clear_cell_value );
+        failures += compare_batch_query( "SimpleGridLayer<1024>", *layer, {{0,0}, {1023.9,1023.9}} );
+    }
+
+    return failures;
+}
+
+} // namespace
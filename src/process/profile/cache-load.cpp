@@ -0,0 +1,141 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "io/flatbuffer.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::io::flatbuffer::MappedTile;
+using chartbox::layer::rolling::RollingGridLayer;
+using chartbox::layer::rolling::RollingGridSector;
+
+namespace chartbox::profile {
+
+constexpr size_t cache_load_repeat_count = 10;
+
+typedef RollingGridLayer<1024> cache_layer_t;
+
+// reference implementation: read the whole file into a buffer, and then decode the cells into the sector
+template<uint32_t n>
+bool read_and_copy( const LocalLocation& origin, RollingGridSector<n>& sector ){
+    const auto filepath = chartbox::io::flatbuffer::generate_tile_cache_filename( origin );
+    std::ifstream source( filepath.string(), std::ios::binary );
+    std::vector<uint8_t> buffer( std::filesystem::file_size(filepath) );
+    source.read( reinterpret_cast<char*>(buffer.data()), buffer.size() );
+    MappedTile tile;
+    return tile.parse( buffer.data(), buffer.size() ) && tile.decode( sector.data(), sector.size() );
+}
+
+// profile tile I/O for a layer of the given contents
+int profile_cache_contents( const char* contents, const std::function<void(cache_layer_t&)>& paint ){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-profile-cache-load";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    auto layer = std::make_unique<cache_layer_t>();
+    layer->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+    layer->enable_cache( cache_path );
+    paint( *layer );
+
+    const uint32_t sectors_across = layer->sectors_across_view();
+    const double sector_count = sectors_across * sectors_across;
+    const uint64_t written_before = chartbox::io::flatbuffer::bytes_written();
+    layer->flush_to_cache();
+    const double bytes_per_tile = (chartbox::io::flatbuffer::bytes_written() - written_before) / sector_count;
+
+    // a copy of the painted layer, to check each load against:
+    std::vector<uint8_t> expect;
+    const auto check_layer = [&](){
+        std::vector<uint8_t> values;
+        for( uint32_t sector_index = 0; sector_index < (sectors_across * sectors_across); ++sector_index ){
+            const auto& sector = layer->sector( sector_index );
+            values.insert( values.end(), sector.data(), sector.data() + sector.size() );
+        }
+        if( expect.empty() ){
+            expect = values;
+        }
+        return expect == values;
+    };
+    check_layer();
+
+    auto sector = std::make_unique<RollingGridSector<1024>>();
+    const double reference_ns = nanoseconds_per_operation( sector_count, cache_load_repeat_count, [&](){
+        for( uint32_t row = 0; row < sectors_across; ++row ){
+            for( uint32_t column = 0; column < sectors_across; ++column ){
+                read_and_copy( layer->visible().min + LocalLocation(column, row) * layer->meters_across_sector(), *sector );
+            }
+        }
+    });
+    const double load_ns = nanoseconds_per_operation( sector_count, cache_load_repeat_count, [&](){
+        layer->load_from_cache();
+    });
+    int failures = check_layer() ? 0 : 1;
+
+    // the same tiles, packed into a single archive:
+    const std::filesystem::path archive_path = cache_path / ("packed" + chartbox::io::flatbuffer::archive_extension);
+    chartbox::io::flatbuffer::pack_directory( cache_path, archive_path );
+    layer->enable_cache( archive_path );
+    const double archive_ns = nanoseconds_per_operation( sector_count, cache_load_repeat_count, [&](){
+        layer->load_from_cache();
+    });
+    failures += check_layer() ? 0 : 1;
+    chartbox::io::flatbuffer::enable( {} );
+
+    const std::string name = fmt::format( "<1024> {}", contents );
+    report( "cache-load", name.c_str(), "read + decode (per tile)", reference_ns );
+    report( "cache-load", name.c_str(), "map + decode (per tile)", load_ns );
+    report( "cache-load", name.c_str(), "archive + decode (per tile)", archive_ns );
+    fmt::print( "        >> {:.0f} bytes per tile    ({:.4f} of raw)\n", bytes_per_tile, bytes_per_tile / sector->size() );
+
+    std::filesystem::remove_all( cache_path );
+
+    if( 0 < failures ){
+        fmt::print( "        !! loaded tiles do not match the layer !!\n" );
+    }
+    return failures;
+}
+
+int profile_cache_load(){
+    int failures = 0;
+
+    // all-water: uniform tiles
+    failures += profile_cache_contents( "uniform", []( cache_layer_t& layer ){
+        layer.fill( chartbox::layer::clear_cell_value );
+    });
+
+    // a coastline: long runs of land + water
+    failures += profile_cache_contents( "coastline", []( cache_layer_t& layer ){
+        const auto& bounds = layer.visible();
+        layer.fill( chartbox::layer::clear_cell_value );
+        layer.fill( make_coastline( bounds.center(), 0.4*bounds.width(), 64*1024 ), bounds, chartbox::layer::block_cell_value );
+    });
+
+    // noise: no runs at all
+    failures += profile_cache_contents( "noise", []( cache_layer_t& layer ){
+        std::mt19937 generator( test_seed );
+        const auto& bounds = layer.visible();
+        for( double northing = bounds.min.northing + 0.5; northing < bounds.max.northing; northing += 1.0 ){
+            for( double easting = bounds.min.easting + 0.5; easting < bounds.max.easting; easting += 1.0 ){
+                layer.store( {easting, northing}, static_cast<uint8_t>(generator()) );
+            }
+        }
+    });
+
+    return failures;
+}
+
+} // namespace
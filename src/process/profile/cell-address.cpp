@@ -0,0 +1,98 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "layer/grid-index.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::GridIndex;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t address_query_count = 1<<20;
+constexpr size_t address_repeat_count = 20;
+
+// reference implementation: the original `RollingGridLayer::get`, with generic division + modulo addressing
+template<uint32_t cells_across_sector>
+uint8_t divide_and_modulo_get( const RollingGridLayer<cells_across_sector>& layer, const LocalLocation& layer_location ){
+    constexpr uint32_t sectors_across_view = RollingGridLayer<cells_across_sector>::sectors_across_view();
+    if( layer.visible(layer_location) ){
+        const LocalLocation view_location = layer_location - layer.visible().min;
+
+        const GridIndex view_index = GridIndex( static_cast<uint32_t>(view_location.easting),
+                                                static_cast<uint32_t>(view_location.northing) )
+                                            .div( static_cast<uint32_t>(layer.meters_across_cell()) );
+
+        const size_t sector_offset = view_index.div(cells_across_sector)
+                                                .add(layer.anchor())
+                                                .wrap(sectors_across_view)
+                                                .offset(sectors_across_view);
+
+        const size_t cell_offset = view_index.mod(cells_across_sector)
+                                            .offset(cells_across_sector);
+
+        return layer.sector( sector_offset )[ cell_offset ];
+    }
+    return chartbox::layer::default_cell_value;
+}
+
+int profile_cell_address(){
+    auto layer = std::make_unique<RollingGridLayer<1024>>();
+    layer->track( BoundBox<LocalLocation>({0,0}, {5120*2,5120*2}) );
+    layer->fill( chartbox::layer::clear_cell_value );
+    // wrap the ring, so that both paths exercise the wrap-around
+    layer->scroll_east();
+    layer->scroll_north();
+
+    // a small area: keep the cells in cache, so that the address-arithmetic dominates
+    const LocalLocation hot_origin = layer->visible().min + LocalLocation( 900, 900 );
+    const std::vector<LocalLocation> points = random_locations( {hot_origin, hot_origin + LocalLocation(32,32)}, address_query_count );
+    for( size_t i = 0; i < points.size(); i += 16 ){
+        layer->store( points[i], static_cast<uint8_t>(i) );
+    }
+
+    std::vector<uint8_t> reference_values( points.size() );
+    std::vector<uint8_t> values( points.size() );
+
+    const double reference_ns = nanoseconds_per_operation( points.size(), address_repeat_count, [&](){
+        for( size_t i = 0; i < points.size(); ++i ){
+            reference_values[i] = divide_and_modulo_get( *layer, points[i] );
+        }
+    });
+
+    const double get_ns = nanoseconds_per_operation( points.size(), address_repeat_count, [&](){
+        for( size_t i = 0; i < points.size(); ++i ){
+            values[i] = layer->get( points[i] );
+        }
+    });
+
+    const double store_ns = nanoseconds_per_operation( points.size(), address_repeat_count, [&](){
+        for( size_t i = 0; i < points.size(); ++i ){
+            layer->store( points[i], values[i] );
+        }
+    });
+
+    report( "cell-address", "RollingGridLayer<1024>", "get (divide+modulo)", reference_ns );
+    report( "cell-address", "RollingGridLayer<1024>", "get (shift+mask)", get_ns );
+    report( "cell-address", "RollingGridLayer<1024>", "store (shift+mask)", store_ns );
+    fmt::print( "        >> speedup: {:.2f}x\n", reference_ns / get_ns );
+
+    if( reference_values != values ){
+        fmt::print( "        !! shift+mask results differ from divide+modulo results !!\n" );
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
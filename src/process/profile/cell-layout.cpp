@@ -0,0 +1,146 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "layer/cell-layout.hpp"
+#include "layer/grid-index.hpp"
+#include "layer/simple-grid/simple-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::GridIndex;
+using chartbox::layer::MortonLayout;
+using chartbox::layer::RowMajorLayout;
+using chartbox::layer::simple::SimpleGridLayer;
+
+namespace chartbox::profile {
+
+constexpr uint32_t layout_cells_across = 4096;
+constexpr size_t layout_point_count = 1000000;
+constexpr size_t layout_step_count = 1000000;
+constexpr size_t layout_box_count = 2000;
+constexpr size_t layout_repeat = 3;
+
+// the same terrain, for each layout: noise, with a few blocked cells
+std::vector<uint8_t> make_layout_terrain(){
+    std::mt19937 generator( test_seed );
+    std::uniform_int_distribution<int> distribution( 0, 255 );
+    std::vector<uint8_t> terrain( layout_cells_across * layout_cells_across );
+    for( auto& cell : terrain ){
+        cell = static_cast<uint8_t>( distribution(generator) ) & 0x7F;
+    }
+    return terrain;
+}
+
+// a random walk across the grid: each step moves to one of the 8 neighbours.  (approximates an A* frontier)
+std::vector<GridIndex> make_layout_walk(){
+    std::mt19937 generator( test_seed );
+    std::uniform_int_distribution<int> direction( -1, 1 );
+    std::vector<GridIndex> walk;
+    walk.reserve( layout_step_count );
+    int64_t column = layout_cells_across / 2;
+    int64_t row = layout_cells_across / 2;
+    for( size_t step = 0; step < layout_step_count; ++step ){
+        column = std::clamp<int64_t>( column + direction(generator), 1, layout_cells_across - 2 );
+        row = std::clamp<int64_t>( row + direction(generator), 1, layout_cells_across - 2 );
+        walk.emplace_back( static_cast<uint32_t>(column), static_cast<uint32_t>(row) );
+    }
+    return walk;
+}
+
+template<typename layout_t>
+uint64_t profile_layout( const std::vector<uint8_t>& terrain, const std::vector<LocalLocation>& points, const std::vector<GridIndex>& walk, const std::vector<GridIndex>& corners ){
+    typedef SimpleGridLayer<uint8_t, layout_cells_across, 1000, layout_t> layer_t;
+    auto layer = std::make_unique<layer_t>();
+    const std::string name = fmt::format( "{} {}", layout_t::name, layout_cells_across );
+    uint64_t checksum = 0;
+
+    // (1) load: store every cell from a row-major image
+    const double load_ns = nanoseconds_per_operation( terrain.size(), layout_repeat, [&](){
+        uint8_t* cells = layer->data();
+        for( uint32_t row = 0; row < layout_cells_across; ++row ){
+            uint32_t offset = layer->lookup( 0, row );
+            for( uint32_t column = 0; column < layout_cells_across; ++column ){
+                cells[offset] = terrain[ column + row * layout_cells_across ];
+                offset = layout_t::next_column( offset, layout_cells_across );
+            }
+        }
+    });
+    report( "cell-layout", name.c_str(), "load", load_ns );
+
+    // (2) point queries: random locations
+    const double point_ns = nanoseconds_per_operation( points.size(), layout_repeat, [&](){
+        for( const auto& point : points ){
+            checksum += layer->get( point );
+        }
+    });
+    report( "cell-layout", name.c_str(), "point query", point_ns );
+
+    // (3) 8-neighbour expansion, along a random walk
+    const double expand_ns = nanoseconds_per_operation( 8 * walk.size(), layout_repeat, [&](){
+        const uint8_t* cells = layer->data();
+        for( const auto& at : walk ){
+            for( uint32_t row = at.row - 1; row <= (at.row + 1); ++row ){
+                for( uint32_t column = at.column - 1; column <= (at.column + 1); ++column ){
+                    if( (column != at.column) || (row != at.row) ){
+                        checksum += cells[ layer->lookup(column, row) ];
+                    }
+                }
+            }
+        }
+    });
+    report( "cell-layout", name.c_str(), "8-neighbour expand", expand_ns );
+
+    // (4) box scans: max over each box -- a footprint collision check, and a larger region query
+    for( const uint32_t box_across : {16u, 256u} ){
+        const double scan_ns = nanoseconds_per_operation( corners.size() * box_across * box_across, layout_repeat, [&](){
+            const uint8_t* cells = layer->data();
+            for( const auto& corner : corners ){
+                const uint32_t first_column = corner.column % (layout_cells_across - box_across);
+                const uint32_t first_row = corner.row % (layout_cells_across - box_across);
+                uint8_t found = 0;
+                for( uint32_t row = first_row; row < (first_row + box_across); ++row ){
+                    uint32_t offset = layer->lookup( first_column, row );
+                    for( uint32_t column = 0; column < box_across; ++column ){
+                        found = std::max( found, cells[offset] );
+                        offset = layout_t::next_column( offset, layout_cells_across );
+                    }
+                }
+                checksum += found;
+            }
+        });
+        report( "cell-layout", name.c_str(), fmt::format("{0}x{0} box scan", box_across).c_str(), scan_ns );
+    }
+
+    return checksum;
+}
+
+int profile_cell_layout(){
+    const std::vector<uint8_t> terrain = make_layout_terrain();
+    const std::vector<LocalLocation> points = random_locations( {{0,0}, LocalLocation(layout_cells_across - 0.01)}, layout_point_count );
+    const std::vector<GridIndex> walk = make_layout_walk();
+    std::vector<GridIndex> corners;
+    for( const auto& each : random_locations( {{0,0}, LocalLocation(layout_cells_across - 1)}, layout_box_count ) ){
+        corners.emplace_back( static_cast<uint32_t>(each.easting), static_cast<uint32_t>(each.northing) );
+    }
+
+    const uint64_t row_major = profile_layout<RowMajorLayout>( terrain, points, walk, corners );
+    const uint64_t morton = profile_layout<MortonLayout>( terrain, points, walk, corners );
+    if( row_major != morton ){
+        fmt::print( "        !! layouts disagree: {} vs {} !!\n", row_major, morton );
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
@@ -0,0 +1,150 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "chart-box/chart-box.hpp"
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+
+#include "profile.hpp"
+
+using chartbox::ChartBox;
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::sensor::SensorHit;
+
+namespace chartbox::profile {
+
+constexpr size_t composite_query_count = 1000000;
+constexpr size_t composite_repeat = 3;
+
+namespace {
+
+// a vessel's track: short steps, with a slowly wandering heading; turns back at the edge of the bounds
+std::vector<LocalLocation> make_track( const BoundBox<LocalLocation>& bounds, size_t count ){
+    std::mt19937 generator( test_seed );
+    std::uniform_real_distribution<double> turn_distribution( -0.05, 0.05 );
+    constexpr double step = 0.5;
+
+    std::vector<LocalLocation> track;
+    track.reserve( count );
+    LocalLocation position = bounds.center();
+    double heading = 0;
+    for( size_t i = 0; i < count; ++i ){
+        heading += turn_distribution( generator );
+        LocalLocation next = position + LocalLocation( step * std::cos(heading), step * std::sin(heading) );
+        if( ! bounds.contains(next) ){
+            heading += M_PI;
+            next = position;
+        }
+        position = next;
+        track.push_back( position );
+    }
+    return track;
+}
+
+} // namespace
+
+// ChartBox queries: each layer combined on the fly (one point at a time, or by chunks), vs. a materialized composite
+int profile_composite(){
+    int failures = 0;
+
+    auto chart = std::make_unique<ChartBox>();
+    auto& boundary = chart->get_boundary_layer();
+    boundary.cells_across_sector( 512 );
+    boundary.meters_across_cell( 4.0 );
+    boundary.origin( {0,0} );
+    auto& contour = chart->get_contour_layer();
+    contour.track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+    const BoundBox<LocalLocation> bounds = contour.visible();
+
+    // coarse boundary data across the whole area; fine contour data near the shore:
+    const Polygon<LocalLocation> coastline = make_coastline( bounds.center(), 0.4*bounds.width(), 64*1024 );
+    const Polygon<LocalLocation> shoal = make_coastline( bounds.center() + LocalLocation( 800, 400 ), 0.2*bounds.width(), 16*1024 );
+    boundary.fill( chartbox::layer::clear_cell_value );
+    boundary.fill( coastline, boundary.visible(), chartbox::layer::block_cell_value );
+    contour.fill( chartbox::layer::clear_cell_value );
+    contour.fill( shoal, bounds, 0xC0 );
+
+    const size_t cell_count = static_cast<size_t>(ChartBox::composite_layer_t::dimension) * ChartBox::composite_layer_t::dimension;
+    const double recompose_ns = nanoseconds_per_operation( cell_count, composite_repeat, [&](){
+        chart->enable_composite( false );
+        chart->enable_composite( true );
+    });
+    report( "composite", "ChartBox", "recompose (full)", recompose_ns );
+
+    const std::vector<LocalLocation> random_points = random_locations( bounds, composite_query_count );
+    const std::vector<LocalLocation> track_points = make_track( bounds, composite_query_count );
+    for( const auto& [variant, points] : { std::pair{ "random", &random_points }, std::pair{ "path-following", &track_points } } ){
+        const std::vector<LocalLocation>& query = *points;
+        std::vector<uint8_t> expected( query.size() );
+        chart->enable_composite( false );
+        const double direct_ns = nanoseconds_per_operation( query.size(), composite_repeat, [&](){
+            for( size_t i = 0; i < query.size(); ++i ){
+                expected[i] = chart->get( query[i] );
+            }
+        });
+        report( "composite", "ChartBox (on the fly)", variant, direct_ns );
+
+        std::vector<uint8_t> batch( query.size() );
+        const double batch_ns = nanoseconds_per_operation( query.size(), composite_repeat, [&](){
+            chart->get( query, batch );
+        });
+        report( "composite", "ChartBox (batch)", variant, batch_ns );
+        if( batch != expected ){
+            fmt::print( "        !! batch and single-point queries disagree, for {} points !!\n", variant );
+            ++failures;
+        }
+
+        std::vector<uint8_t> found( query.size() );
+        chart->enable_composite( true );
+        const double composite_ns = nanoseconds_per_operation( query.size(), composite_repeat, [&](){
+            for( size_t i = 0; i < query.size(); ++i ){
+                found[i] = chart->get( query[i] );
+            }
+        });
+        report( "composite", "ChartBox (composite)", variant, composite_ns );
+        fmt::print( "        >> speedup: {:.2f}x\n", direct_ns / composite_ns );
+
+        if( found != expected ){
+            fmt::print( "        !! composite and on-the-fly queries disagree, for {} points !!\n", variant );
+            ++failures;
+        }
+    }
+
+    // writes through the chart keep the composite current:
+    chart->store( chartbox::layer::CONTOUR, {100.5, 100.5}, 0xEE );
+    chart->store( chartbox::layer::BOUNDARY, {4000.5, 200.5}, 0xEE );
+    if( (0xEE != chart->get({100.5, 100.5})) || (0xEE != chart->get({4000.5, 200.5})) || (0xEE != chart->get({4003.5, 203.5})) ){
+        fmt::print( "        !! composite missed a write !!\n" );
+        ++failures;
+    }
+
+    // ... as do sensor hits, once ingested:  (a blocking hit; the lidar only marks the cells which are likely occupied)
+    const std::vector<SensorHit> hits = { {{200.5, 300.5}, chartbox::layer::block_cell_value} };
+    chart->get_layer<chartbox::layer::LIDAR>().submit( hits );
+    if( (1 != chart->ingest()) || (chartbox::layer::block_cell_value != chart->get({200.5, 300.5})) ){
+        fmt::print( "        !! composite missed a sensor hit !!\n" );
+        ++failures;
+    }
+
+    // ... and the moves of the sensor layers, as they re-center on the view:
+    chart->relocate( bounds.min );
+    const uint8_t composed = chart->get({200.5, 300.5});
+    chart->enable_composite( false );
+    if( (chartbox::layer::block_cell_value == composed) || (chart->get({200.5, 300.5}) != composed) ){
+        fmt::print( "        !! composite missed a sensor layer's move !!\n" );
+        ++failures;
+    }
+
+    return failures;
+}
+
+} // namespace
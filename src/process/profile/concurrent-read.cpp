@@ -0,0 +1,140 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+// how long each configuration reads (and scrolls) for
+constexpr auto concurrent_read_duration = std::chrono::milliseconds(300);
+
+// time between scrolls, on the writing thread
+constexpr auto concurrent_scroll_period = std::chrono::milliseconds(2);
+
+// queries per pinned reader, for the batched variant
+constexpr size_t reads_per_pin = 256;
+
+namespace {
+
+enum class ReadGuard { mutex, reader_per_query, reader_per_batch };
+
+struct ReadResult {
+    double mreads_per_second;
+    size_t scrolls;
+};
+
+// every reader thread queries the layer as fast as it can -- while this thread scrolls it east + west
+ReadResult read_while_scrolling( RollingGridLayer<1024>& layer, ReadGuard guard, size_t thread_count, const std::vector<LocalLocation>& offsets ){
+    std::mutex layer_mutex;
+    std::atomic<bool> done = false;
+    std::atomic<size_t> total_reads = 0;
+    std::atomic<uint64_t> checksum = 0;
+
+    std::vector<std::thread> readers;
+    for( size_t thread = 0; thread < thread_count; ++thread ){
+        readers.emplace_back( [&, thread](){
+            size_t reads = 0;
+            uint64_t sum = 0;
+            size_t next = thread * 7919;
+            while( not done.load(std::memory_order_relaxed) ){
+                if( ReadGuard::mutex == guard ){
+                    for( size_t query = 0; query < reads_per_pin; ++query ){
+                        std::lock_guard<std::mutex> lock( layer_mutex );
+                        sum += layer.get( layer.visible().min + offsets[next++ % offsets.size()] );
+                    }
+                }else if( ReadGuard::reader_per_query == guard ){
+                    for( size_t query = 0; query < reads_per_pin; ++query ){
+                        const auto reader = layer.reader();
+                        sum += reader.get( reader.visible().min + offsets[next++ % offsets.size()] );
+                    }
+                }else{
+                    const auto reader = layer.reader();
+                    for( size_t query = 0; query < reads_per_pin; ++query ){
+                        sum += reader.get( reader.visible().min + offsets[next++ % offsets.size()] );
+                    }
+                }
+                reads += reads_per_pin;
+            }
+            total_reads += reads;
+            checksum += sum;
+        });
+    }
+
+    size_t scrolls = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while( (std::chrono::steady_clock::now() - start) < concurrent_read_duration ){
+        {
+            std::unique_lock<std::mutex> lock( layer_mutex, std::defer_lock );
+            if( ReadGuard::mutex == guard ){
+                lock.lock();
+            }
+            ( 0 == (scrolls % 2) ) ? layer.scroll_east() : layer.scroll_west();
+        }
+        ++scrolls;
+        std::this_thread::sleep_for( concurrent_scroll_period );
+    }
+    done = true;
+    for( auto& reader : readers ){
+        reader.join();
+    }
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    // (keep the reads from being optimized away)
+    if( 0 == checksum.load() ){
+        fmt::print( "    (every read was zero)\n" );
+    }
+    return { static_cast<double>(total_reads.load()) / elapsed / 1e6, scrolls };
+}
+
+} // namespace
+
+// reader throughput while the view scrolls: a global mutex around every access, vs. pinned (lock-free) readers
+int profile_concurrent_read(){
+    int failures = 0;
+
+    auto layer = std::make_unique<RollingGridLayer<1024>>();
+    layer->track( BoundBox<LocalLocation>({0,0}, {1024*64,1024*64}) );
+    layer->fill( chartbox::layer::clear_cell_value );
+    const std::vector<LocalLocation> offsets = random_locations( BoundBox<LocalLocation>({0,0}, {5119.9,5119.9}), 64*1024 );
+
+    const std::pair<ReadGuard, const char*> variants[] = {
+        { ReadGuard::mutex, "mutex (per query)" },
+        { ReadGuard::reader_per_query, "reader (per query)" },
+        { ReadGuard::reader_per_batch, "reader (per 256)" },
+    };
+
+    fmt::print( "    {:<16} {:<24} {:<24} {:>10} {:>10} {:>10}\n", "", "", "", "threads", "Mreads/s", "scrolls" );
+    for( const auto& [guard, variant] : variants ){
+        layer->enable_concurrent_readers( ReadGuard::mutex != guard );
+        for( const size_t thread_count : {1, 2, 4} ){
+            const ReadResult result = read_while_scrolling( *layer, guard, thread_count, offsets );
+            fmt::print( "    {:<16} {:<24} {:<24} {:>10} {:>10.1f} {:>10}\n", "concurrent-read", "RollingGridLayer<1024>", variant,
+                        thread_count, result.mreads_per_second, result.scrolls );
+            if( (0 == result.scrolls) || (0 == result.mreads_per_second) ){
+                ++failures;
+            }
+        }
+    }
+    layer->enable_concurrent_readers( false );
+
+    return failures;
+}
+
+} // namespace
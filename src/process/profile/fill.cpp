@@ -0,0 +1,136 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t fill_repeat_count = 3;
+
+// reference implementation: the original per-cell polygon fill, one `store` call per cell
+template<typename layer_t>
+void store_per_cell_fill( layer_t& layer, const Polygon<LocalLocation>& poly, const BoundBox<LocalLocation>& bounds, uint8_t value ){
+    const double incr = layer.meters_across_cell();
+    for( double y = bounds.min.northing + incr/2; y < bounds.max.northing; y += incr ){
+        std::vector<double> crossings;
+        for( size_t i = 0; i < (poly.size()-1); ++i ){
+            const LocalLocation& start = poly[i];
+            const LocalLocation& end = poly[i+1];
+            if( (std::min(start.y(), end.y()) <= y) && (y < std::max(start.y(), end.y())) ){
+                crossings.emplace_back( start.x() + (y - start.y()) * (end.x() - start.x())/(end.y() - start.y()) );
+            }
+        }
+        std::sort( crossings.begin(), crossings.end() );
+        for( size_t crossing_index = 0; crossing_index < crossings.size(); crossing_index += 2 ){
+            const double start_x = std::max( bounds.min.easting, crossings[crossing_index]) + incr/2;
+            const double end_x = std::min( bounds.max.easting, crossings[crossing_index+1] + incr/2);
+            for( double x = start_x; x < end_x; x += incr ){
+                layer.store( {x,y}, value );
+            }
+        }
+    }
+}
+
+Polygon<LocalLocation> make_star( const LocalLocation& center, double inner_radius, double outer_radius, size_t point_count ){
+    std::vector<LocalLocation> vertices;
+    for( size_t i = 0; i < 2*point_count; ++i ){
+        const double angle = std::numbers::pi * static_cast<double>(i) / static_cast<double>(point_count);
+        const double radius = (0 == (i%2)) ? outer_radius : inner_radius;
+        vertices.emplace_back( center.easting + radius*std::cos(angle), center.northing + radius*std::sin(angle) );
+    }
+    vertices.emplace_back( vertices.front() );
+    return Polygon<LocalLocation>( vertices );
+}
+
+Polygon<LocalLocation> make_coastline( const LocalLocation& center, double radius, size_t vertex_count ){
+    std::vector<LocalLocation> vertices;
+    for( size_t i = 0; i < vertex_count; ++i ){
+        const double angle = 2 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(vertex_count);
+        const double r = radius + 0.08*radius*std::sin(13*angle) + 0.02*radius*std::sin(97*angle + 1) + 0.005*radius*std::sin(1013*angle + 2);
+        vertices.emplace_back( center.easting + r*std::cos(angle), center.northing + r*std::sin(angle) );
+    }
+    vertices.emplace_back( vertices.front() );
+    return Polygon<LocalLocation>( vertices );
+}
+
+int profile_fill(){
+    auto reference = std::make_unique<RollingGridLayer<1024>>();
+    auto layer = std::make_unique<RollingGridLayer<1024>>();
+    for( auto* each : {reference.get(), layer.get()} ){
+        each->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+        each->fill( chartbox::layer::clear_cell_value );
+    }
+    const auto& bounds = layer->visible();
+    const Polygon<LocalLocation> star = make_star( bounds.center(), 800, 2400, 64 );
+    const BoundBox<LocalLocation> box( bounds.min + LocalLocation(100.5, 200.5), bounds.max - LocalLocation(300.5, 50.5) );
+
+    const double cell_count = static_cast<double>(layer->cells_across_view()) * layer->cells_across_view();
+
+    const double reference_box_ns = nanoseconds_per_operation( cell_count, fill_repeat_count, [&](){
+        const double incr = reference->meters_across_cell();
+        for( double northing = box.min.northing + incr/2; northing < box.max.northing; northing += incr ){
+            for( double easting = box.min.easting + incr/2; easting < box.max.easting; easting += incr ){
+                reference->store( {easting, northing}, chartbox::layer::block_cell_value );
+            }
+        }
+    });
+    const double box_ns = nanoseconds_per_operation( cell_count, fill_repeat_count, [&](){
+        layer->fill( box, chartbox::layer::block_cell_value );
+    });
+
+    const double reference_polygon_ns = nanoseconds_per_operation( cell_count, fill_repeat_count, [&](){
+        store_per_cell_fill( *reference, star, bounds, chartbox::layer::clear_cell_value );
+    });
+    const double polygon_ns = nanoseconds_per_operation( cell_count, fill_repeat_count, [&](){
+        layer->fill( star, bounds, chartbox::layer::clear_cell_value );
+    });
+
+    report( "fill", "RollingGridLayer<1024>", "box (per-cell)", reference_box_ns );
+    report( "fill", "RollingGridLayer<1024>", "box", box_ns );
+    report( "fill", "RollingGridLayer<1024>", "polygon (per-cell)", reference_polygon_ns );
+    report( "fill", "RollingGridLayer<1024>", "polygon", polygon_ns );
+    fmt::print( "        >> speedup: box: {:.2f}x    polygon: {:.2f}x    (ns per cell-in-view)\n",
+                reference_box_ns / box_ns, reference_polygon_ns / polygon_ns );
+
+    // a high-vertex 'coastline': 64k vertices
+    const Polygon<LocalLocation> coastline = make_coastline( bounds.center(), 2000, 64*1024 );
+    const double reference_coastline_ns = nanoseconds_per_operation( cell_count, 1, [&](){
+        store_per_cell_fill( *reference, coastline, bounds, 0x42 );
+    });
+    const double coastline_ns = nanoseconds_per_operation( cell_count, 1, [&](){
+        layer->fill( coastline, bounds, 0x42 );
+    });
+    report( "fill", "RollingGridLayer<1024>", "coastline (per-cell)", reference_coastline_ns );
+    report( "fill", "RollingGridLayer<1024>", "coastline", coastline_ns );
+    fmt::print( "        >> speedup: coastline: {:.2f}x\n", reference_coastline_ns / coastline_ns );
+
+    for( uint32_t sector_index = 0; sector_index < (layer->sectors_across_view() * layer->sectors_across_view()); ++sector_index ){
+        const auto& expect = reference->sector(sector_index);
+        const auto& actual = layer->sector(sector_index);
+        if( not std::equal(expect.data(), expect.data() + expect.size(), actual.data()) ){
+            fmt::print( "        !! fill results differ from per-cell results in sector {} !!\n", sector_index );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace
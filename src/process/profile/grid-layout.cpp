@@ -0,0 +1,134 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "layer/dynamic-grid/dynamic-grid-layer.hpp"
+#include "layer/grid-index.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::GridIndex;
+using chartbox::layer::dynamic::DynamicGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t layout_query_count = 1<<20;
+constexpr size_t layout_repeat_count = 5;
+
+// the previous DynamicGridLayer storage: one heap-allocated vector per sector.  (kept here as a baseline)
+class NestedSectorGrid {
+public:
+    NestedSectorGrid( double meters_across_cell, uint32_t cells_across_sector, uint32_t sectors_across_view )
+        : meters_across_cell_(meters_across_cell)
+        , cells_across_sector_(cells_across_sector)
+        , sectors_across_view_(sectors_across_view)
+        , bounds_( {0,0}, LocalLocation(meters_across_cell * cells_across_sector * sectors_across_view) )
+        , sectors_( sectors_across_view * sectors_across_view, std::vector<uint8_t>(cells_across_sector * cells_across_sector, 0) )
+    {}
+
+    uint8_t get( const LocalLocation& p ) const {
+        if( bounds_.contains(p) ){
+            const LocalLocation relative = p - bounds_.min;
+            const LocalLocation clamped( std::fmin(relative.easting, bounds_.width() - meters_across_cell_/10),
+                                         std::fmin(relative.northing, bounds_.height() - meters_across_cell_/10) );
+            const GridIndex index = GridIndex( clamped.easting, clamped.northing ).div( meters_across_cell_ );
+            return sectors_[ index.div(cells_across_sector_).offset(sectors_across_view_) ][ index.mod(cells_across_sector_).offset(cells_across_sector_) ];
+        }
+        return chartbox::layer::default_cell_value;
+    }
+
+    bool store( const LocalLocation& p, uint8_t value ){
+        if( bounds_.contains(p) ){
+            const LocalLocation relative = p - bounds_.min;
+            const GridIndex index = GridIndex( relative.easting, relative.northing ).div( meters_across_cell_ );
+            sectors_[ index.div(cells_across_sector_).offset(sectors_across_view_) ][ index.mod(cells_across_sector_).offset(cells_across_sector_) ] = value;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    double meters_across_cell_;
+    uint32_t cells_across_sector_;
+    uint32_t sectors_across_view_;
+    BoundBox<LocalLocation> bounds_;
+    std::vector<std::vector<uint8_t>> sectors_;
+};
+
+// random + neighbour-walk access patterns; the latter approximates an A* expansion over a `visited` map
+template<typename layer_t>
+int time_layout( const char* layer_name, const char* variant, layer_t& layer, const BoundBox<LocalLocation>& bounds, std::vector<uint8_t>& results ){
+    const std::vector<LocalLocation> points = random_locations( bounds, layout_query_count );
+
+    const double store_ns = nanoseconds_per_operation( points.size(), layout_repeat_count, [&](){
+        for( size_t i = 0; i < points.size(); ++i ){
+            layer.store( points[i], static_cast<uint8_t>(i) );
+        }
+    });
+    report( "grid-layout", layer_name, fmt::format("{} store", variant).c_str(), store_ns );
+
+    results.resize( points.size() );
+    const double get_ns = nanoseconds_per_operation( points.size(), layout_repeat_count, [&](){
+        for( size_t i = 0; i < points.size(); ++i ){
+            results[i] = layer.get( points[i] );
+        }
+    });
+    report( "grid-layout", layer_name, fmt::format("{} get", variant).c_str(), get_ns );
+
+    // visit the 8 neighbours of each point
+    const LocalLocation offsets[] = { {-1,-1}, {0,-1}, {1,-1}, {-1,0}, {1,0}, {-1,1}, {0,1}, {1,1} };
+    uint32_t checksum = 0;
+    const double neighbour_ns = nanoseconds_per_operation( 8 * (points.size() / 8), layout_repeat_count, [&](){
+        for( size_t i = 0; i < points.size(); i += 8 ){
+            for( const auto& offset : offsets ){
+                checksum += layer.get( points[i] + offset );
+            }
+        }
+    });
+    report( "grid-layout", layer_name, fmt::format("{} neighbours", variant).c_str(), neighbour_ns );
+    results.push_back( static_cast<uint8_t>(checksum) );
+
+    return 0;
+}
+
+int compare_layout( uint32_t cells_across_view ){
+    const BoundBox<LocalLocation> bounds( {0,0}, LocalLocation(cells_across_view) );
+    const std::string name = fmt::format( "DynamicGridLayer {}", cells_across_view );
+
+    DynamicGridLayer contiguous;
+    contiguous.meters_across_cell( 1.0 );
+    if( not contiguous.track( bounds ) ){
+        fmt::print( "        !! could not track: {} cells !!\n", cells_across_view );
+        return 1;
+    }
+    fmt::print( "    ({} x {} sectors of {} cells)\n", contiguous.sectors_across_view(), contiguous.sectors_across_view(), contiguous.cells_across_sector() );
+    NestedSectorGrid nested( contiguous.meters_across_cell(), contiguous.cells_across_sector(), contiguous.sectors_across_view() );
+
+    std::vector<uint8_t> nested_results;
+    std::vector<uint8_t> contiguous_results;
+    time_layout( name.c_str(), "nested", nested, bounds, nested_results );
+    time_layout( name.c_str(), "contiguous", contiguous, bounds, contiguous_results );
+
+    if( nested_results != contiguous_results ){
+        fmt::print( "        !! contiguous results differ from nested results !!\n" );
+        return 1;
+    }
+    return 0;
+}
+
+int profile_grid_layout(){
+    int failures = 0;
+    // power-of-two sectors (4 x 256) vs. arbitrary sectors (4 x 250)
+    failures += compare_layout( 1024 );
+    failures += compare_layout( 1000 );
+    return failures;
+}
+
+} // namespace
@@ -1,151 +1,60 @@
-// GPL v3 (c) 2020
-
-#include <fstream>
-#include <iostream>
-#include <random>
-#include <chrono>
-
-#include <sys/stat.h> // may not be standard
-
-#include <cxxopts/cxxopts.hpp>
-
-#include <nlohmann/json.hpp>
-using nlohmann::json;
-
-// #include "node/quad_node.hpp"
-// #include "node/tile_node.hpp"
-#include "world_tree.hpp"
-#include "io/readers.hpp"
-#include "io/writers.hpp"
-
-using namespace yggdrasil::io;
-
-using yggdrasil::grid::Grid;
-using yggdrasil::quadtree::Tree;
-using yggdrasil::WorldTree;
-
-constexpr double boundary_width = 4096.;
-constexpr double desired_precision = 1.0;
-// =====
-const json source = yggdrasil::generate_diamond(  boundary_width, desired_precision);
-
-constexpr size_t test_seed = 55;
-static std::mt19937 generator;
-
-
-cxxopts::Options command_line_options("Profiler", "Run metrics and speed tests of the Yggdrasil library");
-
-void configure_parser_options(cxxopts::Options& opts){
-    // define command line options
-    opts.add_options()
-        // ("d,debug", "Enable debugging")
-        ("i,input", "input json path", cxxopts::value<std::string>())
-        ("c,count", "Iteration Count", cxxopts::value<size_t>())
-        ("o,image", "Output image filen name", cxxopts::value<std::string>())
-    ;
-}
-
-void profile_tree(const WorldTree& worldtree, const size_t iteration_limit){
-    const double max = worldtree.get_layout().get_x_max();
-    const double min = worldtree.get_layout().get_x_min();
-
-    generator.seed(test_seed);
-
-    std::cout << ">> Starting testing:\n";
-    cell_value_t dump = 0;
-    
-    auto start = std::chrono::high_resolution_clock::now(); 
-    size_t iteration = 0;
-    for( iteration = 0; iteration < iteration_limit; ++iteration ){
-        const double x = static_cast<double>(generator()) / generator.max() * max + min;
-
-        const double y = static_cast<double>(generator()) / generator.max() * max + min;
-        //std::cout << "random value: x: " << x << ", " << y << '\n';
-
-        dump = worldtree.classify({x,y});
-        //std::cout << "             =>: " << static_cast<int>(value) << '\n';
-    }
-    auto stop = std::chrono::high_resolution_clock::now(); 
-
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count(); 
-  
-    std::cout.imbue(std::locale(""));
-    std::cout << "<< Finished testing:\n";
-    std::cout << "   Ran " << iteration << " iterations in " << duration << " \u03BCs \n\n";
-}
-
-
-int main(int argc, char* argv[]){
-    std::string filename;
-    std::unique_ptr<std::istream> document_stream;
-    size_t trial_size = 10;
-    
-    configure_parser_options(command_line_options);
-    auto result = command_line_options.parse(argc, argv);
-
-    // configure input:
-    if( 0 == result.count("input")){
-        cerr << "  ## using default input.\n";
-        // load default json source data
-        filename = "<default>";
-        document_stream.reset(new std::istringstream(source.dump()));
-    }else if( 0 < result.count("input")){
-        filename = result["opt"].as<std::string>();
-        cerr << "  ## File input; with:  " << filename << endl;
-
-        struct stat buf;
-        if( stat(filename.c_str(), &buf) == -1){
-            cerr << "!? could not find file!\n";
-            return -1;
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+#include <fmt/core.h>
+
+#include "profile.hpp"
+
+using namespace chartbox::profile;
+
+// ordered list of every available suite:
+const std::pair<std::string_view, std::function<int()>> suites[] = {
+    { "batch-query", profile_batch_query },
+    { "cache-load", profile_cache_load },
+    { "cell-address", profile_cell_address },
+    { "cell-layout", profile_cell_layout },
+    { "composite", profile_composite },
+    { "concurrent-read", profile_concurrent_read },
+    { "fill", profile_fill },
+    { "grid-layout", profile_grid_layout },
+    { "occupancy-scan", profile_occupancy_scan },
+    { "packed-grid", profile_packed_grid },
+    { "parallel-fill", profile_parallel_fill },
+    { "raycast", profile_raycast },
+    { "region-query", profile_region_query },
+    { "relocate", profile_relocate },
+    { "scroll-latency", profile_scroll_latency },
+    { "sensor-ingest", profile_sensor_ingest },
+    { "tacking", profile_tacking },
+    { "tree-index", profile_tree_index },
+};
+
+int main( int argc, char* argv[] ){
+    if( (1 < argc) && ((0 == strcmp("-h", argv[1])) || (0 == strcmp("--help", argv[1]))) ){
+        fmt::print( "usage: {} [suite-name ...]\n", argv[0] );
+        fmt::print( "    (runs every suite, when none are named)\n" );
+        for( const auto& [name, run] : suites ){
+            fmt::print( "    - {}\n", name );
         }
-        std::ifstream document_stream = std::ifstream(filename);
+        return 0;
     }
 
-    if( 0 < result.count("count")){
-        trial_size = result["count"].as<size_t>();
-        cerr << "    ## Selected Trial Size: " << trial_size << endl;
-    }
-
-    
-    WorldTree tree;
-    
-    bool write_output = false;
-    std::string output_path;
-    if( 0 < result.count("image")){
-        write_output = true;
-        output_path = result["image"].as<std::string>();
-        if( output_path.empty() ){
-            output_path = "worldtree.output.png";
+    int failures = 0;
+    for( const auto& [name, run] : suites ){
+        bool selected = (1 == argc);
+        for( int i = 1; i < argc; ++i ){
+            selected |= (name == argv[i]);
         }
-        cerr << "  ## Save output to: " << output_path << '\n';
-    }
-
-    // ^^^^ Configuration
-    // vvvv Execution
 
-    cerr << ">> loading tree ... \n";
-    const auto start_load = std::chrono::high_resolution_clock::now(); 
-    
-    bool load_success;
-    load_success = load_from_json_stream(tree, *document_stream);
-    if(!load_success){
-        cerr << "!!!! error while loading into the tree!!!!\n";
-        cerr << tree.get_error();
-        return -1;
-    }
-    const auto finish_load = std::chrono::high_resolution_clock::now(); 
-    const auto load_duration = static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(finish_load - start_load).count())/1000;
-    cerr << "<< Loaded in:   " << load_duration << " s \n";
-
-    
-    // tree.debug();
-    cerr << tree.summary();
-    profile_tree(tree, trial_size);
-
-    if(write_output){
-        cerr << "##>> writing output...\n";
-        to_png(tree, output_path);
+        if( selected ){
+            fmt::print( "====== ====== {} ====== ======\n", name );
+            failures += run();
+        }
     }
 
-    return 0;
+    return (0 == failures) ? 0 : 1;
 }
@@ -0,0 +1,82 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/local-location.hpp"
+#include "layer/sensor/sensor-layer.hpp"
+#include "layer/worker-pool.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::WorkerPool;
+using chartbox::layer::sensor::SensorLayer;
+
+namespace chartbox::profile {
+
+// one full revolution of a marine lidar: 0.1 degree resolution
+constexpr size_t occupancy_ray_count = 3600;
+
+constexpr size_t occupancy_repeat = 10;
+
+// target latency for a full scan
+constexpr double occupancy_target_ms = 5.0;
+
+namespace {
+
+// a full 360 degree scan around the vessel: returns between 5 m and 600 m out, at random ranges
+std::vector<LocalLocation> make_revolution( const LocalLocation& center, size_t count ){
+    std::mt19937 generator( test_seed );
+    std::uniform_real_distribution<double> range_distribution( 5, 600 );
+
+    std::vector<LocalLocation> hits;
+    hits.reserve( count );
+    for( size_t i = 0; i < count; ++i ){
+        const double azimuth = 2 * M_PI * static_cast<double>(i) / static_cast<double>(count);
+        const double range = range_distribution( generator );
+        hits.push_back( center + LocalLocation( range * std::cos(azimuth), range * std::sin(azimuth) ) );
+    }
+    return hits;
+}
+
+} // namespace
+
+// log-odds integration of a full scan: every ray walked from the sensor, through the sector ring
+int profile_occupancy_scan(){
+    int failures = 0;
+
+    auto layer = std::make_unique<SensorLayer<256>>();
+    layer->fill( chartbox::layer::unknown_cell_value );
+    const LocalLocation origin = layer->visible().center();
+    const std::vector<LocalLocation> hits = make_revolution( origin, occupancy_ray_count );
+
+    fmt::print( "    {:<16} {:<24} {:<24} {:>10} {:>10} {:>10}\n", "", "", "", "threads", "ns/ray", "ms/scan" );
+    for( const size_t thread_count : {1, 2, 4} ){
+        WorkerPool pool( thread_count );
+        const double ray_ns = nanoseconds_per_operation( hits.size(), occupancy_repeat, [&](){
+            if( not layer->integrate_scan( origin, hits, pool ) ){
+                ++failures;
+            }
+        });
+        const double scan_ms = ray_ns * static_cast<double>(hits.size()) / 1e6;
+        fmt::print( "    {:<16} {:<24} {:<24} {:>10} {:>10.1f} {:>10.2f}{}\n", "occupancy-scan", "SensorLayer<256>", "integrate_scan",
+                    thread_count, ray_ns, scan_ms, (occupancy_target_ms < scan_ms) ? "  (over target)" : "" );
+    }
+
+    // after all those scans: free space, out to each hit ... which itself is occupied
+    const LocalLocation& near = hits[0];
+    if( (chartbox::layer::unknown_cell_value <= layer->get( origin + (near - origin) * 0.5 ))
+        || (layer->get( near ) <= chartbox::layer::unknown_cell_value) ){
+        fmt::print( "    !! scan was not integrated\n" );
+        ++failures;
+    }
+    return failures;
+}
+
+} // namespace
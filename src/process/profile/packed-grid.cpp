@@ -0,0 +1,88 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/packed-grid/packed-grid-layer.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::packed::PackedGridLayer;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t packed_grid_query_count = 1000;
+constexpr size_t packed_grid_repeat = 3;
+
+// a 5x5 view of 1024-cell sectors, as one byte per cell -- and as 2 bits per cell
+int profile_packed_grid(){
+    typedef RollingGridLayer<1024> byte_layer_t;
+    typedef PackedGridLayer<5120> packed_layer_t;
+    int failures = 0;
+
+    auto bytes = std::make_unique<byte_layer_t>();
+    bytes->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+    auto packed = std::make_unique<packed_layer_t>();
+    const auto& bounds = packed->visible();
+    const size_t cell_count = static_cast<size_t>(packed_layer_t::dimension) * packed_layer_t::dimension;
+
+    const Polygon<LocalLocation> coastline = make_coastline( bounds.center(), 0.4*bounds.width(), 64*1024 );
+
+    const double byte_fill_ns = nanoseconds_per_operation( cell_count, packed_grid_repeat, [&](){
+        bytes->fill( chartbox::layer::clear_cell_value );
+        bytes->fill( coastline, bounds, chartbox::layer::block_cell_value );
+    });
+    report( "packed-grid", "RollingGridLayer<1024>", "polygon fill", byte_fill_ns );
+    fmt::print( "        >> memory: {:>9} bytes\n", cell_count );
+
+    const double packed_fill_ns = nanoseconds_per_operation( cell_count, packed_grid_repeat, [&](){
+        packed->fill( chartbox::layer::clear_cell_value );
+        packed->fill( coastline, bounds, chartbox::layer::block_cell_value );
+    });
+    report( "packed-grid", "PackedGridLayer<5120>", "polygon fill", packed_fill_ns );
+    fmt::print( "        >> memory: {:>9} bytes\n", packed->memory_usage() );
+
+    // "is there any land within `radius` of this waypoint?"
+    const std::vector<LocalLocation> waypoints = random_locations( bounds, packed_grid_query_count );
+    for( const double radius : {16.0, 64.0, 256.0} ){
+        const auto box_of = [&]( const LocalLocation& waypoint ){
+            return BoundBox<LocalLocation>( waypoint - LocalLocation(radius, radius), waypoint + LocalLocation(radius, radius) ); };
+        const std::string variant = fmt::format( "radius {:.0f}m", radius );
+
+        std::vector<bool> expected( waypoints.size() );
+        const double byte_query_ns = nanoseconds_per_operation( waypoints.size(), packed_grid_repeat, [&](){
+            for( size_t i = 0; i < waypoints.size(); ++i ){
+                expected[i] = (chartbox::layer::block_cell_value == bytes->max( box_of(waypoints[i]), 0 ));
+            }
+        });
+        report( "packed-grid", "RollingGridLayer<1024>", variant.c_str(), byte_query_ns );
+
+        std::vector<bool> found( waypoints.size() );
+        const double packed_query_ns = nanoseconds_per_operation( waypoints.size(), packed_grid_repeat, [&](){
+            for( size_t i = 0; i < waypoints.size(); ++i ){
+                found[i] = packed->any_blocked( box_of(waypoints[i]) );
+            }
+        });
+        report( "packed-grid", "PackedGridLayer<5120>", variant.c_str(), packed_query_ns );
+
+        if( found != expected ){
+            fmt::print( "        !! packed and byte layers disagree, at radius {} !!\n", radius );
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+} // namespace
@@ -0,0 +1,102 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/dynamic-grid/dynamic-grid-layer.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+#include "layer/worker-pool.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::WorkerPool;
+using chartbox::layer::dynamic::DynamicGridLayer;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t parallel_fill_repeat_count = 3;
+
+// thread counts to profile: powers of two, up to the hardware thread count (but at least 4)
+std::vector<size_t> thread_counts(){
+    const size_t limit = std::max<size_t>( 4, std::thread::hardware_concurrency() );
+    std::vector<size_t> counts;
+    for( size_t count = 1; count <= limit; count *= 2 ){
+        counts.push_back( count );
+    }
+    if( counts.back() != limit ){
+        counts.push_back( limit );
+    }
+    return counts;
+}
+
+template<typename layer_t>
+int compare_parallel_fill( const char* name, layer_t& serial, layer_t& parallel ){
+    const auto& bounds = serial.visible();
+    const double cell_count = static_cast<double>(serial.cells_across_view()) * serial.cells_across_view();
+    const Polygon<LocalLocation> coastline = make_coastline( bounds.center(), 0.4*bounds.width(), 64*1024 );
+
+    const double serial_ns = nanoseconds_per_operation( cell_count, parallel_fill_repeat_count, [&](){
+        serial.fill( coastline, bounds, 0x42 );
+    });
+    report( "parallel-fill", name, "serial", serial_ns );
+
+    for( const size_t thread_count : thread_counts() ){
+        WorkerPool pool( thread_count );
+        parallel.fill( chartbox::layer::clear_cell_value );
+        const double parallel_ns = nanoseconds_per_operation( cell_count, parallel_fill_repeat_count, [&](){
+            parallel.fill( coastline, bounds, 0x42, pool );
+        });
+        report( "parallel-fill", name, fmt::format("{} threads", thread_count).c_str(), parallel_ns );
+        fmt::print( "        >> speedup: {:.2f}x\n", serial_ns / parallel_ns );
+
+        const double incr = serial.meters_across_cell();
+        for( double northing = bounds.min.northing + incr/2; northing < bounds.max.northing; northing += incr ){
+            for( double easting = bounds.min.easting + incr/2; easting < bounds.max.easting; easting += incr ){
+                if( serial.get({easting, northing}) != parallel.get({easting, northing}) ){
+                    fmt::print( "        !! parallel fill differs from serial fill at: ({}, {}) !!\n", easting, northing );
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int profile_parallel_fill(){
+    fmt::print( "    ({} hardware threads)\n", std::thread::hardware_concurrency() );
+    int failures = 0;
+
+    {
+        auto serial = std::make_unique<RollingGridLayer<1024>>();
+        auto parallel = std::make_unique<RollingGridLayer<1024>>();
+        for( auto* each : {serial.get(), parallel.get()} ){
+            each->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+            each->fill( chartbox::layer::clear_cell_value );
+        }
+        failures += compare_parallel_fill( "RollingGridLayer<1024>", *serial, *parallel );
+    }{
+        DynamicGridLayer serial;
+        DynamicGridLayer parallel;
+        for( auto* each : {&serial, &parallel} ){
+            each->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+            each->fill( chartbox::layer::clear_cell_value );
+        }
+        failures += compare_parallel_fill( "DynamicGridLayer", serial, parallel );
+    }
+
+    return failures;
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+
+namespace chartbox::profile {
+
+constexpr size_t test_seed = 55;
+
+/// \brief time a callable, and report the mean nanoseconds spent per operation
+///
+/// \param operation_count - the number of operations performed by each call of `run`
+/// \param repeat - the number of times to call `run`; the fastest call is reported
+/// \param run - the code under test
+template<typename function_t>
+double nanoseconds_per_operation( size_t operation_count, size_t repeat, function_t&& run ){
+    double best = std::numeric_limits<double>::max();
+    for( size_t attempt = 0; attempt < repeat; ++attempt ){
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const auto finish = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double,std::nano>(finish - start).count();
+        best = std::min( best, elapsed / static_cast<double>(operation_count) );
+    }
+    return best;
+}
+
+/// \brief generate uniformly random locations inside the given bounds
+inline std::vector<geometry::LocalLocation> random_locations( const geometry::BoundBox<geometry::LocalLocation>& bounds, size_t count ){
+    std::mt19937 generator( test_seed );
+    std::uniform_real_distribution<double> easting_distribution( bounds.min.easting, bounds.max.easting );
+    std::uniform_real_distribution<double> northing_distribution( bounds.min.northing, bounds.max.northing );
+
+    std::vector<geometry::LocalLocation> locations;
+    locations.reserve( count );
+    for( size_t i = 0; i < count; ++i ){
+        locations.emplace_back( easting_distribution(generator), northing_distribution(generator) );
+    }
+    return locations;
+}
+
+/// \brief print a single line of results, in a common format
+inline void report( const char* suite, const char* layer, const char* variant, double nanoseconds ){
+    fmt::print( "    {:<16} {:<24} {:<24} {:>10.2f} ns/op\n", suite, layer, variant, nanoseconds );
+}
+
+/// \brief generate a closed, star-shaped polygon: alternating inner + outer radii, with `point_count` points each
+geometry::Polygon<geometry::LocalLocation> make_star( const geometry::LocalLocation& center, double inner_radius, double outer_radius, size_t point_count );
+
+/// \brief generate a closed, wavy 'coastline': many short edges, but few crossings per row
+geometry::Polygon<geometry::LocalLocation> make_coastline( const geometry::LocalLocation& center, double radius, size_t vertex_count );
+
+// ====== ====== Profile Suites ====== ======
+// each returns the count of failed sanity checks
+
+int profile_batch_query();
+int profile_cache_load();
+int profile_cell_address();
+int profile_cell_layout();
+int profile_composite();
+int profile_concurrent_read();
+int profile_fill();
+int profile_grid_layout();
+int profile_occupancy_scan();
+int profile_packed_grid();
+int profile_parallel_fill();
+int profile_raycast();
+int profile_region_query();
+int profile_relocate();
+int profile_scroll_latency();
+int profile_sensor_ingest();
+int profile_tacking();
+int profile_tree_index();
+
+} // namespace
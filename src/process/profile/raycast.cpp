@@ -0,0 +1,164 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "chart-box/chart-box.hpp"
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/layer-interface.hpp"
+#include "layer/raycast.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::ChartBox;
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::LayerInterface;
+using chartbox::layer::raycast_clear;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+// one frame of line-of-sight queries
+constexpr size_t raycast_count = 10000;
+
+constexpr size_t raycast_repeat = 3;
+
+// the point-sampling baseline samples every half cell
+constexpr double raycast_sample_step = 0.5;
+
+namespace {
+
+typedef RollingGridLayer<1024> raycast_layer_t;
+
+// the "before": sample `get` along each line, until a sample blocks
+void sample_lines( const raycast_layer_t& layer, const LocalLocation& origin, const std::vector<LocalLocation>& targets, uint8_t threshold, std::vector<double>& distances ){
+    for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+        const LocalLocation delta = targets[target_index] - origin;
+        const double length = std::hypot( delta.easting, delta.northing );
+        const LocalLocation step = delta * (raycast_sample_step / length);
+        distances[target_index] = raycast_clear;
+        LocalLocation p = origin;
+        for( double distance = 0; distance <= length; distance += raycast_sample_step, p = p + step ){
+            if( threshold <= layer.get(p) ){
+                distances[target_index] = distance;
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+// line-of-sight: point sampling, vs. walking the cells -- with and without skipping clear level-cells of the pyramid;
+// and across a ChartBox, with and without its composite
+int profile_raycast(){
+    int failures = 0;
+
+    auto layer = std::make_unique<raycast_layer_t>();
+    layer->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+    const auto& bounds = layer->visible();
+    const LocalLocation origin = bounds.min + LocalLocation( 400, 400 );
+    const std::vector<LocalLocation> targets = random_locations( bounds, raycast_count );
+
+    // open water, with scattered small obstacles; and a coastline
+    std::vector<BoundBox<LocalLocation>> obstacles;
+    std::mt19937 generator( test_seed );
+    std::uniform_real_distribution<double> coordinate_distribution( 0, 5100 );
+    for( size_t obstacle = 0; obstacle < 400; ++obstacle ){
+        const LocalLocation corner = bounds.min + LocalLocation( coordinate_distribution(generator), coordinate_distribution(generator) );
+        obstacles.emplace_back( corner, corner + LocalLocation( 12, 12 ) );
+    }
+    const Polygon<LocalLocation> coastline = make_coastline( bounds.center(), 0.4*bounds.width(), 64*1024 );
+
+    // the same map, in a chart's contour layer; each other layer stays unknown
+    auto chart = std::make_unique<ChartBox>();
+    auto& contour = chart->get_contour_layer();
+    contour.track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+
+    for( const bool coast : {false, true} ){
+        layer->enable_pyramid( false );
+        layer->fill( chartbox::layer::clear_cell_value );
+        contour.fill( chartbox::layer::clear_cell_value );
+        if( coast ){
+            layer->fill( coastline, bounds, chartbox::layer::block_cell_value );
+            contour.fill( coastline, bounds, chartbox::layer::block_cell_value );
+        }else{
+            for( const auto& obstacle : obstacles ){
+                layer->fill( obstacle, chartbox::layer::block_cell_value );
+                contour.fill( obstacle, chartbox::layer::block_cell_value );
+            }
+        }
+        const char* map = coast ? "coastline" : "open water";
+
+        std::vector<double> sampled( targets.size() );
+        const double sample_ns = nanoseconds_per_operation( targets.size(), raycast_repeat, [&](){
+            sample_lines( *layer, origin, targets, chartbox::layer::block_cell_value, sampled ); });
+        report( "raycast", map, "sample get() @ 0.5m", sample_ns );
+
+        std::vector<double> expected( targets.size() );
+        const auto& generic = static_cast<const LayerInterface<raycast_layer_t>&>( *layer );
+        const double generic_ns = nanoseconds_per_operation( targets.size(), raycast_repeat, [&](){
+            generic.raycast( origin, targets, chartbox::layer::block_cell_value, expected ); });
+        report( "raycast", map, "walk cells: get()", generic_ns );
+
+        std::vector<double> distances( targets.size() );
+        const auto check = [&](){
+            for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+                if( (raycast_clear == expected[target_index]) != (raycast_clear == distances[target_index])
+                        || ((raycast_clear != expected[target_index]) && (1e-6 < std::fabs(expected[target_index] - distances[target_index]))) ){
+                    fmt::print( "    !! line {} blocked at {}; expected {}\n", target_index, distances[target_index], expected[target_index] );
+                    ++failures;
+                    return;
+                }
+            }
+        };
+
+        for( const bool pyramid : {false, true} ){
+            layer->enable_pyramid( pyramid );
+            const double walk_ns = nanoseconds_per_operation( targets.size(), raycast_repeat, [&](){
+                layer->raycast( origin, targets, chartbox::layer::block_cell_value, distances ); });
+            report( "raycast", map, pyramid ? "walk cells: + pyramid" : "walk cells: direct", walk_ns );
+            check();
+        }
+
+        // the chart folds every layer, for each block and cell it visits; unless its composite holds the fold
+        for( const bool composite : {false, true} ){
+            chart->enable_composite( false );
+            chart->enable_composite( composite );
+            const double chart_ns = nanoseconds_per_operation( targets.size(), raycast_repeat, [&](){
+                chart->raycast( origin, targets, chartbox::layer::block_cell_value, distances ); });
+            report( "raycast", map, composite ? "ChartBox: composite" : "ChartBox: on the fly", chart_ns );
+            check();
+        }
+        chart->enable_composite( false );
+
+        // (sampling can step over the corner of a cell; but never stops short of it)
+        size_t blocked = 0;
+        size_t missed = 0;
+        for( size_t target_index = 0; target_index < targets.size(); ++target_index ){
+            blocked += (raycast_clear != expected[target_index]);
+            missed += (raycast_clear != expected[target_index]) && (raycast_clear == sampled[target_index]);
+            if( sampled[target_index] < (expected[target_index] - 1e-6) ){
+                fmt::print( "    !! line {} was sampled blocked at {}; before its first blocking cell at {}\n", target_index, sampled[target_index], expected[target_index] );
+                ++failures;
+                break;
+            }
+        }
+        fmt::print( "        >> blocked: {} / {};  missed by sampling: {}\n", blocked, targets.size(), missed );
+    }
+    layer->enable_pyramid( false );
+
+    return failures;
+}
+
+} // namespace
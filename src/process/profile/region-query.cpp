@@ -0,0 +1,85 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t region_query_count = 1000;
+constexpr size_t region_query_repeat_count = 3;
+constexpr size_t region_store_count = 1024*1024;
+
+// "is there any land within `radius` of this waypoint?" -- answered from each level of the pyramid
+int profile_region_query(){
+    typedef RollingGridLayer<1024> layer_t;
+    int failures = 0;
+
+    auto layer = std::make_unique<layer_t>();
+    layer->track( BoundBox<LocalLocation>({0,0}, {5120,5120}) );
+    const auto& bounds = layer->visible();
+    const Polygon<LocalLocation> coastline = make_coastline( bounds.center(), 0.4*bounds.width(), 64*1024 );
+    const std::vector<LocalLocation> locations = random_locations( bounds, region_store_count );
+
+    // cost of keeping the pyramid up to date:
+    for( const bool pyramid : {false, true} ){
+        layer->enable_pyramid( pyramid );
+        layer->fill( chartbox::layer::clear_cell_value );
+        const double store_ns = nanoseconds_per_operation( locations.size(), region_query_repeat_count, [&](){
+            for( size_t i = 0; i < locations.size(); ++i ){
+                layer->store( locations[i], static_cast<uint8_t>(i) );
+            }
+        });
+        report( "region-query", "RollingGridLayer<1024>", pyramid ? "store + pyramid" : "store", store_ns );
+    }
+
+    layer->fill( chartbox::layer::clear_cell_value );
+    layer->fill( coastline, bounds, chartbox::layer::block_cell_value );
+
+    const std::vector<LocalLocation> waypoints = random_locations( bounds, region_query_count );
+    for( const double radius : {16.0, 64.0, 256.0} ){
+        std::vector<uint8_t> exact( waypoints.size() );
+        for( size_t i = 0; i < waypoints.size(); ++i ){
+            exact[i] = layer->max( {waypoints[i] - LocalLocation(radius, radius), waypoints[i] + LocalLocation(radius, radius)}, 0 );
+        }
+
+        for( uint32_t level = 0; level <= layer->level_count(); level += 2 ){
+            std::vector<uint8_t> found( waypoints.size() );
+            const double query_ns = nanoseconds_per_operation( waypoints.size(), region_query_repeat_count, [&](){
+                for( size_t i = 0; i < waypoints.size(); ++i ){
+                    found[i] = layer->max( {waypoints[i] - LocalLocation(radius, radius), waypoints[i] + LocalLocation(radius, radius)}, level );
+                }
+            });
+            report( "region-query", fmt::format("radius {:.0f}m", radius).c_str(), fmt::format("level {}", level).c_str(), query_ns );
+
+            size_t false_alarms = 0;
+            for( size_t i = 0; i < waypoints.size(); ++i ){
+                if( found[i] < exact[i] ){
+                    fmt::print( "        !! level {} misses a cell near: ({}, {}) !!\n", level, waypoints[i].easting, waypoints[i].northing );
+                    ++failures;
+                    break;
+                }
+                false_alarms += (found[i] != exact[i]);
+            }
+            fmt::print( "        >> false alarms: {} / {}\n", false_alarms, waypoints.size() );
+        }
+    }
+
+    return failures;
+}
+
+} // namespace
@@ -0,0 +1,95 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "io/flatbuffer.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t relocate_jump_count = 8;
+constexpr size_t relocate_repeat_count = 3;
+
+int profile_relocate(){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-profile-relocate";
+    std::filesystem::create_directories( cache_path );
+
+    auto layer = std::make_unique<RollingGridLayer<256>>();
+    layer->track( BoundBox<LocalLocation>({0,0}, {256*16,256*16}) );
+    layer->fill( chartbox::layer::clear_cell_value );
+    layer->enable_cache( cache_path );
+
+    // a diagonal jump: two sectors east and north; and then back again
+    const LocalLocation home = layer->visible().min;
+    const LocalLocation away = home + LocalLocation( 2, 2 ) * layer->meters_across_sector();
+
+    // the same diagonal jump, by single-sector scrolls
+    const auto scroll_there_and_back = [&]( bool modify ){
+        for( auto scroll : { &RollingGridLayer<256>::scroll_east, &RollingGridLayer<256>::scroll_east,
+                             &RollingGridLayer<256>::scroll_north, &RollingGridLayer<256>::scroll_north,
+                             &RollingGridLayer<256>::scroll_west, &RollingGridLayer<256>::scroll_west,
+                             &RollingGridLayer<256>::scroll_south, &RollingGridLayer<256>::scroll_south } ){
+            if( modify ){
+                layer->fill( chartbox::layer::clear_cell_value );
+            }
+            ((*layer).*scroll)();
+        }
+    };
+
+    // write every tile once, so that each timed load finds its file
+    scroll_there_and_back( true );
+    layer->flush_to_cache();
+
+    // unmodified sectors are not written back:
+    const uint64_t written_before = chartbox::io::flatbuffer::bytes_written();
+
+    const double scroll_ns = nanoseconds_per_operation( relocate_jump_count, relocate_repeat_count, [&](){
+        for( size_t jump = 0; jump < relocate_jump_count; jump += 2 ){
+            scroll_there_and_back( false );
+        }
+    });
+    const double relocate_ns = nanoseconds_per_operation( relocate_jump_count, relocate_repeat_count, [&](){
+        for( size_t jump = 0; jump < relocate_jump_count; jump += 2 ){
+            layer->relocate( away );
+            layer->relocate( home );
+        }
+    });
+
+    const uint64_t clean_bytes = chartbox::io::flatbuffer::bytes_written() - written_before;
+
+    // ... and modified sectors are:
+    layer->fill( chartbox::layer::block_cell_value );
+    layer->relocate( away );
+    const uint64_t dirty_bytes = chartbox::io::flatbuffer::bytes_written() - written_before - clean_bytes;
+    layer->relocate( home );
+
+    report( "relocate", "RollingGridLayer<256>", "diagonal (4 scrolls)", scroll_ns );
+    report( "relocate", "RollingGridLayer<256>", "diagonal (relocate)", relocate_ns );
+    fmt::print( "        >> speedup: {:.2f}x    (20 => 16 sectors loaded per jump)\n", scroll_ns / relocate_ns );
+    fmt::print( "        >> bytes written: {} over {} clean jumps;  {} for one jump after a fill\n",
+                clean_bytes, 2 * relocate_jump_count * relocate_repeat_count, dirty_bytes );
+
+    const bool returned = (home == layer->visible().min);
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+
+    if( not returned ){
+        fmt::print( "        !! view did not return to its starting origin !!\n" );
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
@@ -0,0 +1,87 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "io/flatbuffer.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t scroll_count = 16;
+
+// time between scrolls, spent elsewhere in the control loop
+constexpr auto scroll_period = std::chrono::milliseconds(50);
+
+// latency of each scroll in a steady eastward transit, in milliseconds
+std::vector<double> transit_east( RollingGridLayer<1024>& layer ){
+    std::vector<double> latencies;
+    for( size_t scroll = 0; scroll < scroll_count; ++scroll ){
+        const auto start = std::chrono::steady_clock::now();
+        layer.scroll_east();
+        const auto finish = std::chrono::steady_clock::now();
+        latencies.push_back( std::chrono::duration<double,std::milli>(finish - start).count() );
+
+        std::this_thread::sleep_for( scroll_period );
+    }
+    return latencies;
+}
+
+double percentile( std::vector<double> values, double fraction ){
+    std::sort( values.begin(), values.end() );
+    const size_t index = std::min( values.size() - 1, static_cast<size_t>(fraction * static_cast<double>(values.size())) );
+    return values[index];
+}
+
+int profile_scroll_latency(){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-profile-scroll";
+    std::filesystem::create_directories( cache_path );
+
+    auto layer = std::make_unique<RollingGridLayer<1024>>();
+    layer->track( BoundBox<LocalLocation>({0,0}, {1024*64,1024*64}) );
+    layer->fill( chartbox::layer::clear_cell_value );
+    layer->enable_cache( cache_path );
+    const LocalLocation home = layer->visible().min;
+
+    // write every tile along the route once, so that each timed load finds its file
+    for( size_t scroll = 0; scroll <= scroll_count; ++scroll ){
+        layer->fill( chartbox::layer::clear_cell_value );
+        layer->scroll_east();
+    }
+    layer->flush_to_cache();
+    layer->relocate( home );
+
+    const std::vector<double> blocking = transit_east( *layer );
+    layer->relocate( home );
+
+    layer->enable_prefetch( true );
+    const std::vector<double> prefetched = transit_east( *layer );
+    layer->enable_prefetch( false );
+
+    fmt::print( "    {:<16} {:<24} {:<24} {:>10} {:>10}\n", "", "", "", "p50 (ms)", "p99 (ms)" );
+    fmt::print( "    {:<16} {:<24} {:<24} {:>10.2f} {:>10.2f}\n", "scroll-latency", "RollingGridLayer<1024>", "blocking",
+                percentile(blocking, 0.50), percentile(blocking, 0.99) );
+    fmt::print( "    {:<16} {:<24} {:<24} {:>10.2f} {:>10.2f}\n", "scroll-latency", "RollingGridLayer<1024>", "prefetch",
+                percentile(prefetched, 0.50), percentile(prefetched, 0.99) );
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+    return 0;
+}
+
+} // namespace
@@ -0,0 +1,122 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "layer/sensor/sensor-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::sensor::SensorHit;
+using chartbox::layer::sensor::SensorLayer;
+
+namespace chartbox::profile {
+
+// one second of a marine lidar
+constexpr size_t ingest_hit_count = 1000000;
+
+// hits per packet, as the driver delivers them
+constexpr size_t ingest_batch_size = 10000;
+
+constexpr size_t ingest_repeat = 3;
+
+namespace {
+
+// a rotating scan around the vessel: returns between 5 m and 600 m out, at random ranges
+std::vector<SensorHit> make_scan( const LocalLocation& center, size_t count ){
+    std::mt19937 generator( test_seed );
+    std::uniform_real_distribution<double> range_distribution( 5, 600 );
+    std::uniform_int_distribution<int> value_distribution( 0, 255 );
+
+    std::vector<SensorHit> hits;
+    hits.reserve( count );
+    for( size_t i = 0; i < count; ++i ){
+        const double azimuth = 2 * M_PI * static_cast<double>(i) / 2048;
+        const double range = range_distribution( generator );
+        hits.push_back({ center + LocalLocation( range * std::cos(azimuth), range * std::sin(azimuth) ),
+                         static_cast<uint8_t>(value_distribution(generator)) });
+    }
+    return hits;
+}
+
+} // namespace
+
+// sensor ingestion: direct writes from one thread, vs. batches queued by many producers, and applied by sector
+int profile_sensor_ingest(){
+    int failures = 0;
+
+    auto layer = std::make_unique<SensorLayer<256>>();
+    layer->fill( chartbox::layer::unknown_cell_value );
+    const std::vector<SensorHit> hits = make_scan( layer->visible().center(), ingest_hit_count );
+    const std::span<const SensorHit> all_hits( hits );
+
+    const double store_ns = nanoseconds_per_operation( hits.size(), ingest_repeat, [&](){
+        for( const auto& hit : hits ){
+            layer->store( hit.location, hit.value );
+        }
+    });
+    report( "sensor-ingest", "SensorLayer<256>", "direct store", store_ns );
+
+    double apply_ns = std::numeric_limits<double>::max();
+    const double submit_ns = nanoseconds_per_operation( hits.size(), ingest_repeat, [&](){
+        for( size_t offset = 0; offset < hits.size(); offset += ingest_batch_size ){
+            layer->submit( all_hits.subspan( offset, std::min(ingest_batch_size, hits.size() - offset) ) );
+        }
+
+        // (timed separately)
+        const auto start = std::chrono::steady_clock::now();
+        layer->apply();
+        apply_ns = std::min( apply_ns, std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(hits.size()) );
+    });
+    report( "sensor-ingest", "SensorLayer<256>", "submit", submit_ns - apply_ns );
+    report( "sensor-ingest", "SensorLayer<256>", "apply (by sector)", apply_ns );
+
+    // producers submit their share of the scan, while this thread applies:
+    for( const size_t producer_count : {1, 2, 4} ){
+        const uint64_t applied_before = layer->applied();
+        const double ingest_ns = nanoseconds_per_operation( hits.size(), 1, [&](){
+            std::atomic<size_t> finished = 0;
+            std::vector<std::thread> producers;
+            for( size_t producer = 0; producer < producer_count; ++producer ){
+                producers.emplace_back( [&, producer](){
+                    for( size_t offset = producer * ingest_batch_size; offset < hits.size(); offset += producer_count * ingest_batch_size ){
+                        layer->submit( all_hits.subspan( offset, std::min(ingest_batch_size, hits.size() - offset) ) );
+                    }
+                    ++finished;
+                });
+            }
+            while( producer_count > finished ){
+                layer->apply();
+            }
+            for( auto& producer : producers ){
+                producer.join();
+            }
+            layer->apply();
+        });
+        report( "sensor-ingest", "SensorLayer<256>", fmt::format( "{} producer(s) + apply", producer_count ).c_str(), ingest_ns );
+
+        if( hits.size() != (layer->applied() - applied_before) ){
+            fmt::print( "    !! applied {} of {} hits\n", layer->applied() - applied_before, hits.size() );
+            ++failures;
+        }
+    }
+
+    if( 0 < layer->dropped() ){
+        fmt::print( "    !! dropped {} hits\n", layer->dropped() );
+        ++failures;
+    }
+    return failures;
+}
+
+} // namespace
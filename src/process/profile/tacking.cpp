@@ -0,0 +1,75 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "io/flatbuffer.hpp"
+#include "layer/rolling-grid/rolling-grid-layer.hpp"
+#include "layer/rolling-grid/sector-pool.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::layer::rolling::RollingGridLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t tacking_scroll_count = 16;
+constexpr size_t tacking_repeat_count = 3;
+
+// tack back and forth across a sector boundary -- marking the view on each leg, so that evicted sectors are dirty
+int profile_tacking(){
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "chartbox-profile-tacking";
+    std::filesystem::remove_all( cache_path );
+    std::filesystem::create_directories( cache_path );
+
+    int failures = 0;
+    for( const size_t pool_capacity : {0, 5, 10} ){
+        auto layer = std::make_unique<RollingGridLayer<256>>();
+        layer->track( BoundBox<LocalLocation>({0,0}, {256*16,256*16}) );
+        layer->enable_cache( cache_path );
+        layer->fill( chartbox::layer::clear_cell_value );
+        layer->enable_pool( pool_capacity );
+
+        // mark the south-west + north-east sectors -- one of which leaves the view on the next leg
+        const auto mark = [&]( uint8_t value ){
+            layer->store( layer->visible().min + LocalLocation( 0.5, 0.5 ), value );
+            layer->store( layer->visible().max - LocalLocation( 0.5, 0.5 ), value );
+        };
+
+        const uint64_t written_before = chartbox::io::flatbuffer::bytes_written();
+        const double scroll_ns = nanoseconds_per_operation( tacking_scroll_count, tacking_repeat_count, [&](){
+            for( size_t scroll = 0; scroll < tacking_scroll_count; scroll += 2 ){
+                layer->scroll_east();
+                mark( static_cast<uint8_t>(scroll) );
+                layer->scroll_west();
+                mark( static_cast<uint8_t>(scroll + 1) );
+            }
+        });
+        const uint64_t written_bytes = chartbox::io::flatbuffer::bytes_written() - written_before;
+
+        report( "tacking", "RollingGridLayer<256>", fmt::format("pool of {} sectors", pool_capacity).c_str(), scroll_ns );
+        if( layer->pool() ){
+            fmt::print( "        >> hits: {}   misses: {}   bytes written: {}\n", layer->pool()->hits(), layer->pool()->misses(), written_bytes );
+        }else{
+            fmt::print( "        >> bytes written: {}\n", written_bytes );
+        }
+
+        if( static_cast<uint8_t>(tacking_scroll_count - 1) != layer->get( layer->visible().min + LocalLocation( 0.5, 0.5 ) )){
+            fmt::print( "        !! last mark is missing !!\n" );
+            ++failures;
+        }
+    }
+
+    chartbox::io::flatbuffer::cache_directory_path.clear();
+    std::filesystem::remove_all( cache_path );
+    return failures;
+}
+
+} // namespace
@@ -0,0 +1,126 @@
+// GPL v3 (c) 2021, Daniel Williams
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "geometry/bound-box.hpp"
+#include "geometry/local-location.hpp"
+#include "geometry/polygon.hpp"
+#include "layer/dynamic-grid/dynamic-grid-layer.hpp"
+#include "layer/n-tree/n-tree-layer.hpp"
+#include "layer/quad-tree/hybrid-tree-layer.hpp"
+#include "layer/quad-tree/quad-tree-layer.hpp"
+
+#include "profile.hpp"
+
+using chartbox::geometry::BoundBox;
+using chartbox::geometry::LocalLocation;
+using chartbox::geometry::Polygon;
+using chartbox::layer::HybridTreeLayer;
+using chartbox::layer::QuadTreeLayer;
+using chartbox::layer::dynamic::DynamicGridLayer;
+using chartbox::layer::ntree::NTreeLayer;
+
+namespace chartbox::profile {
+
+constexpr size_t tree_index_point_count = 1000000;
+constexpr size_t tree_index_store_count = 1000;
+constexpr size_t tree_index_repeat = 3;
+
+// build, fill, and query a single tree index; return the sum of every queried cell
+template<typename tree_t>
+uint64_t profile_tree( const char* name, const std::vector<uint8_t>& cells, const Polygon<LocalLocation>& coastline,
+                       const std::vector<LocalLocation>& points, size_t grid_bytes ){
+    const BoundBox<LocalLocation> bounds( {0,0}, LocalLocation(tree_t::dimension) );
+    auto tree = std::make_unique<tree_t>();
+
+    // (1) construction: from a dense grid, and by rasterizing the polygon
+    const double build_ns = nanoseconds_per_operation( cells.size(), tree_index_repeat, [&](){
+        tree->fill( cells.data(), cells.size() );
+    });
+    report( "tree-index", name, "build from grid", build_ns );
+
+    const double polygon_ns = nanoseconds_per_operation( cells.size(), tree_index_repeat, [&](){
+        tree->fill( chartbox::layer::clear_cell_value );
+        tree->fill( coastline, bounds, chartbox::layer::block_cell_value );
+    });
+    report( "tree-index", name, "polygon fill", polygon_ns );
+
+    // (2) memory
+    fmt::print( "        >> memory: {:>8} bytes  ({:.1f}% of the grid); {} levels deep\n",
+                tree->memory_usage(), 100.0 * tree->memory_usage() / grid_bytes, tree->height() );
+
+    // (3) point queries
+    uint64_t sum = 0;
+    const double get_ns = nanoseconds_per_operation( points.size(), tree_index_repeat, [&](){
+        for( const auto& point : points ){
+            sum += tree->get( point );
+        }
+    });
+    report( "tree-index", name, "point query", get_ns );
+
+    // (4) single-cell writes
+    const std::vector<LocalLocation> stores = random_locations( bounds, tree_index_store_count );
+    const double store_ns = nanoseconds_per_operation( stores.size(), 1, [&](){
+        for( const auto& point : stores ){
+            tree->store( point, 0x42 );
+        }
+    });
+    report( "tree-index", name, "single store", store_ns );
+
+    return sum / tree_index_repeat;
+}
+
+int profile_tree_index(){
+    constexpr uint32_t dimension = QuadTreeLayer::dimension;
+    const BoundBox<LocalLocation> bounds( {0,0}, LocalLocation(dimension) );
+
+    // a mostly-uniform chart: open water, and a single large island
+    const Polygon<LocalLocation> coastline = make_coastline( bounds.center(), 0.4*bounds.width(), 4096 );
+
+    DynamicGridLayer grid;
+    grid.meters_across_cell( 1.0 );
+    grid.track( bounds );
+
+    const double grid_polygon_ns = nanoseconds_per_operation( dimension * dimension, tree_index_repeat, [&](){
+        grid.fill( chartbox::layer::clear_cell_value );
+        grid.fill( coastline, bounds, chartbox::layer::block_cell_value );
+    });
+    report( "tree-index", "DynamicGridLayer", "polygon fill", grid_polygon_ns );
+
+    std::vector<uint8_t> cells( dimension * dimension );
+    for( uint32_t row = 0; row < dimension; ++row ){
+        for( uint32_t column = 0; column < dimension; ++column ){
+            cells[column + row*dimension] = grid.get({column + 0.5, row + 0.5});
+        }
+    }
+
+    const std::vector<LocalLocation> points = random_locations( {{0,0}, LocalLocation(dimension - 0.01)}, tree_index_point_count );
+    uint64_t grid_sum = 0;
+    const double grid_get_ns = nanoseconds_per_operation( points.size(), tree_index_repeat, [&](){
+        for( const auto& point : points ){
+            grid_sum += grid.get( point );
+        }
+    });
+    report( "tree-index", "DynamicGridLayer", "point query", grid_get_ns );
+    grid_sum /= tree_index_repeat;
+
+    int failures = 0;
+    const auto check = [&]( const char* name, uint64_t sum ){
+        if( sum != grid_sum ){
+            fmt::print( "        !! {} and grid disagree: {} vs {} !!\n", name, sum, grid_sum );
+            ++failures;
+        }
+    };
+    check( "QuadTreeLayer", profile_tree<QuadTreeLayer>( "QuadTreeLayer", cells, coastline, points, grid.cells_in_view() ) );
+    check( "HybridTreeLayer<32>", profile_tree<HybridTreeLayer<32>>( "HybridTreeLayer<32>", cells, coastline, points, grid.cells_in_view() ) );
+    check( "HybridTreeLayer<64>", profile_tree<HybridTreeLayer<64>>( "HybridTreeLayer<64>", cells, coastline, points, grid.cells_in_view() ) );
+    check( "NTreeLayer<16>", profile_tree<NTreeLayer<16>>( "NTreeLayer<16>", cells, coastline, points, grid.cells_in_view() ) );
+    check( "NTreeLayer<32>", profile_tree<NTreeLayer<32>>( "NTreeLayer<32>", cells, coastline, points, grid.cells_in_view() ) );
+    return failures;
+}
+
+} // namespace